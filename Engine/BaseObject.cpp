@@ -7,11 +7,11 @@ Date: 13/12/2018
 */
 
 #include <DirectXMath.h>
-#include <DirectXCollision.h>
 #include "BaseObject.h"
 #include "World.h"
 #include "graphicsclass.h"
 #include "HitResult.h"
+#include "MathUtil.h"
 
 // The base object class is a generic class which contains information which all objects can use for common purposes
 // This reduces the amount of repeated code and allows for faster addition of many objects
@@ -114,6 +114,7 @@ BaseObject::BaseObject(const char* Name, const char* ModelPath, WCHAR* MaterialP
 	pAngularVelocity = new XMFLOAT3(0.f, 0.f, 0.f);
 
 	pModelClass = new BumpModelClass;
+	mOwnsModel = true;
 	this->pModelPath = ModelPath;
 	this->pMaterialPath = MaterialPath;
 	this->pMaterialPath2 = MaterialPath2;
@@ -131,6 +132,7 @@ BaseObject::BaseObject(const char* Name, const char* ModelPath, WCHAR* MaterialP
 	mHoveringEnabled = false;
 	mDrawOBB = false;
 	mDrawAABB = false;
+	pCollisionUtil = 0;
 
 	pWorld = NULL;
 }
@@ -172,13 +174,26 @@ bool BaseObject::IsInitialized()
 	return Initialized;
 }
 
+// The world owns the objects it creates and deletes them, destroyed ones included, when it
+// goes, see World::DestroyObject. Virtual so a Ship or a Missile frees through its base.
+
 BaseObject::~BaseObject()
 {
-	if (pModelClass) {
+	if (pModelClass && mOwnsModel) {
 		pModelClass->Shutdown();
 		delete pModelClass;
-		pModelClass = 0;
 	}
+	pModelClass = 0;
+
+	delete pScale;
+	delete pPosition;
+	delete pVelocity;
+	delete pAngle;
+	delete pAngularVelocity;
+
+	delete pOBB;
+	delete pAABB;
+	delete pCollisionUtil;
 }
 
 const char* BaseObject::GetName()
@@ -211,8 +226,15 @@ void BaseObject::OnDestroy()
 
 }
 
+// Other objects may read the flag during a parallel update, so there it is set once the update is over
 void BaseObject::Destroy()
 {
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->Destroy(this);
+		return;
+	}
+
 	mDestroyed = true;
 }
 
@@ -221,7 +243,7 @@ bool BaseObject::IsDestroyed()
 	return mDestroyed;
 }
 
-bool BaseObject::operator==(BaseObject other)
+bool BaseObject::operator==(const BaseObject& other)
 {
 	return ID == other.ID;
 }
@@ -233,6 +255,11 @@ void BaseObject::SetModelPath(const char* ModelPath) {
 
 	if (!Initialized) { return; }
 
+	if (mOwnsModel) {
+		delete pModelClass;
+		mOwnsModel = false;
+	}
+
 	bool CacheContainsModel = pWorld->ModelCache.find(ModelPath) != pWorld->ModelCache.end();
 	if (CacheContainsModel) {
 		BumpModelClass* pCachedModelClass = pWorld->ModelCache.at(ModelPath);
@@ -272,65 +299,145 @@ WCHAR* BaseObject::GetNormalPath() {
 
 void BaseObject::SetParent(BaseObject* pParent) {
 	this->pParent = pParent;
+
+	// Children have to come after their parents in the world's transform pass
+	if (pWorld != NULL) {
+		pWorld->InvalidateTransformOrder();
+	}
 }
 
 BaseObject* BaseObject::GetParent() {
 	return pParent;
 }
 
-XMMATRIX TransformRotation(XMMATRIX* pMatrix, XMFLOAT3* pAngle) {
-	XMMATRIX Matrix = *pMatrix;
+// The world matrix is cached along with two frame matrices, the rotation and translation of the
+// object and its parents with and without the object's own rotation. A child is placed inside its
+// parent's frame, so parent scale is never applied, and a child with bDontTransformParentRotation
+// uses the frame without the parent's rotation.
+// The cache is rebuilt only when the scale, position, orientation or parent differ from the values it
+// was built with, or when the parent's cache has been rebuilt since, so an object that does not move
+// costs a few comparisons. Parents are brought up to date first so a chain is never out of order.
+// Objects without a parent are normally built in a batch by World::UpdateTransforms instead.
 
-	if (pAngle->z != 0.f) {
-		Matrix = XMMatrixMultiply(Matrix, XMMatrixRotationZ(pAngle->z));
-	}
-	if (pAngle->y != 0.f) {
-		Matrix = XMMatrixMultiply(Matrix, XMMatrixRotationY(pAngle->y));
+void BaseObject::UpdateTransform()
+{
+	unsigned int parentVersion = 0;
+
+	if (pParent != 0) {
+		pParent->UpdateTransform();
+		parentVersion = pParent->mTransformVersion;
 	}
-	if (pAngle->x != 0.f) {
-		Matrix = XMMatrixMultiply(Matrix, XMMatrixRotationX(pAngle->x));
+
+	SyncOrientation();
+
+	bool unchanged = mTransformVersion != 0 &&
+		pParent == mCachedParent && parentVersion == mCachedParentVersion &&
+		bDontTransformParentRotation == mCachedDontTransformParentRotation &&
+		pScale->x == mCachedScale.x && pScale->y == mCachedScale.y && pScale->z == mCachedScale.z &&
+		pPosition->x == mCachedPosition.x && pPosition->y == mCachedPosition.y && pPosition->z == mCachedPosition.z &&
+		mOrientation.x == mCachedOrientation.x && mOrientation.y == mCachedOrientation.y &&
+		mOrientation.z == mCachedOrientation.z && mOrientation.w == mCachedOrientation.w;
+
+	if (unchanged) { return; }
+
+	XMMATRIX translation = XMMatrixTranslation(pPosition->x, pPosition->y, pPosition->z);
+	XMMATRIX frame = XMMatrixMultiply(GetRotationMatrix(), translation);
+	XMMATRIX frameNoRotation = translation;
+
+	if (pParent != 0) {
+		XMMATRIX parentFrame = XMLoadFloat4x4(bDontTransformParentRotation ? &pParent->mFrameMatrixNoRotation : &pParent->mFrameMatrix);
+
+		frame = XMMatrixMultiply(frame, parentFrame);
+		frameNoRotation = XMMatrixMultiply(frameNoRotation, parentFrame);
 	}
 
-	return Matrix;
+	XMMATRIX scale = XMMatrixScaling(pScale->x, pScale->y, pScale->z);
+
+	XMStoreFloat4x4(&mFrameMatrix, frame);
+	XMStoreFloat4x4(&mFrameMatrixNoRotation, frameNoRotation);
+	XMStoreFloat4x4(&mWorldMatrix, XMMatrixMultiply(scale, frame));
+	XMStoreFloat4x4(&mWorldMatrixNoRotation, XMMatrixMultiply(scale, frameNoRotation));
+
+	CommitTransform(parentVersion);
 }
 
-XMMATRIX TransformPosition(XMMATRIX* pMatrix, XMFLOAT3* pPosition) {
-	XMMATRIX Matrix = *pMatrix;
+// Used by the world's batch pass to find the objects without a parent that need new matrices
 
-	Matrix = XMMatrixMultiply(Matrix, XMMatrixTranslation(pPosition->x, pPosition->y, pPosition->z));
+bool BaseObject::TransformNeedsUpdate()
+{
+	SyncOrientation();
 
-	return Matrix;
+	return mTransformVersion == 0 || pParent != mCachedParent ||
+		pScale->x != mCachedScale.x || pScale->y != mCachedScale.y || pScale->z != mCachedScale.z ||
+		pPosition->x != mCachedPosition.x || pPosition->y != mCachedPosition.y || pPosition->z != mCachedPosition.z ||
+		mOrientation.x != mCachedOrientation.x || mOrientation.y != mCachedOrientation.y ||
+		mOrientation.z != mCachedOrientation.z || mOrientation.w != mCachedOrientation.w;
 }
 
-// This recursive function is used to evaluate the world position of an object
-// This function is recursive in order to take into account parent object matrices to modify the location of the child object
-// This allows for one parent object to have one or more children which move along with it
-// Children of a parent can also have their own children
-// This is more useful for planet orbits than the city scene
+// Takes matrices built by MathUtil::BuildWorldMatrices for an object without a parent
 
-XMMATRIX CalculateWorldPosition(XMMATRIX* pOrigin, BaseObject* pObject, bool dontTransformRotation) {
-	XMMATRIX origin = *pOrigin;
-	XMFLOAT3* pAngle = pObject->pAngle;
-	XMFLOAT3* pPosition = pObject->pPosition;
+void BaseObject::SetRootTransform(const XMFLOAT4X4& world, const XMFLOAT4X4& frame)
+{
+	XMMATRIX translation = XMMatrixTranslation(pPosition->x, pPosition->y, pPosition->z);
 
-	if (pObject->bRotateFirst) {
-		if (!dontTransformRotation) {
-			origin = TransformRotation(&origin, pAngle);
-		}
-		origin = TransformPosition(&origin, pPosition);
+	mWorldMatrix = world;
+	mFrameMatrix = frame;
+	XMStoreFloat4x4(&mFrameMatrixNoRotation, translation);
+	XMStoreFloat4x4(&mWorldMatrixNoRotation, XMMatrixMultiply(XMMatrixScaling(pScale->x, pScale->y, pScale->z), translation));
+
+	CommitTransform(0);
+}
+
+void BaseObject::CommitTransform(unsigned int parentVersion)
+{
+	mCachedScale = *pScale;
+	mCachedPosition = *pPosition;
+	mCachedOrientation = mOrientation;
+	mCachedParent = pParent;
+	mCachedParentVersion = parentVersion;
+	mCachedDontTransformParentRotation = bDontTransformParentRotation;
+
+	// Zero is kept for a cache that has never been built
+	mTransformVersion++;
+	if (mTransformVersion == 0) {
+		mTransformVersion = 1;
 	}
-	else {
-		if (!dontTransformRotation) {
-			origin = TransformRotation(&origin, pAngle);
-		}
-		origin = TransformPosition(&origin, pPosition);
+}
+
+int BaseObject::GetHierarchyDepth()
+{
+	int depth = 0;
+
+	for (BaseObject* pAncestor = GetParent(); pAncestor != 0; pAncestor = pAncestor->GetParent()) {
+		depth++;
 	}
 
-	if (pObject->GetParent() != 0) {
-		origin = CalculateWorldPosition(&origin, pObject->GetParent(), pObject->bDontTransformParentRotation);
+	return depth;
+}
+
+void BaseObject::SavePreviousTransform()
+{
+	mPreviousPosition = *pPosition;
+	mPreviousOrientation = GetOrientation();
+	mPreviousScale = *pScale;
+	mHasPreviousTransform = true;
+}
+
+// The state saved at the start of the last step. An object created during the step has nothing
+// saved yet and gives its current state.
+
+void BaseObject::GetPreviousTransform(XMFLOAT3& position, XMFLOAT4& orientation, XMFLOAT3& scale)
+{
+	if (!mHasPreviousTransform) {
+		position = *pPosition;
+		orientation = GetOrientation();
+		scale = *pScale;
+		return;
 	}
 
-	return origin;
+	position = mPreviousPosition;
+	orientation = mPreviousOrientation;
+	scale = mPreviousScale;
 }
 
 XMMATRIX BaseObject::GetWorldMatrix(XMMATRIX origin)
@@ -340,15 +447,13 @@ XMMATRIX BaseObject::GetWorldMatrix(XMMATRIX origin)
 
 // This returns the world matrix of the object, taking into account its parent (if it has one)
 XMMATRIX BaseObject::GetWorldMatrix(XMMATRIX origin, bool useRotation) {
-	
-	origin = XMMatrixScaling(pScale->x, pScale->y, pScale->z);
-	origin = CalculateWorldPosition(&origin, this, !useRotation);
-
 	if (mUseOrientationMatrix) {
 		return mOrientationMatrix;
 	}
 
-	return origin;
+	UpdateTransform();
+
+	return XMLoadFloat4x4(useRotation ? &mWorldMatrix : &mWorldMatrixNoRotation);
 }
 
 void BaseObject::SetScale(float scale) {
@@ -360,9 +465,7 @@ void BaseObject::SetAngle(float p, float y, float r) {
 
 	pAngle = new XMFLOAT3(p * DegToRad, y * DegToRad, r * DegToRad);
 
-	if (pAABBModel != 0) {
-		ComputeAABB();
-	}
+	// The AABB catches up in the world's bounds pass rather than being rebuilt here
 }
 
 XMFLOAT3 BaseObject::GetAngle() {
@@ -371,6 +474,30 @@ XMFLOAT3 BaseObject::GetAngle() {
 	return XMFLOAT3(pAngle->x / DegToRad, pAngle->y / DegToRad, pAngle->z / DegToRad);
 }
 
+// Game code still writes Euler angles to pAngle, so any change there replaces the quaternion.
+// SetOrientation leaves pAngle alone, the quaternion stands until pAngle is next changed.
+
+void BaseObject::SyncOrientation()
+{
+	if (pAngle->x == mOrientationAngle.x && pAngle->y == mOrientationAngle.y && pAngle->z == mOrientationAngle.z) { return; }
+
+	mOrientation = MathUtil::AngleOrientation(*pAngle);
+	mOrientationAngle = *pAngle;
+}
+
+void BaseObject::SetOrientation(XMFLOAT4 orientation)
+{
+	mOrientation = orientation;
+	mOrientationAngle = *pAngle;
+}
+
+XMFLOAT4 BaseObject::GetOrientation()
+{
+	SyncOrientation();
+
+	return mOrientation;
+}
+
 // Collision
 
 void BaseObject::EnableCollisions(bool enabled) {
@@ -384,14 +511,12 @@ void BaseObject::EnableCollisions(bool enabled) {
 	}
 	else {
 		if (!mDrawOBB && pOBB != 0) {
-			pOBBModel->Shutdown();
-			delete pOBBModel;
 			delete pOBB;
+			pOBB = 0;
 		}
 		if (!mDrawAABB && pAABB != 0) {
-			pAABBModel->Shutdown();
-			delete pAABBModel;
 			delete pAABB;
+			pAABB = 0;
 		}
 	}
 }
@@ -413,39 +538,17 @@ bool BaseObject::GetHoveringEnabled()
 void BaseObject::ComputeOBB() {
 	if (pWorld == NULL || pWorld->pGraphicsClass == NULL) { return; }
 
-	if (pOBB != 0) {
-		delete pOBB;
-	}
+	// The model works its bounds out once when it loads, so this no longer walks the vertices
+	XMFLOAT3 mins, maxs;
+	pModelClass->GetBounds(mins, maxs);
 
-	if (pOBBModel != 0) {
-		pOBBModel->Shutdown();
-		delete pOBBModel;
+	// Only the bounds are kept, debug drawing turns them into lines each frame
+	if (pOBB != 0) {
+		pOBB->Set(mins, maxs);
 	}
-
-	int vertexCount = pModelClass->GetVertexCount();
-
-	XMFLOAT3* pMins = new XMFLOAT3(99999999,99999999, 99999999);
-	XMFLOAT3* pMaxs = new XMFLOAT3(-99999999,-99999999,-99999999);
-
-	for (int i = 0; i < vertexCount; i++) {
-		ModelType* pModel = (ModelType*)(pModelClass->m_model + i);
-
-		pMins->x = min(pModel->x, pMins->x);
-		pMins->y = min(pModel->y, pMins->y);
-		pMins->z = min(pModel->z, pMins->z);
-
-		pMaxs->x = max(pModel->x, pMaxs->x);
-		pMaxs->y = max(pModel->y, pMaxs->y);
-		pMaxs->z = max(pModel->z, pMaxs->z);
+	else {
+		pOBB = new ObjectBoundingBox(new XMFLOAT3(mins), new XMFLOAT3(maxs));
 	}
-	
-
-	pOBB = new ObjectBoundingBox(pMins, pMaxs);
-
-	pOBBModel = new BumpModelClass;
-	VertexData data = VerticesFromBoundingBox(pOBB, true);
-
-	pOBBModel->InitializeFromVertexArray(pWorld->pGraphicsClass->m_D3D->GetDevice(), data, L"../Engine/data/white.dds");
 }
 
 void BaseObject::ComputeAABB()
@@ -456,49 +559,37 @@ void BaseObject::ComputeAABB()
 		ComputeOBB();
 	}
 
+	XMFLOAT4X4 rotation;
+	XMStoreFloat4x4(&rotation, GetRotationMatrix());
+
+	XMFLOAT3 mins, maxs;
+	ObjectBoundingBox::TransformBounds(pOBB->pMins, pOBB->pMaxs, &rotation, 1, &mins, &maxs);
+
 	if (pAABB != 0) {
-		delete pAABB;
+		pAABB->Set(mins, maxs);
 	}
-
-	if (pAABBModel != 0) {
-		pAABBModel->Shutdown();
-		delete pAABBModel;
+	else {
+		pAABB = new ObjectBoundingBox(new XMFLOAT3(mins), new XMFLOAT3(maxs));
 	}
 
-	// pAABBModel = new BumpModelClass;
-
-	XMFLOAT3* pMins = pOBB->pMins;
-	XMFLOAT3* pMaxs = pOBB->pMaxs;
-	XMFLOAT3 translation = XMFLOAT3(0, 0, 0);
-
-	XMVECTOR minVector = XMLoadFloat3(pMins);
-	XMVECTOR maxVector = XMLoadFloat3(pMaxs);
-
-	XMMATRIX rotationMatrix = XMMatrixScaling(1.f, 1.f, 1.f);
-	rotationMatrix = TransformRotation(&rotationMatrix, pAngle);
-
-	BoundingBox aabb;
-	BoundingBox::CreateFromPoints(aabb, minVector, maxVector);
-	aabb.Transform(aabb, rotationMatrix);
-
-	pMins = new XMFLOAT3(-aabb.Extents.x + aabb.Center.x, -aabb.Extents.y + aabb.Center.y, -aabb.Extents.z + aabb.Center.z);
-	pMaxs = new XMFLOAT3(aabb.Extents.x + aabb.Center.x, aabb.Extents.y + aabb.Center.y, aabb.Extents.z + aabb.Center.z);
+	mBoundsOrientation = mOrientation;
+}
 
-	// Calculate the mins and maxs of the AABB
-	pMins->x = min(pMins->x, pMaxs->x);
-	pMins->y = min(pMins->y, pMaxs->y);
-	pMins->z = min(pMins->z, pMaxs->z);
+bool BaseObject::BoundsNeedUpdate()
+{
+	if (pOBB == 0 || pAABB == 0) { return false; }
 
-	pMaxs->x = max(pMins->x, pMaxs->x);
-	pMaxs->y = max(pMins->y, pMaxs->y);
-	pMaxs->z = max(pMins->z, pMaxs->z);
+	SyncOrientation();
 
-	pAABB = new ObjectBoundingBox(pMins, pMaxs);
+	return mOrientation.x != mBoundsOrientation.x || mOrientation.y != mBoundsOrientation.y ||
+		mOrientation.z != mBoundsOrientation.z || mOrientation.w != mBoundsOrientation.w;
+}
 
-	pAABBModel = new BumpModelClass;
-	VertexData data = VerticesFromBoundingBox(pAABB, true);
+XMMATRIX BaseObject::GetRotationMatrix()
+{
+	SyncOrientation();
 
-	pAABBModel->InitializeFromVertexArray(pWorld->pGraphicsClass->m_D3D->GetDevice(), data, L"../Engine/data/white.dds");
+	return XMMatrixRotationQuaternion(XMLoadFloat4(&mOrientation));
 }
 
 void BaseObject::DoClick() {
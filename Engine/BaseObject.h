@@ -45,6 +45,9 @@ private:
 
 	bool Initialized;
 
+	// The placeholder model made with the object is its own, a loaded model belongs to the world's cache
+	bool mOwnsModel;
+
 	// Collision
 	bool mCollisionEnabled;
 	bool mHoveringEnabled;
@@ -58,9 +61,33 @@ protected:
 	WCHAR* pMaterialPath2;
 
 	bool mDestroyed;
+
+	// Transform cache, see UpdateTransform
+	XMFLOAT3 mCachedScale;
+	XMFLOAT3 mCachedPosition;
+	XMFLOAT4 mCachedOrientation;
+	BaseObject* mCachedParent = 0;
+	unsigned int mCachedParentVersion = 0;
+	bool mCachedDontTransformParentRotation = false;
+	unsigned int mTransformVersion = 0;
+	XMFLOAT4X4 mFrameMatrix;
+	XMFLOAT4X4 mFrameMatrixNoRotation;
+	XMFLOAT4X4 mWorldMatrix;
+	XMFLOAT4X4 mWorldMatrixNoRotation;
+	void CommitTransform(unsigned int parentVersion);
+
+	// Orientation is kept as a quaternion, pAngle is read into it whenever it changes, see SyncOrientation
+	XMFLOAT4 mOrientation = XMFLOAT4(0, 0, 0, 1);
+	XMFLOAT3 mOrientationAngle = XMFLOAT3(0, 0, 0);
+
+	// State at the start of the last simulation step, rendering blends from it to the current state
+	XMFLOAT3 mPreviousPosition;
+	XMFLOAT4 mPreviousOrientation;
+	XMFLOAT3 mPreviousScale;
+	bool mHasPreviousTransform = false;
 public:
 	BaseObject(const char* Name, const char* ModelPath, WCHAR* MaterialPath, WCHAR* MaterialPath2);
-	~BaseObject();
+	virtual ~BaseObject();
 
 	int ID;
 
@@ -77,6 +104,12 @@ public:
 	BaseObject* GetParent();
 	XMMATRIX GetWorldMatrix(XMMATRIX origin);
 	XMMATRIX GetWorldMatrix(XMMATRIX origin, bool useRotation);
+	void UpdateTransform();
+	bool TransformNeedsUpdate();
+	void SetRootTransform(const XMFLOAT4X4& world, const XMFLOAT4X4& frame);
+	int GetHierarchyDepth();
+	void SavePreviousTransform();
+	void GetPreviousTransform(XMFLOAT3& position, XMFLOAT4& orientation, XMFLOAT3& scale);
 
 	RenderShader renderShader;
 
@@ -92,11 +125,14 @@ public:
 	void SetScale(float scale);
 	void SetAngle(float, float, float);
 	XMFLOAT3 GetAngle();
+	void SyncOrientation();
+	void SetOrientation(XMFLOAT4);
+	XMFLOAT4 GetOrientation();
 
 	virtual void OnInput(InputFrame inputFrame, float DeltaTime);
 	virtual void OnRender(float DeltaTime);
 	void OnCreate();
-	void OnDestroy();
+	virtual void OnDestroy();
 	void Destroy();
 	bool IsDestroyed();
 
@@ -106,7 +142,7 @@ public:
 	BumpModelClass* pModelClass;
 	class World* pWorld;
 
-	bool operator==(BaseObject other);
+	bool operator==(const BaseObject& other);
 
 	// Collision
 	float mCollisionRadius;
@@ -116,6 +152,8 @@ public:
 	bool GetHoveringEnabled();
 	void ComputeOBB();
 	void ComputeAABB();
+	bool BoundsNeedUpdate();
+	XMMATRIX GetRotationMatrix();
 	virtual void DoClick();
 	virtual void DoHoverStart();
 	virtual void DoHoverEnd();
@@ -132,10 +170,10 @@ public:
 	bool mUseOrientationMatrix = false;
 	XMMATRIX mOrientationMatrix;
 
-	BumpModelClass* pOBBModel = 0;
-	BumpModelClass* pAABBModel = 0;
 	ObjectBoundingBox* pOBB = 0;
 	ObjectBoundingBox* pAABB = 0;
+	// Orientation the AABB was last computed for
+	XMFLOAT4 mBoundsOrientation = XMFLOAT4(0, 0, 0, 1);
 
 	class HitResult* ResolveCollisions();
 	bool mStatic = false;
@@ -1,4 +1,5 @@
 #include "BoundingBox.h"
+#include "SimdMath.h"
 
 
 
@@ -17,3 +18,17 @@ ObjectBoundingBox::~ObjectBoundingBox()
 	delete pMins;
 	delete pMaxs;
 }
+
+void ObjectBoundingBox::Set(const XMFLOAT3& mins, const XMFLOAT3& maxs)
+{
+	*pMins = mins;
+	*pMaxs = maxs;
+}
+
+void ObjectBoundingBox::TransformBounds(const XMFLOAT3* pMins, const XMFLOAT3* pMaxs, const XMFLOAT4X4* pMatrices, unsigned int count,
+	XMFLOAT3* pOutMins, XMFLOAT3* pOutMaxs)
+{
+	SimdMath::TransformBounds(reinterpret_cast<const SimdMath::Float3*>(pMins), reinterpret_cast<const SimdMath::Float3*>(pMaxs),
+		reinterpret_cast<const SimdMath::Float4x4*>(pMatrices), count,
+		reinterpret_cast<SimdMath::Float3*>(pOutMins), reinterpret_cast<SimdMath::Float3*>(pOutMaxs));
+}
@@ -8,6 +8,12 @@ public:
 	ObjectBoundingBox();
 	ObjectBoundingBox(XMFLOAT3*, XMFLOAT3*);
 	~ObjectBoundingBox();
+
+	void Set(const XMFLOAT3& mins, const XMFLOAT3& maxs);
+
+	// Writes the axis aligned bounds of each box after its matrix is applied, see SimdMath::TransformBounds
+	static void TransformBounds(const XMFLOAT3* pMins, const XMFLOAT3* pMaxs, const XMFLOAT4X4* pMatrices, unsigned int count,
+		XMFLOAT3* pOutMins, XMFLOAT3* pOutMaxs);
 	
 	XMFLOAT3* pMins;
 	XMFLOAT3* pMaxs;
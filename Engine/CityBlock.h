@@ -0,0 +1,33 @@
+#pragma once
+
+#include "SimdMath.h"
+#include <vector>
+
+// What a placed model does besides being drawn, set from the generator's settings per model
+enum CityInstanceFlags {
+	CITY_COLLIDE = 1 << 0,
+	CITY_DRAW_AABB = 1 << 1,
+	CITY_DRAW_OBB = 1 << 2,
+};
+
+// One model a block places, 16 bytes. Nothing placed is interactive, so these are drawn
+// straight from the snapshot and collided with as static boxes rather than made objects.
+struct CityInstance {
+	SimdMath::Float3 Position;
+	unsigned short Model;	// Into the generator's models
+	unsigned char Turns;	// Quarter turns about y
+	unsigned char Flags;
+};
+
+// Everything one block of the grid places, a junction at its corner with the roads,
+// lamps and buildings up to the next junction along x and y
+struct CityBlock {
+	int X;
+	int Y;
+	std::vector<CityInstance> Instances;
+
+	// The block's part of the road graph, the middle of its junction and the length of the
+	// roads on from it to the next junctions along +x and +z
+	SimdMath::Float3 Junction;
+	float RoadLengths[2];
+};
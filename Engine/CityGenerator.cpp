@@ -9,16 +9,25 @@ Date: 13/12/2018
 #include "BaseObject.h"
 #include "World.h"
 #include "Parachuter.h"
+#include "Ship.h"
 #include "CityGenerator.h"
+#include "CityStreamer.h"
+#include "CityTraffic.h"
+#include "CityRoads.h"
+#include "JobSystem.h"
+#include "TaskGraph.h"
 
 CityGenerator::CityGenerator() {
 	pBuildings = new std::vector<CityBuilding>();
 	pCarTypes = new std::vector<CityCar>();
-	Cars = std::vector<BaseObject*>();
 	Parachuters = std::vector<Parachuter*>();
 
-	MaxCars = 100;
-	LastCarSpawn = 0.f;
+	Seed = 20181213;
+	Streaming = false;
+	pStreamer = NULL;
+	pTraffic = new CityTraffic();
+	pRoads = new CityRoads();
+	lastParachuteSpawn = 0.f;
 	LampModel = "../Engine/data/city/lamp.obj";
 	LampMaterial = L"../Engine/data/white.dds";
 
@@ -186,341 +195,208 @@ CityGenerator::CityGenerator() {
 }
 
 CityGenerator::~CityGenerator() {
-
+	delete pStreamer;
+	delete pTraffic;
+	delete pRoads;
 }
 
+// Every block is built on its own from its grid position and the seed, so they are built in
+// parallel. Their models are drawn and collided with from the blocks, see WriteSnapshot.
+
 void CityGenerator::GenerateWorld(World* pWorld) {
-	RenderShader roadShader = RenderShader::SHADED_NO_BUMP;
-	RenderShader buildingShader = RenderShader::SHADED_NO_BUMP;
+	BuildModels();
+
+	// Traffic keeps to the loaded blocks when streaming, otherwise to the grid's junctions
+	if (Streaming) {
+		pStreamer = new CityStreamer();
+		pStreamer->Initialize(this, pWorld->pJobSystem);
+
+		pTraffic->GridSize = pStreamer->LoadRadius * 2 + 3;
+		pTraffic->FollowFocus = true;
+	}
+	else {
+		pTraffic->GridSize = NumRoads + 1;
+		pTraffic->FollowFocus = false;
+	}
+
+	for (int i = 0; i < pCarTypes->size(); i++) {
+		const CityCar& car = pCarTypes->at(i);
+
+		// Car models face +x at their yaw, the traffic counts turns from +z
+		int turns = (int)floor((car.Yaw - 90.f) / 90.f + 0.5f);
+		unsigned short model = AddModel(car.Model, car.Material, car.Scale, GetVehicleCollisionsEnabled() ? CITY_COLLIDE : 0);
+
+		pTraffic->AddVehicleType(model, (unsigned char)(turns & 3));
+	}
+
+	pTraffic->Initialize(RoadSegmentSize * RoadLength, RoadSegmentSize, Seed);
+	pRoads->Initialize(RoadSegmentSize * RoadLength, RoadSegmentSize);
+
+	if (Streaming) { return; }
+
+	mBlocks.resize(NumRoads * NumRoads);
 
 	for (int x = 0; x < NumRoads; x++) {
 		for (int y = 0; y < NumRoads; y++) {
-			float xOrigin = RoadSegmentSize * RoadLength * x;
-			float yOrigin = RoadSegmentSize * RoadLength * y;
-
-			// Create corner junction roads
-			BaseObject* roadJunction = pWorld->CreateObject<BaseObject>("Cross Road",
-				CrossRoadsModel,
-				CrossRoadsMaterial,
-				L"../Engine/data/white.dds");
-			roadJunction->SetScale(RoadSegmentScale);
-			roadJunction->pPosition = new XMFLOAT3(xOrigin, 0.f, yOrigin);
-			roadJunction->renderShader = roadShader;
-
-			if (GetRoadCollisionsEnabled()) {
-				roadJunction->EnableCollisions(true);
-			}
-
-			// Create straight roads & buildings
-			for (int i = 1; i < RoadLength; i++) {
-				BaseObject* roadHorizontal = pWorld->CreateObject<BaseObject>("Vertical Road",
-					StraightRoadModel,
-					StraightRoadMaterial,
-					L"../Engine/data/white.dds");
-				roadHorizontal->SetScale(RoadSegmentScale);
-				roadHorizontal->pPosition = new XMFLOAT3(xOrigin + (RoadSegmentSize * i), 0.f, yOrigin);
-				roadHorizontal->renderShader = roadShader;
-
-				BaseObject* roadVertical = pWorld->CreateObject<BaseObject>("Vertical Vertical",
-					StraightRoadModel,
-					StraightRoadMaterial,
-					L"../Engine/data/white.dds");
-				roadVertical->SetAngle(0.f, -90.f, 0.f);
-				roadVertical->bRotateFirst = true;
-				roadVertical->SetScale(RoadSegmentScale);
-				roadVertical->pPosition = new XMFLOAT3(xOrigin, 0.f, yOrigin + (RoadSegmentSize * (i - 1)));
-				roadVertical->renderShader = roadShader;
-
-				if (GetRoadCollisionsEnabled()) {
-					roadHorizontal->EnableCollisions(true);
-					roadVertical->EnableCollisions(true);
-				}
-
-				// Vertical lamp posts
-				BaseObject* lamp = pWorld->CreateObject<BaseObject>("Vertical Vertical",
-					LampModel,
-					LampMaterial,
-					L"../Engine/data/white.dds");
-				lamp->SetAngle(0.f, -90.f, 0.f);
-				lamp->bRotateFirst = true;
-				lamp->SetScale(.1f);
-				lamp->pPosition = new XMFLOAT3(xOrigin + 1.f, 0.7f, yOrigin + (RoadSegmentSize * (i - 1)));
-				lamp->renderShader = roadShader;
-
-				BaseObject* lamp2 = pWorld->CreateObject<BaseObject>("Vertical Vertical",
-					LampModel,
-					LampMaterial,
-					L"../Engine/data/white.dds");
-				lamp2->SetAngle(0.f, 90.f, 0.f);
-				lamp2->bRotateFirst = true;
-				lamp2->SetScale(.1f);
-				lamp2->pPosition = new XMFLOAT3(xOrigin + RoadSegmentSize - 1.f, 0.7f, yOrigin + (RoadSegmentSize * (i - 1)));
-				lamp2->renderShader = roadShader;
-
-				// Horizontal lamp posts
-
-				BaseObject* lamp3 = pWorld->CreateObject<BaseObject>("Vertical Vertical",
-					LampModel,
-					LampMaterial,
-					L"../Engine/data/white.dds");
-				lamp3->SetAngle(0.f, 180.f, 0.f);
-				lamp3->bRotateFirst = true;
-				lamp3->SetScale(.1f);
-				lamp3->pPosition = new XMFLOAT3(xOrigin + (RoadSegmentSize * (i - 1)), 0.7f, yOrigin - RoadSegmentSize + 1.f);
-				lamp3->renderShader = roadShader;
-
-				BaseObject* lamp4 = pWorld->CreateObject<BaseObject>("Vertical Vertical",
-					LampModel,
-					LampMaterial,
-					L"../Engine/data/white.dds");
-				lamp4->bRotateFirst = true;
-				lamp4->SetScale(.1f);
-				lamp4->pPosition = new XMFLOAT3(xOrigin + (RoadSegmentSize * (i - 1)), 0.7f, yOrigin - 1.f);
-				lamp4->renderShader = roadShader;
-
-				if (GetLampCollisionsEnabled()) {
-					lamp->EnableCollisions(true);
-					lamp2->EnableCollisions(true);
-					lamp3->EnableCollisions(true);
-					lamp4->EnableCollisions(true);
-				}
-			}
-
-			// Generate randomly distrubuted buildings across the bottom row
-			float xProgress = RoadSegmentSize;
-			float yProgress = 0.f;
-			float yProgress2 = 0.f;
-			float yMaxProgress = 0.f;
-			float yMaxProgress2 = 0.f;
-
-			if (pBuildings->size() > 0) {
-				int c = 0;
-
-				while (xProgress < RoadSegmentSize * RoadLength) {
-					CityBuilding building;
-
-					bool found = false;
-					for (int i = 0; i < 10; i++) {
-						int index = rand() % pBuildings->size();
-						if (index > pBuildings->size()) { index = pBuildings->size(); }
-						building = pBuildings->at(index); //TODO: Pick random building
-
-						if (xProgress + building.Width <= RoadSegmentSize * RoadLength) {
-							found = true;
-							break;
-						}
-					}
-
-					if (!found) { break; }
-
-					float w = building.Width;
-					float h = building.Height;
-
-					if (c == 0) {
-						yProgress = h;
-					}
-
-					yProgress2 = h;
-
-					xProgress += w;
-
-					BaseObject* buildingObject = pWorld->CreateObject<BaseObject>("Building",
-						building.Model,
-						building.Material,
-						L"../Engine/data/white.dds");
-					buildingObject->SetScale(building.Scale);
-					buildingObject->renderShader = buildingShader;
-					buildingObject->pPosition = new XMFLOAT3(xOrigin + xProgress + building.XOffset, 0.f, yOrigin + building.YOffset);
-					buildingObject->mStatic = true;
-
-					if (GetBuildingCollisionsEnabled()) {
-						buildingObject->EnableCollisions(true);
-					}
-
-					if (BuildingRenderAABB) {
-						buildingObject->SetDrawAABB(true);
-					}
-
-					if (BuildingRenderOBB) {
-						buildingObject->SetDrawOBB(true);
-					}
-
-					c++;
-				}
-			}
-
-			// Generate buildings for the top row
-			xProgress = RoadSegmentSize;
-
-			if (pBuildings->size() > 0) {
-				int c = 0;
-
-				while (xProgress < RoadSegmentSize * RoadLength) {
-					CityBuilding building;
-
-					bool found = false;
-					for (int i = 0; i < 10; i++) {
-						int index = rand() % pBuildings->size();
-						if (index > pBuildings->size()) { index = pBuildings->size(); }
-						building = pBuildings->at(index); //TODO: Pick random building
-
-						if (xProgress + building.Width <= RoadSegmentSize * RoadLength) {
-							found = true;
-							break;
-						}
-					}
-
-					if (!found) { break; }
-
-					float w = building.Width;
-					float h = building.Height;
-
-					if (c == 0) {
-						yMaxProgress = h;
-					}
-
-					yMaxProgress2 = h;
-
-					xProgress += w;
-
-					BaseObject* buildingObject = pWorld->CreateObject<BaseObject>("Building",
-						building.Model,
-						building.Material,
-						L"../Engine/data/white.dds");
-					buildingObject->SetScale(building.Scale);
-					buildingObject->renderShader = buildingShader;
-					buildingObject->pPosition = new XMFLOAT3(xOrigin + xProgress + building.XOffset, 0.f, yOrigin - building.YOffset + (RoadSegmentSize * (RoadLength - 1)));
-					buildingObject->SetAngle(0.f, 180.f, 0.f);
-					buildingObject->mStatic = true;
-					
-					if (GetBuildingCollisionsEnabled()) {
-						buildingObject->EnableCollisions(true);
-					}
-
-					if (BuildingRenderAABB) {
-						buildingObject->SetDrawAABB(true);
-					}
-
-					if (BuildingRenderOBB) {
-						buildingObject->SetDrawOBB(true);
-					}
-
-					c++;
-				}
-			}
-
-			xProgress = yProgress;
-
-			// Generate buildings for the left road
-			if (pBuildings->size() > 0) {
-				int c = 0;
-
-				while (xProgress < (RoadSegmentSize * (RoadLength - 1)) - yMaxProgress) {
-					CityBuilding building;
-
-					bool found = false;
-					for (int i = 0; i < 10; i++) {
-						int index = rand() % pBuildings->size();
-						if (index > pBuildings->size()) { index = pBuildings->size(); }
-						building = pBuildings->at(index); //TODO: Pick random building
-
-						if (xProgress + building.Width <= (RoadSegmentSize * (RoadLength - 1)) - yMaxProgress) {
-							found = true;
-							break;
-						}
-					}
-
-					if (!found) { break; }
-
-					float w = building.Width;
-					float h = building.Height;
-
-					xProgress += w;
-
-					BaseObject* buildingObject = pWorld->CreateObject<BaseObject>("Building",
-						building.Model,
-						building.Material,
-						L"../Engine/data/white.dds");
-					buildingObject->SetScale(building.Scale);
-					buildingObject->renderShader = buildingShader;
-					buildingObject->pPosition = new XMFLOAT3(xOrigin + building.YOffset + RoadSegmentSize, 0.f, yOrigin + xProgress + building.XOffset);
-					buildingObject->SetAngle(0.f, 90.f, 0.f);
-					buildingObject->mStatic = true;
-
-					if (GetBuildingCollisionsEnabled()) {
-						buildingObject->EnableCollisions(true);
-					}
-
-					if (BuildingRenderAABB) {
-						buildingObject->SetDrawAABB(true);
-					}
-
-					if (BuildingRenderOBB) {
-						buildingObject->SetDrawOBB(true);
-					}
-
-					int maxX = RoadSegmentSize * RoadLength * NumRoads;
-					int maxY = RoadSegmentSize * RoadLength * NumRoads;
-
-					c++;
-				}
-			}
-
-			xProgress = yProgress2;
-
-			// Generate buildings for the right road
-			if (pBuildings->size() > 0) {
-				int c = 0;
-
-				while (xProgress < (RoadSegmentSize * (RoadLength - 1)) - yMaxProgress2) {
-					CityBuilding building;
-
-					bool found = false;
-					for (int i = 0; i < 10; i++) {
-						int index = rand() % pBuildings->size();
-						if (index > pBuildings->size()) { index = pBuildings->size(); }
-						building = pBuildings->at(index); //TODO: Pick random building
-
-						if (xProgress + building.Width <= (RoadSegmentSize * (RoadLength - 1)) - yMaxProgress2) {
-							found = true;
-							break;
-						}
-					}
-
-					if (!found) { break; }
-
-					float w = building.Width;
-					float h = building.Height;
-
-					xProgress += w;
-
-					BaseObject* buildingObject = pWorld->CreateObject<BaseObject>("Building",
-						building.Model,
-						building.Material,
-						L"../Engine/data/white.dds");
-					buildingObject->SetScale(building.Scale);
-					buildingObject->renderShader = buildingShader;
-					buildingObject->pPosition = new XMFLOAT3(xOrigin - building.YOffset + (RoadSegmentSize * RoadLength), 0.f, yOrigin + xProgress + building.XOffset);
-					buildingObject->SetAngle(0.f, -90.f, 0.f);
-					buildingObject->mStatic = true;
-
-					if (GetBuildingCollisionsEnabled()) {
-						buildingObject->EnableCollisions(true);
-					}
-
-					if (BuildingRenderAABB) {
-						buildingObject->SetDrawAABB(true);
-					}
-
-					if (BuildingRenderOBB) {
-						buildingObject->SetDrawOBB(true);
-					}
-
-					c++;
-				}
-			}
+			mBlocks[x * NumRoads + y].X = x;
+			mBlocks[x * NumRoads + y].Y = y;
 		}
 	}
+
+	if (pWorld->pJobSystem != NULL) {
+		pWorld->pJobSystem->ParallelForAndWait(TaskMethod<CityGenerator, &CityGenerator::GenerateBlocks>, this, (unsigned int)mBlocks.size(), 1);
+	}
+	else {
+		GenerateBlocks(0, (unsigned int)mBlocks.size());
+	}
+
+	for (int i = 0; i < mBlocks.size(); i++) {
+		pRoads->AddBlock(mBlocks[i]);
+	}
+	pRoads->Update();
+}
+
+void CityGenerator::GenerateBlocks(unsigned int begin, unsigned int end) {
+	for (unsigned int i = begin; i < end; i++) {
+		GenerateBlock(mBlocks[i].X, mBlocks[i].Y, mBlocks[i]);
+	}
+}
+
+void CityGenerator::BuildModels() {
+	unsigned char buildingFlags = 0;
+	if (GetBuildingCollisionsEnabled()) { buildingFlags |= CITY_COLLIDE; }
+	if (BuildingRenderAABB) { buildingFlags |= CITY_DRAW_AABB; }
+	if (BuildingRenderOBB) { buildingFlags |= CITY_DRAW_OBB; }
+
+	mModels.clear();
+	AddModel(CrossRoadsModel, CrossRoadsMaterial, RoadSegmentScale, GetRoadCollisionsEnabled() ? CITY_COLLIDE : 0);
+	AddModel(StraightRoadModel, StraightRoadMaterial, RoadSegmentScale, GetRoadCollisionsEnabled() ? CITY_COLLIDE : 0);
+	AddModel(LampModel, LampMaterial, .1f, GetLampCollisionsEnabled() ? CITY_COLLIDE : 0);
+
+	for (int i = 0; i < pBuildings->size(); i++) {
+		AddModel(pBuildings->at(i).Model, pBuildings->at(i).Material, pBuildings->at(i).Scale, buildingFlags);
+	}
+
+	// Blocks are laid out from the settings and the flags of the models so far, cars are not placed by blocks
+	mLayout.RoadSegmentSize = RoadSegmentSize;
+	mLayout.RoadLength = RoadLength;
+	mLayout.Seed = Seed;
+	mLayout.ModelFlags.clear();
+	for (int i = 0; i < mModels.size(); i++) {
+		mLayout.ModelFlags.push_back(mModels[i].Flags);
+	}
+
+	mLayout.ClearBuildings();
+	for (int i = 0; i < pBuildings->size(); i++) {
+		const CityBuilding& building = pBuildings->at(i);
+		mLayout.AddBuilding(building.Width, building.Height, building.XOffset, building.YOffset);
+	}
+}
+
+unsigned short CityGenerator::AddModel(char* model, WCHAR* material, float scale, unsigned char flags) {
+	CityModel cityModel;
+	cityModel.Model = model;
+	cityModel.Material = material;
+	cityModel.Scale = scale;
+	cityModel.Shader = RenderShader::SHADED_NO_BUMP;
+	cityModel.Flags = flags;
+	cityModel.pModel = NULL;
+
+	mModels.push_back(cityModel);
+
+	return (unsigned short)(mModels.size() - 1);
+}
+
+// Call once the device is up, from the thread that steps the world. A city that is not
+// streamed has all its blocks already, so its colliders go in now.
+
+void CityGenerator::LoadModels(World* pWorld) {
+	for (int i = 0; i < mModels.size(); i++) {
+		CityModel& model = mModels[i];
+
+		if (pWorld->ModelCache.find(model.Model) == pWorld->ModelCache.end()) {
+			pWorld->CacheModel(model.Model, model.Material, L"../Engine/data/white.dds");
+		}
+
+		model.pModel = pWorld->ModelCache.at(model.Model);
+	}
+
+	if (pStreamer != NULL) { return; }
+
+	std::vector<StaticCollider> colliders;
+	for (int i = 0; i < mBlocks.size(); i++) {
+		AddColliders(mBlocks[i], colliders);
+	}
+
+	pWorld->SetStaticColliders(colliders);
+}
+
+// Boxes around the instances that collide, as a building object's AABB was: the model's bounds
+// turned and scaled, centered on its position
+
+void CityGenerator::AddColliders(const CityBlock& block, std::vector<StaticCollider>& colliders) {
+	for (int i = 0; i < block.Instances.size(); i++) {
+		const CityInstance& instance = block.Instances[i];
+
+		if (!(instance.Flags & CITY_COLLIDE)) { continue; }
+
+		const CityModel& model = mModels[instance.Model];
+		if (model.pModel == NULL) { continue; }
+
+		XMFLOAT3 mins, maxs;
+		model.pModel->GetBounds(mins, maxs);
+
+		float halfScale = model.Scale * 0.5f;
+		SimdMath::Float3 extents = SimdMath::Float3((maxs.x - mins.x) * halfScale, (maxs.y - mins.y) * halfScale, (maxs.z - mins.z) * halfScale);
+
+		// A quarter turn swaps the box's width and depth
+		if (instance.Turns & 1) {
+			extents = SimdMath::Float3(extents.z, extents.y, extents.x);
+		}
+
+		StaticCollider collider;
+		collider.center = instance.Position;
+		collider.extents = extents;
+		colliders.push_back(collider);
+	}
+}
+
+// The models and the instances of every block in the world, the renderer builds their matrices
+
+void CityGenerator::WriteSnapshot(RenderSnapshot& snapshot) {
+	snapshot.instanceModels = mModels;
+	snapshot.instances.clear();
+
+	float blockLength = RoadSegmentSize * RoadLength;
+
+	if (pStreamer != NULL) {
+		pStreamer->WriteInstances(snapshot.instances);
+		pTraffic->WriteInstances(snapshot.instances, (pStreamer->LoadRadius + 1) * blockLength);
+		return;
+	}
+
+	for (int i = 0; i < mBlocks.size(); i++) {
+		snapshot.instances.insert(snapshot.instances.end(), mBlocks[i].Instances.begin(), mBlocks[i].Instances.end());
+	}
+	pTraffic->WriteInstances(snapshot.instances, blockLength * (NumRoads + 1) * 2.f);
+}
+
+// Only reads the layout BuildModels fills in, so any number of blocks can be built at once
+
+void CityGenerator::GenerateBlock(int x, int y, CityBlock& block) {
+	mLayout.GenerateBlock(x, y, block);
+}
+
+CityStreamer* CityGenerator::GetStreamer() {
+	return pStreamer;
+}
+
+CityTraffic* CityGenerator::GetTraffic() {
+	return pTraffic;
+}
+
+CityRoads* CityGenerator::GetRoads() {
+	return pRoads;
 }
 
 void CityGenerator::AddBuilding(char* model, WCHAR* material, float width, float height, float scale, float XOffset, float YOffset) {
@@ -547,12 +423,25 @@ void CityGenerator::AddCar(char* model, WCHAR* material, float scale, float yaw)
 }
 
 void CityGenerator::Think(World* pWorld) {
-	if (this->pCarTypes->size() == 0) { return; }
-	if (!mActive) { return; }
+	// Blocks stream and traffic drives around the player ship once there is one, the camera until then
+	Ship* pPlayerShip = pWorld->GetPlayerShip();
+	XMFLOAT3 focus = pPlayerShip != NULL ? *pPlayerShip->pPosition : *pWorld->pCameraPosition;
+
+	if (pStreamer != NULL) {
+		pStreamer->Update(pWorld, focus);
+	}
+
+	// Routes are asked for by the step's later tasks, so the graph settles here
+	pRoads->Update();
+
+	// Spawn timers run on simulated seconds so they follow the fixed step rather than the wall clock
+	float time = (float)pWorld->GetSimulationTime();
+
+	pTraffic->Advance(SimdMath::Float3(focus.x, focus.y, focus.z), pWorld->GetSimulationTime());
 
-	float time = timeGetTime();
+	if (!mActive) { return; }
 
-	if (pWorld->GetGameState() == GameState::PLAY && time > lastParachuteSpawn + 1000) {
+	if (pWorld->GetGameState() == GameState::PLAY && time > lastParachuteSpawn + 1.f) {
 		lastParachuteSpawn = time;
 
 		Parachuter* parachuter = pWorld->CreateObject<Parachuter>("Parachuter",
@@ -576,97 +465,6 @@ void CityGenerator::Think(World* pWorld) {
 		yawVel *= 0.1f;
 		parachuter->pAngularVelocity = new XMFLOAT3(0.f, (float)yawVel, 0.f);
 	}
-
-	if (time < LastCarSpawn + 1000) { return; }
-	LastCarSpawn = time;
-
-	if (this->pCarTypes->size() < this->MaxCars) {
-		for (int x = 0; x < NumRoads; x++) {
-			for (int y = 0; y < NumRoads; y++) {
-				if (x != 0 && y != 0) { continue; }
-
-				float xOrigin = RoadSegmentSize * RoadLength * x;
-				float yOrigin = (RoadSegmentSize * RoadLength * y) - RoadSegmentSize;
-
-				if (rand() % 20 <= 2) {
-					// Pick a random car type to spawn
-					int index = rand() % pCarTypes->size();
-					if (index > pCarTypes->size()) { index = pCarTypes->size(); }
-					CityCar carType = pCarTypes->at(index);
-
-					BaseObject* carObject = pWorld->CreateObject<BaseObject>("Car",
-						carType.Model,
-						carType.Material,
-						L"../Engine/data/white.dds");
-					carObject->SetScale(carType.Scale);
-					carObject->renderShader = RenderShader::SHADED_NO_BUMP;
-
-					float laneCenter = RoadSegmentSize * 0.5f;
-					float laneOffset = 5.f;
-					float carHeightOffset = 0.5f;
-
-					if (x > 1) { x = 1; }
-					if (y > 1) { y = 1; }
-
-					if (x > 0) {
-						carObject->SetAngle(0.f, carType.Yaw - 90.f, 0.f);
-					}
-					else {
-						carObject->SetAngle(0.f, carType.Yaw, 0.f);
-					}
-					
-
-					if (rand() % 2 == 1) {
-						// Spawn car from x,y
-						carObject->pPosition = new XMFLOAT3(xOrigin + (x * laneCenter) + (x * laneOffset), carHeightOffset, yOrigin + (y * laneCenter) + (-y * laneOffset));
-						carObject->pVelocity = new XMFLOAT3(y * 10.f, 0.f, x * 10.f);
-					}
-					else {
-						// Spawn car from x+width, y+width
-						carObject->pPosition = new XMFLOAT3(xOrigin + (x * laneCenter) - (x * laneOffset) + (RoadSegmentSize * RoadLength * y * NumRoads), carHeightOffset, yOrigin + (y * laneCenter) - (-y * laneOffset) + (RoadSegmentSize * RoadLength * x * NumRoads));
-						carObject->pVelocity = new XMFLOAT3(-y * 10.f, 0.f, -x * 10.f);
-						XMFLOAT3 ang = carObject->GetAngle();
-						carObject->SetAngle(0.f, ang.y + 180.f, 0.f);
-					}
-
-					Cars.push_back(carObject);
-				}
-			}
-		}
-	}
-
-	for (int i = 0; i < Cars.size(); i++) {
-		BaseObject* pCar = Cars.at(i);
-
-		float xVel = pCar->pVelocity->x;
-		float zVel = pCar->pVelocity->z;
-		float xPos = pCar->pPosition->x;
-		float zPos = pCar->pPosition->z;
-		float max = RoadSegmentSize * RoadLength * NumRoads;
-
-		if (xVel > 0) {
-			if (xPos > max) {
-
-			}
-		}
-		else {
-			if (xPos < 0) {
-
-			}
-		}
-
-		if (zVel > 0) {
-			if (zPos > max) {
-
-			}
-		}
-		else {
-			if (zPos < 0) {
-
-			}
-		}
-
-	}
 }
 
 // Collisions
@@ -9,9 +9,15 @@ Date: 13/12/2018
 #pragma once
 #include "d3dclass.h"
 #include "Parachuter.h"
+#include "HitResult.h"
+#include "CityLayout.h"
 #include <vector>
 
 class World;
+class CityStreamer;
+class CityTraffic;
+class CityRoads;
+struct RenderSnapshot;
 
 class CityBuilding {
 public:
@@ -24,6 +30,16 @@ public:
 	float YOffset;
 };
 
+// A model the city places. Loaded once the device is up, see LoadModels.
+struct CityModel {
+	char* Model;
+	WCHAR* Material;
+	float Scale;
+	RenderShader Shader;
+	unsigned char Flags;
+	BumpModelClass* pModel;
+};
+
 class CityCar {
 public:
 	char* Model;
@@ -35,15 +51,26 @@ public:
 class CityGenerator {
 private:
 	std::vector<CityCar>* pCarTypes;
-	std::vector<class BaseObject*> Cars;
 	std::vector<class Parachuter*> Parachuters;
 
-	int MaxCars;
-	float LastCarSpawn;
 	float lastParachuteSpawn;
 
 	void AddCar(char* model, WCHAR* material, float scale, float yaw);
 
+	// Blocks of the NumRoads grid when not streaming, built in parallel
+	std::vector<CityBlock> mBlocks;
+	void GenerateBlocks(unsigned int begin, unsigned int end);
+	CityLayout mLayout;
+
+	// Junction, road and lamp first, then one per building type and one per car type in order
+	std::vector<CityModel> mModels;
+	void BuildModels();
+	unsigned short AddModel(char* model, WCHAR* material, float scale, unsigned char flags);
+
+	CityStreamer* pStreamer;
+	CityTraffic* pTraffic;
+	CityRoads* pRoads;
+
 	// Collisions
 
 	bool BuildingCollisionsEnabled;
@@ -73,7 +100,20 @@ public:
 	int RoadLength;
 	int NumRoads;
 
+	// The same seed gives the same city however many threads build it
+	unsigned int Seed;
+
+	// Streams blocks in and out around the player instead of building the NumRoads grid, see CityStreamer
+	bool Streaming;
+
 	void GenerateWorld(World* pWorld);
+	void GenerateBlock(int x, int y, CityBlock& block);
+	void LoadModels(World* pWorld);
+	void AddColliders(const CityBlock& block, std::vector<StaticCollider>& colliders);
+	void WriteSnapshot(RenderSnapshot& snapshot);
+	CityStreamer* GetStreamer();
+	CityTraffic* GetTraffic();
+	CityRoads* GetRoads();
 	void AddBuilding(char* model, WCHAR* material, float width, float height, float scale, float XOffset, float YOffset);
 
 	// Collisions
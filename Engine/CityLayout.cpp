@@ -0,0 +1,140 @@
+#include "CityLayout.h"
+
+CityLayout::CityLayout()
+{
+	RoadSegmentSize = 0.f;
+	RoadLength = 0;
+	Seed = 0;
+}
+
+void CityLayout::ClearBuildings()
+{
+	mBuildings.clear();
+	mFootprints.clear();
+	mFootprintTypes.clear();
+}
+
+void CityLayout::AddBuilding(float width, float depth, float xOffset, float yOffset)
+{
+	Building building = { width, xOffset, yOffset };
+	mBuildings.push_back(building);
+
+	// A building with no width would be packed over and over in the same place
+	if (width <= 0.f) { return; }
+
+	CityFootprint footprint = { width, depth };
+	mFootprints.push_back(footprint);
+	mFootprintTypes.push_back((int)mBuildings.size() - 1);
+}
+
+void CityLayout::GenerateBlock(int x, int y, CityBlock& block) const
+{
+	CityRandom random(Seed, CityRandom::BlockKey(x, y));
+
+	std::vector<CityInstance>& instances = block.Instances;
+	instances.clear();
+
+	float xOrigin = RoadSegmentSize * RoadLength * x;
+	float yOrigin = RoadSegmentSize * RoadLength * y;
+
+	CityInstance road;
+	road.Model = MODEL_ROAD;
+	road.Flags = ModelFlags[MODEL_ROAD];
+
+	CityInstance lamp;
+	lamp.Model = MODEL_LAMP;
+	lamp.Flags = ModelFlags[MODEL_LAMP];
+
+	// Corner junction road
+	CityInstance junction;
+	junction.Model = MODEL_JUNCTION;
+	junction.Flags = ModelFlags[MODEL_JUNCTION];
+	junction.Position = SimdMath::Float3(xOrigin, 0.f, yOrigin);
+	junction.Turns = 0;
+	instances.push_back(junction);
+
+	// The crossroads model's middle is half a segment along x and back along z from where it is
+	// placed. Its roads run up to the next block's junction, so are a segment longer than the
+	// straight roads placed.
+	block.Junction = SimdMath::Float3(xOrigin + RoadSegmentSize * 0.5f, 0.f, yOrigin - RoadSegmentSize * 0.5f);
+	block.RoadLengths[0] = RoadSegmentSize;
+	block.RoadLengths[1] = RoadSegmentSize;
+
+	// Straight roads and the lamp posts either side of them. Turns are counted from a yaw of 0,
+	// so -90 is three.
+	for (int i = 1; i < RoadLength; i++) {
+		road.Position = SimdMath::Float3(xOrigin + (RoadSegmentSize * i), 0.f, yOrigin);
+		road.Turns = 0;
+		instances.push_back(road);
+		block.RoadLengths[0] += RoadSegmentSize;
+
+		road.Position = SimdMath::Float3(xOrigin, 0.f, yOrigin + (RoadSegmentSize * (i - 1)));
+		road.Turns = 3;
+		instances.push_back(road);
+		block.RoadLengths[1] += RoadSegmentSize;
+
+		lamp.Position = SimdMath::Float3(xOrigin + 1.f, 0.7f, yOrigin + (RoadSegmentSize * (i - 1)));
+		lamp.Turns = 3;
+		instances.push_back(lamp);
+
+		lamp.Position = SimdMath::Float3(xOrigin + RoadSegmentSize - 1.f, 0.7f, yOrigin + (RoadSegmentSize * (i - 1)));
+		lamp.Turns = 1;
+		instances.push_back(lamp);
+
+		lamp.Position = SimdMath::Float3(xOrigin + (RoadSegmentSize * (i - 1)), 0.7f, yOrigin - RoadSegmentSize + 1.f);
+		lamp.Turns = 2;
+		instances.push_back(lamp);
+
+		lamp.Position = SimdMath::Float3(xOrigin + (RoadSegmentSize * (i - 1)), 0.7f, yOrigin - 1.f);
+		lamp.Turns = 0;
+		instances.push_back(lamp);
+	}
+
+	if (mBuildings.empty()) { return; }
+
+	float blockLength = RoadSegmentSize * RoadLength;
+	float inside = RoadSegmentSize * (RoadLength - 1);
+
+	// Bottom and top rows first so they run the length of the block, the left and right rows
+	// fit in around them
+	CityPacker packer;
+	packer.Begin(inside, inside);
+
+	CityRow bottom = { CityPacker::SIDE_BOTTOM, SimdMath::Float2(xOrigin + RoadSegmentSize, yOrigin), SimdMath::Float2(1.f, 0.f), SimdMath::Float2(0.f, 1.f), 0 };
+	PlaceRow(random, packer, bottom, instances);
+
+	CityRow top = { CityPacker::SIDE_TOP, SimdMath::Float2(xOrigin + RoadSegmentSize, yOrigin + inside), SimdMath::Float2(1.f, 0.f), SimdMath::Float2(0.f, -1.f), 2 };
+	PlaceRow(random, packer, top, instances);
+
+	CityRow left = { CityPacker::SIDE_LEFT, SimdMath::Float2(xOrigin + RoadSegmentSize, yOrigin), SimdMath::Float2(0.f, 1.f), SimdMath::Float2(1.f, 0.f), 1 };
+	PlaceRow(random, packer, left, instances);
+
+	CityRow right = { CityPacker::SIDE_RIGHT, SimdMath::Float2(xOrigin + blockLength, yOrigin), SimdMath::Float2(0.f, 1.f), SimdMath::Float2(-1.f, 0.f), 3 };
+	PlaceRow(random, packer, right, instances);
+}
+
+// Packs the row's side of the block, a building's footprint is its width along the row and
+// its depth in to the block. The packer keeps it clear of every building already placed.
+
+void CityLayout::PlaceRow(CityRandom& random, CityPacker& packer, const CityRow& row, std::vector<CityInstance>& instances) const
+{
+	std::vector<CityPlacement> placements;
+	packer.PackSide(row.Side, random, mFootprints, placements);
+
+	int count = (int)placements.size();
+
+	for (int i = 0; i < count; i++) {
+		int type = mFootprintTypes[placements[i].Footprint];
+		const Building& building = mBuildings[type];
+
+		float along = placements[i].Start + building.width + building.xOffset;
+
+		CityInstance instance;
+		instance.Model = (unsigned short)(MODEL_BUILDINGS + type);
+		instance.Flags = ModelFlags[instance.Model];
+		instance.Position = SimdMath::Float3(row.Origin.x + row.Along.x * along + row.Inward.x * building.yOffset, 0.f,
+			row.Origin.y + row.Along.y * along + row.Inward.y * building.yOffset);
+		instance.Turns = row.Turns;
+		instances.push_back(instance);
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CityBlock.h"
+#include "CityPacker.h"
+#include "CityRandom.h"
+#include <vector>
+
+// Where each kind of model is in the generator's models, the buildings follow in the order they were added
+enum CityModelIndex {
+	MODEL_JUNCTION,
+	MODEL_ROAD,
+	MODEL_LAMP,
+	MODEL_BUILDINGS,
+};
+
+// A side of a block buildings are lined up along. A building's position is Origin plus
+// Along times how far along it is and Inward times its depth offset. Origin is the
+// corner inside the roads the packer's side starts from.
+struct CityRow {
+	CityPacker::Side Side;
+	SimdMath::Float2 Origin;
+	SimdMath::Float2 Along;
+	SimdMath::Float2 Inward;
+	unsigned char Turns;
+};
+
+// Lays out what one block of the city grid places from its grid position and the seed
+// alone, so any number of threads can lay out blocks at once and get the same city.
+// CityGenerator fills this in from its settings and models, nothing here needs the
+// device or the world.
+class CityLayout
+{
+public:
+	CityLayout();
+
+	// Settings, read by GenerateBlock
+	float RoadSegmentSize;
+	int RoadLength;
+	unsigned int Seed;
+
+	// The flags of each of the generator's models, by CityModelIndex
+	std::vector<unsigned char> ModelFlags;
+
+	// Building types in the order their models follow MODEL_BUILDINGS. depth is how far in
+	// to the block the building takes, the offsets move the model from its footprint.
+	void ClearBuildings();
+	void AddBuilding(float width, float depth, float xOffset, float yOffset);
+
+	void GenerateBlock(int x, int y, CityBlock& block) const;
+
+private:
+	struct Building {
+		float width;
+		float xOffset;
+		float yOffset;
+	};
+
+	void PlaceRow(CityRandom& random, CityPacker& packer, const CityRow& row, std::vector<CityInstance>& instances) const;
+
+	std::vector<Building> mBuildings;
+
+	// The width and depth of each building type that has a width, and which type each one is
+	std::vector<CityFootprint> mFootprints;
+	std::vector<int> mFootprintTypes;
+};
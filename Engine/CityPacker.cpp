@@ -0,0 +1,149 @@
+#include "CityPacker.h"
+
+void OccupancyIndex::Clear()
+{
+	mIntervals.clear();
+}
+
+void OccupancyIndex::Add(float start, float end, float depth)
+{
+	Interval interval = { start, end, depth };
+	mIntervals.push_back(interval);
+}
+
+float OccupancyIndex::GetDepth(float start, float end)
+{
+	float depth = 0.f;
+	int count = (int)mIntervals.size();
+
+	for (int i = Find(start); i < count && mIntervals[i].start < end; i++) {
+		if (mIntervals[i].depth > depth) {
+			depth = mIntervals[i].depth;
+		}
+	}
+
+	return depth;
+}
+
+// Steps past each interval in the way, so the search only goes forwards
+
+float OccupancyIndex::FindClear(float start, float width, float depth)
+{
+	int count = (int)mIntervals.size();
+
+	for (int i = Find(start); i < count && mIntervals[i].start < start + width; i++) {
+		if (mIntervals[i].depth > depth) {
+			start = mIntervals[i].end;
+		}
+	}
+
+	return start;
+}
+
+int OccupancyIndex::Find(float position)
+{
+	int low = 0;
+	int high = (int)mIntervals.size();
+
+	while (low < high) {
+		int middle = (low + high) / 2;
+
+		if (mIntervals[middle].end <= position) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+void CityPacker::Begin(float width, float depth)
+{
+	mWidth = width;
+	mDepth = depth;
+
+	for (int i = 0; i < 4; i++) {
+		mSides[i].Clear();
+	}
+}
+
+void CityPacker::PackSide(Side side, CityRandom& random, const std::vector<CityFootprint>& footprints, std::vector<CityPlacement>& placements)
+{
+	int count = (int)footprints.size();
+	if (count == 0) { return; }
+
+	float length = GetLength(side);
+	float progress = 0.f;
+
+	while (true) {
+		int pick = random.Range(count);
+		int best = -1;
+		float bestStart = length;
+
+		for (int i = 0; i < count; i++) {
+			int footprint = (pick + i) % count;
+			float start = Fit(side, progress, footprints[footprint].Width, footprints[footprint].Depth);
+
+			if (start < bestStart) {
+				best = footprint;
+				bestStart = start;
+			}
+		}
+
+		if (best < 0) { break; }
+
+		CityPlacement placement = { best, bestStart };
+		placements.push_back(placement);
+
+		progress = bestStart + footprints[best].Width;
+		mSides[side].Add(bestStart, progress, footprints[best].Depth);
+	}
+}
+
+float CityPacker::GetLength(Side side)
+{
+	return side == SIDE_BOTTOM || side == SIDE_TOP ? mWidth : mDepth;
+}
+
+CityPacker::Side CityPacker::GetOpposite(Side side)
+{
+	switch (side) {
+	case SIDE_BOTTOM: return SIDE_TOP;
+	case SIDE_TOP: return SIDE_BOTTOM;
+	case SIDE_LEFT: return SIDE_RIGHT;
+	default: return SIDE_LEFT;
+	}
+}
+
+// A footprint against one side can only meet those against the sides either end of it where
+// it is within their depth, and those against the opposite side where the two together are
+// deeper than the block. The sides at its ends give the first and last place it can go, the
+// opposite side is searched for a gap between those.
+
+float CityPacker::Fit(Side side, float start, float width, float depth)
+{
+	float length = GetLength(side);
+	float across = side == SIDE_BOTTOM || side == SIDE_TOP ? mDepth : mWidth;
+
+	if (depth > across) { return length; }
+
+	// The part of the sides at its ends it is beside
+	float nearStart = (side == SIDE_TOP || side == SIDE_RIGHT) ? across - depth : 0.f;
+	float nearEnd = nearStart + depth;
+
+	Side first = side == SIDE_BOTTOM || side == SIDE_TOP ? SIDE_LEFT : SIDE_BOTTOM;
+	Side last = side == SIDE_BOTTOM || side == SIDE_TOP ? SIDE_RIGHT : SIDE_TOP;
+
+	float firstDepth = mSides[first].GetDepth(nearStart, nearEnd);
+	float end = length - mSides[last].GetDepth(nearStart, nearEnd);
+
+	if (start < firstDepth) {
+		start = firstDepth;
+	}
+
+	start = mSides[GetOpposite(side)].FindClear(start, width, across - depth);
+
+	return start + width <= end ? start : length;
+}
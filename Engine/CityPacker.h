@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CityRandom.h"
+#include <vector>
+
+// How much of a side of a block is taken, as intervals along the side each with how
+// deep in to the block they are taken from it. Intervals are added in order along
+// the side and do not overlap.
+class OccupancyIndex
+{
+public:
+	void Clear();
+	void Add(float start, float end, float depth);
+
+	// The deepest anything is taken over [start, end), 0 where nothing is
+	float GetDepth(float start, float end);
+
+	// The first position from start on where width fits with nothing deeper than depth
+	float FindClear(float start, float width, float depth);
+
+private:
+	struct Interval {
+		float start;
+		float end;
+		float depth;
+	};
+
+	// The first interval that ends after position
+	int Find(float position);
+
+	std::vector<Interval> mIntervals;
+};
+
+// A rectangle to pack against a side, Width along it and Depth in to the block
+struct CityFootprint {
+	float Width;
+	float Depth;
+};
+
+struct CityPlacement {
+	int Footprint;
+	float Start;	// Along the side
+};
+
+// Packs footprints against the sides of a rectangular block, each one with its back
+// to its side. A side is packed from its start and each footprint goes at the
+// earliest place it fits without overlapping one already packed against any side.
+// The footprint picked at random goes there when it fits as early as any other,
+// else the first in turn after it that does, so gaps a wide pick would leave are
+// filled by a narrower one. Each footprint packed costs a few searches of the other
+// sides' indexes, so a block packs in time linear in what it places.
+//
+// Bottom and top run along x from the left, left and right along z from the bottom.
+class CityPacker
+{
+public:
+	enum Side {
+		SIDE_BOTTOM,
+		SIDE_TOP,
+		SIDE_LEFT,
+		SIDE_RIGHT,
+	};
+
+	// width along x and depth along z of the space inside the roads
+	void Begin(float width, float depth);
+
+	// Appends what is placed against side to placements, every footprint must be wider than 0
+	void PackSide(Side side, CityRandom& random, const std::vector<CityFootprint>& footprints, std::vector<CityPlacement>& placements);
+
+private:
+	float GetLength(Side side);
+	Side GetOpposite(Side side);
+
+	// Where a footprint of width and depth can go against side from start on, or past the
+	// side's length when it does not fit before the end
+	float Fit(Side side, float start, float width, float depth);
+
+	float mWidth;
+	float mDepth;
+	OccupancyIndex mSides[4];
+};
@@ -0,0 +1,43 @@
+#include "CityRandom.h"
+
+// SplitMix64's finalizer, every input bit affects every output bit
+static unsigned long long Mix(unsigned long long z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+CityRandom::CityRandom(unsigned int seed, unsigned long long key)
+{
+	mStream = Mix(Mix(key) ^ ((unsigned long long)seed * 0x9E3779B97F4A7C15ull));
+	mCounter = 0;
+}
+
+unsigned long long CityRandom::BlockKey(int x, int y)
+{
+	return ((unsigned long long)(unsigned int)x << 32) | (unsigned int)y;
+}
+
+unsigned int CityRandom::Next()
+{
+	unsigned long long z = Mix(mStream + (unsigned long long)mCounter * 0x9E3779B97F4A7C15ull);
+	mCounter++;
+
+	return (unsigned int)(z >> 32);
+}
+
+// Multiply and shift rather than modulo, so small counts are not biased towards low values
+int CityRandom::Range(int count)
+{
+	if (count <= 0) {
+		return 0;
+	}
+
+	return (int)(((unsigned long long)Next() * (unsigned int)count) >> 32);
+}
+
+float CityRandom::Float()
+{
+	return (Next() >> 8) * (1.f / 16777216.f);
+}
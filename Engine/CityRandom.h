@@ -0,0 +1,25 @@
+#pragma once
+
+// Counter based random numbers. Each value is a hash of the seed, a key and how
+// many values were taken before it, so anything keyed the same way gets the same
+// numbers whichever thread asks and in whatever order. The city keys one per block.
+class CityRandom
+{
+public:
+	CityRandom(unsigned int seed, unsigned long long key);
+
+	// The key for the block at (x, y) of the city grid
+	static unsigned long long BlockKey(int x, int y);
+
+	unsigned int Next();
+
+	// [0, count)
+	int Range(int count);
+
+	// [0, 1)
+	float Float();
+
+private:
+	unsigned long long mStream;
+	unsigned int mCounter;
+};
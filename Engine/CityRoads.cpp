@@ -0,0 +1,599 @@
+#include "CityRoads.h"
+#include "CityRandom.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <queue>
+
+// How a junction was reached in a route search, so the way there can be filled in
+enum RouteStepKind {
+	ROUTE_FROM_START,
+	ROUTE_IN_REGION,
+	ROUTE_BETWEEN_REGIONS,
+	ROUTE_TO_GOAL,
+};
+
+struct RouteStep {
+	unsigned long long from;
+	RouteStepKind kind;
+};
+
+typedef std::pair<float, unsigned long long> OpenNode;
+typedef std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> OpenList;
+
+static unsigned long long JunctionKey(SimdMath::Int2 junction)
+{
+	return CityRandom::BlockKey(junction.x, junction.y);
+}
+
+static SimdMath::Int2 KeyJunction(unsigned long long key)
+{
+	return SimdMath::Int2((int)(unsigned int)(key >> 32), (int)(unsigned int)key);
+}
+
+// Rounds towards negative infinity, so regions either side of zero are the same size
+static int FloorDivide(int value, int divisor)
+{
+	return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+CityRoads::CityRoads()
+{
+	RegionSize = 4;
+	CacheCapacity = 4096;
+
+	mBlockLength = 1.f;
+	mJunctionHalf = 0.f;
+	mShortestRoad = 0.f;
+	mRegionSize = RegionSize;
+	mVersion = 0;
+	mHits = 0;
+	mMisses = 0;
+}
+
+CityRoads::~CityRoads()
+{
+}
+
+void CityRoads::Initialize(float blockLength, float roadWidth)
+{
+	mBlockLength = blockLength;
+	mJunctionHalf = roadWidth * 0.5f;
+	mShortestRoad = blockLength;
+	mRegionSize = RegionSize > 0 ? RegionSize : 1;
+
+	mJunctions.clear();
+	mRegions.clear();
+	mDirty.clear();
+	mCache.clear();
+	mUsed.clear();
+}
+
+// The junction is where the block's crossroads is, its roads are the straight segments
+// placed on from it plus the junction they lead in to
+
+void CityRoads::AddBlock(const CityBlock& block)
+{
+	Junction junction;
+	junction.position = block.Junction;
+
+	for (int i = 0; i < 2; i++) {
+		junction.roads[i] = block.RoadLengths[i];
+
+		if (junction.roads[i] > 0.f && junction.roads[i] < mShortestRoad) {
+			mShortestRoad = junction.roads[i];
+		}
+	}
+
+	mJunctions[CityRandom::BlockKey(block.X, block.Y)] = junction;
+	MarkDirty(block.X, block.Y);
+}
+
+void CityRoads::RemoveBlock(int x, int y)
+{
+	if (mJunctions.erase(CityRandom::BlockKey(x, y)) > 0) {
+		MarkDirty(x, y);
+	}
+}
+
+void CityRoads::Update()
+{
+	if (mDirty.empty()) { return; }
+
+	std::unordered_set<unsigned long long>::iterator it;
+	for (it = mDirty.begin(); it != mDirty.end(); it++) {
+		BuildRegion(KeyJunction(*it));
+	}
+	mDirty.clear();
+
+	// Routes through a region that changed may now be cut or go through junctions that are gone
+	std::map<std::pair<unsigned long long, unsigned long long>, CachedRoute>::iterator cached = mCache.begin();
+
+	while (cached != mCache.end()) {
+		bool valid = true;
+		int count = (int)cached->second.regions.size();
+
+		for (int i = 0; i < count && valid; i++) {
+			std::unordered_map<unsigned long long, Region>::iterator region = mRegions.find(cached->second.regions[i].first);
+			valid = region != mRegions.end() && region->second.version == cached->second.regions[i].second;
+		}
+
+		if (valid) {
+			cached++;
+			continue;
+		}
+
+		mUsed.erase(cached->second.used);
+		cached = mCache.erase(cached);
+	}
+}
+
+bool CityRoads::FindRoute(SimdMath::Int2 start, SimdMath::Int2 goal, std::vector<SimdMath::Int2>& route)
+{
+	route.clear();
+
+	if (!HasJunction(start) || !HasJunction(goal)) { return false; }
+
+	if (start.x == goal.x && start.y == goal.y) {
+		route.push_back(start);
+		return true;
+	}
+
+	if (FindCached(start, goal, route)) {
+		mHits++;
+		return true;
+	}
+
+	mMisses++;
+
+	if (!Search(start, goal, route)) {
+		route.clear();
+		return false;
+	}
+
+	Cache(start, goal, route);
+	return true;
+}
+
+SimdMath::Int2 CityRoads::GetNearestJunction(SimdMath::Float3 position)
+{
+	return SimdMath::Int2((int)floor((position.x - mJunctionHalf) / mBlockLength + 0.5f),
+		(int)floor((position.z + mJunctionHalf) / mBlockLength + 0.5f));
+}
+
+SimdMath::Float3 CityRoads::GetJunctionPosition(SimdMath::Int2 junction)
+{
+	std::unordered_map<unsigned long long, Junction>::const_iterator it = mJunctions.find(JunctionKey(junction));
+
+	if (it == mJunctions.end()) {
+		return SimdMath::Float3(junction.x * mBlockLength + mJunctionHalf, 0.f, junction.y * mBlockLength - mJunctionHalf);
+	}
+
+	return it->second.position;
+}
+
+bool CityRoads::HasJunction(SimdMath::Int2 junction)
+{
+	return mJunctions.find(JunctionKey(junction)) != mJunctions.end();
+}
+
+int CityRoads::GetJunctionCount()
+{
+	return (int)mJunctions.size();
+}
+
+int CityRoads::GetRegionCount()
+{
+	return (int)mRegions.size();
+}
+
+int CityRoads::GetCachedRouteCount()
+{
+	std::lock_guard<std::mutex> lock(mCacheLock);
+	return (int)mCache.size();
+}
+
+int CityRoads::GetCacheHits()
+{
+	return mHits;
+}
+
+int CityRoads::GetCacheMisses()
+{
+	return mMisses;
+}
+
+// A road joins two junctions when the block it belongs to and the one it leads in to are both
+// in the graph. Roads are two way, a junction's roads towards -x and -z belong to its neighbours.
+
+int CityRoads::GetRoads(SimdMath::Int2 junction, SimdMath::Int2* pNeighbours, float* pCosts)
+{
+	std::unordered_map<unsigned long long, Junction>::const_iterator it = mJunctions.find(JunctionKey(junction));
+	if (it == mJunctions.end()) { return 0; }
+
+	int count = 0;
+
+	for (int axis = 0; axis < 2; axis++) {
+		SimdMath::Int2 next(junction.x + (axis == 0 ? 1 : 0), junction.y + (axis == 1 ? 1 : 0));
+		SimdMath::Int2 previous(junction.x - (axis == 0 ? 1 : 0), junction.y - (axis == 1 ? 1 : 0));
+
+		if (it->second.roads[axis] > 0.f && HasJunction(next)) {
+			pNeighbours[count] = next;
+			pCosts[count] = it->second.roads[axis];
+			count++;
+		}
+
+		std::unordered_map<unsigned long long, Junction>::const_iterator back = mJunctions.find(JunctionKey(previous));
+
+		if (back != mJunctions.end() && back->second.roads[axis] > 0.f) {
+			pNeighbours[count] = previous;
+			pCosts[count] = back->second.roads[axis];
+			count++;
+		}
+	}
+
+	return count;
+}
+
+SimdMath::Int2 CityRoads::GetRegion(SimdMath::Int2 junction)
+{
+	return SimdMath::Int2(FloorDivide(junction.x, mRegionSize), FloorDivide(junction.y, mRegionSize));
+}
+
+// A block changes its own region, and the entrances of the regions next to it when the
+// roads either side of it cross in to them
+
+void CityRoads::MarkDirty(int x, int y)
+{
+	const int offsets[5][2] = { { 0, 0 }, { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	for (int i = 0; i < 5; i++) {
+		SimdMath::Int2 region = GetRegion(SimdMath::Int2(x + offsets[i][0], y + offsets[i][1]));
+		mDirty.insert(CityRandom::BlockKey(region.x, region.y));
+	}
+}
+
+// Finds the region's entrances and the shortest ways between each pair of them that stay in
+// the region. A region with no junctions left is dropped.
+
+void CityRoads::BuildRegion(SimdMath::Int2 region)
+{
+	unsigned long long key = CityRandom::BlockKey(region.x, region.y);
+	std::vector<SimdMath::Int2> entrances;
+	bool empty = true;
+
+	for (int x = region.x * mRegionSize; x < (region.x + 1) * mRegionSize; x++) {
+		for (int y = region.y * mRegionSize; y < (region.y + 1) * mRegionSize; y++) {
+			SimdMath::Int2 junction(x, y);
+			if (!HasJunction(junction)) { continue; }
+
+			empty = false;
+
+			SimdMath::Int2 neighbours[4];
+			float costs[4];
+			int count = GetRoads(junction, neighbours, costs);
+
+			for (int i = 0; i < count; i++) {
+				SimdMath::Int2 neighbourRegion = GetRegion(neighbours[i]);
+
+				if (neighbourRegion.x != region.x || neighbourRegion.y != region.y) {
+					entrances.push_back(junction);
+					break;
+				}
+			}
+		}
+	}
+
+	if (empty) {
+		mRegions.erase(key);
+		return;
+	}
+
+	Region& built = mRegions[key];
+	int count = (int)entrances.size();
+
+	built.version = ++mVersion;
+	built.entrances = entrances;
+	built.costs.assign(count * count, -1.f);
+	built.paths.assign(count * count, std::vector<SimdMath::Int2>());
+
+	RegionSearch search;
+
+	for (int a = 0; a < count; a++) {
+		search.costs.clear();
+		search.parents.clear();
+		SearchRegion(entrances[a], search);
+
+		for (int b = 0; b < count; b++) {
+			std::unordered_map<unsigned long long, float>::const_iterator found = search.costs.find(JunctionKey(entrances[b]));
+			if (found == search.costs.end()) { continue; }
+
+			built.costs[a * count + b] = found->second;
+			TracePath(search, entrances[b], built.paths[a * count + b]);
+		}
+	}
+}
+
+int CityRoads::FindEntrance(const Region& region, SimdMath::Int2 junction)
+{
+	int count = (int)region.entrances.size();
+
+	for (int i = 0; i < count; i++) {
+		if (region.entrances[i].x == junction.x && region.entrances[i].y == junction.y) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+// Dijkstra from source over the junctions of its region
+
+void CityRoads::SearchRegion(SimdMath::Int2 source, RegionSearch& search)
+{
+	SimdMath::Int2 region = GetRegion(source);
+	OpenList open;
+
+	search.costs[JunctionKey(source)] = 0.f;
+	search.parents[JunctionKey(source)] = source;
+	open.push(OpenNode(0.f, JunctionKey(source)));
+
+	while (!open.empty()) {
+		OpenNode node = open.top();
+		open.pop();
+
+		if (node.first > search.costs[node.second]) { continue; }
+
+		SimdMath::Int2 junction = KeyJunction(node.second);
+		SimdMath::Int2 neighbours[4];
+		float costs[4];
+		int count = GetRoads(junction, neighbours, costs);
+
+		for (int i = 0; i < count; i++) {
+			SimdMath::Int2 neighbourRegion = GetRegion(neighbours[i]);
+			if (neighbourRegion.x != region.x || neighbourRegion.y != region.y) { continue; }
+
+			unsigned long long neighbourKey = JunctionKey(neighbours[i]);
+			float cost = node.first + costs[i];
+
+			std::unordered_map<unsigned long long, float>::iterator known = search.costs.find(neighbourKey);
+			if (known != search.costs.end() && known->second <= cost) { continue; }
+
+			search.costs[neighbourKey] = cost;
+			search.parents[neighbourKey] = junction;
+			open.push(OpenNode(cost, neighbourKey));
+		}
+	}
+}
+
+void CityRoads::TracePath(const RegionSearch& search, SimdMath::Int2 target, std::vector<SimdMath::Int2>& path)
+{
+	path.clear();
+
+	SimdMath::Int2 junction = target;
+	path.push_back(junction);
+
+	while (true) {
+		SimdMath::Int2 parent = search.parents.at(JunctionKey(junction));
+		if (parent.x == junction.x && parent.y == junction.y) { break; }
+
+		junction = parent;
+		path.push_back(junction);
+	}
+
+	std::reverse(path.begin(), path.end());
+}
+
+// A* over the region entrances. The start joins the entrances of its region by the ways to
+// them inside it, and the goal those of its own, then the way found is filled in from the
+// ways kept for each region it crosses.
+
+bool CityRoads::Search(SimdMath::Int2 start, SimdMath::Int2 goal, std::vector<SimdMath::Int2>& route)
+{
+	unsigned long long startKey = JunctionKey(start);
+	unsigned long long goalKey = JunctionKey(goal);
+	SimdMath::Int2 goalRegion = GetRegion(goal);
+
+	RegionSearch startSearch;
+	SearchRegion(start, startSearch);
+
+	// In the same region the way inside it is taken when there is one
+	if (startSearch.costs.find(goalKey) != startSearch.costs.end()) {
+		TracePath(startSearch, goal, route);
+		return true;
+	}
+
+	// Roads are the same length both ways, so the ways out from the goal are the ways in to it
+	RegionSearch goalSearch;
+	SearchRegion(goal, goalSearch);
+
+	std::unordered_map<unsigned long long, float> costs;
+	std::unordered_map<unsigned long long, RouteStep> steps;
+	std::unordered_set<unsigned long long> closed;
+	OpenList open;
+
+	costs[startKey] = 0.f;
+	open.push(OpenNode(0.f, startKey));
+
+	// Each step along the way is at least the shortest road long
+	auto estimate = [&](SimdMath::Int2 junction) {
+		return (float)(abs(goal.x - junction.x) + abs(goal.y - junction.y)) * mShortestRoad;
+	};
+
+	auto reach = [&](unsigned long long from, SimdMath::Int2 to, float cost, RouteStepKind kind) {
+		unsigned long long key = JunctionKey(to);
+		if (closed.find(key) != closed.end()) { return; }
+
+		std::unordered_map<unsigned long long, float>::iterator known = costs.find(key);
+		if (known != costs.end() && known->second <= cost) { return; }
+
+		RouteStep step = { from, kind };
+		costs[key] = cost;
+		steps[key] = step;
+		open.push(OpenNode(cost + estimate(to), key));
+	};
+
+	bool found = false;
+
+	while (!open.empty()) {
+		unsigned long long key = open.top().second;
+		open.pop();
+
+		if (!closed.insert(key).second) { continue; }
+
+		if (key == goalKey) {
+			found = true;
+			break;
+		}
+
+		SimdMath::Int2 junction = KeyJunction(key);
+		SimdMath::Int2 region = GetRegion(junction);
+		float cost = costs[key];
+
+		if (key == startKey) {
+			std::unordered_map<unsigned long long, Region>::const_iterator it = mRegions.find(CityRandom::BlockKey(region.x, region.y));
+			int count = it != mRegions.end() ? (int)it->second.entrances.size() : 0;
+
+			for (int i = 0; i < count; i++) {
+				std::unordered_map<unsigned long long, float>::const_iterator way = startSearch.costs.find(JunctionKey(it->second.entrances[i]));
+
+				if (way != startSearch.costs.end()) {
+					reach(key, it->second.entrances[i], cost + way->second, ROUTE_FROM_START);
+				}
+			}
+		}
+
+		// Entrances lead on to the others of their region and over the roads out of it
+		std::unordered_map<unsigned long long, Region>::const_iterator it = mRegions.find(CityRandom::BlockKey(region.x, region.y));
+		int entrance = it != mRegions.end() ? FindEntrance(it->second, junction) : -1;
+
+		if (entrance >= 0) {
+			const Region& current = it->second;
+			int count = (int)current.entrances.size();
+
+			for (int i = 0; i < count; i++) {
+				float way = current.costs[entrance * count + i];
+
+				if (i != entrance && way >= 0.f) {
+					reach(key, current.entrances[i], cost + way, ROUTE_IN_REGION);
+				}
+			}
+
+			SimdMath::Int2 neighbours[4];
+			float roads[4];
+			int roadCount = GetRoads(junction, neighbours, roads);
+
+			for (int i = 0; i < roadCount; i++) {
+				SimdMath::Int2 neighbourRegion = GetRegion(neighbours[i]);
+
+				if (neighbourRegion.x != region.x || neighbourRegion.y != region.y) {
+					reach(key, neighbours[i], cost + roads[i], ROUTE_BETWEEN_REGIONS);
+				}
+			}
+		}
+
+		if (region.x == goalRegion.x && region.y == goalRegion.y) {
+			std::unordered_map<unsigned long long, float>::const_iterator way = goalSearch.costs.find(key);
+
+			if (way != goalSearch.costs.end()) {
+				reach(key, goal, cost + way->second, ROUTE_TO_GOAL);
+			}
+		}
+	}
+
+	if (!found) { return false; }
+
+	// Walk back from the goal, then fill in each step from the start on
+	std::vector<unsigned long long> junctions;
+	for (unsigned long long key = goalKey; key != startKey; key = steps[key].from) {
+		junctions.push_back(key);
+	}
+	junctions.push_back(startKey);
+	std::reverse(junctions.begin(), junctions.end());
+
+	std::vector<SimdMath::Int2> path;
+	route.clear();
+	route.push_back(start);
+
+	int junctionCount = (int)junctions.size();
+
+	for (int i = 1; i < junctionCount; i++) {
+		SimdMath::Int2 from = KeyJunction(junctions[i - 1]);
+		SimdMath::Int2 to = KeyJunction(junctions[i]);
+		const RouteStep& step = steps[junctions[i]];
+
+		if (step.kind == ROUTE_FROM_START) {
+			TracePath(startSearch, to, path);
+		}
+		else if (step.kind == ROUTE_TO_GOAL) {
+			TracePath(goalSearch, from, path);
+			std::reverse(path.begin(), path.end());
+		}
+		else if (step.kind == ROUTE_IN_REGION) {
+			SimdMath::Int2 region = GetRegion(from);
+			const Region& current = mRegions.at(CityRandom::BlockKey(region.x, region.y));
+			int count = (int)current.entrances.size();
+
+			path = current.paths[FindEntrance(current, from) * count + FindEntrance(current, to)];
+		}
+		else {
+			path.clear();
+			path.push_back(from);
+			path.push_back(to);
+		}
+
+		// Each piece starts where the last one ended
+		route.insert(route.end(), path.begin() + 1, path.end());
+	}
+
+	return true;
+}
+
+bool CityRoads::FindCached(SimdMath::Int2 start, SimdMath::Int2 goal, std::vector<SimdMath::Int2>& route)
+{
+	std::lock_guard<std::mutex> lock(mCacheLock);
+
+	std::map<std::pair<unsigned long long, unsigned long long>, CachedRoute>::iterator it =
+		mCache.find(std::make_pair(JunctionKey(start), JunctionKey(goal)));
+	if (it == mCache.end()) { return false; }
+
+	mUsed.splice(mUsed.begin(), mUsed, it->second.used);
+	route = it->second.route;
+	return true;
+}
+
+// Keeps the route with the version of every region it goes through, see Update
+
+void CityRoads::Cache(SimdMath::Int2 start, SimdMath::Int2 goal, const std::vector<SimdMath::Int2>& route)
+{
+	std::pair<unsigned long long, unsigned long long> key(JunctionKey(start), JunctionKey(goal));
+
+	CachedRoute cached;
+	cached.route = route;
+
+	int count = (int)route.size();
+
+	for (int i = 0; i < count; i++) {
+		SimdMath::Int2 region = GetRegion(route[i]);
+		unsigned long long regionKey = CityRandom::BlockKey(region.x, region.y);
+
+		if (!cached.regions.empty() && cached.regions.back().first == regionKey) { continue; }
+
+		std::unordered_map<unsigned long long, Region>::const_iterator it = mRegions.find(regionKey);
+		cached.regions.push_back(std::make_pair(regionKey, it != mRegions.end() ? it->second.version : 0u));
+	}
+
+	std::lock_guard<std::mutex> lock(mCacheLock);
+
+	// Another thread may have found the same route meanwhile
+	if (mCache.find(key) != mCache.end()) { return; }
+
+	mUsed.push_front(key);
+	cached.used = mUsed.begin();
+	mCache[key] = cached;
+
+	while ((int)mCache.size() > CacheCapacity && !mUsed.empty()) {
+		mCache.erase(mUsed.back());
+		mUsed.pop_back();
+	}
+}
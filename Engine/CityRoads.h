@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CityBlock.h"
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The road network of the blocks in the world as a graph, a node for each block's
+// junction and an edge for each run of straight road between two junctions. Nodes
+// are named by their block's grid position.
+//
+// Routes are found over two levels. The grid is cut into square regions of
+// RegionSize blocks, the junctions of a region with a road out of it are its
+// entrances and the shortest ways between each pair of them inside the region are
+// kept. A route is searched for over the entrances only, then filled in from the
+// kept ways, so its cost barely grows with the distance. Routes found are kept too
+// and handed to everyone who asks for the same one, until a region they go through
+// changes. Routes stay within the blocks that are in the graph and may not be the
+// very shortest, as a way that leaves and comes back in to a region is not looked
+// at inside it.
+class CityRoads
+{
+public:
+	CityRoads();
+	~CityRoads();
+
+	// blockLength is the distance between junctions, roadWidth the size of a junction
+	void Initialize(float blockLength, float roadWidth);
+
+	// Blocks join the graph when they are added to the world and leave when they go
+	void AddBlock(const CityBlock& block);
+	void RemoveBlock(int x, int y);
+
+	// Call once a step from the main thread, finds the ways across the regions that
+	// changed and drops the routes through them. Must not run alongside FindRoute.
+	void Update();
+
+	// Fills route with the junctions from start to goal, both included. False when
+	// either is not in the graph or there is no way between them. Safe from any
+	// number of threads at once between Updates.
+	bool FindRoute(SimdMath::Int2 start, SimdMath::Int2 goal, std::vector<SimdMath::Int2>& route);
+
+	// The junction nearest a point in the world, and a junction's middle
+	SimdMath::Int2 GetNearestJunction(SimdMath::Float3 position);
+	SimdMath::Float3 GetJunctionPosition(SimdMath::Int2 junction);
+	bool HasJunction(SimdMath::Int2 junction);
+
+	int GetJunctionCount();
+	int GetRegionCount();
+	int GetCachedRouteCount();
+	int GetCacheHits();
+	int GetCacheMisses();
+
+	// Settings, RegionSize is read at Initialize
+	int RegionSize;
+	int CacheCapacity;
+
+private:
+	struct Junction {
+		SimdMath::Float3 position;
+		float roads[2];	// Length of the road on to the next junction along +x and +z, 0 when there is none
+	};
+
+	struct Region {
+		unsigned int version;
+		std::vector<SimdMath::Int2> entrances;
+
+		// Entrances by entrances, the cost and the junctions of the shortest way from
+		// one to the other within the region, both ends included. Negative cost when
+		// there is none.
+		std::vector<float> costs;
+		std::vector<std::vector<SimdMath::Int2>> paths;
+	};
+
+	// Shortest ways from one junction to the others of its region
+	struct RegionSearch {
+		std::unordered_map<unsigned long long, float> costs;
+		std::unordered_map<unsigned long long, SimdMath::Int2> parents;
+	};
+
+	struct CachedRoute {
+		std::vector<SimdMath::Int2> route;
+		std::vector<std::pair<unsigned long long, unsigned int>> regions;
+		std::list<std::pair<unsigned long long, unsigned long long>>::iterator used;
+	};
+
+	int GetRoads(SimdMath::Int2 junction, SimdMath::Int2* pNeighbours, float* pCosts);
+	SimdMath::Int2 GetRegion(SimdMath::Int2 junction);
+	void MarkDirty(int x, int y);
+	void BuildRegion(SimdMath::Int2 region);
+	int FindEntrance(const Region& region, SimdMath::Int2 junction);
+	void SearchRegion(SimdMath::Int2 source, RegionSearch& search);
+	void TracePath(const RegionSearch& search, SimdMath::Int2 target, std::vector<SimdMath::Int2>& path);
+	bool Search(SimdMath::Int2 start, SimdMath::Int2 goal, std::vector<SimdMath::Int2>& route);
+	bool FindCached(SimdMath::Int2 start, SimdMath::Int2 goal, std::vector<SimdMath::Int2>& route);
+	void Cache(SimdMath::Int2 start, SimdMath::Int2 goal, const std::vector<SimdMath::Int2>& route);
+
+	float mBlockLength;
+	float mJunctionHalf;
+	float mShortestRoad;
+	int mRegionSize;
+	unsigned int mVersion;
+
+	std::unordered_map<unsigned long long, Junction> mJunctions;
+	std::unordered_map<unsigned long long, Region> mRegions;
+	std::unordered_set<unsigned long long> mDirty;
+
+	// Routes by start and goal, most recently used at the front of mUsed
+	std::mutex mCacheLock;
+	std::map<std::pair<unsigned long long, unsigned long long>, CachedRoute> mCache;
+	std::list<std::pair<unsigned long long, unsigned long long>> mUsed;
+
+	std::atomic<int> mHits;
+	std::atomic<int> mMisses;
+};
@@ -0,0 +1,212 @@
+#include "CityStreamer.h"
+#include "World.h"
+#include "CityRoads.h"
+#include <algorithm>
+#include <cmath>
+
+CityStreamer::CityStreamer()
+{
+	pGenerator = 0;
+	pJobSystem = 0;
+
+	LoadRadius = 3;
+	UnloadRadius = 4;
+	ActivationBudget = 2;
+	CacheCapacity = 128;
+
+	mOffsetsRadius = -1;
+	mActiveChanged = false;
+	mGeneratingCount = 0;
+}
+
+CityStreamer::~CityStreamer()
+{
+	std::unordered_map<unsigned long long, StreamedBlock*>::iterator it;
+
+	for (it = mBlocks.begin(); it != mBlocks.end(); it++) {
+		if (it->second->state == BLOCK_GENERATING && pJobSystem) {
+			pJobSystem->Wait(&it->second->counter);
+		}
+
+		delete it->second;
+	}
+}
+
+void CityStreamer::Initialize(CityGenerator* pGenerator, JobSystem* pJobSystem)
+{
+	this->pGenerator = pGenerator;
+	this->pJobSystem = pJobSystem;
+}
+
+void CityStreamer::Update(World* pWorld, XMFLOAT3 focus)
+{
+	std::unordered_map<unsigned long long, StreamedBlock*>::iterator it;
+
+
+	if (mOffsetsRadius != LoadRadius) {
+		BuildOffsets();
+	}
+
+	float blockLength = pGenerator->RoadSegmentSize * pGenerator->RoadLength;
+	int focusX = (int)floor(focus.x / blockLength);
+	int focusY = (int)floor(focus.z / blockLength);
+
+	// Finished blocks become ready, active blocks past the unload radius are taken out
+	for (it = mBlocks.begin(); it != mBlocks.end(); it++) {
+		StreamedBlock* pBlock = it->second;
+
+		if (pBlock->state == BLOCK_GENERATING) {
+			if (!pBlock->counter.IsDone()) { continue; }
+
+			pBlock->state = BLOCK_READY;
+			mGeneratingCount--;
+			Cache(it->first, pBlock);
+			continue;
+		}
+
+		if (pBlock->state == BLOCK_ACTIVE) {
+			int dx = pBlock->block.X - focusX;
+			int dy = pBlock->block.Y - focusY;
+
+			if (dx * dx + dy * dy > UnloadRadius * UnloadRadius) {
+				Deactivate(pBlock);
+				Cache(it->first, pBlock);
+			}
+		}
+	}
+
+	// Nearest first, start the blocks that are missing and bring in the ones that are ready
+	int budget = ActivationBudget;
+
+	for (int i = 0; i < mOffsets.size(); i++) {
+		int x = focusX + mOffsets[i].x;
+		int y = focusY + mOffsets[i].y;
+		unsigned long long key = CityRandom::BlockKey(x, y);
+
+		it = mBlocks.find(key);
+
+		if (it == mBlocks.end()) {
+			StreamedBlock* pBlock = new StreamedBlock();
+			pBlock->block.X = x;
+			pBlock->block.Y = y;
+			pBlock->state = BLOCK_GENERATING;
+			pBlock->pStreamer = this;
+
+			mBlocks[key] = pBlock;
+			mGeneratingCount++;
+
+			if (pJobSystem) {
+				pJobSystem->Run(GenerateJob, pBlock, 0, 1, &pBlock->counter);
+			}
+			else {
+				GenerateJob(pBlock, 0, 1);
+			}
+			continue;
+		}
+
+		StreamedBlock* pBlock = it->second;
+
+		if (pBlock->state == BLOCK_READY && budget > 0) {
+			mCache.erase(pBlock->cached);
+			Activate(pBlock);
+			budget--;
+		}
+	}
+
+	// Forget the blocks that have been away the longest
+	while ((int)mCache.size() > CacheCapacity) {
+		unsigned long long key = mCache.back();
+		mCache.pop_back();
+
+		delete mBlocks[key];
+		mBlocks.erase(key);
+	}
+
+	if (mActiveChanged) {
+		mColliders.clear();
+		for (int i = 0; i < mActive.size(); i++) {
+			pGenerator->AddColliders(mActive[i]->block, mColliders);
+		}
+
+		pWorld->SetStaticColliders(mColliders);
+		mActiveChanged = false;
+	}
+}
+
+void CityStreamer::WriteInstances(std::vector<CityInstance>& instances)
+{
+	for (int i = 0; i < mActive.size(); i++) {
+		std::vector<CityInstance>& blockInstances = mActive[i]->block.Instances;
+		instances.insert(instances.end(), blockInstances.begin(), blockInstances.end());
+	}
+}
+
+int CityStreamer::GetActiveCount()
+{
+	return (int)mActive.size();
+}
+
+int CityStreamer::GetCachedCount()
+{
+	return (int)mCache.size();
+}
+
+int CityStreamer::GetGeneratingCount()
+{
+	return mGeneratingCount;
+}
+
+void CityStreamer::GenerateJob(void* pData, unsigned int begin, unsigned int end)
+{
+	StreamedBlock* pBlock = (StreamedBlock*)pData;
+
+	pBlock->pStreamer->pGenerator->GenerateBlock(pBlock->block.X, pBlock->block.Y, pBlock->block);
+}
+
+void CityStreamer::BuildOffsets()
+{
+	mOffsets.clear();
+
+	for (int x = -LoadRadius; x <= LoadRadius; x++) {
+		for (int y = -LoadRadius; y <= LoadRadius; y++) {
+			if (x * x + y * y <= LoadRadius * LoadRadius) {
+				mOffsets.push_back(XMINT2(x, y));
+			}
+		}
+	}
+
+	std::stable_sort(mOffsets.begin(), mOffsets.end(), [](const XMINT2& a, const XMINT2& b) {
+		return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+	});
+
+	mOffsetsRadius = LoadRadius;
+}
+
+void CityStreamer::Activate(StreamedBlock* pBlock)
+{
+	pBlock->active = (int)mActive.size();
+	mActive.push_back(pBlock);
+
+	pBlock->state = BLOCK_ACTIVE;
+	mActiveChanged = true;
+
+	pGenerator->GetRoads()->AddBlock(pBlock->block);
+}
+
+void CityStreamer::Deactivate(StreamedBlock* pBlock)
+{
+	mActive[pBlock->active] = mActive.back();
+	mActive[pBlock->active]->active = pBlock->active;
+	mActive.pop_back();
+
+	pBlock->state = BLOCK_READY;
+	mActiveChanged = true;
+
+	pGenerator->GetRoads()->RemoveBlock(pBlock->block.X, pBlock->block.Y);
+}
+
+void CityStreamer::Cache(unsigned long long key, StreamedBlock* pBlock)
+{
+	mCache.push_front(key);
+	pBlock->cached = mCache.begin();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CityGenerator.h"
+#include "JobSystem.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class World;
+
+// Keeps the blocks of an endless city grid around a focus point in the world.
+// Blocks that come within LoadRadius are generated on the job system and made
+// active, at most ActivationBudget a step, nearest first. Active blocks are in the
+// road graph. Blocks that go past UnloadRadius stop being drawn, collided with and
+// routed through but keep their instances, the
+// least recently active of those are dropped once there are more than
+// CacheCapacity. A block is built from the seed and its position, so one that
+// comes back is the same as when it left.
+class CityStreamer
+{
+public:
+	CityStreamer();
+	~CityStreamer();
+
+	void Initialize(CityGenerator* pGenerator, JobSystem* pJobSystem);
+
+	// Call once a step from the main thread, before the step's objects are gathered.
+	// Hands the world the colliders of the active blocks when they change.
+	void Update(World* pWorld, XMFLOAT3 focus);
+
+	// The instances of every active block
+	void WriteInstances(std::vector<CityInstance>& instances);
+
+	// In blocks
+	int LoadRadius;
+	int UnloadRadius;
+	int ActivationBudget;
+	int CacheCapacity;
+
+	int GetActiveCount();
+	int GetCachedCount();
+	int GetGeneratingCount();
+
+private:
+	enum BlockState {
+		BLOCK_GENERATING,
+		BLOCK_READY,
+		BLOCK_ACTIVE,
+	};
+
+	struct StreamedBlock {
+		CityBlock block;
+		BlockState state;
+		JobCounter counter;
+
+		// Where the block is in mActive while it is active
+		int active;
+
+		// Where the block is in mCache while it is ready but not active
+		std::list<unsigned long long>::iterator cached;
+
+		CityStreamer* pStreamer;
+	};
+
+	static void GenerateJob(void* pData, unsigned int begin, unsigned int end);
+
+	void BuildOffsets();
+	void Activate(StreamedBlock* pBlock);
+	void Deactivate(StreamedBlock* pBlock);
+	void Cache(unsigned long long key, StreamedBlock* pBlock);
+
+	CityGenerator* pGenerator;
+	JobSystem* pJobSystem;
+
+	std::unordered_map<unsigned long long, StreamedBlock*> mBlocks;
+
+	// Ready blocks that are not active, most recently active at the front
+	std::list<unsigned long long> mCache;
+
+	// Offsets within LoadRadius of the focus block, nearest first
+	std::vector<XMINT2> mOffsets;
+	int mOffsetsRadius;
+
+	std::vector<StreamedBlock*> mActive;
+	bool mActiveChanged;
+	std::vector<StaticCollider> mColliders;
+
+	int mGeneratingCount;
+};
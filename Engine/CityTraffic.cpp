@@ -0,0 +1,538 @@
+#include "CityTraffic.h"
+#include "CityRandom.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Indexed by LaneDirection, turning left adds one and turning right takes one
+static const int LANE_DX[4] = { 1, 0, -1, 0 };
+static const int LANE_DY[4] = { 0, 1, 0, -1 };
+
+// Quarter turns about y of a car driving each way, a yaw of 0 faces +z
+static const unsigned char LANE_TURNS[4] = { 1, 0, 3, 2 };
+
+CityTraffic::CityTraffic()
+{
+	GridSize = 9;
+	VehicleCount = 400;
+	FollowFocus = true;
+	MaxSpeed = 12.f;
+	MaxAcceleration = 3.f;
+	ComfortableBraking = 5.f;
+	MinimumGap = 2.f;
+	HeadwayTime = 1.f;
+	VehicleLength = 6.f;
+	LaneOffset = 5.f;
+	PriorityPeriod = 8.f;
+
+	mBlockLength = 0.f;
+	mJunctionHalf = 0.f;
+	mSeed = 0;
+	mOriginX = 0;
+	mOriginY = 0;
+	mTargetX = 0;
+	mTargetY = 0;
+	mFocus = SimdMath::Float3(0.f, 0.f, 0.f);
+	mTime = -1.0;
+	mDelta = 0.f;
+	mTick = 0;
+	mCurrent = 0;
+	mWaitingCount = 0;
+}
+
+CityTraffic::~CityTraffic()
+{
+}
+
+// Cars start spread evenly over every lane, the ones that do not fit wait to come in at the edge
+void CityTraffic::Initialize(float blockLength, float roadWidth, unsigned int seed)
+{
+	mBlockLength = blockLength;
+	mJunctionHalf = roadWidth * 0.5f;
+	mSeed = seed;
+
+	if (mTypes.empty()) {
+		VehicleCount = 0;
+	}
+
+	int nodeCount = GridSize * GridSize;
+	int laneCount = nodeCount * 4;
+
+	mLaneEnd.resize(laneCount);
+	mLaneStart.resize(laneCount + 1);
+	mLaneFill.resize(laneCount);
+	mLaneTail.resize(laneCount);
+	mLaneIncoming.resize(laneCount);
+	mNodePhase.resize(nodeCount);
+	mNodeAxes.resize(nodeCount);
+	mEntryLanes.clear();
+
+	for (int y = 0; y < GridSize; y++) {
+		for (int x = 0; x < GridSize; x++) {
+			for (int d = 0; d < 4; d++) {
+				int endX = x + LANE_DX[d];
+				int endY = y + LANE_DY[d];
+				bool inside = endX >= 0 && endX < GridSize && endY >= 0 && endY < GridSize;
+
+				mLaneEnd[GetLane(x, y, d)] = inside ? endY * GridSize + endX : -1;
+
+				// Lanes into the region from its edge are where cars come back in
+				int backX = x - LANE_DX[d];
+				int backY = y - LANE_DY[d];
+				if (inside && (backX < 0 || backX >= GridSize || backY < 0 || backY >= GridSize)) {
+					mEntryLanes.push_back(GetLane(x, y, d));
+				}
+			}
+		}
+	}
+
+	BuildNodes();
+
+	for (int i = 0; i < 2; i++) {
+		mLane[i].resize(VehicleCount);
+		mDistance[i].resize(VehicleCount);
+		mSpeed[i].resize(VehicleCount);
+		mTurn[i].resize(VehicleCount);
+	}
+	mType.resize(VehicleCount);
+	mLeader.resize(VehicleCount);
+	mGranted.resize(VehicleCount);
+	mOrder.resize(VehicleCount);
+	mOrderScratch.resize(VehicleCount);
+
+	float spacing = VehicleLength * 3.f;
+	float last = mBlockLength - mJunctionHalf - VehicleLength;
+
+	for (int i = 0; i < VehicleCount; i++) {
+		int lane = i % laneCount;
+		float distance = mJunctionHalf + (i / laneCount) * spacing;
+
+		if (distance > last) {
+			lane = -1;
+			distance = 0.f;
+		}
+
+		CityRandom random(mSeed, (unsigned long long)i);
+		mType[i] = (unsigned char)random.Range((int)mTypes.size());
+
+		for (int j = 0; j < 2; j++) {
+			mLane[j][i] = lane;
+			mDistance[j][i] = distance;
+			mSpeed[j][i] = 0.f;
+			mTurn[j][i] = ChooseTurn(i, lane & 3);
+		}
+
+		mOrder[i] = i;
+		mGranted[i] = 0;
+	}
+}
+
+void CityTraffic::AddVehicleType(unsigned short model, unsigned char turns)
+{
+	VehicleType type;
+	type.model = model;
+	type.turns = turns;
+
+	mTypes.push_back(type);
+}
+
+// The region moves in whole junctions once the focus is a quarter of the way from its middle
+void CityTraffic::Advance(SimdMath::Float3 focus, double time)
+{
+	bool first = mTime < 0.0;
+
+	mDelta = first ? 0.f : (float)(time - mTime);
+	mTime = time;
+	mFocus = focus;
+
+	if (!FollowFocus) { return; }
+
+	int focusX = (int)floor((focus.x - mJunctionHalf) / mBlockLength + 0.5f);
+	int focusY = (int)floor((focus.z + mJunctionHalf) / mBlockLength + 0.5f);
+	int half = GridSize / 2;
+
+	// The cars start out placed around wherever the focus is
+	if (first) {
+		mOriginX = mTargetX = focusX - half;
+		mOriginY = mTargetY = focusY - half;
+		BuildNodes();
+		return;
+	}
+
+	if (abs(focusX - (mTargetX + half)) > GridSize / 4 || abs(focusY - (mTargetY + half)) > GridSize / 4) {
+		mTargetX = focusX - half;
+		mTargetY = focusY - half;
+	}
+}
+
+// Serial part of a step. Cars waiting come back in on an edge lane with room, then the cars are
+// bucketed by lane in their last order, which only needs a few swaps to put back front to back as
+// cars do not pass each other. The car at the front of a lane follows the last car on the lane it
+// is going on to, and is let into the junction here so two cars are never let on to one lane.
+void CityTraffic::Sort(unsigned int begin, unsigned int end)
+{
+	mCurrent ^= 1;
+	mTick++;
+
+	if (mTargetX != mOriginX || mTargetY != mOriginY) {
+		Shift(mTargetX, mTargetY);
+	}
+
+	std::vector<int>& lanes = mLane[mCurrent];
+	std::vector<float>& distances = mDistance[mCurrent];
+	std::vector<float>& speeds = mSpeed[mCurrent];
+	std::vector<unsigned char>& turns = mTurn[mCurrent];
+	int laneCount = (int)mLaneEnd.size();
+	float stopLine = mBlockLength - mJunctionHalf;
+	int i, j;
+
+	// The last car on each lane and the car in the junction on its way on to it
+	std::fill(mLaneTail.begin(), mLaneTail.end(), mBlockLength);
+	std::fill(mLaneIncoming.begin(), mLaneIncoming.end(), -1);
+
+	for (i = 0; i < VehicleCount; i++) {
+		int lane = lanes[i];
+		if (lane < 0) { continue; }
+
+		mLaneTail[lane] = std::min(mLaneTail[lane], distances[i]);
+
+		if (mLaneEnd[lane] >= 0 && distances[i] >= stopLine) {
+			mLaneIncoming[mLaneEnd[lane] * 4 + turns[i]] = i;
+		}
+	}
+
+	float room = VehicleLength + MinimumGap;
+
+	for (i = 0; i < VehicleCount && !mEntryLanes.empty(); i++) {
+		if (lanes[i] >= 0) { continue; }
+
+		CityRandom random(mSeed, ((unsigned long long)i << 32) | mTick);
+		int first = random.Range((int)mEntryLanes.size());
+
+		// A few tries a step, a car that finds no room tries again next step
+		for (j = 0; j < 4; j++) {
+			int lane = mEntryLanes[(first + j) % mEntryLanes.size()];
+			if (mLaneTail[lane] < room || mLaneIncoming[lane] >= 0) { continue; }
+
+			lanes[i] = lane;
+			distances[i] = 0.f;
+			speeds[i] = MaxSpeed * 0.5f;
+			turns[i] = ChooseTurn(i, lane & 3);
+			mLaneTail[lane] = 0.f;
+			break;
+		}
+	}
+
+	std::fill(mLaneStart.begin(), mLaneStart.end(), 0);
+	for (i = 0; i < VehicleCount; i++) {
+		if (lanes[i] >= 0) {
+			mLaneStart[lanes[i] + 1]++;
+		}
+	}
+	for (i = 0; i < laneCount; i++) {
+		mLaneStart[i + 1] += mLaneStart[i];
+		mLaneFill[i] = mLaneStart[i];
+	}
+
+	// Waiting cars go after the last lane
+	int waiting = mLaneStart[laneCount];
+	for (i = 0; i < VehicleCount; i++) {
+		int vehicle = mOrder[i];
+		int lane = lanes[vehicle];
+
+		if (lane >= 0) {
+			mOrderScratch[mLaneFill[lane]++] = vehicle;
+		}
+		else {
+			mOrderScratch[waiting++] = vehicle;
+		}
+	}
+	mOrder.swap(mOrderScratch);
+
+	std::fill(mNodeAxes.begin(), mNodeAxes.end(), 0);
+	int stopped = 0;
+
+	for (int lane = 0; lane < laneCount; lane++) {
+		int first = mLaneStart[lane];
+		int last = mLaneStart[lane + 1];
+
+		for (i = first + 1; i < last; i++) {
+			int vehicle = mOrder[i];
+			for (j = i; j > first && distances[mOrder[j - 1]] < distances[vehicle]; j--) {
+				mOrder[j] = mOrder[j - 1];
+			}
+			mOrder[j] = vehicle;
+		}
+
+		int laneEnd = mLaneEnd[lane];
+		unsigned char axis = (unsigned char)(1 << (lane & 1));
+
+		for (i = first; i < last; i++) {
+			int vehicle = mOrder[i];
+
+			mLeader[vehicle] = -1;
+
+			if (i > first) {
+				mLeader[vehicle] = mOrder[i - 1];
+			}
+			else if (laneEnd >= 0) {
+				int nextLane = laneEnd * 4 + turns[vehicle];
+				if (mLaneStart[nextLane + 1] > mLaneStart[nextLane]) {
+					mLeader[vehicle] = mOrder[mLaneStart[nextLane + 1] - 1];
+				}
+			}
+
+			// Cars still in the junction they came from or already in the one ahead
+			if (distances[vehicle] < mJunctionHalf) {
+				mNodeAxes[lane >> 2] |= axis;
+			}
+			if (laneEnd >= 0 && distances[vehicle] > stopLine) {
+				mNodeAxes[laneEnd] |= axis;
+			}
+
+			if (speeds[vehicle] < 0.5f) {
+				stopped++;
+			}
+		}
+	}
+
+	// The first car short of each stop line, if it is close enough to need to know. The ones let
+	// through last step go first so a car is not stopped at the last moment for one behind it.
+	float approach = mBlockLength - mJunctionHalf - VehicleLength - MaxSpeed * MaxSpeed / ComfortableBraking;
+
+	for (int pass = 1; pass >= 0; pass--) {
+		for (int lane = 0; lane < laneCount; lane++) {
+			if (mLaneEnd[lane] < 0) { continue; }
+
+			int first = mLaneStart[lane];
+			int last = mLaneStart[lane + 1];
+			while (first < last && distances[mOrder[first]] >= stopLine) {
+				first++;
+			}
+			if (first == last) { continue; }
+
+			int vehicle = mOrder[first];
+			if (mGranted[vehicle] != pass) { continue; }
+
+			mGranted[vehicle] = 0;
+
+			if (distances[vehicle] < approach) { continue; }
+
+			int nextLane = mLaneEnd[lane] * 4 + turns[vehicle];
+			if (mLaneIncoming[nextLane] < 0 && CanEnter(lane, nextLane)) {
+				mGranted[vehicle] = 1;
+				mLaneIncoming[nextLane] = vehicle;
+			}
+		}
+	}
+
+	mWaitingCount = stopped;
+}
+
+// Moves each car on its own from the current state, the other buffer gets its next state
+void CityTraffic::Update(unsigned int begin, unsigned int end)
+{
+	const std::vector<int>& lanes = mLane[mCurrent];
+	const std::vector<float>& distances = mDistance[mCurrent];
+	const std::vector<float>& speeds = mSpeed[mCurrent];
+	const std::vector<unsigned char>& turns = mTurn[mCurrent];
+	int next = mCurrent ^ 1;
+
+	float stopLine = mBlockLength - mJunctionHalf;
+	float brakingTerm = 2.f * sqrtf(MaxAcceleration * ComfortableBraking);
+	float deltaTime = mDelta;
+
+	for (unsigned int i = begin; i < end; i++) {
+		int lane = lanes[i];
+		float distance = distances[i];
+		float speed = speeds[i];
+		unsigned char turn = turns[i];
+
+		if (lane < 0) {
+			mLane[next][i] = lane;
+			mDistance[next][i] = distance;
+			mSpeed[next][i] = speed;
+			mTurn[next][i] = turn;
+			continue;
+		}
+
+		int laneEnd = mLaneEnd[lane];
+
+		bool blocked = false;
+		float gap = 0.f;
+		float closing = 0.f;
+
+		int leader = mLeader[i];
+		if (leader >= 0) {
+			float leaderDistance = distances[leader] + (lanes[leader] == lane ? 0.f : mBlockLength);
+
+			blocked = true;
+			gap = leaderDistance - distance - VehicleLength;
+			closing = speed - speeds[leader];
+		}
+
+		// Cars wait at the stop line until let through, past it a car is committed
+		if (laneEnd >= 0 && distance < stopLine && !mGranted[i]) {
+			float stopGap = stopLine - distance - VehicleLength * 0.5f;
+
+			if (!blocked || stopGap < gap) {
+				blocked = true;
+				gap = stopGap;
+				closing = speed;
+			}
+		}
+
+		// Intelligent driver model
+		float ratio = speed / MaxSpeed;
+		float acceleration = 1.f - ratio * ratio * ratio * ratio;
+
+		if (blocked) {
+			float desired = MinimumGap + std::max(0.f, speed * HeadwayTime + speed * closing / brakingTerm);
+			float pressure = gap > 0.01f ? desired / gap : 100.f;
+			acceleration -= pressure * pressure;
+		}
+
+		speed += MaxAcceleration * acceleration * deltaTime;
+		speed = std::min(std::max(speed, 0.f), MaxSpeed);
+
+		float travel = speed * deltaTime;
+		if (blocked) {
+			travel = std::min(travel, std::max(gap, 0.f));
+		}
+		distance += travel;
+
+		// On to the next lane, or out of the region to come back in at the edge
+		if (distance >= mBlockLength) {
+			if (laneEnd < 0) {
+				lane = -1;
+				distance = 0.f;
+			}
+			else {
+				lane = laneEnd * 4 + turn;
+				distance -= mBlockLength;
+				turn = ChooseTurn(i, turn);
+				mGranted[i] = 0;
+			}
+		}
+
+		mLane[next][i] = lane;
+		mDistance[next][i] = distance;
+		mSpeed[next][i] = speed;
+		mTurn[next][i] = turn;
+	}
+}
+
+void CityTraffic::WriteInstances(std::vector<CityInstance>& instances, float radius)
+{
+	int latest = mCurrent ^ 1;
+
+	for (int i = 0; i < VehicleCount; i++) {
+		int lane = mLane[latest][i];
+		if (lane < 0) { continue; }
+
+		SimdMath::Float3 position = GetPosition(lane, mDistance[latest][i]);
+
+		float x = position.x - mFocus.x;
+		float z = position.z - mFocus.z;
+		if (x * x + z * z > radius * radius) { continue; }
+
+		const VehicleType& type = mTypes[mType[i]];
+
+		CityInstance instance;
+		instance.Position = position;
+		instance.Model = type.model;
+		instance.Turns = (unsigned char)((LANE_TURNS[lane & 3] + type.turns) & 3);
+		instance.Flags = 0;
+		instances.push_back(instance);
+	}
+}
+
+int CityTraffic::GetVehicleCount()
+{
+	return VehicleCount;
+}
+
+int CityTraffic::GetWaitingCount()
+{
+	return mWaitingCount;
+}
+
+int CityTraffic::GetLane(int x, int y, int direction)
+{
+	return ((y * GridSize) + x) * 4 + direction;
+}
+
+// Straight on more often than not, never back the way it came
+unsigned char CityTraffic::ChooseTurn(int vehicle, int direction)
+{
+	CityRandom random(mSeed, ((unsigned long long)vehicle << 32) | mTick);
+	int pick = random.Range(10);
+
+	if (pick < 6) { return (unsigned char)direction; }
+	if (pick < 8) { return (unsigned char)((direction + 1) & 3); }
+	return (unsigned char)((direction + 3) & 3);
+}
+
+bool CityTraffic::CanEnter(int lane, int nextLane)
+{
+	int node = mLaneEnd[lane];
+	int axis = lane & 1;
+
+	int phase = (int)floor((mTime + mNodePhase[node]) / PriorityPeriod) & 1;
+	if (phase != axis) { return false; }
+
+	if (mNodeAxes[node] & (1 << (axis ^ 1))) { return false; }
+
+	return mLaneTail[nextLane] >= mJunctionHalf + VehicleLength + MinimumGap;
+}
+
+// Junctions are where the road models meet, half a road to +x and -z of the grid point.
+// Cars keep to the right of the road's middle.
+SimdMath::Float3 CityTraffic::GetPosition(int lane, float distance)
+{
+	int node = lane >> 2;
+	int direction = lane & 3;
+	int right = (direction + 3) & 3;
+
+	float x = mBlockLength * (mOriginX + node % GridSize) + mJunctionHalf;
+	float z = mBlockLength * (mOriginY + node / GridSize) - mJunctionHalf;
+
+	x += LANE_DX[direction] * distance + LANE_DX[right] * LaneOffset;
+	z += LANE_DY[direction] * distance + LANE_DY[right] * LaneOffset;
+
+	return SimdMath::Float3(x, 0.5f, z);
+}
+
+// Cars keep their place in the world. The junctions that leave the region are the ones that come
+// into it on the other side, so the cars left outside wrap around to the same places on those and
+// the region keeps its traffic.
+void CityTraffic::Shift(int x, int y)
+{
+	int shiftX = x - mOriginX;
+	int shiftY = y - mOriginY;
+	std::vector<int>& lanes = mLane[mCurrent];
+
+	for (int i = 0; i < VehicleCount; i++) {
+		int lane = lanes[i];
+		if (lane < 0) { continue; }
+
+		int node = lane >> 2;
+		int nodeX = ((node % GridSize - shiftX) % GridSize + GridSize) % GridSize;
+		int nodeY = ((node / GridSize - shiftY) % GridSize + GridSize) % GridSize;
+
+		lanes[i] = GetLane(nodeX, nodeY, lane & 3);
+	}
+
+	mOriginX = x;
+	mOriginY = y;
+	BuildNodes();
+}
+
+// Each junction's priority swaps on its own offset, taken from where it is so it does not change as the region moves
+void CityTraffic::BuildNodes()
+{
+	for (int i = 0; i < (int)mNodePhase.size(); i++) {
+		CityRandom random(mSeed, CityRandom::BlockKey(mOriginX + i % GridSize, mOriginY + i / GridSize));
+		mNodePhase[i] = random.Float() * PriorityPeriod * 2.f;
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "CityBlock.h"
+#include <atomic>
+#include <vector>
+
+// Cars driving the lanes of the road grid in a square region of junctions around
+// a focus point. Each road between two junctions has a lane each way, a lane runs
+// from the center of one junction to the center of the next. Cars keep their
+// distance to the car ahead with the intelligent driver model and pick a way on
+// at random when they take a lane. Priority at each junction swaps between its
+// two roads every PriorityPeriod seconds, a car waits at the stop line unless its
+// road has priority, no car on the other road is still in the junction and there
+// is room on the lane it is going on to. Only one car at a time is let through on
+// to any one lane, so cars turning in from either side do not merge into each
+// other. Cars that drive out of the region come back in on a lane at its edge.
+//
+// The state is kept as arrays per field and double buffered. Sort orders the cars
+// along their lanes and finds what each one follows, then Update moves every car
+// on its own from the last state to the next, so any number of workers can share
+// it and the result is the same.
+class CityTraffic
+{
+public:
+	CityTraffic();
+	~CityTraffic();
+
+	// blockLength is the distance between junctions, roadWidth the size of a junction
+	void Initialize(float blockLength, float roadWidth, unsigned int seed);
+	void AddVehicleType(unsigned short model, unsigned char turns);
+
+	// Call once a step from the main thread, before Sort. The region is moved to
+	// keep the focus near its middle when FollowFocus is set.
+	void Advance(SimdMath::Float3 focus, double time);
+
+	// Step phases, Sort runs once and Update over [0, GetVehicleCount())
+	void Sort(unsigned int begin, unsigned int end);
+	void Update(unsigned int begin, unsigned int end);
+
+	// The cars within radius of the focus, as of the last Update
+	void WriteInstances(std::vector<CityInstance>& instances, float radius);
+
+	int GetVehicleCount();
+	int GetWaitingCount();
+
+	// Settings, read at Initialize. Distances are in world units and seconds.
+	int GridSize;
+	int VehicleCount;
+	bool FollowFocus;
+	float MaxSpeed;
+	float MaxAcceleration;
+	float ComfortableBraking;
+	float MinimumGap;
+	float HeadwayTime;
+	float VehicleLength;
+	float LaneOffset;
+	float PriorityPeriod;
+
+private:
+	enum LaneDirection {
+		LANE_POS_X,
+		LANE_POS_Z,
+		LANE_NEG_X,
+		LANE_NEG_Z,
+	};
+
+	struct VehicleType {
+		unsigned short model;
+		unsigned char turns;
+	};
+
+	int GetLane(int x, int y, int direction);
+	unsigned char ChooseTurn(int vehicle, int direction);
+	bool CanEnter(int lane, int nextLane);
+	SimdMath::Float3 GetPosition(int lane, float distance);
+	void Shift(int x, int y);
+	void BuildNodes();
+
+	float mBlockLength;
+	float mJunctionHalf;
+	unsigned int mSeed;
+	std::vector<VehicleType> mTypes;
+
+	// Grid position of the region's first junction, and where it is to move to
+	int mOriginX;
+	int mOriginY;
+	int mTargetX;
+	int mTargetY;
+	SimdMath::Float3 mFocus;
+
+	double mTime;
+	float mDelta;
+	unsigned int mTick;
+
+	// Per lane, lane = (junction * 4) + direction. The junction a lane ends at, -1 when it leaves the region.
+	std::vector<int> mLaneEnd;
+	std::vector<int> mLaneStart;
+	std::vector<int> mLaneFill;
+	std::vector<float> mLaneTail;
+	std::vector<int> mLaneIncoming;
+	std::vector<int> mEntryLanes;
+
+	// Per junction
+	std::vector<float> mNodePhase;
+	std::vector<unsigned char> mNodeAxes;
+
+	// Per car. Update reads buffer mCurrent and writes the other, a lane of -1 is a car waiting to come back in.
+	int mCurrent;
+	std::vector<int> mLane[2];
+	std::vector<float> mDistance[2];
+	std::vector<float> mSpeed[2];
+	std::vector<unsigned char> mTurn[2];
+	std::vector<unsigned char> mType;
+	std::vector<int> mLeader;
+	std::vector<unsigned char> mGranted;
+
+	// Cars by lane, each lane front to back
+	std::vector<int> mOrder;
+	std::vector<int> mOrderScratch;
+
+	std::atomic<int> mWaitingCount;
+};
@@ -0,0 +1,185 @@
+// HeightRangeBenchmark.cpp
+//
+// Feeds random glyph sizes through the skyline in CFW1HeightRange and through the column per
+// height packer it replaced, placing them the way CFW1GlyphSheet::InsertGlyph does and opening
+// a new sheet whenever one fills. Prints glyphs placed per millisecond and how much of each
+// sheet the glyphs cover, and checks no glyph the skyline places overlaps another. Needs no
+// Windows, DirectX or DirectWrite headers.
+//   cl /EHsc /O2 /ISource HeightRangeBenchmark.cpp Source\CFW1HeightRange.cpp
+//   g++ -O2 -ISource HeightRangeBenchmark.cpp Source/CFW1HeightRange.cpp
+
+#include "CFW1HeightRange.h"
+#include "../Tests/TestCheck.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace FW1FontWrapper;
+
+
+// The packer before the skyline, one height per column with a window slid across them all
+class LinearHeightRange {
+	public:
+		LinearHeightRange(UINT totalWidth) : m_totalWidth(totalWidth) {
+			m_heights = new UINT[m_totalWidth];
+			memset(m_heights, 0, m_totalWidth * sizeof(UINT));
+		}
+		~LinearHeightRange() {
+			delete[] m_heights;
+		}
+
+		UINT findMin(UINT width, UINT *outMin) {
+			if(width > m_totalWidth)
+				width = m_totalWidth;
+
+			UINT currentMax = findMax(0, width);
+			UINT currentMin = currentMax;
+			UINT minX = 0;
+
+			for(UINT i=1; i < m_totalWidth-width; ++i) {
+				if(m_heights[i+width-1] >= currentMax)
+					currentMax = m_heights[i+width-1];
+				else if(m_heights[i-1] == currentMax) {
+					currentMax = findMax(i, width);
+					if(currentMax < currentMin) {
+						currentMin = currentMax;
+						minX = i;
+					}
+				}
+			}
+
+			*outMin = currentMin;
+			return minX;
+		}
+
+		void update(UINT startX, UINT width, UINT newHeight) {
+			if(width > m_totalWidth)
+				width = m_totalWidth;
+
+			for(UINT i=0; i < width; ++i)
+				m_heights[startX+i] = newHeight;
+		}
+
+	private:
+		UINT findMax(UINT startX, UINT width) {
+			UINT currentMax = m_heights[startX];
+			for(UINT i=1; i < width; ++i)
+				currentMax = std::max(currentMax, m_heights[startX+i]);
+
+			return currentMax;
+		}
+
+		UINT				*m_heights;
+		UINT				m_totalWidth;
+};
+
+
+struct GlyphSize {
+	UINT					width;
+	UINT					height;
+};
+
+struct PackResult {
+	double					milliseconds;
+	UINT					sheetCount;
+	double					occupancy;
+};
+
+
+// Places every glyph as InsertGlyph does with one mip level, so a one pixel border on each
+// side. When verify is set a copy of each column's height checks the range reports exactly the
+// height of what is already packed under each place it picks.
+template<class T>
+static PackResult packGlyphs(const std::vector<GlyphSize> &glyphs, UINT sheetSize, bool verify) {
+	std::vector<UINT> columns;
+	unsigned long long glyphArea = 0;
+	UINT sheetCount = 1;
+	T *pRange = new T(sheetSize);
+
+	if(verify)
+		columns.assign(sheetSize, 0);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for(size_t i=0; i < glyphs.size(); ++i) {
+		UINT blockWidth = glyphs[i].width + 1;
+		UINT blockHeight = glyphs[i].height + 1;
+		UINT blockY;
+		UINT blockX = pRange->findMin(blockWidth, &blockY);
+
+		if(1 + blockY + glyphs[i].height + 1 > sheetSize) {
+			// Sheet full, carry on in a new one
+			delete pRange;
+			pRange = new T(sheetSize);
+			++sheetCount;
+
+			if(verify)
+				columns.assign(sheetSize, 0);
+
+			blockX = pRange->findMin(blockWidth, &blockY);
+		}
+
+		if(verify) {
+			UINT highest = 0;
+			for(UINT x=blockX; x < blockX + blockWidth; ++x)
+				highest = std::max(highest, columns[x]);
+			CHECK(highest == blockY);
+
+			for(UINT x=blockX; x < blockX + blockWidth; ++x)
+				columns[x] = blockY + blockHeight;
+		}
+
+		pRange->update(blockX, blockWidth, blockY + blockHeight);
+		glyphArea += glyphs[i].width * glyphs[i].height;
+	}
+
+	PackResult result;
+	result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	result.sheetCount = sheetCount;
+	result.occupancy = static_cast<double>(glyphArea) / (static_cast<double>(sheetSize) * sheetSize * sheetCount);
+
+	delete pRange;
+
+	return result;
+}
+
+
+int main() {
+	const UINT glyphCount = 200000;
+	const UINT sheetSizes[3] = { 512, 1024, 2048 };
+
+	// Sizes of text from small UI fonts up to headings
+	std::vector<GlyphSize> glyphs(glyphCount);
+	UINT randomState = 1;
+	for(UINT i=0; i < glyphCount; ++i) {
+		randomState = randomState * 1664525u + 1013904223u;
+		glyphs[i].width = 4 + (randomState >> 8) % 44;
+		randomState = randomState * 1664525u + 1013904223u;
+		glyphs[i].height = 4 + (randomState >> 8) % 60;
+	}
+
+	// The skyline must place exactly where the columns say is free
+	packGlyphs<CFW1HeightRange>(glyphs, 512, true);
+
+	printf("sheet    linear glyphs/ms  skyline glyphs/ms  linear occupancy  skyline occupancy\n");
+
+	for(UINT i=0; i < 3; ++i) {
+		PackResult linear = packGlyphs<LinearHeightRange>(glyphs, sheetSizes[i], false);
+		PackResult skyline = packGlyphs<CFW1HeightRange>(glyphs, sheetSizes[i], false);
+
+		CHECK(skyline.occupancy >= linear.occupancy - 0.01);
+
+		printf(
+			"%4u^2   %16.0f  %17.0f  %15.1f%%  %16.1f%%\n",
+			sheetSizes[i],
+			glyphCount / linear.milliseconds,
+			glyphCount / skyline.milliseconds,
+			linear.occupancy * 100.0,
+			skyline.occupancy * 100.0
+		);
+	}
+
+	return TestResult("HeightRangeBenchmark");
+}
@@ -126,7 +126,7 @@ HRESULT CFW1GlyphSheet::initGlyphSheet(
 	
 	m_glyphCoords = new FW1_GLYPHCOORDS[m_maxGlyphCount];
 	
-	m_heightRange = new HeightRange(m_sheetWidth / m_alignWidth);
+	m_heightRange = new CFW1HeightRange(m_sheetWidth / m_alignWidth);
 	
 	// Device texture/coord-buffer
 	hResult = createDeviceResources();
@@ -220,56 +220,4 @@ HRESULT CFW1GlyphSheet::createDeviceResources() {
 }
 
 
-// Height-range helper class, used to fit glyphs in the sheet
-
-CFW1GlyphSheet::HeightRange::HeightRange(UINT totalWidth) : m_totalWidth(totalWidth) {
-	m_heights = new UINT[m_totalWidth];
-	ZeroMemory(m_heights, m_totalWidth * sizeof(UINT));
-}
-
-CFW1GlyphSheet::HeightRange::~HeightRange() {
-	delete[] m_heights;
-}
-
-UINT CFW1GlyphSheet::HeightRange::findMin(UINT width, UINT *outMin) {
-	if(width > m_totalWidth)
-		width = m_totalWidth;
-	
-	UINT currentMax = findMax(0, width);
-	UINT currentMin = currentMax;
-	UINT minX = 0;
-	
-	for(UINT i=1; i < m_totalWidth-width; ++i) {
-		if(m_heights[i+width-1] >= currentMax)
-			currentMax = m_heights[i+width-1];
-		else if(m_heights[i-1] == currentMax) {
-			currentMax = findMax(i, width);
-			if(currentMax < currentMin) {
-				currentMin = currentMax;
-				minX = i;
-			}
-		}
-	}
-	
-	*outMin = currentMin;
-	return minX;
-}
-
-void CFW1GlyphSheet::HeightRange::update(UINT startX, UINT width, UINT newHeight) {
-	if(width > m_totalWidth)
-		width = m_totalWidth;
-	
-	for(UINT i=0; i < width; ++i)
-		m_heights[startX+i] = newHeight;
-}
-
-UINT CFW1GlyphSheet::HeightRange::findMax(UINT startX, UINT width) {
-	UINT currentMax = m_heights[startX];
-	for(UINT i=1; i < width; ++i)
-		currentMax = std::max(currentMax, m_heights[startX+i]);
-	
-	return currentMax;
-}
-
-
 }// namespace FW1FontWrapper
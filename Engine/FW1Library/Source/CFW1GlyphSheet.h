@@ -4,6 +4,7 @@
 #define IncludeGuard__FW1_CFW1GlyphSheet
 
 #include "CFW1Object.h"
+#include "CFW1HeightRange.h"
 
 
 namespace FW1FontWrapper {
@@ -58,25 +59,6 @@ class CFW1GlyphSheet : public CFW1Object<IFW1GlyphSheet> {
 			UINT					bottom;
 		};
 		
-		class HeightRange {
-			public:
-				HeightRange(UINT totalWidth);
-				~HeightRange();
-				
-				UINT findMin(UINT width, UINT *outMin);
-				void update(UINT startX, UINT width, UINT newHeight);
-			
-			private:
-				HeightRange();
-				HeightRange(const HeightRange&);
-				HeightRange& operator=(const HeightRange&);
-				
-				UINT findMax(UINT startX, UINT width);
-				
-				UINT				*m_heights;
-				UINT				m_totalWidth;
-		};
-		
 		class CriticalSectionLock {
 			public:
 				CriticalSectionLock(LPCRITICAL_SECTION pCriticalSection) : m_pCriticalSection(pCriticalSection) {
@@ -126,7 +108,7 @@ class CFW1GlyphSheet : public CFW1Object<IFW1GlyphSheet> {
 		bool						m_closed;
 		bool						m_static;
 		
-		HeightRange					*m_heightRange;
+		CFW1HeightRange				*m_heightRange;
 		
 		UINT						m_updatedGlyphCount;
 		RectUI						m_dirtyRect;
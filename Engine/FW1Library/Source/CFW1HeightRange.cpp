@@ -0,0 +1,132 @@
+// CFW1HeightRange.cpp
+
+#include "CFW1HeightRange.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace FW1FontWrapper {
+
+
+// Construct
+CFW1HeightRange::CFW1HeightRange(UINT totalWidth) : m_totalWidth(totalWidth) {
+	// Every segment is at least one column wide, so there can never be more segments than columns
+	m_segments = new Segment[m_totalWidth];
+	
+	m_segments[0].x = 0;
+	m_segments[0].width = m_totalWidth;
+	m_segments[0].height = 0;
+	m_segmentCount = 1;
+}
+
+CFW1HeightRange::~CFW1HeightRange() {
+	delete[] m_segments;
+}
+
+UINT CFW1HeightRange::findMin(UINT width, UINT *outMin) {
+	if(width > m_totalWidth)
+		width = m_totalWidth;
+	
+	UINT currentMin = 0xffffffff;
+	UINT minX = 0;
+	
+	// Only the start of each segment can be the lowest position, so test those
+	for(UINT i=0; i < m_segmentCount; ++i) {
+		const Segment &segment = m_segments[i];
+		if(segment.x + width > m_totalWidth)
+			break;
+		if(segment.height >= currentMin)
+			continue;
+		
+		UINT endX = segment.x + width;
+		UINT currentMax = segment.height;
+		for(UINT j=i+1; j < m_segmentCount && m_segments[j].x < endX && currentMax < currentMin; ++j)
+			currentMax = std::max(currentMax, m_segments[j].height);
+		
+		if(currentMax < currentMin) {
+			currentMin = currentMax;
+			minX = segment.x;
+		}
+	}
+	
+	*outMin = currentMin;
+	return minX;
+}
+
+void CFW1HeightRange::update(UINT startX, UINT width, UINT newHeight) {
+	if(startX >= m_totalWidth)
+		return;
+	if(width > m_totalWidth - startX)
+		width = m_totalWidth - startX;
+	if(width == 0)
+		return;
+	
+	UINT endX = startX + width;
+	
+	// Find the segments covered by the new one
+	UINT first = 0;
+	while(m_segments[first].x + m_segments[first].width <= startX)
+		++first;
+	UINT last = first;
+	while(last+1 < m_segmentCount && m_segments[last+1].x < endX)
+		++last;
+	
+	// Build the replacement for the covered segments, keeping any uncovered part at either end
+	Segment replacement[3];
+	UINT replacementCount = 0;
+	UINT newIndex = first;
+	
+	if(m_segments[first].x < startX) {
+		replacement[replacementCount] = m_segments[first];
+		replacement[replacementCount].width = startX - m_segments[first].x;
+		++replacementCount;
+		++newIndex;
+	}
+	
+	replacement[replacementCount].x = startX;
+	replacement[replacementCount].width = width;
+	replacement[replacementCount].height = newHeight;
+	++replacementCount;
+	
+	UINT lastEndX = m_segments[last].x + m_segments[last].width;
+	if(lastEndX > endX) {
+		replacement[replacementCount].x = endX;
+		replacement[replacementCount].width = lastEndX - endX;
+		replacement[replacementCount].height = m_segments[last].height;
+		++replacementCount;
+	}
+	
+	UINT coveredCount = last - first + 1;
+	if(replacementCount != coveredCount)
+		memmove(
+			m_segments + first + replacementCount,
+			m_segments + last + 1,
+			(m_segmentCount - last - 1) * sizeof(Segment)
+		);
+	memcpy(m_segments + first, replacement, replacementCount * sizeof(Segment));
+	m_segmentCount = m_segmentCount - coveredCount + replacementCount;
+	
+	// Merge the new segment with neighbours of the same height to keep the skyline short
+	if(newIndex+1 < m_segmentCount && m_segments[newIndex+1].height == newHeight) {
+		m_segments[newIndex].width += m_segments[newIndex+1].width;
+		memmove(
+			m_segments + newIndex + 1,
+			m_segments + newIndex + 2,
+			(m_segmentCount - newIndex - 2) * sizeof(Segment)
+		);
+		--m_segmentCount;
+	}
+	if(newIndex > 0 && m_segments[newIndex-1].height == newHeight) {
+		m_segments[newIndex-1].width += m_segments[newIndex].width;
+		memmove(
+			m_segments + newIndex,
+			m_segments + newIndex + 1,
+			(m_segmentCount - newIndex - 1) * sizeof(Segment)
+		);
+		--m_segmentCount;
+	}
+}
+
+
+}// namespace FW1FontWrapper
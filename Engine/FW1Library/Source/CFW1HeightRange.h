@@ -0,0 +1,44 @@
+// CFW1HeightRange.h
+
+#ifndef IncludeGuard__FW1_CFW1HeightRange
+#define IncludeGuard__FW1_CFW1HeightRange
+
+
+// The same as the Windows typedef, so this builds without any Windows, DirectX or DirectWrite headers
+typedef unsigned int UINT;
+
+
+namespace FW1FontWrapper {
+
+
+// Skyline of the glyphs packed in a sheet, stored as runs of equal height ordered by x.
+// Needs nothing from the rest of the library, so it can be built and timed on its own.
+class CFW1HeightRange {
+	public:
+		CFW1HeightRange(UINT totalWidth);
+		~CFW1HeightRange();
+		
+		UINT findMin(UINT width, UINT *outMin);
+		void update(UINT startX, UINT width, UINT newHeight);
+	
+	private:
+		CFW1HeightRange();
+		CFW1HeightRange(const CFW1HeightRange&);
+		CFW1HeightRange& operator=(const CFW1HeightRange&);
+		
+		struct Segment {
+			UINT				x;
+			UINT				width;
+			UINT				height;
+		};
+		
+		Segment				*m_segments;
+		UINT				m_segmentCount;
+		UINT				m_totalWidth;
+};
+
+
+}// namespace FW1FontWrapper
+
+
+#endif// IncludeGuard__FW1_CFW1HeightRange
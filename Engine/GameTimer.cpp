@@ -0,0 +1,71 @@
+#include "GameTimer.h"
+
+GameTimer::GameTimer()
+{
+	Reset();
+}
+
+void GameTimer::Reset()
+{
+	mStart = std::chrono::steady_clock::now();
+	mLast = mStart;
+}
+
+double GameTimer::Tick()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double>(now - mLast).count();
+
+	mLast = now;
+
+	return elapsed;
+}
+
+double GameTimer::GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+}
+
+FixedTimestep::FixedTimestep(double step, int maxSteps)
+{
+	mStep = step;
+	mAccumulator = 0.0;
+	mMaxSteps = maxSteps;
+	mStepCount = 0;
+}
+
+void FixedTimestep::Advance(double frameTime)
+{
+	mAccumulator += frameTime;
+
+	if (mAccumulator > mStep * mMaxSteps) {
+		mAccumulator = mStep * mMaxSteps;
+	}
+}
+
+bool FixedTimestep::Step()
+{
+	if (mAccumulator < mStep) {
+		return false;
+	}
+
+	mAccumulator -= mStep;
+	mStepCount++;
+
+	return true;
+}
+
+double FixedTimestep::GetStep()
+{
+	return mStep;
+}
+
+float FixedTimestep::GetAlpha()
+{
+	return (float)(mAccumulator / mStep);
+}
+
+unsigned long long FixedTimestep::GetStepCount()
+{
+	return mStepCount;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+
+// High resolution clock for the frame loop. Reads std::chrono::steady_clock
+// rather than timeGetTime, which only has millisecond resolution.
+class GameTimer
+{
+public:
+	GameTimer();
+
+	void Reset();
+
+	// Seconds since the last Tick or Reset
+	double Tick();
+
+	// Seconds since Reset
+	double GetTime();
+
+private:
+	std::chrono::steady_clock::time_point mStart;
+	std::chrono::steady_clock::time_point mLast;
+};
+
+// Accumulator for a fixed simulation step. Frame time goes in through Advance and
+// Step returns true once for every whole step owed. At most maxSteps are owed at
+// once, so a long frame slows the simulation down instead of running it for longer
+// and longer to catch up.
+class FixedTimestep
+{
+public:
+	FixedTimestep(double step, int maxSteps);
+
+	void Advance(double frameTime);
+	bool Step();
+
+	double GetStep();
+
+	// How far the time left over is into the next step, 0 to 1. Rendering
+	// interpolates between the last two steps by this much.
+	float GetAlpha();
+
+	// Steps taken since construction
+	unsigned long long GetStepCount();
+
+private:
+	double mStep;
+	double mAccumulator;
+	int mMaxSteps;
+	unsigned long long mStepCount;
+};
@@ -17,7 +17,7 @@ void HitResult::ResolveCollision(HitResult * pHitResult, BaseObject * a, BaseObj
 
 	// Resolve impulses between the two objects
 	XMFLOAT3 relativeVelocity = MathUtil::SubtractFloat3(*b->pVelocity, *a->pVelocity);
-	float contactVelocity = MathUtil::DotProduct(relativeVelocity, pHitResult->mNormal);
+	float contactVelocity = MathUtil::DotProduct(relativeVelocity, MathUtil::FromFloat3(pHitResult->mNormal));
 
 	//if (contactVelocity < 0) {
 		// Only resolve impulses if the objects are moving towards each other
@@ -30,7 +30,7 @@ void HitResult::ResolveCollision(HitResult * pHitResult, BaseObject * a, BaseObj
 
 		impulseScalar /= massA + massB;
 
-		XMFLOAT3 impulse = MathUtil::MultiplyFloat3(pHitResult->mNormal, impulseScalar);
+		XMFLOAT3 impulse = MathUtil::MultiplyFloat3(MathUtil::FromFloat3(pHitResult->mNormal), impulseScalar);
 
 		float impulseMultiplier = 10.f;
 
@@ -70,17 +70,36 @@ HitResult * HitResult::AABB_AABB(BaseObject * a, BaseObject * b)
 	XMFLOAT3 extA = MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(maxA, minA), 0.5f);
 	XMFLOAT3 extB = MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(maxB, minB), 0.5f);
 
-	if (pPosA->x + extA.x < pPosB->x - extB.x) { return NULL; }
-	if (pPosA->y + extA.y < pPosB->y - extB.y) { return NULL; }
-	if (pPosA->z + extA.z < pPosB->z - extB.z) { return NULL; }
-	if (pPosA->x - extA.x > pPosB->x + extB.x) { return NULL; }
-	if (pPosA->y - extA.y > pPosB->y + extB.y) { return NULL; }
-	if (pPosA->z - extA.x > pPosB->z + extB.z) { return NULL; }
+	return Boxes(MathUtil::ToFloat3(*pPosA), MathUtil::ToFloat3(extA), MathUtil::ToFloat3(*pPosB), MathUtil::ToFloat3(extB));
+}
+
+HitResult * HitResult::AABB_Box(BaseObject * a, const StaticCollider& box)
+{
+	ObjectBoundingBox* pAABB = a->pAABB;
+
+	if (pAABB == NULL) { return NULL; }
+
+	XMFLOAT3 maxA = MathUtil::MultiplyFloat3(*pAABB->pMaxs, *a->pScale);
+	XMFLOAT3 minA = MathUtil::MultiplyFloat3(*pAABB->pMins, *a->pScale);
+
+	XMFLOAT3 extA = MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(maxA, minA), 0.5f);
+
+	return Boxes(MathUtil::ToFloat3(*a->pPosition), MathUtil::ToFloat3(extA), box.center, box.extents);
+}
+
+HitResult * HitResult::Boxes(const SimdMath::Float3& posA, const SimdMath::Float3& extA, const SimdMath::Float3& posB, const SimdMath::Float3& extB)
+{
+	if (posA.x + extA.x < posB.x - extB.x) { return NULL; }
+	if (posA.y + extA.y < posB.y - extB.y) { return NULL; }
+	if (posA.z + extA.z < posB.z - extB.z) { return NULL; }
+	if (posA.x - extA.x > posB.x + extB.x) { return NULL; }
+	if (posA.y - extA.y > posB.y + extB.y) { return NULL; }
+	if (posA.z - extA.z > posB.z + extB.z) { return NULL; }
 
 	HitResult* pHitResult = new HitResult();
 	pHitResult->mHitDepth = 0.f;
-	pHitResult->mHitPos = MathUtil::AddFloat3(*pPosA, extA);
-	pHitResult->mNormal = MathUtil::Normalize(MathUtil::SubtractFloat3(*pPosA, *pPosB));
+	pHitResult->mHitPos = SimdMath::Store3(SimdMath::Add(SimdMath::Load3(posA), SimdMath::Load3(extA)));
+	pHitResult->mNormal = SimdMath::Store3(SimdMath::Normalize3(SimdMath::Subtract(SimdMath::Load3(posA), SimdMath::Load3(posB))));
 
 	return pHitResult;
 }
@@ -1,20 +1,31 @@
 #pragma once
 
-#include "d3dclass.h"
+#include "SimdMath.h"
 
 class BaseObject;
 
+// A box that never moves, centered on a position as HitResult tests boxes
+struct StaticCollider
+{
+	SimdMath::Float3 center;
+	SimdMath::Float3 extents;
+};
+
 class HitResult
 {
 public:
 	HitResult();
 	~HitResult();
 
-	XMFLOAT3 mNormal;
-	XMFLOAT3 mHitPos;
+	SimdMath::Float3 mNormal;
+	SimdMath::Float3 mHitPos;
 	float mHitDepth;
 
 	static void ResolveCollision(HitResult*, BaseObject*, BaseObject*);
 	static HitResult* AABB_AABB(BaseObject*, BaseObject*);
+	static HitResult* AABB_Box(BaseObject*, const StaticCollider&);
+
+private:
+	static HitResult* Boxes(const SimdMath::Float3& posA, const SimdMath::Float3& extA, const SimdMath::Float3& posB, const SimdMath::Float3& extB);
 };
 
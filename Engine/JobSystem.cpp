@@ -0,0 +1,310 @@
+#include "JobSystem.h"
+
+// The system and worker the current thread belongs to, a thread outside the system has no worker
+static thread_local JobSystem* sCurrentSystem = 0;
+static thread_local unsigned int sCurrentWorker = 0;
+
+JobCounter::JobCounter()
+{
+	mValue = 0;
+}
+
+bool JobCounter::IsDone()
+{
+	return mValue.load() == 0;
+}
+
+int JobCounter::GetValue()
+{
+	return mValue.load();
+}
+
+JobSystem::JobSystem()
+{
+	mRunning = false;
+	mQueued = 0;
+	mNextWorker = 0;
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+bool JobSystem::Initialize(unsigned int workerCount)
+{
+	Shutdown();
+
+	if (workerCount == 0) {
+		workerCount = std::thread::hardware_concurrency();
+		if (workerCount == 0) {
+			workerCount = 1;
+		}
+	}
+
+	for (unsigned int i = 0; i < workerCount; i++) {
+		mWorkers.push_back(new Worker());
+	}
+
+	mRunning = true;
+
+	sCurrentSystem = this;
+	sCurrentWorker = 0;
+
+	for (unsigned int i = 1; i < workerCount; i++) {
+		mThreads.push_back(std::thread(&JobSystem::WorkerThread, this, i));
+	}
+
+	return true;
+}
+
+void JobSystem::Shutdown()
+{
+	if (mWorkers.empty()) {
+		return;
+	}
+
+	mRunning = false;
+	{
+		std::lock_guard<std::mutex> lock(mSleepLock);
+	}
+	mWake.notify_all();
+
+	for (unsigned int i = 0; i < mThreads.size(); i++) {
+		mThreads[i].join();
+	}
+	mThreads.clear();
+
+	for (unsigned int i = 0; i < mWorkers.size(); i++) {
+		delete mWorkers[i];
+	}
+	mWorkers.clear();
+
+	mQueued = 0;
+
+	if (sCurrentSystem == this) {
+		sCurrentSystem = 0;
+	}
+}
+
+unsigned int JobSystem::GetWorkerCount()
+{
+	return (unsigned int)mWorkers.size();
+}
+
+void JobSystem::Run(JobFunction function, void* pData, unsigned int begin, unsigned int end, JobCounter* pCounter)
+{
+	Job job = { function, pData, begin, end, pCounter };
+
+	if (pCounter) {
+		pCounter->mValue++;
+	}
+
+	Push(job);
+}
+
+void JobSystem::RunAfter(JobCounter* pDependency, JobFunction function, void* pData, unsigned int begin, unsigned int end, JobCounter* pCounter)
+{
+	Job job = { function, pData, begin, end, pCounter };
+
+	// The job counts against its own counter from now, not from when it is released
+	if (pCounter) {
+		pCounter->mValue++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pDependency->mLock);
+
+		if (pDependency->mValue.load() != 0) {
+			pDependency->mContinuations.push_back(job);
+			return;
+		}
+	}
+
+	Push(job);
+}
+
+void JobSystem::ParallelFor(JobFunction function, void* pData, unsigned int count, unsigned int grain, JobCounter* pCounter)
+{
+	if (count == 0) {
+		return;
+	}
+
+	// Without a grain aim for a few jobs per worker so stealing can even the load out
+	if (grain == 0) {
+		grain = count / (GetWorkerCount() * 4);
+		if (grain == 0) {
+			grain = 1;
+		}
+	}
+
+	for (unsigned int begin = 0; begin < count; begin += grain) {
+		unsigned int end = count - begin > grain ? begin + grain : count;
+		Run(function, pData, begin, end, pCounter);
+	}
+}
+
+void JobSystem::Wait(JobCounter* pCounter)
+{
+	unsigned int worker = GetCurrentWorker();
+
+	while (!pCounter->IsDone()) {
+		if (!RunOne(worker)) {
+			std::this_thread::yield();
+		}
+	}
+
+	// The job that finished the counter may still hold its lock
+	std::lock_guard<std::mutex> lock(pCounter->mLock);
+}
+
+void JobSystem::ParallelForAndWait(JobFunction function, void* pData, unsigned int count, unsigned int grain)
+{
+	JobCounter counter;
+
+	ParallelFor(function, pData, count, grain, &counter);
+	Wait(&counter);
+}
+
+bool JobSystem::RunPending()
+{
+	return RunOne(GetCurrentWorker());
+}
+
+// A worker queues on its own deque, any other thread spreads its jobs over the workers in turn
+
+void JobSystem::Push(const Job& job)
+{
+	unsigned int worker = GetCurrentWorker();
+	if (worker >= mWorkers.size()) {
+		worker = mNextWorker++ % mWorkers.size();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mWorkers[worker]->lock);
+		mWorkers[worker]->jobs.push_back(job);
+	}
+
+	mQueued++;
+
+	// Taking the sleep lock means a worker cannot miss the wake between checking mQueued and sleeping
+	{
+		std::lock_guard<std::mutex> lock(mSleepLock);
+	}
+	mWake.notify_one();
+}
+
+bool JobSystem::Pop(unsigned int worker, Job& job)
+{
+	if (worker >= mWorkers.size()) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mWorkers[worker]->lock);
+
+	if (mWorkers[worker]->jobs.empty()) {
+		return false;
+	}
+
+	// Newest first, it is the most likely to still be in this core's cache
+	job = mWorkers[worker]->jobs.back();
+	mWorkers[worker]->jobs.pop_back();
+	mQueued--;
+
+	return true;
+}
+
+bool JobSystem::Steal(unsigned int worker, Job& job)
+{
+	unsigned int count = (unsigned int)mWorkers.size();
+
+	for (unsigned int i = 1; i <= count; i++) {
+		unsigned int victim = (worker + i) % count;
+		if (victim == worker) { continue; }
+
+		std::lock_guard<std::mutex> lock(mWorkers[victim]->lock);
+
+		if (mWorkers[victim]->jobs.empty()) { continue; }
+
+		// Oldest first, for a split range that is the largest piece left
+		job = mWorkers[victim]->jobs.front();
+		mWorkers[victim]->jobs.pop_front();
+		mQueued--;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool JobSystem::RunOne(unsigned int worker)
+{
+	Job job;
+
+	if (!Pop(worker, job) && !Steal(worker, job)) {
+		return false;
+	}
+
+	Execute(job);
+
+	return true;
+}
+
+void JobSystem::Execute(const Job& job)
+{
+	job.function(job.pData, job.begin, job.end);
+
+	JobCounter* pCounter = job.pCounter;
+	if (!pCounter) {
+		return;
+	}
+
+	// Any job but the last leaves the counter above zero, so nothing can be waiting to free it yet
+	int value = pCounter->mValue.load();
+	while (value > 1) {
+		if (pCounter->mValue.compare_exchange_weak(value, value - 1)) {
+			return;
+		}
+	}
+
+	// The last one takes the lock first, Wait takes it too before returning so the counter
+	// outlives this. Anything queued to run after the counter is released.
+	std::vector<Job> continuations;
+	{
+		std::lock_guard<std::mutex> lock(pCounter->mLock);
+
+		if (pCounter->mValue.fetch_sub(1) != 1) {
+			return;
+		}
+
+		continuations.swap(pCounter->mContinuations);
+	}
+
+	for (unsigned int i = 0; i < continuations.size(); i++) {
+		Push(continuations[i]);
+	}
+}
+
+void JobSystem::WorkerThread(unsigned int worker)
+{
+	sCurrentSystem = this;
+	sCurrentWorker = worker;
+
+	while (mRunning) {
+		if (RunOne(worker)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepLock);
+		mWake.wait(lock, [this]() { return mQueued.load() > 0 || !mRunning; });
+	}
+}
+
+unsigned int JobSystem::GetCurrentWorker()
+{
+	if (sCurrentSystem != this) {
+		return (unsigned int)mWorkers.size();
+	}
+
+	return sCurrentWorker;
+}
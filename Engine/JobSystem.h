@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs over the index range [begin, end) with the data it was queued with
+typedef void (*JobFunction)(void* pData, unsigned int begin, unsigned int end);
+
+struct Job {
+	JobFunction function;
+	void* pData;
+	unsigned int begin;
+	unsigned int end;
+	class JobCounter* pCounter;
+};
+
+// Counts the jobs queued against it that have not finished. Jobs queued with
+// RunAfter are held by the counter and released when it reaches zero, which is
+// how one batch of work is made to depend on another. Wait on a counter before
+// it goes out of scope.
+class JobCounter
+{
+public:
+	JobCounter();
+
+	bool IsDone();
+	int GetValue();
+
+private:
+	friend class JobSystem;
+
+	std::atomic<int> mValue;
+	std::mutex mLock;
+	std::vector<Job> mContinuations;
+};
+
+// Work stealing job scheduler. Each worker has its own deque, takes its newest
+// job from the back and steals the oldest from the front of another worker's
+// deque when its own is empty. The thread that calls Initialize is worker 0 and
+// only runs jobs while it waits on a counter, the others are threads that sleep
+// when there is nothing to do.
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	// workerCount includes the calling thread, 0 uses one worker per hardware thread
+	bool Initialize(unsigned int workerCount = 0);
+	void Shutdown();
+
+	unsigned int GetWorkerCount();
+
+	// Queues one job over [begin, end), pCounter may be null
+	void Run(JobFunction function, void* pData, unsigned int begin, unsigned int end, JobCounter* pCounter);
+
+	// Queues the job once pDependency reaches zero, or now if it already has
+	void RunAfter(JobCounter* pDependency, JobFunction function, void* pData, unsigned int begin, unsigned int end, JobCounter* pCounter);
+
+	// Splits [0, count) into jobs of at most grain indices
+	void ParallelFor(JobFunction function, void* pData, unsigned int count, unsigned int grain, JobCounter* pCounter);
+
+	// Runs queued jobs on this thread until the counter reaches zero
+	void Wait(JobCounter* pCounter);
+
+	// ParallelFor and Wait in one call
+	void ParallelForAndWait(JobFunction function, void* pData, unsigned int count, unsigned int grain);
+
+	// Runs one queued job on this thread, false if there was none
+	bool RunPending();
+
+	// The calling thread's worker, GetWorkerCount for a thread outside the system
+	unsigned int GetCurrentWorker();
+
+private:
+	struct Worker {
+		std::mutex lock;
+		std::deque<Job> jobs;
+	};
+
+	void Push(const Job& job);
+	bool Pop(unsigned int worker, Job& job);
+	bool Steal(unsigned int worker, Job& job);
+	bool RunOne(unsigned int worker);
+	void Execute(const Job& job);
+	void WorkerThread(unsigned int worker);
+
+	std::vector<Worker*> mWorkers;
+	std::vector<std::thread> mThreads;
+
+	std::atomic<bool> mRunning;
+	std::atomic<int> mQueued;
+	std::atomic<unsigned int> mNextWorker;
+	std::mutex mSleepLock;
+	std::condition_variable mWake;
+};
@@ -1,5 +1,25 @@
 #include "MathUtil.h"
-#include <cstdlib>
+#include <cmath>
+
+// The DirectXMath storage types are passed to SimdMath as its own, which share their layout
+static_assert(sizeof(XMFLOAT3) == sizeof(SimdMath::Float3), "XMFLOAT3 and Float3 must match");
+static_assert(sizeof(XMFLOAT4) == sizeof(SimdMath::Float4), "XMFLOAT4 and Float4 must match");
+static_assert(sizeof(XMFLOAT4X4) == sizeof(SimdMath::Float4x4), "XMFLOAT4X4 and Float4x4 must match");
+
+static XMFLOAT3 FromVector3(SimdMath::Vector value)
+{
+	return MathUtil::FromFloat3(SimdMath::Store3(value));
+}
+
+SimdMath::Float3 MathUtil::ToFloat3(XMFLOAT3 value)
+{
+	return SimdMath::Float3(value.x, value.y, value.z);
+}
+
+XMFLOAT3 MathUtil::FromFloat3(SimdMath::Float3 value)
+{
+	return XMFLOAT3(value.x, value.y, value.z);
+}
 
 XMFLOAT3 MathUtil::AddFloat3(XMFLOAT3 a, XMFLOAT3 b)
 {
@@ -50,16 +70,14 @@ XMFLOAT3 MathUtil::InvertFloat3(XMFLOAT3 value)
 
 XMFLOAT3 MathUtil::Cross(XMFLOAT3 a, XMFLOAT3 b)
 {
-	return XMFLOAT3(a.y * b.z - a.z * b.y,
-		a.z * b.x - a.x * b.z,
-		a.x * b.y - a.y * b.x);
+	return FromVector3(SimdMath::Cross3(SimdMath::Load3(ToFloat3(a)), SimdMath::Load3(ToFloat3(b))));
 }
 
+// Divides by the Euclidean length, a zero vector stays zero
+
 XMFLOAT3 MathUtil::Normalize(XMFLOAT3 value)
 {
-	float magnitude = std::abs(value.x) + std::abs(value.y) + std::abs(value.z);
-
-	return XMFLOAT3(value.x / magnitude, value.y / magnitude, value.z / magnitude);
+	return FromVector3(SimdMath::Normalize3(SimdMath::Load3(ToFloat3(value))));
 }
 
 XMMATRIX* MathUtil::DirectionToOrientation(XMFLOAT3 pos, XMFLOAT3 dir)
@@ -87,7 +105,35 @@ XMMATRIX* MathUtil::DirectionToOrientation(XMFLOAT3 pos, XMFLOAT3 dir)
 	return pOrientation;
 }
 
+XMFLOAT4 MathUtil::AngleOrientation(XMFLOAT3 angle)
+{
+	XMFLOAT4 result;
+	SimdMath::Store4(&result.x, SimdMath::QuaternionFromEuler(ToFloat3(angle)));
+	return result;
+}
+
+XMFLOAT4 MathUtil::DirectionOrientation(XMFLOAT3 dir)
+{
+	XMFLOAT4 result;
+	SimdMath::Store4(&result.x, SimdMath::QuaternionFromDirection(ToFloat3(dir)));
+	return result;
+}
+
+XMFLOAT4 MathUtil::OrientationNlerp(XMFLOAT4 a, XMFLOAT4 b, float t)
+{
+	XMFLOAT4 result;
+	SimdMath::Store4(&result.x, SimdMath::QuaternionNlerp(SimdMath::Load4(&a.x), SimdMath::Load4(&b.x), t));
+	return result;
+}
+
+void MathUtil::BuildWorldMatrices(const XMFLOAT3* pPositions, const XMFLOAT4* pOrientations, const XMFLOAT3* pScales, unsigned int count,
+	XMFLOAT4X4* pWorlds, XMFLOAT4X4* pFrames)
+{
+	SimdMath::BuildWorldMatrices(reinterpret_cast<const SimdMath::Float3*>(pPositions), reinterpret_cast<const SimdMath::Float4*>(pOrientations),
+		reinterpret_cast<const SimdMath::Float3*>(pScales), count, reinterpret_cast<SimdMath::Float4x4*>(pWorlds), reinterpret_cast<SimdMath::Float4x4*>(pFrames));
+}
+
 float MathUtil::DotProduct(XMFLOAT3 a, XMFLOAT3 b)
 {
-	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+	return SimdMath::Dot3(SimdMath::Load3(ToFloat3(a)), SimdMath::Load3(ToFloat3(b)));
 }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "d3dclass.h"
+#include "SimdMath.h"
 
+// XMFLOAT wrappers over SimdMath for the game code, which works in DirectXMath types
 class MathUtil
 {
 public:
@@ -16,6 +18,17 @@ public:
 	static XMFLOAT3 Cross(XMFLOAT3, XMFLOAT3);
 	static XMFLOAT3 Normalize(XMFLOAT3);
 	static XMMATRIX* DirectionToOrientation(XMFLOAT3 pos, XMFLOAT3 dir);
+
+	// See the SimdMath functions of the same name
+	static XMFLOAT4 AngleOrientation(XMFLOAT3);
+	static XMFLOAT4 DirectionOrientation(XMFLOAT3);
+	static XMFLOAT4 OrientationNlerp(XMFLOAT4, XMFLOAT4, float);
+	static void BuildWorldMatrices(const XMFLOAT3* pPositions, const XMFLOAT4* pOrientations, const XMFLOAT3* pScales, unsigned int count,
+		XMFLOAT4X4* pWorlds, XMFLOAT4X4* pFrames);
 	static float DotProduct(XMFLOAT3, XMFLOAT3);
+
+	// Between the game code's XMFLOAT3 and the SimdMath Float3 of the portable code, such as the city and static colliders
+	static SimdMath::Float3 ToFloat3(XMFLOAT3);
+	static XMFLOAT3 FromFloat3(SimdMath::Float3);
 };
 
@@ -2,7 +2,6 @@
 #include "MathUtil.h"
 #include "World.h"
 #include "ParticleSystem.h"
-#include "Particle.h"
 
 Missile::Missile(const char * Name, const char * ModelPath, WCHAR * MaterialPath, WCHAR * MaterialPath2) : BaseObject::BaseObject(Name, ModelPath, MaterialPath, MaterialPath2)
 {
@@ -46,21 +45,26 @@ void Missile::OnRender(float DeltaTime)
 		//mOrientationMatrix = lookAtMatrix;
 		// mOrientationMatrix = MathUtil::DirectionToOrientation(*pPosition, direction);
 
-		float radToDeg = 57.2958f;
-
-		//XMFLOAT3 directionAngle = MathUtil::MultiplyFloat3(direction, 360.f);
-		XMFLOAT3 directionAngle = MathUtil::DirectionAngle(direction);
-		SetAngle(0.f, -directionAngle.z, -directionAngle.y);
-
-		float time = timeGetTime();
-		if (time - lastParticle > 100.f) {
-			lastParticle = time;
-			
-			Particle* pParticle = pWorld->pParticleSystem->CreateParticle(L"../Engine/data/missile/missile.dds");
-			pParticle->mPosition = XMFLOAT3(pPosition->x, pPosition->y, pPosition->z);
-			pParticle->mLifetime = 1000.f;
-			pParticle->mScale = 1.f;
-
+		SetOrientation(MathUtil::DirectionOrientation(direction));
+
+		if (mTrailEmitter < 0) {
+			ParticleEmitterDesc trail;
+			trail.rate = 10.f;
+			trail.burst = 0;
+			trail.minLifetime = 0.8f;
+			trail.maxLifetime = 1.2f;
+			trail.startScale = 0.8f;
+			trail.endScale = 1.4f;
+			trail.direction = XMFLOAT3(0, 1, 0);
+			trail.coneAngle = XM_PIDIV4;
+			trail.minSpeed = 0.f;
+			trail.maxSpeed = 2.f;
+			trail.budget = 16;
+
+			pWorld->CreateEmitter(trail, *pPosition, &mTrailEmitter);
+		}
+		else {
+			pWorld->SetEmitterPosition(mTrailEmitter, *pPosition);
 		}
 
 		XMFLOAT3 diff = MathUtil::SubtractFloat3(*pTarget->pPosition, *pPosition);
@@ -68,7 +72,7 @@ void Missile::OnRender(float DeltaTime)
 
 		if (!IsDestroyed() && len < 100) {
 			pTarget->Destroy();
-			pWorld->mScore++;
+			pWorld->AddScore(1);
 			Destroy();
 		}
 
@@ -81,11 +85,20 @@ void Missile::OnRender(float DeltaTime)
 	}
 }
 
+void Missile::OnDestroy()
+{
+	// Let the trail that is already out fade away on its own
+	if (mTrailEmitter >= 0) {
+		pWorld->pParticleSystem->ReleaseEmitter(mTrailEmitter);
+		mTrailEmitter = -1;
+	}
+}
+
 void Missile::OnCollide(BaseObject * pOther, HitResult * pHitResult)
 {
 	if (pOther->GetName() == "Parachute") {
 		pOther->Destroy();
-		pWorld->mScore++;
+		pWorld->AddScore(1);
 		Destroy();
 	}
 }
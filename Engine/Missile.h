@@ -11,10 +11,11 @@ public:
 	virtual void DoClick();
 	virtual void OnRender(float DeltaTime);
 	virtual void OnCollide(BaseObject* pOther, HitResult* pHitResult);
+	virtual void OnDestroy();
 
 	float mMissileSpeed;
 	BaseObject* pTarget;
 
-	float lastParticle = 0.f;
+	int mTrailEmitter = -1;
 };
 
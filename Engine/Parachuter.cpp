@@ -32,10 +32,7 @@ void Parachuter::OnRender(float deltaTime)
 {
 	if (pPosition->y < 10) {
 		Destroy();
-
-		if (pWorld->mHealth > 0) {
-			pWorld->mHealth--;
-		}
+		pWorld->Damage(1);
 	}
 }
 
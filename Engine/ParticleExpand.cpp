@@ -0,0 +1,97 @@
+#include "ParticleExpand.h"
+
+void ComputeDepthKeys(const float* pX, const float* pY, const float* pZ, unsigned int count,
+	float ax, float ay, float az, float d, float* pDepths, unsigned short* pKeys)
+{
+	SimdMath::Vector x, y, z, offset, depth, nearest4, furthest4;
+	unsigned int i, groups;
+	float nearest, furthest, scale;
+
+	if (count == 0) {
+		return;
+	}
+
+	x = SimdMath::Splat(ax);
+	y = SimdMath::Splat(ay);
+	z = SimdMath::Splat(az);
+	offset = SimdMath::Splat(d);
+	nearest4 = SimdMath::Splat(pX[0] * ax + pY[0] * ay + pZ[0] * az + d);
+	furthest4 = nearest4;
+
+	// The range is gathered in the same pass, four lanes each then folded together
+	groups = count & ~3u;
+
+	for (i = 0; i < groups; i += 4) {
+		depth = SimdMath::Add(SimdMath::Multiply(SimdMath::Load4(pX + i), x), offset);
+		depth = SimdMath::Add(depth, SimdMath::Multiply(SimdMath::Load4(pY + i), y));
+		depth = SimdMath::Add(depth, SimdMath::Multiply(SimdMath::Load4(pZ + i), z));
+
+		nearest4 = SimdMath::Min(nearest4, depth);
+		furthest4 = SimdMath::Max(furthest4, depth);
+		SimdMath::Store4(pDepths + i, depth);
+	}
+
+	nearest = SimdMath::GetX(nearest4);
+	nearest = SimdMath::GetY(nearest4) < nearest ? SimdMath::GetY(nearest4) : nearest;
+	nearest = SimdMath::GetZ(nearest4) < nearest ? SimdMath::GetZ(nearest4) : nearest;
+	nearest = SimdMath::GetW(nearest4) < nearest ? SimdMath::GetW(nearest4) : nearest;
+	furthest = SimdMath::GetX(furthest4);
+	furthest = SimdMath::GetY(furthest4) > furthest ? SimdMath::GetY(furthest4) : furthest;
+	furthest = SimdMath::GetZ(furthest4) > furthest ? SimdMath::GetZ(furthest4) : furthest;
+	furthest = SimdMath::GetW(furthest4) > furthest ? SimdMath::GetW(furthest4) : furthest;
+
+	for (i = groups; i < count; i++) {
+		pDepths[i] = pX[i] * ax + pY[i] * ay + pZ[i] * az + d;
+		nearest = pDepths[i] < nearest ? pDepths[i] : nearest;
+		furthest = pDepths[i] > furthest ? pDepths[i] : furthest;
+	}
+
+	scale = furthest > nearest ? 65535.f / (furthest - nearest) : 0.f;
+
+	for (i = 0; i < count; i++) {
+		pKeys[i] = (unsigned short)(65535 - (unsigned int)((pDepths[i] - nearest) * scale));
+	}
+}
+
+void ExpandParticles(ParticleVertex* pVertices, const unsigned int* pOrder, unsigned int count,
+	const float* pX, const float* pY, const float* pZ, const float* pHalfSize)
+{
+	unsigned int i, j, index;
+	float x, y, z, h;
+
+	for (i = 0; i < count; i++) {
+		index = pOrder[i];
+
+		x = pX[index];
+		y = pY[index];
+		z = pZ[index];
+		h = pHalfSize[index];
+
+		// Flat quad facing up
+		pVertices[0].position = SimdMath::Float3(x - h, y, z + h);
+		pVertices[1].position = SimdMath::Float3(x + h, y, z + h);
+		pVertices[2].position = SimdMath::Float3(x - h, y, z - h);
+		pVertices[3].position = SimdMath::Float3(x + h, y, z - h);
+
+		// Upright quad facing down the z axis
+		pVertices[4].position = SimdMath::Float3(x - h, y + h, z);
+		pVertices[5].position = SimdMath::Float3(x + h, y + h, z);
+		pVertices[6].position = SimdMath::Float3(x - h, y - h, z);
+		pVertices[7].position = SimdMath::Float3(x + h, y - h, z);
+
+		// Upright quad facing down the x axis
+		pVertices[8].position = SimdMath::Float3(x, y + h, z - h);
+		pVertices[9].position = SimdMath::Float3(x, y + h, z + h);
+		pVertices[10].position = SimdMath::Float3(x, y - h, z - h);
+		pVertices[11].position = SimdMath::Float3(x, y - h, z + h);
+
+		for (j = 0; j < PARTICLE_VERTICES; j += 4) {
+			pVertices[j].texture = SimdMath::Float2(0.f, 0.f);
+			pVertices[j + 1].texture = SimdMath::Float2(1.f, 0.f);
+			pVertices[j + 2].texture = SimdMath::Float2(0.f, 1.f);
+			pVertices[j + 3].texture = SimdMath::Float2(1.f, 1.f);
+		}
+
+		pVertices += PARTICLE_VERTICES;
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "SimdMath.h"
+
+// Each particle is drawn as three crossed quads
+#define PARTICLE_VERTICES 12
+#define PARTICLE_INDICES 36
+
+struct ParticleVertex
+{
+	SimdMath::Float3 position;
+	SimdMath::Float2 texture;
+};
+
+// The per frame passes over the particles drawn, kept apart from ParticleSystem so they can be
+// timed without a device.
+
+// Writes each particle's depth along a, a.position + d, to pDepths, four at a time, then
+// quantizes them into 16 bit keys across the range found, inverted so the furthest sorts first
+void ComputeDepthKeys(const float* pX, const float* pY, const float* pZ, unsigned int count,
+	float ax, float ay, float az, float d, float* pDepths, unsigned short* pKeys);
+
+// Writes the quads of count particles in the given order, PARTICLE_VERTICES each
+void ExpandParticles(ParticleVertex* pVertices, const unsigned int* pOrder, unsigned int count,
+	const float* pX, const float* pY, const float* pZ, const float* pHalfSize);
@@ -0,0 +1,261 @@
+#include "ParticlePool.h"
+#include <cstring>
+#include <xmmintrin.h>
+
+#define PARTICLE_ARRAY_COUNT 11
+
+ParticlePool::ParticlePool()
+{
+	mCount = 0;
+	mCapacity = 0;
+	pMemory = 0;
+
+	pPositionX = 0;
+	pPositionY = 0;
+	pPositionZ = 0;
+	pVelocityX = 0;
+	pVelocityY = 0;
+	pVelocityZ = 0;
+	pAge = 0;
+	pLifetime = 0;
+	pScale = 0;
+	pEndScale = 0;
+	pOwner = 0;
+}
+
+ParticlePool::~ParticlePool()
+{
+	Shutdown();
+}
+
+bool ParticlePool::Initialize(unsigned int capacity)
+{
+	float* pArray;
+	size_t address;
+
+	if (capacity == 0) {
+		return false;
+	}
+
+	Shutdown();
+
+	// Round up so the update never has to special case a partial group of four
+	mCapacity = (capacity + 3) & ~3u;
+
+	pMemory = new unsigned char[PARTICLE_ARRAY_COUNT * mCapacity * sizeof(float) + 16];
+	if (!pMemory) {
+		return false;
+	}
+
+	// Zero everything so the unused lanes past the last particle hold valid floats
+	memset(pMemory, 0, PARTICLE_ARRAY_COUNT * mCapacity * sizeof(float) + 16);
+
+	address = ((size_t)pMemory + 15) & ~(size_t)15;
+	pArray = (float*)address;
+
+	pPositionX = pArray;
+	pPositionY = pPositionX + mCapacity;
+	pPositionZ = pPositionY + mCapacity;
+	pVelocityX = pPositionZ + mCapacity;
+	pVelocityY = pVelocityX + mCapacity;
+	pVelocityZ = pVelocityY + mCapacity;
+	pAge = pVelocityZ + mCapacity;
+	pLifetime = pAge + mCapacity;
+	pScale = pLifetime + mCapacity;
+	pEndScale = pScale + mCapacity;
+	pOwner = (unsigned int*)(pEndScale + mCapacity);
+
+	mCount = 0;
+
+	return true;
+}
+
+void ParticlePool::Shutdown()
+{
+	if (pMemory) {
+		delete[] pMemory;
+		pMemory = 0;
+	}
+
+	mCount = 0;
+	mCapacity = 0;
+}
+
+bool ParticlePool::Emit(float x, float y, float z, float vx, float vy, float vz, float lifetime, float scale)
+{
+	unsigned int index;
+
+	if (mCount >= mCapacity) {
+		return false;
+	}
+
+	index = mCount++;
+
+	pPositionX[index] = x;
+	pPositionY[index] = y;
+	pPositionZ[index] = z;
+	pVelocityX[index] = vx;
+	pVelocityY[index] = vy;
+	pVelocityZ[index] = vz;
+	pAge[index] = 0.f;
+	pLifetime[index] = lifetime;
+	pScale[index] = scale;
+	pEndScale[index] = scale;
+	pOwner[index] = PARTICLE_NO_OWNER;
+
+	return true;
+}
+
+unsigned int ParticlePool::Allocate(unsigned int count, unsigned int owner, unsigned int& first)
+{
+	unsigned int i;
+
+	if (count > mCapacity - mCount) {
+		count = mCapacity - mCount;
+	}
+
+	first = mCount;
+	mCount += count;
+
+	for (i = first; i < mCount; i++) {
+		pAge[i] = 0.f;
+		pOwner[i] = owner;
+	}
+
+	return count;
+}
+
+void ParticlePool::Update(float deltaTime, unsigned int* pOwnerCounts)
+{
+	__m128 delta, x, y, z, age, expired;
+	unsigned int i, lanes;
+	int expiredMask, anyExpired;
+
+	delta = _mm_set1_ps(deltaTime);
+	anyExpired = 0;
+
+	for (i = 0; i < mCount; i += 4) {
+		x = _mm_load_ps(pPositionX + i);
+		y = _mm_load_ps(pPositionY + i);
+		z = _mm_load_ps(pPositionZ + i);
+
+		x = _mm_add_ps(x, _mm_mul_ps(_mm_load_ps(pVelocityX + i), delta));
+		y = _mm_add_ps(y, _mm_mul_ps(_mm_load_ps(pVelocityY + i), delta));
+		z = _mm_add_ps(z, _mm_mul_ps(_mm_load_ps(pVelocityZ + i), delta));
+
+		_mm_store_ps(pPositionX + i, x);
+		_mm_store_ps(pPositionY + i, y);
+		_mm_store_ps(pPositionZ + i, z);
+
+		age = _mm_add_ps(_mm_load_ps(pAge + i), delta);
+		_mm_store_ps(pAge + i, age);
+
+		expired = _mm_cmpge_ps(age, _mm_load_ps(pLifetime + i));
+		expiredMask = _mm_movemask_ps(expired);
+
+		// Ignore the lanes past the last live particle in the final group
+		lanes = mCount - i;
+		if (lanes < 4) {
+			expiredMask &= (1 << lanes) - 1;
+		}
+
+		anyExpired |= expiredMask;
+	}
+
+	if (!anyExpired) {
+		return;
+	}
+
+	// Walk backwards so the particle swapped into a freed slot has already been checked
+	for (i = mCount; i > 0; i--) {
+		if (pAge[i - 1] >= pLifetime[i - 1]) {
+			Remove(i - 1, pOwnerCounts);
+		}
+	}
+}
+
+void ParticlePool::Clear()
+{
+	mCount = 0;
+}
+
+unsigned int ParticlePool::GetCount()
+{
+	return mCount;
+}
+
+unsigned int ParticlePool::GetCapacity()
+{
+	return mCapacity;
+}
+
+float* ParticlePool::GetPositionX()
+{
+	return pPositionX;
+}
+
+float* ParticlePool::GetPositionY()
+{
+	return pPositionY;
+}
+
+float* ParticlePool::GetPositionZ()
+{
+	return pPositionZ;
+}
+
+float* ParticlePool::GetVelocityX()
+{
+	return pVelocityX;
+}
+
+float* ParticlePool::GetVelocityY()
+{
+	return pVelocityY;
+}
+
+float* ParticlePool::GetVelocityZ()
+{
+	return pVelocityZ;
+}
+
+float* ParticlePool::GetAge()
+{
+	return pAge;
+}
+
+float* ParticlePool::GetLifetime()
+{
+	return pLifetime;
+}
+
+float* ParticlePool::GetScale()
+{
+	return pScale;
+}
+
+float* ParticlePool::GetEndScale()
+{
+	return pEndScale;
+}
+
+void ParticlePool::Remove(unsigned int index, unsigned int* pOwnerCounts)
+{
+	unsigned int last = --mCount;
+
+	if (pOwnerCounts && pOwner[index] != PARTICLE_NO_OWNER) {
+		pOwnerCounts[pOwner[index]]--;
+	}
+
+	pPositionX[index] = pPositionX[last];
+	pPositionY[index] = pPositionY[last];
+	pPositionZ[index] = pPositionZ[last];
+	pVelocityX[index] = pVelocityX[last];
+	pVelocityY[index] = pVelocityY[last];
+	pVelocityZ[index] = pVelocityZ[last];
+	pAge[index] = pAge[last];
+	pLifetime[index] = pLifetime[last];
+	pScale[index] = pScale[last];
+	pEndScale[index] = pEndScale[last];
+	pOwner[index] = pOwner[last];
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Owner value for particles that do not belong to an emitter
+#define PARTICLE_NO_OWNER 0xFFFFFFFF
+
+// Fixed capacity pool of particles stored as one array per attribute so the
+// update can work on four particles at a time with SSE. Live particles are
+// always packed at the front, a dead particle is replaced by the last live one.
+class ParticlePool
+{
+public:
+	ParticlePool();
+	~ParticlePool();
+
+	bool Initialize(unsigned int capacity);
+	void Shutdown();
+
+	// Adds a particle, returns false if the pool is full
+	bool Emit(float x, float y, float z, float vx, float vy, float vz, float lifetime, float scale);
+
+	// Reserves up to count particles at the end of the pool for the caller to fill in.
+	// Age and owner are set here, returns how many were reserved starting at first.
+	unsigned int Allocate(unsigned int count, unsigned int owner, unsigned int& first);
+
+	// Moves every particle by its velocity, ages it and removes the expired ones.
+	// If pOwnerCounts is given the count of each removed particle's owner is decremented.
+	void Update(float deltaTime, unsigned int* pOwnerCounts = 0);
+
+	void Clear();
+
+	unsigned int GetCount();
+	unsigned int GetCapacity();
+
+	float* GetPositionX();
+	float* GetPositionY();
+	float* GetPositionZ();
+	float* GetVelocityX();
+	float* GetVelocityY();
+	float* GetVelocityZ();
+	float* GetAge();
+	float* GetLifetime();
+	float* GetScale();
+	float* GetEndScale();
+
+private:
+	void Remove(unsigned int index, unsigned int* pOwnerCounts);
+
+	unsigned int mCount;
+	unsigned int mCapacity;
+
+	// Single block holding all of the arrays below, each starts on a 16 byte boundary
+	unsigned char* pMemory;
+
+	float* pPositionX;
+	float* pPositionY;
+	float* pPositionZ;
+	float* pVelocityX;
+	float* pVelocityY;
+	float* pVelocityZ;
+	float* pAge;
+	float* pLifetime;
+	float* pScale;
+	float* pEndScale;
+	unsigned int* pOwner;
+};
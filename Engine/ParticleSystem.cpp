@@ -1,73 +1,391 @@
 #include "ParticleSystem.h"
-#include "Particle.h"
 #include "graphicsclass.h"
-#include "bumpmodelclass.h"
+#include "textureclass.h"
+#include <chrono>
+#include <vector>
+
+// Half the width of the plane model the particles used to be drawn with
+#define PARTICLE_HALF_SIZE 5.9819f
+
+ParticleSnapshot::ParticleSnapshot()
+{
+	count = 0;
+}
 
 ParticleSystem::ParticleSystem()
 {
+	pD3D = 0;
+	pBackend = 0;
+	pTexture = 0;
+
+	mVertexBuffer = 0;
+	mIndexBuffer = 0;
+
+	mBudget = 0;
+	mRandomState = 1;
+
+	mUpdateTime = 0.f;
+	mSortTime = 0.f;
+	mExpandTime = 0.f;
 }
 
 
 ParticleSystem::~ParticleSystem()
 {
-	delete pModelClass;
+	if (pBackend) {
+		pBackend->DestroyBuffer(mVertexBuffer);
+		pBackend->DestroyBuffer(mIndexBuffer);
+	}
+
+	if (pTexture) {
+		pTexture->Shutdown();
+		delete pTexture;
+	}
+
+	mPool.Shutdown();
 }
 
 int ParticleSystem::GetNumParticles()
 {
-	return mParticles.size();
+	return mPool.GetCount();
+}
+
+bool ParticleSystem::Emit(XMFLOAT3 position, XMFLOAT3 velocity, float lifetime, float scale)
+{
+	return mPool.Emit(position.x, position.y, position.z, velocity.x, velocity.y, velocity.z, lifetime, scale);
+}
+
+void ParticleSystem::Initialize(unsigned int capacity)
+{
+	BufferDesc desc;
+	unsigned int i, j, base;
+
+	mPool.Initialize(capacity);
+	capacity = mPool.GetCapacity();
+	mBudget = capacity;
+
+	mSort.Reserve(capacity);
+	mDepths.resize(capacity);
+	mDepthKeys.resize(capacity);
+
+	pTexture = new TextureClass();
+	pTexture->Initialize(pD3D->GetDevice(), L"../Engine/data/missile/smoke.dds");
+
+	// The vertices are rewritten every frame, so the vertex buffer is dynamic and sized for a full pool
+	desc.type = BUFFER_VERTEX;
+	desc.byteWidth = capacity * PARTICLE_VERTICES * sizeof(ParticleVertex);
+	desc.dynamic = true;
+	desc.initialData = 0;
+	mVertexBuffer = pBackend->CreateBuffer(desc);
+
+	// Every particle uses the same index pattern, each quad is wound both ways so it shows from either side
+	std::vector<unsigned long> indices(capacity * PARTICLE_INDICES);
+	const unsigned long quadIndices[12] = { 0, 1, 3, 0, 3, 2, 0, 3, 1, 0, 2, 3 };
+
+	for (i = 0; i < capacity * 3; i++) {
+		base = i * 4;
+
+		for (j = 0; j < 12; j++) {
+			indices[i * 12 + j] = base + quadIndices[j];
+		}
+	}
+
+	desc.type = BUFFER_INDEX;
+	desc.byteWidth = capacity * PARTICLE_INDICES * sizeof(unsigned long);
+	desc.dynamic = false;
+	desc.initialData = &indices[0];
+	mIndexBuffer = pBackend->CreateBuffer(desc);
+}
+
+int ParticleSystem::CreateEmitter(const ParticleEmitterDesc& desc, XMFLOAT3 position)
+{
+	ParticleEmitter emitter;
+	unsigned int i;
+
+	emitter.desc = desc;
+	emitter.position = position;
+	emitter.lastPosition = position;
+	emitter.accumulator = 0.f;
+	emitter.pending = desc.burst;
+	emitter.wanted = 0;
+	emitter.active = true;
+	emitter.released = false;
+
+	// Reuse a slot whose particles have all died
+	for (i = 0; i < mEmitters.size(); i++) {
+		if (!mEmitters[i].active) {
+			mEmitters[i] = emitter;
+			mEmitterCounts[i] = 0;
+			return i;
+		}
+	}
+
+	mEmitters.push_back(emitter);
+	mEmitterCounts.push_back(0);
+
+	return mEmitters.size() - 1;
+}
+
+void ParticleSystem::SetEmitterPosition(int emitter, XMFLOAT3 position)
+{
+	if (emitter >= 0 && emitter < (int)mEmitters.size()) {
+		mEmitters[emitter].position = position;
+	}
+}
+
+void ParticleSystem::ReleaseEmitter(int emitter)
+{
+	if (emitter >= 0 && emitter < (int)mEmitters.size()) {
+		mEmitters[emitter].released = true;
+	}
+}
+
+int ParticleSystem::GetNumEmitters()
+{
+	int count = 0;
+
+	for (unsigned int i = 0; i < mEmitters.size(); i++) {
+		if (mEmitters[i].active && !mEmitters[i].released) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+void ParticleSystem::SetBudget(unsigned int budget)
+{
+	mBudget = min(budget, mPool.GetCapacity());
+}
+
+// Moves, ages and spawns particles, called once per simulation step
+
+void ParticleSystem::Update(float deltaTime)
+{
+	std::chrono::high_resolution_clock::time_point start, updated;
+
+	start = std::chrono::high_resolution_clock::now();
+
+	mPool.Update(deltaTime, mEmitterCounts.empty() ? 0 : &mEmitterCounts[0]);
+	UpdateEmitters(deltaTime);
+
+	updated = std::chrono::high_resolution_clock::now();
+
+	mUpdateTime = std::chrono::duration<float, std::milli>(updated - start).count();
+}
+
+// Copies each live particle's position and its size at its current age
+
+void ParticleSystem::Snapshot(ParticleSnapshot& snapshot)
+{
+	const float* pScale = mPool.GetScale();
+	const float* pEndScale = mPool.GetEndScale();
+	const float* pAge = mPool.GetAge();
+	const float* pLifetime = mPool.GetLifetime();
+	unsigned int count = mPool.GetCount();
+	unsigned int i;
+	float life;
+
+	snapshot.count = count;
+	snapshot.x.assign(mPool.GetPositionX(), mPool.GetPositionX() + count);
+	snapshot.y.assign(mPool.GetPositionY(), mPool.GetPositionY() + count);
+	snapshot.z.assign(mPool.GetPositionZ(), mPool.GetPositionZ() + count);
+	snapshot.halfSize.resize(count);
+
+	for (i = 0; i < count; i++) {
+		life = pLifetime[i] > 0.f ? min(pAge[i] / pLifetime[i], 1.f) : 1.f;
+		snapshot.halfSize[i] = PARTICLE_HALF_SIZE * (pScale[i] + (pEndScale[i] - pScale[i]) * life);
+	}
 }
 
-Particle * ParticleSystem::CreateParticle(WCHAR * materialPath)
+void ParticleSystem::RenderParticles(GraphicsClass* pGraphicsClass, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix,
+	const ParticleSnapshot& particles)
 {
-	Particle* pParticle = new Particle();
-	pParticle->pParticleSystem = this;
-	pParticle->pMaterial = materialPath;
-	pParticle->Initialize();
+	std::chrono::high_resolution_clock::time_point updated, sorted, expanded;
+	const unsigned int* pOrder;
+	ParticleVertex* pVertices;
+	unsigned int count;
+
+	updated = std::chrono::high_resolution_clock::now();
+
+	// Alpha blending needs the furthest particles drawn first
+	pOrder = SortParticles(viewMatrix, particles);
+
+	sorted = std::chrono::high_resolution_clock::now();
+
+	// The vertex buffer only has room for a full pool
+	count = min(particles.count, mPool.GetCapacity());
+
+	if (count > 0 && mVertexBuffer && mIndexBuffer) {
+		pVertices = (ParticleVertex*)pBackend->Map(mVertexBuffer, MAP_WRITE_DISCARD);
+
+		if (pVertices) {
+			ExpandParticles(pVertices, pOrder, count, &particles.x[0], &particles.y[0], &particles.z[0], &particles.halfSize[0]);
+			pBackend->Unmap(mVertexBuffer, count * PARTICLE_VERTICES * sizeof(ParticleVertex));
 
-	mParticles.push_back(pParticle);
+			// The vertices are already in world space, so every particle goes out in a single draw
+			pGraphicsClass->m_ShaderManager->SetRenderFlags(RENDER_FLAG_ALPHA_BLEND);
+			pGraphicsClass->m_ShaderManager->RenderTextureShader(pD3D->GetDeviceContext(), mVertexBuffer, mIndexBuffer, sizeof(ParticleVertex),
+				count * PARTICLE_INDICES, XMMatrixIdentity(), viewMatrix, projectionMatrix, pTexture->GetTexture());
+			pGraphicsClass->m_ShaderManager->SetRenderFlags(0);
+		}
+	}
+
+	expanded = std::chrono::high_resolution_clock::now();
+
+	mSortTime = std::chrono::duration<float, std::milli>(sorted - updated).count();
+	mExpandTime = std::chrono::duration<float, std::milli>(expanded - sorted).count();
+}
 
-	return pParticle;
+float ParticleSystem::GetUpdateTime()
+{
+	return mUpdateTime;
 }
 
-void ParticleSystem::Initialize()
+float ParticleSystem::GetSortTime()
 {
-	pModelClass = new BumpModelClass();
-	HRESULT result = pModelClass->Initialize(pD3D->GetDevice(), "../Engine/data/plane.obj", L"../Engine/data/missile/smoke.dds", L"../Engine/data/missile/smoke.dds");
+	return mSortTime;
 }
 
-void ParticleSystem::RenderParticles(float deltaTime, GraphicsClass* pGraphicsClass, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+float ParticleSystem::GetExpandTime()
 {
-	pD3D->TurnOnAlphaBlending();
+	return mExpandTime;
+}
+
+void ParticleSystem::UpdateEmitters(float deltaTime)
+{
+	unsigned int i, wanted, total, available, count;
+	float desired, share;
+
+	// Work out how many particles each emitter wants this frame, capped by its own budget
+	total = 0;
+
+	for (i = 0; i < mEmitters.size(); i++) {
+		ParticleEmitter& emitter = mEmitters[i];
+
+		if (!emitter.active) {
+			continue;
+		}
+
+		if (emitter.released) {
+			emitter.wanted = 0;
+
+			if (mEmitterCounts[i] == 0) {
+				emitter.active = false;
+			}
+			continue;
+		}
 
-	// Iterate in reverse order so we can delete particles during loop
-	for (int i = mParticles.size() - 1; i >= 0; i--) {
-		Particle* pParticle = mParticles.at(i);
+		desired = emitter.accumulator + emitter.desc.rate * deltaTime;
+		wanted = (unsigned int)desired + emitter.pending;
 
-		if (pParticle->mDestroyed) {
-			// remove destroyed particles
-			mParticles.erase(mParticles.begin() + i);
+		// Keep the fraction so low rates still spawn on average
+		emitter.accumulator = desired - (float)(unsigned int)desired;
+		emitter.pending = 0;
 
-			delete pParticle;
+		if (mEmitterCounts[i] + wanted > emitter.desc.budget) {
+			wanted = emitter.desc.budget > mEmitterCounts[i] ? emitter.desc.budget - mEmitterCounts[i] : 0;
 		}
-		else {
-			XMMATRIX particleMatrix = pParticle->GetWorldMatrix(worldMatrix, XMFLOAT3(0,0,0));
-			
-			pModelClass->Render(pD3D->GetDeviceContext());
-			pGraphicsClass->m_ShaderManager->RenderTextureShader(pD3D->GetDeviceContext(), pModelClass->GetIndexCount(), particleMatrix, viewMatrix, projectionMatrix,
-				pModelClass->GetColorTexture());
-
-			particleMatrix = pParticle->GetWorldMatrix(worldMatrix, XMFLOAT3(90, 0, 0));
-			pGraphicsClass->m_ShaderManager->RenderTextureShader(pD3D->GetDeviceContext(), pModelClass->GetIndexCount(), particleMatrix, viewMatrix, projectionMatrix,
-				pModelClass->GetColorTexture());
-
-			particleMatrix = pParticle->GetWorldMatrix(worldMatrix, XMFLOAT3(0, 90, 0));
-			pGraphicsClass->m_ShaderManager->RenderTextureShader(pD3D->GetDeviceContext(), pModelClass->GetIndexCount(), particleMatrix, viewMatrix, projectionMatrix,
-				pModelClass->GetColorTexture());
-
-			pParticle->OnRender(deltaTime);
+
+		emitter.wanted = wanted;
+		total += wanted;
+	}
+
+	// If the emitters together want more than the global budget allows, every emitter
+	// gives up the same fraction of its spawns rather than the last ones getting nothing
+	available = mBudget > mPool.GetCount() ? mBudget - mPool.GetCount() : 0;
+	share = total > available ? (float)available / (float)total : 1.f;
+
+	for (i = 0; i < mEmitters.size(); i++) {
+		ParticleEmitter& emitter = mEmitters[i];
+
+		if (emitter.active && emitter.wanted > 0) {
+			count = (unsigned int)(emitter.wanted * share);
+
+			if (count > 0) {
+				SpawnParticles(emitter, i, count);
+			}
 		}
+
+		emitter.lastPosition = emitter.position;
+	}
+}
+
+void ParticleSystem::SpawnParticles(ParticleEmitter& emitter, unsigned int index, unsigned int count)
+{
+	const ParticleEmitterDesc& desc = emitter.desc;
+	XMVECTOR axis, tangent, bitangent, direction;
+	XMFLOAT3 velocity;
+	unsigned int first, i;
+	float t, cosAngle, cosTheta, sinTheta, phi, speed;
+
+	count = mPool.Allocate(count, index, first);
+	mEmitterCounts[index] += count;
+
+	float* pX = mPool.GetPositionX();
+	float* pY = mPool.GetPositionY();
+	float* pZ = mPool.GetPositionZ();
+	float* pVX = mPool.GetVelocityX();
+	float* pVY = mPool.GetVelocityY();
+	float* pVZ = mPool.GetVelocityZ();
+	float* pLifetime = mPool.GetLifetime();
+	float* pScale = mPool.GetScale();
+	float* pEndScale = mPool.GetEndScale();
+
+	// Build the cone basis once per emitter, not once per particle
+	axis = XMVector3Normalize(XMLoadFloat3(&desc.direction));
+	tangent = XMVector3Orthogonal(axis);
+	tangent = XMVector3Normalize(tangent);
+	bitangent = XMVector3Cross(axis, tangent);
+	cosAngle = cosf(desc.coneAngle);
+
+	for (i = 0; i < count; i++) {
+		// Spread the spawns along the path travelled since last frame so fast emitters leave an even trail
+		t = (float)(i + 1) / (float)count;
+		pX[first + i] = emitter.lastPosition.x + (emitter.position.x - emitter.lastPosition.x) * t;
+		pY[first + i] = emitter.lastPosition.y + (emitter.position.y - emitter.lastPosition.y) * t;
+		pZ[first + i] = emitter.lastPosition.z + (emitter.position.z - emitter.lastPosition.z) * t;
+
+		// Pick a direction uniformly over the cone's cap
+		cosTheta = 1.f - Random() * (1.f - cosAngle);
+		sinTheta = sqrtf(max(0.f, 1.f - cosTheta * cosTheta));
+		phi = Random() * XM_2PI;
+		speed = desc.minSpeed + (desc.maxSpeed - desc.minSpeed) * Random();
+
+		direction = axis * cosTheta + (tangent * cosf(phi) + bitangent * sinf(phi)) * sinTheta;
+		XMStoreFloat3(&velocity, direction * speed);
+
+		pVX[first + i] = velocity.x;
+		pVY[first + i] = velocity.y;
+		pVZ[first + i] = velocity.z;
+
+		pLifetime[first + i] = desc.minLifetime + (desc.maxLifetime - desc.minLifetime) * Random();
+		pScale[first + i] = desc.startScale;
+		pEndScale[first + i] = desc.endScale;
 	}
+}
+
+float ParticleSystem::Random()
+{
+	// Cheap linear congruential generator, good enough for spreading particles
+	mRandomState = mRandomState * 1664525u + 1013904223u;
+
+	return (mRandomState >> 8) * (1.f / 16777216.f);
+}
+
+const unsigned int* ParticleSystem::SortParticles(XMMATRIX viewMatrix, const ParticleSnapshot& particles)
+{
+	XMFLOAT4X4 view;
+	unsigned int count = min(particles.count, mPool.GetCapacity());
+
+	if (count == 0) {
+		return 0;
+	}
+
+	// The view space depth is the dot product with the third column of the view matrix
+	XMStoreFloat4x4(&view, viewMatrix);
+	ComputeDepthKeys(&particles.x[0], &particles.y[0], &particles.z[0], count, view._13, view._23, view._33, view._43,
+		&mDepths[0], &mDepthKeys[0]);
 
-	pD3D->TurnOffAlphaBlending();
+	return mSort.Sort(&mDepthKeys[0], count);
 }
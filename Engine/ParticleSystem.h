@@ -1,11 +1,47 @@
 #pragma once
 
 #include "d3dclass.h"
+#include "renderbackendclass.h"
+#include "ParticleExpand.h"
+#include "ParticlePool.h"
+#include "RadixSort.h"
+#include <atomic>
 #include <vector>
 
-class Particle;
 class GraphicsClass;
-class BumpModelClass;
+class TextureClass;
+
+// Particles the pool holds unless told otherwise, see World::ParticleCapacity
+#define PARTICLE_DEFAULT_CAPACITY 8192
+
+// Describes how an emitter spawns particles, shared by every emitter of that effect
+struct ParticleEmitterDesc
+{
+	float rate;                 // Particles per second while the emitter is active
+	unsigned int burst;         // Particles spawned at once when the emitter is created
+	float minLifetime;          // Seconds
+	float maxLifetime;
+	float startScale;           // Scale is interpolated from start to end over each particle's life
+	float endScale;
+	XMFLOAT3 direction;         // Axis of the velocity cone
+	float coneAngle;            // Half angle of the cone in radians
+	float minSpeed;
+	float maxSpeed;
+	unsigned int budget;        // Most live particles the emitter may own at once
+};
+
+// What drawing needs from the live particles, copied out by the simulation so the
+// render thread can sort and expand them while the pool carries on updating
+struct ParticleSnapshot
+{
+	ParticleSnapshot();
+
+	unsigned int count;
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> halfSize;
+};
 
 class ParticleSystem
 {
@@ -14,14 +50,69 @@ public:
 	~ParticleSystem();
 
 	int GetNumParticles();
-	Particle* CreateParticle(WCHAR* materialPath);
-	void Initialize();
+	bool Emit(XMFLOAT3 position, XMFLOAT3 velocity, float lifetime, float scale);
+	void Initialize(unsigned int capacity = PARTICLE_DEFAULT_CAPACITY);
+
+	// Emitters are referred to by index. A released emitter stops spawning and its
+	// slot is reused once the last of its particles has died.
+	int CreateEmitter(const ParticleEmitterDesc& desc, XMFLOAT3 position);
+	void SetEmitterPosition(int emitter, XMFLOAT3 position);
+	void ReleaseEmitter(int emitter);
+	int GetNumEmitters();
+
+	// Total particles all emitters may keep alive, spawning is scaled down evenly to stay under it
+	void SetBudget(unsigned int budget);
 
 	D3DClass* pD3D;
-	BumpModelClass* pModelClass;
+	RenderBackendClass* pBackend;
 
-	void RenderParticles(float deltaTime, GraphicsClass* pGraphicsClass, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+	void Update(float deltaTime);
+	void Snapshot(ParticleSnapshot& snapshot);
+	void RenderParticles(GraphicsClass* pGraphicsClass, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix,
+		const ParticleSnapshot& particles);
+
+	// Milliseconds spent last frame updating the pool and emitters, sorting and filling the vertex buffer
+	float GetUpdateTime();
+	float GetSortTime();
+	float GetExpandTime();
 private:
-	std::vector<Particle*> mParticles;
-};
+	struct ParticleEmitter
+	{
+		ParticleEmitterDesc desc;
+		XMFLOAT3 position;
+		XMFLOAT3 lastPosition;
+		float accumulator;
+		unsigned int pending;
+		unsigned int wanted;
+		bool active;
+		bool released;
+	};
+
+	void UpdateEmitters(float deltaTime);
+	void SpawnParticles(ParticleEmitter& emitter, unsigned int index, unsigned int count);
+	float Random();
+
+	const unsigned int* SortParticles(XMMATRIX viewMatrix, const ParticleSnapshot& particles);
+
+	ParticlePool mPool;
+	RadixSort mSort;
 
+	std::vector<ParticleEmitter> mEmitters;
+	// Live particles owned by each emitter, kept apart so the pool can update it directly
+	std::vector<unsigned int> mEmitterCounts;
+	unsigned int mBudget;
+	unsigned int mRandomState;
+
+	// Per frame scratch, sized for a full pool at initialization
+	std::vector<float> mDepths;
+	std::vector<unsigned short> mDepthKeys;
+	TextureClass* pTexture;
+
+	BufferHandle mVertexBuffer;
+	BufferHandle mIndexBuffer;
+
+	// Update is timed on the simulation thread, sort and expand on the render thread
+	float mUpdateTime;
+	std::atomic<float> mSortTime;
+	std::atomic<float> mExpandTime;
+};
@@ -0,0 +1,78 @@
+#include "RadixSort.h"
+#include <cstring>
+
+RadixSort::RadixSort()
+{
+}
+
+RadixSort::~RadixSort()
+{
+}
+
+void RadixSort::Reserve(unsigned int capacity)
+{
+	if (mIndices.size() < capacity) {
+		mIndices.resize(capacity);
+		mScratch.resize(capacity);
+	}
+}
+
+const unsigned int* RadixSort::Sort(const unsigned short* keys, unsigned int count)
+{
+	unsigned int low[256], high[256];
+	unsigned int i, sum, next;
+	bool sameHigh;
+	unsigned int* pIn;
+	unsigned int* pOut;
+
+	if (count == 0) {
+		return 0;
+	}
+
+	Reserve(count);
+
+	// Count both digits in one pass over the keys
+	memset(low, 0, sizeof(low));
+	memset(high, 0, sizeof(high));
+
+	for (i = 0; i < count; i++) {
+		low[keys[i] & 0xFF]++;
+		high[keys[i] >> 8]++;
+	}
+
+	// When every key shares the high byte the second pass would not change anything
+	sameHigh = high[keys[0] >> 8] == count;
+
+	// Turn the counts into starting offsets
+	sum = 0;
+	for (i = 0; i < 256; i++) {
+		next = sum + low[i];
+		low[i] = sum;
+		sum = next;
+	}
+
+	sum = 0;
+	for (i = 0; i < 256; i++) {
+		next = sum + high[i];
+		high[i] = sum;
+		sum = next;
+	}
+
+	pIn = &mIndices[0];
+	pOut = &mScratch[0];
+
+	// The first pass scatters straight from the key order, so no index array needs filling
+	for (i = 0; i < count; i++) {
+		pOut[low[keys[i] & 0xFF]++] = i;
+	}
+
+	if (sameHigh) {
+		return pOut;
+	}
+
+	for (i = 0; i < count; i++) {
+		pIn[high[keys[pOut[i]] >> 8]++] = pOut[i];
+	}
+
+	return pIn;
+}
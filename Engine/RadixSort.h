@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+// Least significant digit radix sort over 16 bit keys, eight bits per pass.
+// Produces the order of the keys rather than moving any data, the scratch
+// arrays are kept between calls so sorting a frame does not allocate.
+class RadixSort
+{
+public:
+	RadixSort();
+	~RadixSort();
+
+	void Reserve(unsigned int capacity);
+
+	// Sorts ascending and returns count indices into keys, stable for equal keys
+	const unsigned int* Sort(const unsigned short* keys, unsigned int count);
+
+private:
+	std::vector<unsigned int> mIndices;
+	std::vector<unsigned int> mScratch;
+};
@@ -0,0 +1,48 @@
+#include "RenderSnapshot.h"
+
+RenderSnapshot::RenderSnapshot()
+{
+	previousCameraPosition = XMFLOAT3(0.f, 0.f, 0.f);
+	cameraPosition = XMFLOAT3(0.f, 0.f, 0.f);
+	cameraFree = true;
+
+	hasLightingOrigin = false;
+	lightingOrigin = XMFLOAT3(0.f, 0.f, 0.f);
+	lightingAngle = XMFLOAT3(0.f, -1.f, 0.f);
+
+	score = 0;
+	health = 0;
+	textCount = 0;
+
+	step = 0.0;
+}
+
+SnapshotMailbox::SnapshotMailbox()
+{
+	mBack = 0;
+	mReady = 1;
+	mFront = 2;
+	mHasFront = false;
+}
+
+RenderSnapshot* SnapshotMailbox::GetBack()
+{
+	return &mSnapshots[mBack];
+}
+
+// The filled back snapshot becomes the ready one and the old ready one, taken or not, is written next
+void SnapshotMailbox::Publish()
+{
+	mBack = mReady.exchange(mBack | FRESH) & ~FRESH;
+}
+
+// Only swaps when something new was published, otherwise the reader keeps drawing the one it has
+RenderSnapshot* SnapshotMailbox::Acquire()
+{
+	if (mReady.load() & FRESH) {
+		mFront = mReady.exchange(mFront) & ~FRESH;
+		mHasFront = true;
+	}
+
+	return mHasFront ? &mSnapshots[mFront] : 0;
+}
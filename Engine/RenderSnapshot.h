@@ -0,0 +1,103 @@
+#pragma once
+
+#include "BaseObject.h"
+#include "CityGenerator.h"
+#include "ParticleSystem.h"
+#include "textclass.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// One drawn object as the simulation left it. Objects without a parent carry the
+// transforms of the last two steps for the renderer to blend, the rest carry their
+// world matrix from the last step.
+struct RenderItem
+{
+	int objectID;
+	BumpModelClass* pModel;
+	RenderShader shader;
+
+	bool interpolate;
+	XMFLOAT3 previousPosition;
+	XMFLOAT3 position;
+	XMFLOAT4 previousOrientation;
+	XMFLOAT4 orientation;
+	XMFLOAT3 previousScale;
+	XMFLOAT3 scale;
+	XMFLOAT4X4 world;
+
+	// Picking, the result goes back to the simulation by ID
+	bool pickable;
+	bool hoverable;
+	float collisionRadius;
+
+	// Debug boxes, the AABB is drawn unrotated
+	bool drawOBB;
+	XMFLOAT3 obbMins;
+	XMFLOAT3 obbMaxs;
+	bool drawAABB;
+	XMFLOAT3 aabbMins;
+	XMFLOAT3 aabbMaxs;
+	XMFLOAT4X4 aabbWorld;
+};
+
+// Everything the renderer needs from one simulation step. The renderer only ever
+// reads a published snapshot, so it never touches the world the simulation is
+// stepping.
+struct RenderSnapshot
+{
+	RenderSnapshot();
+
+	std::vector<RenderItem> items;
+
+	// The city's placed models, which never move, drawn after the items
+	std::vector<CityInstance> instances;
+	std::vector<CityModel> instanceModels;
+
+	XMFLOAT3 previousCameraPosition;
+	XMFLOAT3 cameraPosition;
+	bool cameraFree;
+
+	bool hasLightingOrigin;
+	XMFLOAT3 lightingOrigin;
+	XMFLOAT3 lightingAngle;
+
+	ParticleSnapshot particles;
+
+	int score;
+	int health;
+	char text[TEXT_SENTENCE_COUNT - 1][TEXT_SENTENCE_LENGTH];
+	int textCount;
+
+	// When it was published and the length of a step, the renderer blends from the
+	// previous state to the current one over the step after publishing
+	std::chrono::steady_clock::time_point publishTime;
+	double step;
+};
+
+// Triple buffered hand over from the simulation thread to the render thread. The
+// writer fills the back snapshot and publishes it, the reader takes the newest
+// published one. Neither waits for the other and each always has a snapshot to
+// itself, a snapshot the reader did not get to in time is overwritten.
+class SnapshotMailbox
+{
+public:
+	SnapshotMailbox();
+
+	// Writer side
+	RenderSnapshot* GetBack();
+	void Publish();
+
+	// Reader side, the newest published snapshot or null before the first
+	RenderSnapshot* Acquire();
+
+private:
+	// mReady holds an index and this bit while the reader has not taken it
+	static const int FRESH = 4;
+
+	RenderSnapshot mSnapshots[3];
+	int mBack;
+	int mFront;
+	bool mHasFront;
+	std::atomic<int> mReady;
+};
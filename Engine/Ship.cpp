@@ -4,6 +4,9 @@
 #include "World.h"
 #include "graphicsclass.h"
 #include "ParticleSystem.h"
+#include "TextFormatter.h"
+#include "CityStreamer.h"
+#include "CityTraffic.h"
 
 Ship::Ship(const char* Name, const char* ModelPath, WCHAR* MaterialPath, WCHAR* MaterialPath2) : BaseObject::BaseObject(Name, ModelPath, MaterialPath, MaterialPath2)
 {
@@ -58,21 +61,34 @@ void Ship::OnRender(float deltaTime)
 		XMFLOAT3 cameraPos = MathUtil::AddFloat3(pos, MathUtil::MultiplyFloat3(MathUtil::InvertFloat3(cameraBackDirection), cameraBackDistance));
 		cameraPos = MathUtil::AddFloat3(cameraPos, XMFLOAT3(0.f, cameraUpDistance, 0.f));
 		lastCameraPosition = MathUtil::AddFloat3(lastCameraPosition, MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(cameraPos, lastCameraPosition), 0.1f));
-		pWorld->pCameraPosition = new XMFLOAT3(lastCameraPosition.x, lastCameraPosition.y, lastCameraPosition.z);
-		pWorld->mCameraMovementEnabled = false;
+		pWorld->SetCameraPosition(lastCameraPosition);
 
 		lastShipDirection = MathUtil::AddFloat3(lastShipDirection, MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(cameraDirection, lastShipDirection), 0.1f));
 		MathUtil::DivideFloat3(lastShipDirection, 180.f);
-		XMFLOAT3 newAngle = MathUtil::DirectionAngle(lastShipDirection);
-		SetAngle(0.f, -newAngle.z, -newAngle.y);
-
-		std::string text = "\n\nCam Dir: " + std::to_string(cameraDirection.x) + " | " + std::to_string(cameraDirection.y) + " | " + std::to_string(cameraDirection.z)
-			+ "\nCam Ang: " + std::to_string(camAng.x) + " | " + std::to_string(camAng.y) + " | " + std::to_string(camAng.z)
-			+ "\nDirection: " + std::to_string(direction.x) + "|" + std::to_string(direction.y) + "|" + std::to_string(direction.z)
-			+ "\Pos: " + std::to_string(pPosition->x) + "|" + std::to_string(pPosition->y) + "|" + std::to_string(pPosition->z)
-			+ "\nSpeed: " + std::to_string(mSpeed)
-			+ "\n Particles: " + std::to_string(pWorld->pParticleSystem->GetNumParticles());
-		pWorld->pGraphicsClass->RenderText(text);
+		SetOrientation(MathUtil::DirectionOrientation(lastShipDirection));
+
+		TextFormatter text;
+		text.Append("\n\nCam Dir: ").Append(cameraDirection.x, 6).Append(" | ").Append(cameraDirection.y, 6).Append(" | ").Append(cameraDirection.z, 6)
+			.Append("\nCam Ang: ").Append(camAng.x, 6).Append(" | ").Append(camAng.y, 6).Append(" | ").Append(camAng.z, 6)
+			.Append("\nDirection: ").Append(direction.x, 6).Append("|").Append(direction.y, 6).Append("|").Append(direction.z, 6)
+			.Append("\nPos: ").Append(pPosition->x, 6).Append("|").Append(pPosition->y, 6).Append("|").Append(pPosition->z, 6)
+			.Append("\nSpeed: ").Append(mSpeed, 6)
+			.Append("\n Particles: ").Append(pWorld->pParticleSystem->GetNumParticles())
+			.Append(" (update ").Append(pWorld->pParticleSystem->GetUpdateTime(), 6).Append("ms, sort ").Append(pWorld->pParticleSystem->GetSortTime(), 6)
+			.Append("ms, expand ").Append(pWorld->pParticleSystem->GetExpandTime(), 6).Append("ms)")
+			.Append("\n Step: ").Append(pWorld->GetStepGraph()->GetElapsedTime(), 6).Append("ms (critical path ")
+			.Append(pWorld->GetStepGraph()->GetCriticalPathTime(), 6).Append("ms, work ").Append(pWorld->GetStepGraph()->GetWorkTime(), 6).Append("ms)");
+
+		CityStreamer* pStreamer = pWorld->pCityGenerator->GetStreamer();
+		if (pStreamer != NULL) {
+			text.Append("\n City blocks: ").Append(pStreamer->GetActiveCount()).Append(" active, ")
+				.Append(pStreamer->GetCachedCount()).Append(" cached, ").Append(pStreamer->GetGeneratingCount()).Append(" generating");
+		}
+
+		CityTraffic* pTraffic = pWorld->pCityGenerator->GetTraffic();
+		text.Append("\n Traffic: ").Append(pTraffic->GetVehicleCount()).Append(" cars, ").Append(pTraffic->GetWaitingCount()).Append(" stopped");
+
+		pWorld->RenderText(text.GetText());
 	}
 }
 
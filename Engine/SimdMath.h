@@ -0,0 +1,523 @@
+#pragma once
+
+// Header only vector, matrix and quaternion maths for the engine core. Nothing here needs Windows or
+// DirectXMath, so code built on it compiles with GCC and Clang as well as MSVC.
+// Int2, Float2, Float3, Float4 and Float4x4 have the same layout as XMINT2, XMFLOAT2, XMFLOAT3, XMFLOAT4 and XMFLOAT4X4, and matrices
+// work on row vectors like DirectXMath, so results can be passed straight to the renderer.
+// Vector is an SSE register when the compiler targets SSE and four floats otherwise. Defining
+// SIMDMATH_SCALAR forces the scalar backend. The batch functions use AVX where it helps and is enabled.
+
+#include <cmath>
+
+#if !defined(SIMDMATH_SCALAR) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define SIMDMATH_SSE
+#include <xmmintrin.h>
+#endif
+
+#if defined(SIMDMATH_SSE) && defined(__AVX__)
+#define SIMDMATH_AVX
+#include <immintrin.h>
+#endif
+
+namespace SimdMath {
+
+struct Int2 {
+	int x, y;
+
+	Int2() {}
+	Int2(int x, int y) : x(x), y(y) {}
+};
+
+struct Float2 {
+	float x, y;
+
+	Float2() {}
+	Float2(float x, float y) : x(x), y(y) {}
+};
+
+struct Float3 {
+	float x, y, z;
+
+	Float3() {}
+	Float3(float x, float y, float z) : x(x), y(y), z(z) {}
+};
+
+struct Float4 {
+	float x, y, z, w;
+
+	Float4() {}
+	Float4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+};
+
+struct Float4x4 {
+	float m[4][4];
+};
+
+#ifdef SIMDMATH_SSE
+typedef __m128 Vector;
+#else
+struct Vector {
+	float v[4];
+};
+#endif
+
+// Four row vectors
+struct Matrix {
+	Vector r[4];
+};
+
+// Vectors
+
+#ifdef SIMDMATH_SSE
+
+inline Vector Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline Vector Splat(float value) { return _mm_set1_ps(value); }
+inline Vector Zero() { return _mm_setzero_ps(); }
+
+inline float GetX(Vector v) { return _mm_cvtss_f32(v); }
+inline float GetY(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+inline float GetZ(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))); }
+inline float GetW(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+inline Vector SplatX(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+inline Vector SplatY(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+inline Vector SplatZ(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+inline Vector SplatW(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+inline Vector Load4(const float* p) { return _mm_loadu_ps(p); }
+inline void Store4(float* p, Vector v) { _mm_storeu_ps(p, v); }
+
+inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+inline Vector Subtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+inline Vector Multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+inline Vector Divide(Vector a, Vector b) { return _mm_div_ps(a, b); }
+inline Vector Min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+inline Vector Max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+inline Vector Abs(Vector v) { return _mm_andnot_ps(_mm_set1_ps(-0.f), v); }
+inline Vector Sqrt(Vector v) { return _mm_sqrt_ps(v); }
+
+// Lanes where mask is set take a, the rest take b. Masks come from the comparisons below.
+inline Vector Select(Vector mask, Vector a, Vector b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline Vector Greater(Vector a, Vector b) { return _mm_cmpgt_ps(a, b); }
+
+// Rows a, b, c and d become columns
+inline void Transpose(Vector& a, Vector& b, Vector& c, Vector& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+
+#else
+
+inline Vector Set(float x, float y, float z, float w) { Vector r = { { x, y, z, w } }; return r; }
+inline Vector Splat(float value) { return Set(value, value, value, value); }
+inline Vector Zero() { return Splat(0.f); }
+
+inline float GetX(Vector v) { return v.v[0]; }
+inline float GetY(Vector v) { return v.v[1]; }
+inline float GetZ(Vector v) { return v.v[2]; }
+inline float GetW(Vector v) { return v.v[3]; }
+
+inline Vector SplatX(Vector v) { return Splat(v.v[0]); }
+inline Vector SplatY(Vector v) { return Splat(v.v[1]); }
+inline Vector SplatZ(Vector v) { return Splat(v.v[2]); }
+inline Vector SplatW(Vector v) { return Splat(v.v[3]); }
+
+inline Vector Load4(const float* p) { return Set(p[0], p[1], p[2], p[3]); }
+inline void Store4(float* p, Vector v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+
+inline Vector Add(Vector a, Vector b) { return Set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+inline Vector Subtract(Vector a, Vector b) { return Set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+inline Vector Multiply(Vector a, Vector b) { return Set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+inline Vector Divide(Vector a, Vector b) { return Set(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]); }
+inline Vector Min(Vector a, Vector b) { Vector r; for (int i = 0; i < 4; i++) { r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; } return r; }
+inline Vector Max(Vector a, Vector b) { Vector r; for (int i = 0; i < 4; i++) { r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; } return r; }
+inline Vector Abs(Vector v) { return Set(std::fabs(v.v[0]), std::fabs(v.v[1]), std::fabs(v.v[2]), std::fabs(v.v[3])); }
+inline Vector Sqrt(Vector v) { return Set(std::sqrt(v.v[0]), std::sqrt(v.v[1]), std::sqrt(v.v[2]), std::sqrt(v.v[3])); }
+
+// A set lane has every bit set like the SSE comparisons, only the sign is looked at here
+inline Vector Select(Vector mask, Vector a, Vector b) { Vector r; for (int i = 0; i < 4; i++) { r.v[i] = std::signbit(mask.v[i]) ? a.v[i] : b.v[i]; } return r; }
+inline Vector Greater(Vector a, Vector b) { Vector r; for (int i = 0; i < 4; i++) { r.v[i] = a.v[i] > b.v[i] ? -1.f : 0.f; } return r; }
+
+inline void Transpose(Vector& a, Vector& b, Vector& c, Vector& d)
+{
+	Vector rows[4] = { a, b, c, d };
+	a = Set(rows[0].v[0], rows[1].v[0], rows[2].v[0], rows[3].v[0]);
+	b = Set(rows[0].v[1], rows[1].v[1], rows[2].v[1], rows[3].v[1]);
+	c = Set(rows[0].v[2], rows[1].v[2], rows[2].v[2], rows[3].v[2]);
+	d = Set(rows[0].v[3], rows[1].v[3], rows[2].v[3], rows[3].v[3]);
+}
+
+#endif
+
+inline Vector Load3(const Float3& f) { return Set(f.x, f.y, f.z, 0.f); }
+inline Vector Load4(const Float4& f) { return Load4(&f.x); }
+
+inline Float3 Store3(Vector v)
+{
+	float result[4];
+	Store4(result, v);
+	return Float3(result[0], result[1], result[2]);
+}
+
+inline Float4 Store4(Vector v)
+{
+	Float4 result;
+	Store4(&result.x, v);
+	return result;
+}
+
+inline Vector Scale(Vector v, float s) { return Multiply(v, Splat(s)); }
+inline Vector Negate(Vector v) { return Subtract(Zero(), v); }
+inline Vector Lerp(Vector a, Vector b, float t) { return Add(a, Scale(Subtract(b, a), t)); }
+
+inline float Dot3(Vector a, Vector b)
+{
+	Vector product = Multiply(a, b);
+	return GetX(product) + GetY(product) + GetZ(product);
+}
+
+inline float Dot4(Vector a, Vector b)
+{
+	Vector product = Multiply(a, b);
+	return GetX(product) + GetY(product) + GetZ(product) + GetW(product);
+}
+
+inline Vector Cross3(Vector a, Vector b)
+{
+	float ax = GetX(a), ay = GetY(a), az = GetZ(a);
+	float bx = GetX(b), by = GetY(b), bz = GetZ(b);
+
+	return Set(ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx, 0.f);
+}
+
+inline float Length3(Vector v) { return std::sqrt(Dot3(v, v)); }
+
+// Euclidean length, a zero vector stays zero
+inline Vector Normalize3(Vector v)
+{
+	float length = Length3(v);
+	return length > 0.f ? Scale(v, 1.f / length) : Zero();
+}
+
+// Matrices
+
+inline Matrix Identity()
+{
+	Matrix m;
+	m.r[0] = Set(1.f, 0.f, 0.f, 0.f);
+	m.r[1] = Set(0.f, 1.f, 0.f, 0.f);
+	m.r[2] = Set(0.f, 0.f, 1.f, 0.f);
+	m.r[3] = Set(0.f, 0.f, 0.f, 1.f);
+	return m;
+}
+
+inline Matrix Translation(float x, float y, float z)
+{
+	Matrix m = Identity();
+	m.r[3] = Set(x, y, z, 1.f);
+	return m;
+}
+
+inline Matrix Scaling(float x, float y, float z)
+{
+	Matrix m;
+	m.r[0] = Set(x, 0.f, 0.f, 0.f);
+	m.r[1] = Set(0.f, y, 0.f, 0.f);
+	m.r[2] = Set(0.f, 0.f, z, 0.f);
+	m.r[3] = Set(0.f, 0.f, 0.f, 1.f);
+	return m;
+}
+
+inline Matrix LoadMatrix(const Float4x4& f)
+{
+	Matrix m;
+	for (int i = 0; i < 4; i++) {
+		m.r[i] = Load4(f.m[i]);
+	}
+	return m;
+}
+
+inline Float4x4 StoreMatrix(const Matrix& m)
+{
+	Float4x4 f;
+	for (int i = 0; i < 4; i++) {
+		Store4(f.m[i], m.r[i]);
+	}
+	return f;
+}
+
+// Row vector times matrix, the w of v is used as is
+inline Vector Transform4(Vector v, const Matrix& m)
+{
+	Vector result = Multiply(SplatX(v), m.r[0]);
+	result = Add(result, Multiply(SplatY(v), m.r[1]));
+	result = Add(result, Multiply(SplatZ(v), m.r[2]));
+	return Add(result, Multiply(SplatW(v), m.r[3]));
+}
+
+// a then b
+inline Matrix Multiply(const Matrix& a, const Matrix& b)
+{
+	Matrix m;
+	for (int i = 0; i < 4; i++) {
+		m.r[i] = Transform4(a.r[i], b);
+	}
+	return m;
+}
+
+inline Matrix Transpose(const Matrix& m)
+{
+	Matrix t = m;
+	Transpose(t.r[0], t.r[1], t.r[2], t.r[3]);
+	return t;
+}
+
+// Point with w = 1, no divide, for affine matrices
+inline Vector TransformPoint(Vector v, const Matrix& m)
+{
+	Vector result = Multiply(SplatX(v), m.r[0]);
+	result = Add(result, Multiply(SplatY(v), m.r[1]));
+	result = Add(result, Multiply(SplatZ(v), m.r[2]));
+	return Add(result, m.r[3]);
+}
+
+// Direction with w = 0
+inline Vector TransformNormal(Vector v, const Matrix& m)
+{
+	Vector result = Multiply(SplatX(v), m.r[0]);
+	result = Add(result, Multiply(SplatY(v), m.r[1]));
+	return Add(result, Multiply(SplatZ(v), m.r[2]));
+}
+
+// Quaternions, stored x, y, z, w in a Vector
+
+inline Vector QuaternionIdentity() { return Set(0.f, 0.f, 0.f, 1.f); }
+
+// a then b, the same order as XMQuaternionMultiply
+inline Vector QuaternionMultiply(Vector a, Vector b)
+{
+	float ax = GetX(a), ay = GetY(a), az = GetZ(a), aw = GetW(a);
+	float bx = GetX(b), by = GetY(b), bz = GetZ(b), bw = GetW(b);
+
+	return Set(bw * ax + bx * aw + by * az - bz * ay,
+		bw * ay - bx * az + by * aw + bz * ax,
+		bw * az + bx * ay - by * ax + bz * aw,
+		bw * aw - bx * ax - by * ay - bz * az);
+}
+
+inline Vector QuaternionNormalize(Vector q)
+{
+	float length = std::sqrt(Dot4(q, q));
+	return length > 0.f ? Scale(q, 1.f / length) : QuaternionIdentity();
+}
+
+// Normalized lerp along the shorter arc, close enough to a slerp for the small steps it is used on
+inline Vector QuaternionNlerp(Vector a, Vector b, float t)
+{
+	if (Dot4(a, b) < 0.f) {
+		b = Negate(b);
+	}
+
+	return QuaternionNormalize(Lerp(a, b, t));
+}
+
+// Angle in radians, rotating about Z, then Y, then X
+inline Vector QuaternionFromEuler(const Float3& angle)
+{
+	float sx = std::sin(angle.x * 0.5f), cx = std::cos(angle.x * 0.5f);
+	float sy = std::sin(angle.y * 0.5f), cy = std::cos(angle.y * 0.5f);
+	float sz = std::sin(angle.z * 0.5f), cz = std::cos(angle.z * 0.5f);
+
+	return Set(cx * sy * sz + sx * cy * cz,
+		cx * sy * cz - sx * cy * sz,
+		cx * cy * sz + sx * sy * cz,
+		cx * cy * cz - sx * sy * sz);
+}
+
+// The rotation the game has always used to face a direction, a yaw of -atan2(x, y) then a roll of
+// -atan2(z, length of xy). The half angle sines and cosines come straight from the direction.
+inline Vector QuaternionFromDirection(const Float3& dir)
+{
+	float flat = std::sqrt((dir.x * dir.x) + (dir.y * dir.y));
+	float length = std::sqrt((flat * flat) + (dir.z * dir.z));
+
+	if (length == 0.f) {
+		return QuaternionIdentity();
+	}
+
+	float cosYaw = flat > 0.f ? dir.y / flat : 1.f;
+	float cosPitch = flat / length;
+
+	float sinHalfYaw = std::sqrt(std::fmax(0.f, (1.f - cosYaw) * 0.5f));
+	float cosHalfYaw = std::sqrt(std::fmax(0.f, (1.f + cosYaw) * 0.5f));
+	float sinHalfPitch = std::sqrt(std::fmax(0.f, (1.f - cosPitch) * 0.5f));
+	float cosHalfPitch = std::sqrt(std::fmax(0.f, (1.f + cosPitch) * 0.5f));
+
+	// Both angles are negated, so the half angle sines take the opposite sign to the direction
+	if (dir.x >= 0.f) { sinHalfYaw = -sinHalfYaw; }
+	if (dir.z >= 0.f) { sinHalfPitch = -sinHalfPitch; }
+
+	return Set(sinHalfYaw * sinHalfPitch, sinHalfYaw * cosHalfPitch, cosHalfYaw * sinHalfPitch, cosHalfYaw * cosHalfPitch);
+}
+
+inline Matrix RotationQuaternion(Vector q)
+{
+	float x = GetX(q), y = GetY(q), z = GetZ(q), w = GetW(q);
+	float x2 = x + x, y2 = y + y, z2 = z + z;
+	float xx = x * x2, yy = y * y2, zz = z * z2;
+	float xy = x * y2, xz = x * z2, yz = y * z2;
+	float wx = w * x2, wy = w * y2, wz = w * z2;
+
+	Matrix m;
+	m.r[0] = Set(1.f - (yy + zz), xy + wz, xz - wy, 0.f);
+	m.r[1] = Set(xy - wz, 1.f - (xx + zz), yz + wx, 0.f);
+	m.r[2] = Set(xz + wy, yz - wx, 1.f - (xx + yy), 0.f);
+	m.r[3] = Set(0.f, 0.f, 0.f, 1.f);
+	return m;
+}
+
+// Batches
+
+inline void NormalizeArray(const Float3* pIn, unsigned int count, Float3* pOut)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		pOut[i] = Store3(Normalize3(Load3(pIn[i])));
+	}
+}
+
+inline void TransformPoints(const Float3* pIn, unsigned int count, const Matrix& m, Float3* pOut)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		pOut[i] = Store3(TransformPoint(Load3(pIn[i]), m));
+	}
+}
+
+// Transforms points held as one array per axis in place, eight at a time with AVX, four with SSE
+inline void TransformPointsSoA(float* pX, float* pY, float* pZ, unsigned int count, const Float4x4& m)
+{
+	unsigned int i = 0;
+
+#ifdef SIMDMATH_AVX
+	for (; i + 8 <= count; i += 8) {
+		__m256 x = _mm256_loadu_ps(pX + i), y = _mm256_loadu_ps(pY + i), z = _mm256_loadu_ps(pZ + i);
+		__m256 outX = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(m.m[0][0])), _mm256_mul_ps(y, _mm256_set1_ps(m.m[1][0]))),
+			_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(m.m[2][0])), _mm256_set1_ps(m.m[3][0])));
+		__m256 outY = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(m.m[0][1])), _mm256_mul_ps(y, _mm256_set1_ps(m.m[1][1]))),
+			_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(m.m[2][1])), _mm256_set1_ps(m.m[3][1])));
+		__m256 outZ = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(m.m[0][2])), _mm256_mul_ps(y, _mm256_set1_ps(m.m[1][2]))),
+			_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(m.m[2][2])), _mm256_set1_ps(m.m[3][2])));
+		_mm256_storeu_ps(pX + i, outX);
+		_mm256_storeu_ps(pY + i, outY);
+		_mm256_storeu_ps(pZ + i, outZ);
+	}
+#endif
+
+	for (; i + 4 <= count; i += 4) {
+		Vector x = Load4(pX + i), y = Load4(pY + i), z = Load4(pZ + i);
+		Vector outX = Add(Add(Multiply(x, Splat(m.m[0][0])), Multiply(y, Splat(m.m[1][0]))), Add(Multiply(z, Splat(m.m[2][0])), Splat(m.m[3][0])));
+		Vector outY = Add(Add(Multiply(x, Splat(m.m[0][1])), Multiply(y, Splat(m.m[1][1]))), Add(Multiply(z, Splat(m.m[2][1])), Splat(m.m[3][1])));
+		Vector outZ = Add(Add(Multiply(x, Splat(m.m[0][2])), Multiply(y, Splat(m.m[1][2]))), Add(Multiply(z, Splat(m.m[2][2])), Splat(m.m[3][2])));
+		Store4(pX + i, outX);
+		Store4(pY + i, outY);
+		Store4(pZ + i, outZ);
+	}
+
+	for (; i < count; i++) {
+		float x = pX[i], y = pY[i], z = pZ[i];
+		pX[i] = x * m.m[0][0] + y * m.m[1][0] + z * m.m[2][0] + m.m[3][0];
+		pY[i] = x * m.m[0][1] + y * m.m[1][1] + z * m.m[2][1] + m.m[3][1];
+		pZ[i] = x * m.m[0][2] + y * m.m[1][2] + z * m.m[2][2] + m.m[3][2];
+	}
+}
+
+// Builds scale * rotation * translation for every object, four objects at a time with one object per
+// lane. pFrames gets the same matrices without the scale and can be null.
+inline void BuildWorldMatrices(const Float3* pPositions, const Float4* pOrientations, const Float3* pScales, unsigned int count,
+	Float4x4* pWorlds, Float4x4* pFrames)
+{
+	const Vector one = Splat(1.f);
+
+	for (unsigned int i = 0; i < count; i += 4) {
+		unsigned int n = count - i < 4 ? count - i : 4;
+
+		// The last block is padded with identity so it takes the same path as the others
+		Float4 orientation[4] = { Float4(0, 0, 0, 1), Float4(0, 0, 0, 1), Float4(0, 0, 0, 1), Float4(0, 0, 0, 1) };
+		Float3 scale[4] = { Float3(1, 1, 1), Float3(1, 1, 1), Float3(1, 1, 1), Float3(1, 1, 1) };
+		for (unsigned int j = 0; j < n; j++) {
+			orientation[j] = pOrientations[i + j];
+			scale[j] = pScales[i + j];
+		}
+
+		Vector x = Load4(orientation[0]), y = Load4(orientation[1]), z = Load4(orientation[2]), w = Load4(orientation[3]);
+		Transpose(x, y, z, w);
+
+		Vector x2 = Add(x, x), y2 = Add(y, y), z2 = Add(z, z);
+		Vector xx = Multiply(x, x2), yy = Multiply(y, y2), zz = Multiply(z, z2);
+		Vector xy = Multiply(x, y2), xz = Multiply(x, z2), yz = Multiply(y, z2);
+		Vector wx = Multiply(w, x2), wy = Multiply(w, y2), wz = Multiply(w, z2);
+
+		Vector rows[3][3];
+		rows[0][0] = Subtract(one, Add(yy, zz));
+		rows[0][1] = Add(xy, wz);
+		rows[0][2] = Subtract(xz, wy);
+		rows[1][0] = Subtract(xy, wz);
+		rows[1][1] = Subtract(one, Add(xx, zz));
+		rows[1][2] = Add(yz, wx);
+		rows[2][0] = Add(xz, wy);
+		rows[2][1] = Subtract(yz, wx);
+		rows[2][2] = Subtract(one, Add(xx, yy));
+
+		Vector scales[3];
+		scales[0] = Set(scale[0].x, scale[1].x, scale[2].x, scale[3].x);
+		scales[1] = Set(scale[0].y, scale[1].y, scale[2].y, scale[3].y);
+		scales[2] = Set(scale[0].z, scale[1].z, scale[2].z, scale[3].z);
+
+		for (int r = 0; r < 3; r++) {
+			// Turn one row of four objects back into four object rows
+			Vector frame[4] = { rows[r][0], rows[r][1], rows[r][2], Zero() };
+			Vector world[4] = { Multiply(frame[0], scales[r]), Multiply(frame[1], scales[r]), Multiply(frame[2], scales[r]), Zero() };
+			Transpose(frame[0], frame[1], frame[2], frame[3]);
+			Transpose(world[0], world[1], world[2], world[3]);
+
+			for (unsigned int j = 0; j < n; j++) {
+				Store4(pWorlds[i + j].m[r], world[j]);
+				if (pFrames) {
+					Store4(pFrames[i + j].m[r], frame[j]);
+				}
+			}
+		}
+
+		for (unsigned int j = 0; j < n; j++) {
+			const Float3& position = pPositions[i + j];
+			Store4(pWorlds[i + j].m[3], Set(position.x, position.y, position.z, 1.f));
+			if (pFrames) {
+				Store4(pFrames[i + j].m[3], Set(position.x, position.y, position.z, 1.f));
+			}
+		}
+	}
+}
+
+// Axis aligned bounds of each box after its matrix is applied, using Arvo's method: the new center
+// is the transformed center and each new half extent is the old half extents weighted by the
+// absolute matrix terms, so no corners are transformed. The output may alias the input.
+inline void TransformBounds(const Float3* pMins, const Float3* pMaxs, const Float4x4* pMatrices, unsigned int count,
+	Float3* pOutMins, Float3* pOutMaxs)
+{
+	const Vector half = Splat(0.5f);
+
+	for (unsigned int i = 0; i < count; i++) {
+		Vector mins = Load3(pMins[i]);
+		Vector maxs = Load3(pMaxs[i]);
+		Matrix m = LoadMatrix(pMatrices[i]);
+
+		Vector center = Multiply(Add(mins, maxs), half);
+		Vector extent = Multiply(Subtract(maxs, mins), half);
+
+		Vector worldCenter = TransformPoint(center, m);
+		Vector worldExtent = Multiply(SplatX(extent), Abs(m.r[0]));
+		worldExtent = Add(worldExtent, Multiply(SplatY(extent), Abs(m.r[1])));
+		worldExtent = Add(worldExtent, Multiply(SplatZ(extent), Abs(m.r[2])));
+
+		pOutMins[i] = Store3(Subtract(worldCenter, worldExtent));
+		pOutMaxs[i] = Store3(Add(worldCenter, worldExtent));
+	}
+}
+
+}
@@ -0,0 +1,105 @@
+#include "SimulationThread.h"
+#include "World.h"
+#include <windows.h>
+#include <mmsystem.h>
+
+SimulationThread::SimulationThread(double step, int maxSteps) : mTimestep(step, maxSteps)
+{
+	pWorld = 0;
+	mRunning = false;
+}
+
+SimulationThread::~SimulationThread()
+{
+	Stop();
+}
+
+void SimulationThread::Start(World* pWorld, const SimulationInput& input)
+{
+	this->pWorld = pWorld;
+	mInput = input;
+
+	// The thread sleeps between steps, the default timer resolution would oversleep a whole step
+	timeBeginPeriod(1);
+
+	mTimer.Reset();
+	mRunning = true;
+	mThread = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop()
+{
+	if (!mRunning) {
+		return;
+	}
+
+	mRunning = false;
+	mThread.join();
+
+	timeEndPeriod(1);
+}
+
+void SimulationThread::SetInput(const SimulationInput& input)
+{
+	std::lock_guard<std::mutex> lock(mInputLock);
+	mInput = input;
+}
+
+void SimulationThread::Pick(const PickEvent& pick)
+{
+	std::lock_guard<std::mutex> lock(mInputLock);
+	mPicks.push_back(pick);
+}
+
+RenderSnapshot* SimulationThread::AcquireSnapshot()
+{
+	return mMailbox.Acquire();
+}
+
+double SimulationThread::GetStep()
+{
+	return mTimestep.GetStep();
+}
+
+void SimulationThread::Run()
+{
+	while (mRunning) {
+		mTimestep.Advance(mTimer.Tick());
+
+		SimulationInput input;
+		{
+			std::lock_guard<std::mutex> lock(mInputLock);
+			input = mInput;
+			mPendingPicks.swap(mPicks);
+		}
+
+		*pWorld->pCameraAngle = input.cameraAngle;
+		if (input.freeCamera && pWorld->mCameraMovementEnabled) {
+			*pWorld->pCameraPosition = input.cameraPosition;
+		}
+
+		// Picks were made against the last snapshot, so they go in before the next step
+		for (int i = 0; i < mPendingPicks.size(); i++) {
+			pWorld->Pick(mPendingPicks[i].objectID, mPendingPicks[i].clicked, mPendingPicks[i].hovered);
+		}
+		mPendingPicks.clear();
+
+		bool stepped = false;
+		while (mTimestep.Step()) {
+			pWorld->Step((float)mTimestep.GetStep(), input.inputFrame);
+			stepped = true;
+		}
+
+		if (!stepped) {
+			std::this_thread::sleep_for(std::chrono::duration<double>((1.0 - mTimestep.GetAlpha()) * mTimestep.GetStep()));
+			continue;
+		}
+
+		RenderSnapshot* pSnapshot = mMailbox.GetBack();
+		pWorld->WriteSnapshot(*pSnapshot);
+		pSnapshot->step = mTimestep.GetStep();
+		pSnapshot->publishTime = std::chrono::steady_clock::now();
+
+		mMailbox.Publish();
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "GameTimer.h"
+#include "RenderSnapshot.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class World;
+
+// What the render thread samples each frame for the simulation to use on its next step
+struct SimulationInput
+{
+	InputFrame inputFrame;
+	XMFLOAT3 cameraAngle;
+
+	// Where the free camera is, while the render thread is moving it
+	bool freeCamera;
+	XMFLOAT3 cameraPosition;
+};
+
+// A click or hover the render thread found on a snapshot item
+struct PickEvent
+{
+	int objectID;
+	bool clicked;
+	bool hovered;
+};
+
+// Runs the world's fixed steps on a thread of its own, a frame ahead of the
+// renderer. After the steps owed are done it writes a snapshot and publishes
+// it, so a slow step holds up the next snapshot rather than the frame being
+// drawn. Between Start and Stop the world belongs to this thread, the render
+// thread only sends input and picks and reads snapshots.
+class SimulationThread
+{
+public:
+	SimulationThread(double step, int maxSteps);
+	~SimulationThread();
+
+	void Start(World* pWorld, const SimulationInput& input);
+	void Stop();
+
+	void SetInput(const SimulationInput& input);
+	void Pick(const PickEvent& pick);
+
+	// The newest snapshot, null until the first step is done
+	RenderSnapshot* AcquireSnapshot();
+
+	double GetStep();
+
+private:
+	void Run();
+
+	World* pWorld;
+	std::thread mThread;
+	std::atomic<bool> mRunning;
+
+	GameTimer mTimer;
+	FixedTimestep mTimestep;
+	SnapshotMailbox mMailbox;
+
+	std::mutex mInputLock;
+	SimulationInput mInput;
+	std::vector<PickEvent> mPicks;
+
+	// Taken out from under the lock at the start of each tick
+	std::vector<PickEvent> mPendingPicks;
+};
@@ -0,0 +1,255 @@
+#include "TaskGraph.h"
+
+static float Milliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+TaskGraph::TaskGraph()
+{
+	pJobSystem = 0;
+	mRemaining = 0;
+	mCriticalPathTime = 0.f;
+	mWorkTime = 0.f;
+	mElapsedTime = 0.f;
+}
+
+TaskGraph::~TaskGraph()
+{
+	for (unsigned int i = 0; i < mTasks.size(); i++) {
+		delete mTasks[i];
+	}
+}
+
+int TaskGraph::AddTask(const char* name, JobFunction function, void* pData, unsigned int reads, unsigned int writes,
+	unsigned int flags, unsigned int count, unsigned int grain)
+{
+	Task* pTask = new Task();
+	pTask->name = name;
+	pTask->function = function;
+	pTask->pData = pData;
+	pTask->reads = reads;
+	pTask->writes = writes;
+	pTask->flags = flags;
+	pTask->count = count;
+	pTask->grain = grain;
+	pTask->dependencyCount = 0;
+	pTask->pending = 0;
+	pTask->time = 0.f;
+	pTask->critical = false;
+	pTask->pGraph = this;
+
+	int index = (int)mTasks.size();
+
+	// Read after write, write after write and write after read all order the tasks
+	for (int i = 0; i < index; i++) {
+		Task* pEarlier = mTasks[i];
+
+		if ((pEarlier->writes & (reads | writes)) || (pEarlier->reads & writes)) {
+			pEarlier->successors.push_back(index);
+			pTask->dependencyCount++;
+		}
+	}
+
+	mTasks.push_back(pTask);
+
+	return index;
+}
+
+// before has to have been added first, so the order tasks were added in stays a valid order to run them in
+void TaskGraph::AddDependency(int before, int after)
+{
+	if (before < 0 || before >= after || after >= (int)mTasks.size()) {
+		return;
+	}
+
+	std::vector<int>& successors = mTasks[before]->successors;
+	for (unsigned int i = 0; i < successors.size(); i++) {
+		if (successors[i] == after) { return; }
+	}
+
+	successors.push_back(after);
+	mTasks[after]->dependencyCount++;
+}
+
+void TaskGraph::SetTaskCount(int task, unsigned int count)
+{
+	mTasks[task]->count = count;
+}
+
+void TaskGraph::Execute(JobSystem* pJobSystem)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (!pJobSystem) {
+		for (unsigned int i = 0; i < mTasks.size(); i++) {
+			Task* pTask = mTasks[i];
+
+			pTask->start = std::chrono::steady_clock::now();
+			if (pTask->count > 0) {
+				pTask->function(pTask->pData, 0, pTask->count);
+			}
+			pTask->end = std::chrono::steady_clock::now();
+		}
+
+		Measure(start);
+		return;
+	}
+
+	this->pJobSystem = pJobSystem;
+	mRemaining = (int)mTasks.size();
+
+	for (unsigned int i = 0; i < mTasks.size(); i++) {
+		mTasks[i]->pending = mTasks[i]->dependencyCount;
+	}
+
+	for (unsigned int i = 0; i < mTasks.size(); i++) {
+		if (mTasks[i]->dependencyCount == 0) {
+			Release(mTasks[i]);
+		}
+	}
+
+	// Run main thread tasks as they become ready and help with the jobs in between
+	while (mRemaining.load() > 0) {
+		Task* pTask = 0;
+		{
+			std::lock_guard<std::mutex> lock(mMainLock);
+
+			if (!mMainReady.empty()) {
+				pTask = mMainReady.front();
+				mMainReady.erase(mMainReady.begin());
+			}
+		}
+
+		if (pTask) {
+			if (pTask->count > 0) {
+				pTask->function(pTask->pData, 0, pTask->count);
+			}
+			Finish(pTask);
+			continue;
+		}
+
+		if (!pJobSystem->RunPending()) {
+			std::this_thread::yield();
+		}
+	}
+
+	Measure(start);
+}
+
+void TaskGraph::Release(Task* pTask)
+{
+	pTask->start = std::chrono::steady_clock::now();
+
+	if (pTask->flags & TASK_MAIN_THREAD) {
+		std::lock_guard<std::mutex> lock(mMainLock);
+		mMainReady.push_back(pTask);
+		return;
+	}
+
+	// The task is finished by a job held on its counter until the last piece of it is done
+	pJobSystem->ParallelFor(pTask->function, pTask->pData, pTask->count, pTask->grain, &pTask->counter);
+	pJobSystem->RunAfter(&pTask->counter, FinishJob, pTask, 0, 0, 0);
+}
+
+void TaskGraph::Finish(Task* pTask)
+{
+	pTask->end = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0; i < pTask->successors.size(); i++) {
+		Task* pSuccessor = mTasks[pTask->successors[i]];
+
+		if (pSuccessor->pending.fetch_sub(1) == 1) {
+			Release(pSuccessor);
+		}
+	}
+
+	// Last, Execute returns as soon as this reaches zero
+	mRemaining--;
+}
+
+void TaskGraph::FinishJob(void* pData, unsigned int begin, unsigned int end)
+{
+	Task* pTask = (Task*)pData;
+	pTask->pGraph->Finish(pTask);
+}
+
+// Successors always come later in mTasks, so one pass in order finds the longest chain ending at each task
+void TaskGraph::Measure(std::chrono::steady_clock::time_point start)
+{
+	std::vector<float> longest(mTasks.size(), 0.f);
+	std::vector<int> previous(mTasks.size(), -1);
+	int last = -1;
+
+	mWorkTime = 0.f;
+	mCriticalPathTime = 0.f;
+
+	for (unsigned int i = 0; i < mTasks.size(); i++) {
+		Task* pTask = mTasks[i];
+
+		pTask->time = Milliseconds(pTask->start, pTask->end);
+		pTask->critical = false;
+		mWorkTime += pTask->time;
+
+		longest[i] += pTask->time;
+		if (longest[i] > mCriticalPathTime || last < 0) {
+			mCriticalPathTime = longest[i];
+			last = (int)i;
+		}
+
+		for (unsigned int j = 0; j < pTask->successors.size(); j++) {
+			int successor = pTask->successors[j];
+
+			if (previous[successor] < 0 || longest[i] > longest[successor]) {
+				longest[successor] = longest[i];
+				previous[successor] = (int)i;
+			}
+		}
+	}
+
+	for (int i = last; i >= 0; i = previous[i]) {
+		mTasks[i]->critical = true;
+	}
+
+	mElapsedTime = Milliseconds(start, std::chrono::steady_clock::now());
+}
+
+int TaskGraph::GetTaskCount()
+{
+	return (int)mTasks.size();
+}
+
+const char* TaskGraph::GetTaskName(int task)
+{
+	return mTasks[task]->name;
+}
+
+int TaskGraph::GetDependencyCount(int task)
+{
+	return mTasks[task]->dependencyCount;
+}
+
+float TaskGraph::GetTaskTime(int task)
+{
+	return mTasks[task]->time;
+}
+
+bool TaskGraph::IsOnCriticalPath(int task)
+{
+	return mTasks[task]->critical;
+}
+
+float TaskGraph::GetCriticalPathTime()
+{
+	return mCriticalPathTime;
+}
+
+float TaskGraph::GetWorkTime()
+{
+	return mWorkTime;
+}
+
+float TaskGraph::GetElapsedTime()
+{
+	return mElapsedTime;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// The task has to run on the thread that calls Execute, for work that touches
+// the device context or game code that is not safe to run on a worker
+const unsigned int TASK_MAIN_THREAD = 1 << 0;
+
+// Lets a member function that takes (begin, end) be a task, the object is passed as the task's data
+template<class T, void (T::*Method)(unsigned int, unsigned int)>
+void TaskMethod(void* pData, unsigned int begin, unsigned int end)
+{
+	(((T*)pData)->*Method)(begin, end);
+}
+
+// A frame split into tasks that declare what they read and write. Resources are
+// bits the owner of the graph hands out, one per piece of shared state. A task
+// depends on every earlier task that writes something it reads or writes, and on
+// every earlier task that reads something it writes, so adding tasks in the order
+// they would run serially gives a graph with the same result. Tasks that share
+// nothing run at the same time on the job system.
+//
+// Each run times its tasks from when they are released to when their last job
+// finishes. The critical path is the longest chain of those through the graph, the
+// least the frame could take however many workers there were.
+class TaskGraph
+{
+public:
+	TaskGraph();
+	~TaskGraph();
+
+	// The function is split over [0, count) in jobs of grain indices, count is 1
+	// for a task that runs once. Returns the task's index.
+	int AddTask(const char* name, JobFunction function, void* pData, unsigned int reads, unsigned int writes,
+		unsigned int flags = 0, unsigned int count = 1, unsigned int grain = 0);
+
+	// Orders two tasks that share no declared resource
+	void AddDependency(int before, int after);
+
+	// Changes how many indices a task covers. The count is read when the task is
+	// released, so a task can set it for one that depends on it.
+	void SetTaskCount(int task, unsigned int count);
+
+	// Runs the graph and returns once every task has finished. Without a job
+	// system every task runs on this thread in the order it was added.
+	void Execute(JobSystem* pJobSystem);
+
+	int GetTaskCount();
+	const char* GetTaskName(int task);
+	int GetDependencyCount(int task);
+
+	// Timings from the last Execute, in milliseconds
+	float GetTaskTime(int task);
+	bool IsOnCriticalPath(int task);
+	float GetCriticalPathTime();
+	float GetWorkTime();
+	float GetElapsedTime();
+
+private:
+	struct Task {
+		const char* name;
+		JobFunction function;
+		void* pData;
+		unsigned int reads;
+		unsigned int writes;
+		unsigned int flags;
+		unsigned int count;
+		unsigned int grain;
+
+		std::vector<int> successors;
+		int dependencyCount;
+
+		// Per Execute
+		std::atomic<int> pending;
+		JobCounter counter;
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point end;
+
+		// Results of the last Execute
+		float time;
+		bool critical;
+
+		TaskGraph* pGraph;
+	};
+
+	void Release(Task* pTask);
+	void Finish(Task* pTask);
+	void Measure(std::chrono::steady_clock::time_point start);
+
+	static void FinishJob(void* pData, unsigned int begin, unsigned int end);
+
+	std::vector<Task*> mTasks;
+
+	JobSystem* pJobSystem;
+	std::atomic<int> mRemaining;
+
+	// Main thread tasks that are ready, run by Execute in between jobs
+	std::mutex mMainLock;
+	std::vector<Task*> mMainReady;
+
+	float mCriticalPathTime;
+	float mWorkTime;
+	float mElapsedTime;
+};
@@ -0,0 +1,138 @@
+// Lays out square grids of 5 up to 200 blocks a side over the job system, the way
+// CityGenerator::GenerateWorld runs GenerateBlock for each block of its grid, with the
+// settings and buildings the game uses and no device. Prints the time for each grid at 1, 2,
+// 4 and 8 workers and checks every worker count places exactly the same city.
+//   cl /EHsc /O2 /I.. CityLayoutBenchmark.cpp ..\CityLayout.cpp ..\CityPacker.cpp ..\CityRandom.cpp ..\JobSystem.cpp
+//   g++ -O2 -pthread -I.. CityLayoutBenchmark.cpp ../CityLayout.cpp ../CityPacker.cpp ../CityRandom.cpp ../JobSystem.cpp
+
+#include "CityLayout.h"
+#include "JobSystem.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#define BENCHMARK_SIZES 5
+#define BENCHMARK_WORKER_COUNTS 4
+
+struct BenchmarkGrid {
+	const CityLayout* pLayout;
+	std::vector<CityBlock> blocks;
+};
+
+static void GenerateJob(void* pData, unsigned int begin, unsigned int end)
+{
+	BenchmarkGrid* pGrid = (BenchmarkGrid*)pData;
+
+	for (unsigned int i = begin; i < end; i++) {
+		CityBlock& block = pGrid->blocks[i];
+		pGrid->pLayout->GenerateBlock(block.X, block.Y, block);
+	}
+}
+
+// As World::Initialize and CityGenerator set it up, with the building types the generator adds
+static void SetUp(CityLayout& layout)
+{
+	const float buildings[7][4] = {
+		{ 40.f, 20.f, -20.f, 10.f },
+		{ 15.f, 15.f, -6.f, 10.f },
+		{ 25.f, 28.f, -6.f, 10.f },
+		{ 50.f, 50.f, -20.f, 24.f },
+		{ 60.f, 50.f, -30.f, 15.f },
+		{ 70.f, 50.f, -25.f, 20.f },
+		{ 25.f, 40.f, -6.f, 20.f },
+	};
+
+	layout.RoadSegmentSize = 36.f;
+	layout.RoadLength = 10;
+	layout.Seed = 20181213;
+
+	layout.ModelFlags.assign(MODEL_BUILDINGS, 0);
+	for (int i = 0; i < 7; i++) {
+		layout.AddBuilding(buildings[i][0], buildings[i][1], buildings[i][2], buildings[i][3]);
+		layout.ModelFlags.push_back(CITY_COLLIDE | CITY_DRAW_AABB);
+	}
+}
+
+// FNV-1a over every instance of every block in grid order
+static unsigned long long Hash(const std::vector<CityBlock>& blocks, unsigned int& count)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	unsigned char bytes[16];
+
+	count = 0;
+
+	for (unsigned int i = 0; i < blocks.size(); i++) {
+		for (unsigned int j = 0; j < blocks[i].Instances.size(); j++) {
+			const CityInstance& instance = blocks[i].Instances[j];
+
+			memcpy(bytes, &instance.Position, 12);
+			memcpy(bytes + 12, &instance.Model, 2);
+			bytes[14] = instance.Turns;
+			bytes[15] = instance.Flags;
+
+			for (int k = 0; k < 16; k++) {
+				hash = (hash ^ bytes[k]) * 1099511628211ull;
+			}
+			count++;
+		}
+	}
+
+	return hash;
+}
+
+static double Since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+	const int sizes[BENCHMARK_SIZES] = { 5, 25, 50, 100, 200 };
+	const unsigned int workerCounts[BENCHMARK_WORKER_COUNTS] = { 1, 2, 4, 8 };
+	unsigned long long hashes[BENCHMARK_SIZES];
+	CityLayout layout;
+
+	SetUp(layout);
+
+	for (int w = 0; w < BENCHMARK_WORKER_COUNTS; w++) {
+		JobSystem jobs;
+		CHECK(jobs.Initialize(workerCounts[w]));
+
+		for (int s = 0; s < BENCHMARK_SIZES; s++) {
+			int size = sizes[s];
+			BenchmarkGrid grid;
+			unsigned int count;
+
+			grid.pLayout = &layout;
+			grid.blocks.resize(size * size);
+
+			for (int x = 0; x < size; x++) {
+				for (int y = 0; y < size; y++) {
+					grid.blocks[x * size + y].X = x;
+					grid.blocks[x * size + y].Y = y;
+				}
+			}
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			jobs.ParallelForAndWait(GenerateJob, &grid, (unsigned int)grid.blocks.size(), 1);
+			double ms = Since(start);
+
+			unsigned long long hash = Hash(grid.blocks, count);
+
+			// The same seed gives the same city however many threads build it
+			if (w == 0) {
+				hashes[s] = hash;
+			}
+			CHECK(hash == hashes[s]);
+			CHECK(count > (unsigned int)(size * size) * (1 + 6 * (layout.RoadLength - 1)));
+
+			printf("workers %u  %3dx%-3d  %8u instances  %9.2f ms  %.2f us a block  hash %016llx\n", workerCounts[w], size, size,
+				count, ms, ms * 1000.0 / (size * size), hash);
+		}
+
+		jobs.Shutdown();
+	}
+
+	return TestResult("CityLayoutBenchmark");
+}
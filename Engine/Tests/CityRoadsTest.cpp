@@ -0,0 +1,268 @@
+// Standalone test of CityRoads on grids of blocks built here, needs no device. Checks every
+// route found is a connected walk over the graph between the right junctions, agrees with a
+// flat search over which pairs are connected, and that routes through a block are dropped
+// and found again around it once the block is removed.
+//   cl /EHsc /I.. CityRoadsTest.cpp ..\CityRoads.cpp ..\CityRandom.cpp
+//   g++ -I.. CityRoadsTest.cpp ../CityRoads.cpp ../CityRandom.cpp
+
+#include "CityRoads.h"
+#include "TestCheck.h"
+#include <cstdlib>
+#include <queue>
+#include <set>
+
+#define TEST_BLOCK_LENGTH 360.f
+#define TEST_ROAD_WIDTH 36.f
+
+typedef std::set<std::pair<int, int>> BlockSet;
+
+static CityBlock MakeBlock(int x, int y)
+{
+	CityBlock block;
+	block.X = x;
+	block.Y = y;
+	block.Junction = SimdMath::Float3(x * TEST_BLOCK_LENGTH, 0.f, y * TEST_BLOCK_LENGTH);
+	block.RoadLengths[0] = TEST_BLOCK_LENGTH;
+	block.RoadLengths[1] = TEST_BLOCK_LENGTH;
+
+	return block;
+}
+
+static void AddGrid(CityRoads& roads, const BlockSet& blocks)
+{
+	for (BlockSet::const_iterator it = blocks.begin(); it != blocks.end(); it++) {
+		roads.AddBlock(MakeBlock(it->first, it->second));
+	}
+
+	roads.Update();
+}
+
+// Fewest roads between two blocks over the four neighbours of each, -1 when there is no way
+static int FlatSearch(const BlockSet& blocks, SimdMath::Int2 start, SimdMath::Int2 goal)
+{
+	const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	std::map<std::pair<int, int>, int> steps;
+	std::queue<std::pair<int, int>> open;
+
+	if (!blocks.count(std::make_pair(start.x, start.y)) || !blocks.count(std::make_pair(goal.x, goal.y))) {
+		return -1;
+	}
+
+	steps[std::make_pair(start.x, start.y)] = 0;
+	open.push(std::make_pair(start.x, start.y));
+
+	while (!open.empty()) {
+		std::pair<int, int> current = open.front();
+		open.pop();
+
+		if (current.first == goal.x && current.second == goal.y) {
+			return steps[current];
+		}
+
+		for (int i = 0; i < 4; i++) {
+			std::pair<int, int> next(current.first + offsets[i][0], current.second + offsets[i][1]);
+
+			if (blocks.count(next) && !steps.count(next)) {
+				steps[next] = steps[current] + 1;
+				open.push(next);
+			}
+		}
+	}
+
+	return -1;
+}
+
+// Starts and ends at the right junctions and every step is one road between two in the graph
+static bool IsValidRoute(CityRoads& roads, const BlockSet& blocks, SimdMath::Int2 start, SimdMath::Int2 goal, const std::vector<SimdMath::Int2>& route)
+{
+	int count = (int)route.size();
+
+	if (count == 0) { return false; }
+	if (route[0].x != start.x || route[0].y != start.y) { return false; }
+	if (route[count - 1].x != goal.x || route[count - 1].y != goal.y) { return false; }
+
+	for (int i = 0; i < count; i++) {
+		if (!roads.HasJunction(route[i]) || !blocks.count(std::make_pair(route[i].x, route[i].y))) { return false; }
+
+		if (i > 0 && abs(route[i].x - route[i - 1].x) + abs(route[i].y - route[i - 1].y) != 1) { return false; }
+	}
+
+	return true;
+}
+
+static bool Contains(const std::vector<SimdMath::Int2>& route, SimdMath::Int2 junction)
+{
+	for (int i = 0; i < (int)route.size(); i++) {
+		if (route[i].x == junction.x && route[i].y == junction.y) { return true; }
+	}
+
+	return false;
+}
+
+// With nothing missing every route is as short as it can be
+static void TestFullGrid()
+{
+	const int size = 16;
+	CityRoads roads;
+	BlockSet blocks;
+	std::vector<SimdMath::Int2> route;
+
+	for (int x = 0; x < size; x++) {
+		for (int y = 0; y < size; y++) {
+			blocks.insert(std::make_pair(x, y));
+		}
+	}
+
+	roads.Initialize(TEST_BLOCK_LENGTH, TEST_ROAD_WIDTH);
+	AddGrid(roads, blocks);
+
+	CHECK(roads.GetJunctionCount() == size * size);
+	CHECK(roads.GetRegionCount() == (size / roads.RegionSize) * (size / roads.RegionSize));
+
+	for (int i = 0; i < 200; i++) {
+		SimdMath::Int2 start(rand() % size, rand() % size);
+		SimdMath::Int2 goal(rand() % size, rand() % size);
+
+		CHECK(roads.FindRoute(start, goal, route));
+		CHECK(IsValidRoute(roads, blocks, start, goal, route));
+		CHECK((int)route.size() - 1 == abs(goal.x - start.x) + abs(goal.y - start.y));
+	}
+
+	// Blocks outside the graph have no route
+	CHECK(!roads.FindRoute(SimdMath::Int2(0, 0), SimdMath::Int2(size, 0), route));
+}
+
+// A route is found exactly when the flat search finds one
+static void TestHoles()
+{
+	const int size = 24;
+	CityRoads roads;
+	BlockSet blocks;
+	std::vector<SimdMath::Int2> route;
+	int found = 0;
+
+	srand(7);
+
+	for (int x = 0; x < size; x++) {
+		for (int y = 0; y < size; y++) {
+			if (rand() % 4 != 0) {
+				blocks.insert(std::make_pair(x, y));
+			}
+		}
+	}
+
+	roads.Initialize(TEST_BLOCK_LENGTH, TEST_ROAD_WIDTH);
+	AddGrid(roads, blocks);
+
+	for (int i = 0; i < 500; i++) {
+		SimdMath::Int2 start(rand() % size, rand() % size);
+		SimdMath::Int2 goal(rand() % size, rand() % size);
+		int shortest = FlatSearch(blocks, start, goal);
+
+		if (roads.FindRoute(start, goal, route)) {
+			CHECK(shortest >= 0);
+			CHECK(IsValidRoute(roads, blocks, start, goal, route));
+			CHECK((int)route.size() - 1 >= shortest);
+			found++;
+		}
+		else {
+			CHECK(shortest < 0);
+		}
+	}
+
+	CHECK(found > 0);
+}
+
+// Removing a block on a kept route drops it, and the next search goes round the block
+static void TestRemoveBlock()
+{
+	const int size = 12;
+	CityRoads roads;
+	BlockSet blocks;
+	std::vector<SimdMath::Int2> route;
+	SimdMath::Int2 start(0, 5);
+	SimdMath::Int2 goal(11, 5);
+	SimdMath::Int2 removed(6, 5);
+
+	for (int x = 0; x < size; x++) {
+		for (int y = 0; y < size; y++) {
+			blocks.insert(std::make_pair(x, y));
+		}
+	}
+
+	roads.Initialize(TEST_BLOCK_LENGTH, TEST_ROAD_WIDTH);
+	AddGrid(roads, blocks);
+
+	// The only shortest route is straight along the row
+	CHECK(roads.FindRoute(start, goal, route));
+	CHECK(Contains(route, removed));
+	CHECK(roads.GetCachedRouteCount() == 1);
+	CHECK(roads.GetCacheMisses() == 1);
+
+	CHECK(roads.FindRoute(start, goal, route));
+	CHECK(roads.GetCacheHits() == 1);
+
+	// A route through other regions only is kept
+	std::vector<SimdMath::Int2> other;
+	CHECK(roads.FindRoute(SimdMath::Int2(0, 0), SimdMath::Int2(3, 0), other));
+	CHECK(roads.GetCachedRouteCount() == 2);
+
+	roads.RemoveBlock(removed.x, removed.y);
+	blocks.erase(std::make_pair(removed.x, removed.y));
+	roads.Update();
+
+	CHECK(!roads.HasJunction(removed));
+	CHECK(roads.GetCachedRouteCount() == 1);
+
+	CHECK(roads.FindRoute(start, goal, route));
+	CHECK(IsValidRoute(roads, blocks, start, goal, route));
+	CHECK(!Contains(route, removed));
+	CHECK((int)route.size() - 1 == FlatSearch(blocks, start, goal));
+	CHECK(roads.GetCacheMisses() == 3);
+
+	// Nothing leads to the removed block
+	CHECK(!roads.FindRoute(start, removed, route));
+
+	// Putting it back drops the way round it again
+	roads.AddBlock(MakeBlock(removed.x, removed.y));
+	blocks.insert(std::make_pair(removed.x, removed.y));
+	roads.Update();
+
+	CHECK(roads.FindRoute(start, goal, route));
+	CHECK(IsValidRoute(roads, blocks, start, goal, route));
+	CHECK((int)route.size() - 1 == goal.x - start.x);
+}
+
+// A wall of missing blocks splits the graph in two
+static void TestDisconnected()
+{
+	const int size = 10;
+	CityRoads roads;
+	BlockSet blocks;
+	std::vector<SimdMath::Int2> route;
+
+	for (int x = 0; x < size; x++) {
+		for (int y = 0; y < size; y++) {
+			if (x != 5) {
+				blocks.insert(std::make_pair(x, y));
+			}
+		}
+	}
+
+	roads.Initialize(TEST_BLOCK_LENGTH, TEST_ROAD_WIDTH);
+	AddGrid(roads, blocks);
+
+	CHECK(!roads.FindRoute(SimdMath::Int2(0, 0), SimdMath::Int2(9, 9), route));
+	CHECK(roads.FindRoute(SimdMath::Int2(0, 0), SimdMath::Int2(4, 9), route));
+	CHECK(IsValidRoute(roads, blocks, SimdMath::Int2(0, 0), SimdMath::Int2(4, 9), route));
+}
+
+int main()
+{
+	TestFullGrid();
+	TestHoles();
+	TestRemoveBlock();
+	TestDisconnected();
+
+	return TestResult("CityRoads");
+}
@@ -0,0 +1,148 @@
+// Drives 100k cars over a 64 by 64 grid of junctions for a simulated minute, with no device:
+// Sort on this thread then a ParallelFor over Update, as the world's traffic phases run them.
+// Prints the time a step takes and checks it stays inside its share of the step, and that no
+// two cars ever overlap on a lane.
+//   cl /EHsc /O2 /I.. CityTrafficBenchmark.cpp ..\CityTraffic.cpp ..\CityRandom.cpp ..\JobSystem.cpp
+//   g++ -O2 -pthread -I.. CityTrafficBenchmark.cpp ../CityTraffic.cpp ../CityRandom.cpp ../JobSystem.cpp
+
+#include "CityTraffic.h"
+#include "TaskGraph.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#define BENCHMARK_VEHICLES 100000
+#define BENCHMARK_GRID 64
+#define BENCHMARK_STEPS 3600
+#define BENCHMARK_WARMUP 60
+#define BENCHMARK_CHECK_EVERY 300
+#define BENCHMARK_DELTA (1.0 / 60.0)
+
+// Traffic may take half a 60 Hz step on average, even on one worker, leaving the rest for the objects
+#define BENCHMARK_TICK_BUDGET_MS (1000.0 / 60.0 / 2.0)
+
+// The world's city, see World::Initialize
+#define BENCHMARK_BLOCK_LENGTH 360.f
+#define BENCHMARK_ROAD_WIDTH 36.f
+
+static double Since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct LaneCar {
+	int direction;
+	int line;		// Which road across the grid, from the position off the direction of travel
+	float along;	// How far along it
+};
+
+static bool operator<(const LaneCar& a, const LaneCar& b)
+{
+	if (a.direction != b.direction) { return a.direction < b.direction; }
+	if (a.line != b.line) { return a.line < b.line; }
+	return a.along < b.along;
+}
+
+// Cars on the same road going the same way, whichever lane of it, must be a car length apart.
+// The vehicle types have no turns of their own, so an instance's turns are its direction.
+static int CountOverlaps(CityTraffic& traffic, float vehicleLength)
+{
+	std::vector<CityInstance> instances;
+	std::vector<LaneCar> cars;
+	int overlaps = 0;
+
+	traffic.WriteInstances(instances, 1e9f);
+
+	for (unsigned int i = 0; i < instances.size(); i++) {
+		const CityInstance& instance = instances[i];
+		bool alongX = (instance.Turns & 1) != 0;
+		LaneCar car;
+
+		car.direction = instance.Turns;
+		car.line = (int)floorf((alongX ? instance.Position.z : instance.Position.x) * 10.f + 0.5f);
+		car.along = alongX ? instance.Position.x : instance.Position.z;
+		cars.push_back(car);
+	}
+
+	std::sort(cars.begin(), cars.end());
+
+	for (unsigned int i = 1; i < cars.size(); i++) {
+		if (cars[i].direction == cars[i - 1].direction && cars[i].line == cars[i - 1].line &&
+			cars[i].along - cars[i - 1].along < vehicleLength - 0.01f) {
+			overlaps++;
+		}
+	}
+
+	return overlaps;
+}
+
+int main()
+{
+	CityTraffic traffic;
+	JobSystem jobs;
+	double time = 0.0;
+	double sortMs = 0.0;
+	double updateMs = 0.0;
+	double worstMs = 0.0;
+	long long stopped = 0;
+	int overlaps = 0;
+	int step;
+
+	traffic.GridSize = BENCHMARK_GRID;
+	traffic.VehicleCount = BENCHMARK_VEHICLES;
+	traffic.FollowFocus = false;
+	traffic.AddVehicleType(0, 0);
+	traffic.AddVehicleType(1, 0);
+	traffic.AddVehicleType(2, 0);
+	traffic.Initialize(BENCHMARK_BLOCK_LENGTH, BENCHMARK_ROAD_WIDTH, 20181213);
+
+	CHECK(jobs.Initialize());
+	CHECK(traffic.GetVehicleCount() == BENCHMARK_VEHICLES);
+
+	overlaps += CountOverlaps(traffic, traffic.VehicleLength);
+
+	for (step = 0; step < BENCHMARK_STEPS; step++) {
+		time += BENCHMARK_DELTA;
+		traffic.Advance(SimdMath::Float3(0.f, 0.f, 0.f), time);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		traffic.Sort(0, 1);
+		double sort = Since(start);
+
+		start = std::chrono::steady_clock::now();
+		jobs.ParallelForAndWait(TaskMethod<CityTraffic, &CityTraffic::Update>, &traffic, BENCHMARK_VEHICLES, 1024);
+		double update = Since(start);
+
+		// The first steps start every car from rest at once
+		if (step >= BENCHMARK_WARMUP) {
+			sortMs += sort;
+			updateMs += update;
+			worstMs = sort + update > worstMs ? sort + update : worstMs;
+			stopped += traffic.GetWaitingCount();
+		}
+
+		if (step % BENCHMARK_CHECK_EVERY == BENCHMARK_CHECK_EVERY - 1) {
+			overlaps += CountOverlaps(traffic, traffic.VehicleLength);
+		}
+	}
+
+	int measured = BENCHMARK_STEPS - BENCHMARK_WARMUP;
+	double tickMs = (sortMs + updateMs) / measured;
+
+	CHECK(overlaps == 0);
+	CHECK(tickMs < BENCHMARK_TICK_BUDGET_MS);
+
+	// Cars reach the junctions and wait at them, but are not stuck behind one another
+	CHECK(stopped > 0);
+	CHECK(stopped / measured < BENCHMARK_VEHICLES / 2);
+
+	printf("%d cars on %dx%d junctions, %u workers: sort %.3f ms, update %.3f ms, %.3f ms a step (worst %.3f, budget %.3f), "
+		"%lld stopped a step, %d overlaps\n", BENCHMARK_VEHICLES, BENCHMARK_GRID, BENCHMARK_GRID, jobs.GetWorkerCount(),
+		sortMs / measured, updateMs / measured, tickMs, worstMs, BENCHMARK_TICK_BUDGET_MS, stopped / measured, overlaps);
+
+	jobs.Shutdown();
+
+	return TestResult("CityTrafficBenchmark");
+}
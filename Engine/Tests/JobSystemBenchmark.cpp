@@ -0,0 +1,167 @@
+// Times the job system at 1, 2, 4 up to 64 workers, with no device: a ParallelFor over an
+// array, and chains of batches where each batch is queued with RunAfter on the counter of
+// the one before. Prints the time and the speedup over one worker for each count, and checks
+// every index is run once and every batch of a chain sees the whole of the batch before it.
+//   cl /EHsc /O2 /I.. JobSystemBenchmark.cpp ..\JobSystem.cpp
+//   g++ -O2 -pthread -I.. JobSystemBenchmark.cpp ../JobSystem.cpp
+
+#include "JobSystem.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#define BENCHMARK_COUNT 262144
+#define BENCHMARK_GRAIN 1024
+#define BENCHMARK_REPEATS 10
+#define BENCHMARK_STAGES 16
+#define BENCHMARK_MAX_WORKERS 64
+
+struct BenchmarkData {
+	float* pValues;
+	float* pTotals;
+	unsigned int* pRuns;
+	unsigned int stage;
+};
+
+// Enough arithmetic per index that a job costs more than taking it from a deque
+static float Work(float value)
+{
+	for (int i = 0; i < 8; i++) {
+		value = std::sqrt(value * value + 1.f) * 0.5f;
+	}
+
+	return value;
+}
+
+static void ForJob(void* pData, unsigned int begin, unsigned int end)
+{
+	BenchmarkData* pBenchmark = (BenchmarkData*)pData;
+
+	for (unsigned int i = begin; i < end; i++) {
+		pBenchmark->pValues[i] = Work(pBenchmark->pValues[i]);
+		pBenchmark->pRuns[i]++;
+	}
+}
+
+// Doubles the total and adds the stage, so a batch that ran early or twice shows in it
+static void StageJob(void* pData, unsigned int begin, unsigned int end)
+{
+	BenchmarkData* pBenchmark = (BenchmarkData*)pData;
+
+	for (unsigned int i = begin; i < end; i++) {
+		pBenchmark->pValues[i] = Work(pBenchmark->pValues[i]);
+		pBenchmark->pTotals[i] = pBenchmark->pTotals[i] * 2.f + (float)pBenchmark->stage;
+	}
+}
+
+static double Since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double BenchmarkParallelFor(JobSystem& jobs)
+{
+	std::vector<float> values(BENCHMARK_COUNT, 1.f);
+	std::vector<unsigned int> runs(BENCHMARK_COUNT, 0);
+	BenchmarkData data = { &values[0], 0, &runs[0], 0 };
+	bool once = true;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++) {
+		jobs.ParallelForAndWait(ForJob, &data, BENCHMARK_COUNT, BENCHMARK_GRAIN);
+	}
+
+	double ms = Since(start) / BENCHMARK_REPEATS;
+
+	for (unsigned int i = 0; i < BENCHMARK_COUNT; i++) {
+		once = once && runs[i] == BENCHMARK_REPEATS;
+	}
+	CHECK(once);
+
+	return ms;
+}
+
+// Every batch is queued up front, each held by the counter of the batch before it
+static double BenchmarkChains(JobSystem& jobs)
+{
+	std::vector<float> values(BENCHMARK_COUNT, 1.f);
+	std::vector<float> totals(BENCHMARK_COUNT);
+	std::vector<BenchmarkData> data(BENCHMARK_STAGES);
+	bool ordered = true;
+	double ms = 0.0;
+
+	for (int stage = 0; stage < BENCHMARK_STAGES; stage++) {
+		data[stage].pValues = &values[0];
+		data[stage].pTotals = &totals[0];
+		data[stage].pRuns = 0;
+		data[stage].stage = stage;
+	}
+
+	for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++) {
+		JobCounter counters[BENCHMARK_STAGES];
+		totals.assign(BENCHMARK_COUNT, 0.f);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		jobs.ParallelFor(StageJob, &data[0], BENCHMARK_COUNT, BENCHMARK_GRAIN, &counters[0]);
+
+		for (int stage = 1; stage < BENCHMARK_STAGES; stage++) {
+			for (unsigned int begin = 0; begin < BENCHMARK_COUNT; begin += BENCHMARK_GRAIN) {
+				jobs.RunAfter(&counters[stage - 1], StageJob, &data[stage], begin, begin + BENCHMARK_GRAIN, &counters[stage]);
+			}
+		}
+
+		jobs.Wait(&counters[BENCHMARK_STAGES - 1]);
+		ms += Since(start);
+
+		// The last batch done means every batch is, this only waits out the locks before the counters go
+		for (int stage = 0; stage < BENCHMARK_STAGES; stage++) {
+			CHECK(counters[stage].IsDone());
+			jobs.Wait(&counters[stage]);
+		}
+	}
+
+	// Sum over the stages of stage * 2^(STAGES - 1 - stage), exact in a float
+	float expected = 0.f;
+	for (int stage = 0; stage < BENCHMARK_STAGES; stage++) {
+		expected = expected * 2.f + (float)stage;
+	}
+
+	for (unsigned int i = 0; i < BENCHMARK_COUNT; i++) {
+		ordered = ordered && totals[i] == expected;
+	}
+	CHECK(ordered);
+
+	return ms / BENCHMARK_REPEATS;
+}
+
+int main()
+{
+	double forBase = 0.0;
+	double chainBase = 0.0;
+
+	printf("workers  parallel for ms  speedup  %d batch chain ms  speedup\n", BENCHMARK_STAGES);
+
+	for (unsigned int workers = 1; workers <= BENCHMARK_MAX_WORKERS; workers *= 2) {
+		JobSystem jobs;
+
+		CHECK(jobs.Initialize(workers));
+		CHECK(jobs.GetWorkerCount() == workers);
+
+		double forMs = BenchmarkParallelFor(jobs);
+		double chainMs = BenchmarkChains(jobs);
+
+		if (workers == 1) {
+			forBase = forMs;
+			chainBase = chainMs;
+		}
+
+		printf("%7u  %15.3f  %6.2fx  %17.3f  %6.2fx\n", workers, forMs, forBase / forMs, chainMs, chainBase / chainMs);
+
+		jobs.Shutdown();
+	}
+
+	return TestResult("JobSystemBenchmark");
+}
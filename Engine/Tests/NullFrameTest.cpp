@@ -0,0 +1,286 @@
+// Runs the queued draw path, the constant ring, the draw queue and the state cache, on the
+// null backend with no window or device. Checks what a frame issues, checks that a recorded
+// frame replays into another backend on that backend's own resources, and times frames.
+//   cl /EHsc /O2 /I.. NullFrameTest.cpp ..\constantbufferringclass.cpp ..\drawqueueclass.cpp ..\renderstatecacheclass.cpp ..\nullrenderbackendclass.cpp ..\UniformRingAllocator.cpp
+//   g++ -O2 -I.. NullFrameTest.cpp ../constantbufferringclass.cpp ../drawqueueclass.cpp ../renderstatecacheclass.cpp ../nullrenderbackendclass.cpp ../UniformRingAllocator.cpp
+
+#include "constantbufferringclass.h"
+#include "drawqueueclass.h"
+#include "renderstatecacheclass.h"
+#include "nullrenderbackendclass.h"
+#include "TestCheck.h"
+
+#include <chrono>
+#include <cstring>
+#include <set>
+
+const int FRAME_PIPELINES = 4;
+const unsigned int FRAME_CONSTANT_BYTES = 64;
+
+// What the renderer would hold, a model's buffers and texture and one pipeline per shader
+struct Scene
+{
+	BufferHandle vertexBuffer;
+	BufferHandle indexBuffer;
+	TextureHandle texture;
+	PipelineHandle pipelines[FRAME_PIPELINES];
+};
+
+struct FrameDriver
+{
+	NullRenderBackendClass null;
+	RenderStateCacheClass cache;
+	ConstantBufferRingClass ring;
+	DrawQueueClass queue;
+	Scene scene;
+};
+
+static bool InitializeDriver(FrameDriver& driver)
+{
+	BufferDesc bufferDesc = { BUFFER_VERTEX, 36 * 32, false, 0 };
+	TextureDesc textureDesc = { 4, 4, 0 };
+	PipelineDesc pipelineDesc = { 0, 0, 0, 0 };
+	unsigned char pixels[4 * 4 * 4];
+	int i;
+
+
+	if(!driver.cache.Initialize(&driver.null)) { return false; }
+	if(!driver.ring.Initialize(&driver.cache, CONSTANT_RING_SIZE, CONSTANT_RING_FRAMES_IN_FLIGHT)) { return false; }
+	if(!driver.queue.Initialize(16384)) { return false; }
+
+	driver.scene.vertexBuffer = driver.cache.CreateBuffer(bufferDesc);
+
+	bufferDesc.type = BUFFER_INDEX;
+	bufferDesc.byteWidth = 36 * 4;
+	driver.scene.indexBuffer = driver.cache.CreateBuffer(bufferDesc);
+
+	memset(pixels, 0x7f, sizeof(pixels));
+	textureDesc.initialData = pixels;
+	driver.scene.texture = driver.cache.CreateTexture(textureDesc);
+
+	for(i=0; i<FRAME_PIPELINES; i++)
+	{
+		driver.scene.pipelines[i] = driver.cache.CreatePipeline(pipelineDesc);
+	}
+
+	return true;
+}
+
+static void ShutdownDriver(FrameDriver& driver)
+{
+	driver.queue.Shutdown();
+	driver.ring.Shutdown();
+	driver.cache.Shutdown();
+	driver.null.Shutdown();
+}
+
+// Queues drawCount draws sorted by pipeline, each with its own constants, then submits them
+static void RunFrame(FrameDriver& driver, int drawCount)
+{
+	DrawPacket packet;
+	float* constants;
+	int i, j;
+
+
+	memset(&packet, 0, sizeof(packet));
+	packet.vertexBuffer = driver.scene.vertexBuffer;
+	packet.indexBuffer = driver.scene.indexBuffer;
+	packet.stride = 32;
+	packet.indexCount = 36;
+	packet.topology = TOPOLOGY_TRIANGLE_LIST;
+	packet.textures[0] = driver.scene.texture;
+	packet.textureCount = 1;
+	packet.vsConstantCount = 1;
+
+	for(i=0; i<drawCount; i++)
+	{
+		packet.pipeline = driver.scene.pipelines[i * FRAME_PIPELINES / drawCount];
+
+		CHECK(driver.ring.Allocate(FRAME_CONSTANT_BYTES, (void**)&constants, packet.vsConstants[0]));
+
+		for(j=0; j<16; j++)
+		{
+			constants[j] = (float)i;
+		}
+
+		driver.queue.Add(packet);
+	}
+
+	CHECK(driver.ring.Commit());
+	driver.queue.Execute(&driver.ring, &driver.cache);
+
+	driver.ring.EndFrame();
+	driver.cache.EndFrame();
+}
+
+// What a frame of 1000 draws reaches the backend as
+static void TestFrame()
+{
+	FrameDriver driver;
+	CHECK(InitializeDriver(driver));
+
+	driver.null.Reset();
+	RunFrame(driver, 1000);
+
+	CHECK(driver.null.GetCallCount(NullRenderBackendClass::COMMAND_DRAW_INDEXED) == 1000);
+	CHECK(driver.null.GetIndexCount() == 36000);
+	CHECK(driver.null.GetCallCount(NullRenderBackendClass::COMMAND_MAP) == 1);
+	CHECK(driver.null.GetBytesUploaded() == 1000 * CONSTANT_RING_ALIGNMENT);
+
+	// Only the pipeline and the constant range change between draws
+	CHECK(driver.null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE) == FRAME_PIPELINES);
+	CHECK(driver.null.GetCallCount(NullRenderBackendClass::COMMAND_VERTEX_BUFFER) == 1);
+	CHECK(driver.null.GetCallCount(NullRenderBackendClass::COMMAND_TEXTURE) == 1);
+	CHECK(driver.null.GetCallCount(NullRenderBackendClass::COMMAND_VS_CONSTANT_BUFFER) == 1000);
+
+	RenderStateStats stats = driver.cache.GetFrameStats();
+	CHECK(stats.issued + stats.filtered == 1000 * 7 + 1);
+
+	// The second frame goes on after the first in the ring, without a discard
+	driver.null.Reset();
+	RunFrame(driver, 1000);
+	CHECK(driver.null.GetCallCount(NullRenderBackendClass::COMMAND_MAP) == 1);
+	CHECK(driver.null.GetCommands().empty());
+
+	ShutdownDriver(driver);
+}
+
+// Keeps a copy of each constant buffer it is given, to check the replay's uploads
+class CapturingBackend : public NullRenderBackendClass
+{
+public:
+	BufferHandle CreateBuffer(const BufferDesc& desc)
+	{
+		BufferHandle handle = NullRenderBackendClass::CreateBuffer(desc);
+
+		if(desc.type == BUFFER_CONSTANT && desc.initialData)
+		{
+			constants.assign((const unsigned char*)desc.initialData, (const unsigned char*)desc.initialData + desc.byteWidth);
+		}
+
+		return handle;
+	}
+
+	std::vector<unsigned char> constants;
+};
+
+static bool IsBind(NullRenderBackendClass::CommandType type)
+{
+	return type == NullRenderBackendClass::COMMAND_PIPELINE || type == NullRenderBackendClass::COMMAND_VERTEX_BUFFER ||
+		type == NullRenderBackendClass::COMMAND_INDEX_BUFFER || type == NullRenderBackendClass::COMMAND_TEXTURE ||
+		type == NullRenderBackendClass::COMMAND_VS_CONSTANT_BUFFER || type == NullRenderBackendClass::COMMAND_PS_CONSTANT_BUFFER;
+}
+
+// A replayed frame binds the target's own resources, never the recording backend's handles
+static void TestReplay()
+{
+	FrameDriver driver;
+	CapturingBackend target;
+	std::set<void*> created, source;
+	unsigned int i;
+	int binds;
+
+
+	CHECK(InitializeDriver(driver));
+
+	driver.null.SetRecording(true);
+	RunFrame(driver, 100);
+
+	for(i=0; i<driver.null.GetCommands().size(); i++)
+	{
+		if(driver.null.GetCommands()[i].handle)
+		{
+			source.insert(driver.null.GetCommands()[i].handle);
+		}
+	}
+
+	target.SetRecording(true);
+	driver.null.Replay(&target);
+
+	const vector<NullRenderBackendClass::RenderCommand>& commands = target.GetCommands();
+	binds = 0;
+
+	for(i=0; i<commands.size(); i++)
+	{
+		if(commands[i].type == NullRenderBackendClass::COMMAND_CREATE_BUFFER || commands[i].type == NullRenderBackendClass::COMMAND_CREATE_TEXTURE ||
+			commands[i].type == NullRenderBackendClass::COMMAND_CREATE_PIPELINE)
+		{
+			created.insert(commands[i].handle);
+		}
+
+		if(IsBind(commands[i].type))
+		{
+			CHECK(created.count(commands[i].handle) == 1);
+			CHECK(source.count(commands[i].handle) == 0);
+			binds++;
+		}
+	}
+
+	CHECK(binds == driver.null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE) + 3 + 100);
+	CHECK(target.GetCallCount(NullRenderBackendClass::COMMAND_DRAW_INDEXED) == 100);
+	CHECK(target.GetIndexCount() == 3600);
+
+	// Every resource made for the replay is destroyed again
+	CHECK(target.GetCallCount(NullRenderBackendClass::COMMAND_CREATE_BUFFER) == target.GetCallCount(NullRenderBackendClass::COMMAND_DESTROY_BUFFER));
+	CHECK(target.GetCallCount(NullRenderBackendClass::COMMAND_CREATE_PIPELINE) == FRAME_PIPELINES);
+	CHECK(target.GetCallCount(NullRenderBackendClass::COMMAND_DESTROY_PIPELINE) == FRAME_PIPELINES);
+
+	// The target's constant buffer starts with what the frame wrote, draw 42's constants at its window
+	CHECK(target.constants.size() == CONSTANT_RING_SIZE);
+	if(target.constants.size() == CONSTANT_RING_SIZE)
+	{
+		float value;
+		memcpy(&value, &target.constants[42 * CONSTANT_RING_ALIGNMENT], sizeof(value));
+		CHECK(value == 42.0f);
+	}
+
+	// A texture destroyed since the recording is bound as null
+	NullRenderBackendClass second;
+	second.SetRecording(true);
+	driver.cache.DestroyTexture(driver.scene.texture);
+	driver.null.Replay(&second);
+
+	for(i=0; i<second.GetCommands().size(); i++)
+	{
+		if(second.GetCommands()[i].type == NullRenderBackendClass::COMMAND_TEXTURE)
+		{
+			CHECK(second.GetCommands()[i].handle == 0);
+		}
+	}
+
+	ShutdownDriver(driver);
+}
+
+// Frames through the whole path, to time the CPU side of submission. Each draw takes 256
+// bytes of the ring and four frames can be in it at once, so 2000 draws is about the most
+// the ring holds.
+static void BenchmarkFrames()
+{
+	FrameDriver driver;
+	const int frames = 500;
+	const int draws = 2000;
+
+	if(!InitializeDriver(driver)) { return; }
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < frames; i++)
+	{
+		RunFrame(driver, draws);
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	ShutdownDriver(driver);
+
+	printf("%d draws a frame: %.3f ms a frame, %.1f ns a draw\n", draws, ms / frames, ms * 1000000.0 / (frames * draws));
+}
+
+int main()
+{
+	TestFrame();
+	TestReplay();
+	BenchmarkFrames();
+
+	return TestResult("NullFrame");
+}
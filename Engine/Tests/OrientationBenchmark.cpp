@@ -0,0 +1,141 @@
+// Times building world matrices for a batch of objects the way BaseObject used to, from Euler
+// angles through three rotation matrices then a scale and a translation each, against
+// SimdMath::BuildWorldMatrices over packed position, quaternion and scale arrays. Checks both
+// give the same matrices.
+//   cl /EHsc /O2 /I.. OrientationBenchmark.cpp
+//   g++ -O2 -msse2 -I.. OrientationBenchmark.cpp
+
+#include "SimdMath.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#define BENCHMARK_OBJECTS 4096
+#define BENCHMARK_REPEATS 500
+
+using namespace SimdMath;
+
+static unsigned int gRandomState = 1;
+
+static float Random()
+{
+	gRandomState = gRandomState * 1664525u + 1013904223u;
+
+	return (gRandomState >> 8) * (1.f / 16777216.f);
+}
+
+// The same matrices as XMMatrixRotationX, Y and Z, for row vectors
+static Matrix RotationX(float angle)
+{
+	float s = std::sin(angle), c = std::cos(angle);
+	Matrix m = Identity();
+	m.r[1] = Set(0.f, c, s, 0.f);
+	m.r[2] = Set(0.f, -s, c, 0.f);
+	return m;
+}
+
+static Matrix RotationY(float angle)
+{
+	float s = std::sin(angle), c = std::cos(angle);
+	Matrix m = Identity();
+	m.r[0] = Set(c, 0.f, -s, 0.f);
+	m.r[2] = Set(s, 0.f, c, 0.f);
+	return m;
+}
+
+static Matrix RotationZ(float angle)
+{
+	float s = std::sin(angle), c = std::cos(angle);
+	Matrix m = Identity();
+	m.r[0] = Set(c, s, 0.f, 0.f);
+	m.r[1] = Set(-s, c, 0.f, 0.f);
+	return m;
+}
+
+// What TransformRotation and UpdateTransform did for an object without a parent
+static void BuildEulerMatrices(const Float3* pPositions, const Float3* pAngles, const Float3* pScales, unsigned int count,
+	Float4x4* pWorlds)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		Matrix rotation = Identity();
+		if (pAngles[i].z != 0.f) { rotation = Multiply(rotation, RotationZ(pAngles[i].z)); }
+		if (pAngles[i].y != 0.f) { rotation = Multiply(rotation, RotationY(pAngles[i].y)); }
+		if (pAngles[i].x != 0.f) { rotation = Multiply(rotation, RotationX(pAngles[i].x)); }
+
+		Matrix frame = Multiply(rotation, Translation(pPositions[i].x, pPositions[i].y, pPositions[i].z));
+		pWorlds[i] = StoreMatrix(Multiply(Scaling(pScales[i].x, pScales[i].y, pScales[i].z), frame));
+	}
+}
+
+static double Since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool MatricesMatch(const Float4x4* pA, const Float4x4* pB, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		for (int r = 0; r < 4; r++) {
+			for (int c = 0; c < 4; c++) {
+				float tolerance = r == 3 ? 1e-3f : 1e-5f;
+				if (std::fabs(pA[i].m[r][c] - pB[i].m[r][c]) > tolerance) { return false; }
+			}
+		}
+	}
+
+	return true;
+}
+
+int main()
+{
+	const unsigned int count = BENCHMARK_OBJECTS;
+	std::vector<Float3> positions(count), angles(count), scales(count);
+	std::vector<Float4> orientations(count);
+	std::vector<Float4x4> eulerWorlds(count), worlds(count), frames(count);
+	double ns;
+
+	for (unsigned int i = 0; i < count; i++) {
+		positions[i] = Float3(Random() * 1000.f, Random() * 100.f, Random() * 1000.f);
+		angles[i] = Float3(Random() * 6.f - 3.f, Random() * 6.f - 3.f, Random() * 6.f - 3.f);
+		scales[i] = Float3(0.5f + Random(), 0.5f + Random(), 0.5f + Random());
+	}
+
+	// The old path
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++) {
+		BuildEulerMatrices(&positions[0], &angles[0], &scales[0], count, &eulerWorlds[0]);
+	}
+	ns = Since(start) * 1000000.0 / ((double)BENCHMARK_REPEATS * count);
+	printf("euler angles, three rotation matrices: %.1f ns an object\n", ns);
+
+	// Objects whose Euler angles changed, folded into quaternions then built in one pass
+	start = std::chrono::steady_clock::now();
+	for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++) {
+		for (unsigned int i = 0; i < count; i++) {
+			orientations[i] = Store4(QuaternionFromEuler(angles[i]));
+		}
+		BuildWorldMatrices(&positions[0], &orientations[0], &scales[0], count, &worlds[0], &frames[0]);
+	}
+	ns = Since(start) * 1000000.0 / ((double)BENCHMARK_REPEATS * count);
+	printf("quaternion from euler plus batch build: %.1f ns an object\n", ns);
+
+	CHECK(MatricesMatch(&eulerWorlds[0], &worlds[0], count));
+
+	// Objects that already hold a quaternion, SetOrientation and DirectionOrientation
+	start = std::chrono::steady_clock::now();
+	for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++) {
+		BuildWorldMatrices(&positions[0], &orientations[0], &scales[0], count, &worlds[0], &frames[0]);
+	}
+	ns = Since(start) * 1000000.0 / ((double)BENCHMARK_REPEATS * count);
+	printf("batch build only: %.1f ns an object\n", ns);
+
+	CHECK(MatricesMatch(&eulerWorlds[0], &worlds[0], count));
+
+	// The frame is the world without the scale, and a count that is not a multiple of four is fine
+	CHECK(std::fabs(frames[5].m[0][0] * scales[5].x - worlds[5].m[0][0]) < 1e-5f);
+	BuildWorldMatrices(&positions[0], &orientations[0], &scales[0], 7, &worlds[0], 0);
+	CHECK(MatricesMatch(&eulerWorlds[0], &worlds[0], 7));
+
+	return TestResult("OrientationBenchmark");
+}
@@ -0,0 +1,188 @@
+// Times full pools of particles through what a frame does to them, with no device: the SSE
+// integrate and age kernel and the swap-remove of expired particles at 100k, and the depth
+// sort and expansion to vertices from 10k up to 100k. Checks the pool stays consistent while
+// it does.
+//   cl /EHsc /O2 /I.. ParticlePoolBenchmark.cpp ..\ParticlePool.cpp ..\ParticleExpand.cpp ..\RadixSort.cpp
+//   g++ -O2 -msse2 -I.. ParticlePoolBenchmark.cpp ../ParticlePool.cpp ../ParticleExpand.cpp ../RadixSort.cpp
+
+#include "ParticlePool.h"
+#include "ParticleExpand.h"
+#include "RadixSort.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#define BENCHMARK_CAPACITY 100000
+#define BENCHMARK_STEPS 200
+#define BENCHMARK_DELTA (1.f / 60.f)
+
+static unsigned int gRandomState = 1;
+
+static float Random()
+{
+	gRandomState = gRandomState * 1664525u + 1013904223u;
+
+	return (gRandomState >> 8) * (1.f / 16777216.f);
+}
+
+// Fills the rest of the pool, each particle living between minLifetime and maxLifetime
+static void Fill(ParticlePool& pool, unsigned int* pOwnerCounts, float minLifetime, float maxLifetime)
+{
+	unsigned int first, count, i;
+
+	count = pool.Allocate(pool.GetCapacity() - pool.GetCount(), 0, first);
+	pOwnerCounts[0] += count;
+
+	for (i = first; i < first + count; i++) {
+		pool.GetPositionX()[i] = Random() * 1000.f;
+		pool.GetPositionY()[i] = Random() * 100.f;
+		pool.GetPositionZ()[i] = Random() * 1000.f;
+		pool.GetVelocityX()[i] = Random() * 2.f - 1.f;
+		pool.GetVelocityY()[i] = Random() * 4.f;
+		pool.GetVelocityZ()[i] = Random() * 2.f - 1.f;
+		pool.GetLifetime()[i] = minLifetime + (maxLifetime - minLifetime) * Random();
+		pool.GetScale()[i] = 1.f;
+		pool.GetEndScale()[i] = 3.f;
+	}
+}
+
+static double Since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nothing expires, so this is the integrate and age kernel alone
+static void BenchmarkIntegrate()
+{
+	ParticlePool pool;
+	unsigned int ownerCount = 0;
+	float x;
+	int step;
+
+	CHECK(pool.Initialize(BENCHMARK_CAPACITY));
+	Fill(pool, &ownerCount, 1000.f, 1000.f);
+	CHECK(pool.GetCount() == BENCHMARK_CAPACITY);
+
+	x = pool.GetPositionX()[0] + pool.GetVelocityX()[0] * BENCHMARK_DELTA * BENCHMARK_STEPS;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (step = 0; step < BENCHMARK_STEPS; step++) {
+		pool.Update(BENCHMARK_DELTA, &ownerCount);
+	}
+
+	double ms = Since(start);
+
+	CHECK(pool.GetCount() == BENCHMARK_CAPACITY);
+	CHECK(ownerCount == BENCHMARK_CAPACITY);
+	CHECK(pool.GetPositionX()[0] > x - 0.01f && pool.GetPositionX()[0] < x + 0.01f);
+
+	printf("integrate %d: %.3f ms a step, %.2f ns a particle\n", BENCHMARK_CAPACITY, ms / BENCHMARK_STEPS,
+		ms * 1000000.0 / ((double)BENCHMARK_STEPS * BENCHMARK_CAPACITY));
+}
+
+// Lifetimes spread over up to a second so a few percent expire each step, and the pool is
+// topped back up between steps outside the timing
+static void BenchmarkRemove()
+{
+	ParticlePool pool;
+	unsigned int ownerCount = 0;
+	unsigned int removed = 0;
+	unsigned int before, i;
+	bool valid;
+	int step;
+	double ms = 0.0;
+
+	CHECK(pool.Initialize(BENCHMARK_CAPACITY));
+	Fill(pool, &ownerCount, 0.f, 1.f);
+
+	for (step = 0; step < BENCHMARK_STEPS; step++) {
+		before = pool.GetCount();
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		pool.Update(BENCHMARK_DELTA, &ownerCount);
+		ms += Since(start);
+
+		removed += before - pool.GetCount();
+		CHECK(ownerCount == pool.GetCount());
+
+		Fill(pool, &ownerCount, 0.f, 1.f);
+	}
+
+	// Every particle left is still alive
+	valid = true;
+	for (i = 0; i < pool.GetCount(); i++) {
+		valid = valid && pool.GetAge()[i] < pool.GetLifetime()[i];
+	}
+	CHECK(valid);
+	CHECK(removed > 0);
+
+	printf("integrate and remove %d: %.3f ms a step, %u removed a step\n", BENCHMARK_CAPACITY, ms / BENCHMARK_STEPS,
+		removed / BENCHMARK_STEPS);
+}
+
+// Depth keys and sort as ParticleSystem::SortParticles does them, then the quads in that order,
+// for a frame's worth of particles
+static void BenchmarkSortExpand(unsigned int capacity)
+{
+	ParticlePool pool;
+	RadixSort sort;
+	unsigned int ownerCount = 0;
+	unsigned int count, i;
+	const unsigned int* pOrder;
+	int step;
+	double sortMs = 0.0;
+	double expandMs = 0.0;
+
+	CHECK(pool.Initialize(capacity));
+	Fill(pool, &ownerCount, 1000.f, 1000.f);
+	count = pool.GetCount();
+
+	std::vector<float> depths(count);
+	std::vector<unsigned short> keys(count);
+	std::vector<float> halfSizes(count);
+	std::vector<ParticleVertex> vertices(count * PARTICLE_VERTICES);
+	sort.Reserve(count);
+
+	for (i = 0; i < count; i++) {
+		halfSizes[i] = pool.GetScale()[i];
+	}
+
+	for (step = 0; step < BENCHMARK_STEPS; step++) {
+		pool.Update(BENCHMARK_DELTA);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		ComputeDepthKeys(pool.GetPositionX(), pool.GetPositionY(), pool.GetPositionZ(), count, 0.6f, 0.f, 0.8f, 0.f,
+			&depths[0], &keys[0]);
+		pOrder = sort.Sort(&keys[0], count);
+		sortMs += Since(start);
+
+		start = std::chrono::steady_clock::now();
+		ExpandParticles(&vertices[0], pOrder, count, pool.GetPositionX(), pool.GetPositionY(), pool.GetPositionZ(), &halfSizes[0]);
+		expandMs += Since(start);
+	}
+
+	// The depths match the scalar sum and the first quad drawn belongs to the furthest particle
+	CHECK(fabsf(depths[count - 1] - (pool.GetPositionX()[count - 1] * 0.6f + pool.GetPositionZ()[count - 1] * 0.8f)) < 0.01f);
+	CHECK(keys[pOrder[0]] <= keys[pOrder[count - 1]]);
+	CHECK(vertices[0].position.y == pool.GetPositionY()[pOrder[0]]);
+	CHECK(vertices[(count - 1) * PARTICLE_VERTICES + 11].texture.x == 1.f);
+
+	printf("sort %u: %.3f ms a frame, expand %u: %.3f ms a frame, %.1f MB of vertices\n", count, sortMs / BENCHMARK_STEPS,
+		count, expandMs / BENCHMARK_STEPS, vertices.size() * sizeof(ParticleVertex) / (1024.0 * 1024.0));
+}
+
+int main()
+{
+	const unsigned int sizes[4] = { 10000, 25000, 50000, 100000 };
+
+	BenchmarkIntegrate();
+	BenchmarkRemove();
+
+	for (int i = 0; i < 4; i++) {
+		BenchmarkSortExpand(sizes[i]);
+	}
+
+	return TestResult("ParticlePoolBenchmark");
+}
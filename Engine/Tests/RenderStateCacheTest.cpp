@@ -0,0 +1,154 @@
+// Standalone test of RenderStateCacheClass in front of the null backend, needs no device.
+//   cl /EHsc /I.. RenderStateCacheTest.cpp ..\renderstatecacheclass.cpp ..\nullrenderbackendclass.cpp
+//   g++ -I.. RenderStateCacheTest.cpp ../renderstatecacheclass.cpp ../nullrenderbackendclass.cpp
+
+#include "renderstatecacheclass.h"
+#include "nullrenderbackendclass.h"
+#include "TestCheck.h"
+
+struct Resources
+{
+	BufferHandle vertexBuffer;
+	BufferHandle indexBuffer;
+	BufferHandle constantBuffer;
+	TextureHandle texture;
+	PipelineHandle pipeline;
+};
+
+static Resources CreateResources(RenderBackendClass* backend)
+{
+	Resources resources;
+	BufferDesc bufferDesc = { BUFFER_VERTEX, 1024, false, 0 };
+	TextureDesc textureDesc = { 4, 4, 0 };
+	PipelineDesc pipelineDesc = { 0, 0, 0, 0 };
+
+	resources.vertexBuffer = backend->CreateBuffer(bufferDesc);
+
+	bufferDesc.type = BUFFER_INDEX;
+	resources.indexBuffer = backend->CreateBuffer(bufferDesc);
+
+	bufferDesc.type = BUFFER_CONSTANT;
+	bufferDesc.dynamic = true;
+	resources.constantBuffer = backend->CreateBuffer(bufferDesc);
+
+	resources.texture = backend->CreateTexture(textureDesc);
+	resources.pipeline = backend->CreatePipeline(pipelineDesc);
+
+	return resources;
+}
+
+// The seven binds a queued draw makes
+static void BindDraw(RenderBackendClass* backend, const Resources& resources, unsigned int firstConstant)
+{
+	backend->SetRenderFlags(0);
+	backend->SetVertexBuffer(resources.vertexBuffer, 32, 0);
+	backend->SetIndexBuffer(resources.indexBuffer);
+	backend->SetTopology(TOPOLOGY_TRIANGLE_LIST);
+	backend->SetPipeline(resources.pipeline);
+	backend->SetTexture(0, resources.texture);
+	backend->SetVSConstantBuffer(0, resources.constantBuffer, firstConstant, 16);
+	backend->DrawIndexed(36, 0);
+}
+
+// The same draw bound ten times issues each bind once and filters the rest
+static void TestRepeatedBinds()
+{
+	NullRenderBackendClass null;
+	RenderStateCacheClass cache;
+	CHECK(cache.Initialize(&null));
+
+	Resources resources = CreateResources(&cache);
+
+	for (int i = 0; i < 10; i++) {
+		BindDraw(&cache, resources, 0);
+	}
+
+	cache.EndFrame();
+	RenderStateStats stats = cache.GetFrameStats();
+	CHECK(stats.issued == 7);
+	CHECK(stats.filtered == 63);
+
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE) == 1);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_VERTEX_BUFFER) == 1);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_TEXTURE) == 1);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_VS_CONSTANT_BUFFER) == 1);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_DRAW_INDEXED) == 10);
+}
+
+// A constant buffer bound at a new offset is a different bind, everything else is filtered
+static void TestChangedRange()
+{
+	NullRenderBackendClass null;
+	RenderStateCacheClass cache;
+	CHECK(cache.Initialize(&null));
+
+	Resources resources = CreateResources(&cache);
+
+	for (unsigned int i = 0; i < 10; i++) {
+		BindDraw(&cache, resources, i * 16);
+	}
+
+	cache.EndFrame();
+	RenderStateStats stats = cache.GetFrameStats();
+	CHECK(stats.issued == 7 + 9);
+	CHECK(stats.filtered == 6 * 9);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_VS_CONSTANT_BUFFER) == 10);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE) == 1);
+}
+
+// After Invalidate every bind is issued again, even one that matches the cleared value
+static void TestInvalidate()
+{
+	NullRenderBackendClass null;
+	RenderStateCacheClass cache;
+	CHECK(cache.Initialize(&null));
+
+	Resources resources = CreateResources(&cache);
+
+	BindDraw(&cache, resources, 0);
+	BindDraw(&cache, resources, 0);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE) == 1);
+
+	cache.Invalidate();
+	BindDraw(&cache, resources, 0);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE) == 2);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_RENDER_FLAGS) == 2);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_VS_CONSTANT_BUFFER) == 2);
+
+	// A null texture is the cleared value, but the first bind after Invalidate still goes through
+	cache.Invalidate();
+	cache.SetTexture(1, 0);
+	cache.SetTexture(1, 0);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_TEXTURE) == 3);
+
+	// Destroying a resource forgets what was bound, as a new one could reuse the handle
+	BindDraw(&cache, resources, 0);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_TEXTURE) == 4);
+	int pipelineBinds = null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE);
+	cache.DestroyTexture(resources.texture);
+	BindDraw(&cache, resources, 0);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_PIPELINE) == pipelineBinds + 1);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_TEXTURE) == 5);
+
+	// Slots past the cached ones are always passed through
+	cache.SetTexture(STATE_CACHE_SLOTS, 0);
+	cache.SetTexture(STATE_CACHE_SLOTS, 0);
+	CHECK(null.GetCallCount(NullRenderBackendClass::COMMAND_TEXTURE) == 7);
+
+	// The frame's counts move to the frame stats and start again
+	cache.EndFrame();
+	BindDraw(&cache, resources, 0);
+	cache.EndFrame();
+	RenderStateStats stats = cache.GetFrameStats();
+	CHECK(stats.issued == 7);
+	CHECK(stats.filtered == 0);
+}
+
+int main()
+{
+	TestRepeatedBinds();
+	TestChangedRange();
+	TestInvalidate();
+
+	return TestResult("RenderStateCache");
+}
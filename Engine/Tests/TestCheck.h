@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+
+// Checks for the standalone tests. Each test is a console program of its own that
+// carries on past a failed check and returns how many failed, so 0 is a pass.
+static int gTestFailures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+			gTestFailures++; \
+		} \
+	} while (0)
+
+static int TestResult(const char* name)
+{
+	if (gTestFailures == 0) {
+		printf("%s: passed\n", name);
+	}
+	else {
+		printf("%s: %d checks failed\n", name, gTestFailures);
+	}
+
+	return gTestFailures;
+}
@@ -0,0 +1,129 @@
+// Standalone test of UniformRingAllocator, needs no device.
+//   cl /EHsc /I.. UniformRingAllocatorTest.cpp ..\UniformRingAllocator.cpp
+//   g++ -I.. UniformRingAllocatorTest.cpp ../UniformRingAllocator.cpp
+
+#include "UniformRingAllocator.h"
+#include "TestCheck.h"
+
+// Every offset handed out is a multiple of the alignment, whatever size was asked for
+static void TestAlignment()
+{
+	UniformRingAllocator ring;
+	CHECK(ring.Initialize(64 * 1024, 256, 3));
+
+	unsigned int offset = 0;
+	for (unsigned int size = 1; size <= 600; size += 7) {
+		CHECK(ring.Allocate(size, offset));
+		CHECK(offset % 256 == 0);
+	}
+
+	// Sizes are rounded up to the alignment
+	CHECK(ring.GetUsed() % 256 == 0);
+
+	// Not a power of two, or a capacity that is not a multiple of the alignment
+	UniformRingAllocator bad;
+	CHECK(!bad.Initialize(4096, 100, 3));
+	CHECK(!bad.Initialize(4000, 256, 3));
+	CHECK(!bad.Initialize(4096, 256, 0));
+}
+
+// A frame's bytes stay reserved until three newer frames have ended
+static void TestRetirement()
+{
+	UniformRingAllocator ring;
+	CHECK(ring.Initialize(4096, 256, 3));
+
+	unsigned int offset = 0;
+	CHECK(ring.Allocate(1024, offset));
+	ring.EndFrame();
+
+	ring.EndFrame();
+	ring.EndFrame();
+	CHECK(ring.GetUsed() == 1024);
+
+	ring.EndFrame();
+	CHECK(ring.GetUsed() == 0);
+	CHECK(ring.GetFrameBytes() == 0);
+}
+
+// An allocation that would run past the end of the ring starts again at zero instead
+// of being split, and the skipped bytes stay used until its frame retires
+static void TestWrap()
+{
+	UniformRingAllocator ring;
+	CHECK(ring.Initialize(4096, 256, 3));
+
+	unsigned int offset = 0;
+	CHECK(ring.Allocate(2048, offset));
+	CHECK(offset == 0);
+	ring.EndFrame();
+
+	CHECK(ring.Allocate(1024, offset));
+	CHECK(offset == 2048);
+	ring.EndFrame();
+
+	// Retires the first frame only, leaving [2048, 3072) in use
+	ring.EndFrame();
+	ring.EndFrame();
+	CHECK(ring.GetUsed() == 1024);
+
+	// 1536 does not fit in the 1024 left before the end, so it goes at 0
+	CHECK(ring.Allocate(1536, offset));
+	CHECK(offset == 0);
+	CHECK(offset + 1536 <= ring.GetCapacity());
+	CHECK(ring.GetHead() == 1536);
+	CHECK(ring.GetUsed() == 1024 + 1024 + 1536);
+
+	// Once everything retires the whole ring is free again
+	ring.EndFrame();
+	ring.EndFrame();
+	ring.EndFrame();
+	ring.EndFrame();
+	CHECK(ring.GetUsed() == 0);
+}
+
+// A full ring refuses allocations until frames retire or it is reset, then starts over
+static void TestFull()
+{
+	UniformRingAllocator ring;
+	CHECK(ring.Initialize(4096, 256, 3));
+
+	unsigned int offset = 0;
+	CHECK(!ring.Allocate(4096 + 1, offset));
+
+	for (int i = 0; i < 16; i++) {
+		CHECK(ring.Allocate(256, offset));
+		CHECK(offset == (unsigned int)i * 256);
+	}
+
+	CHECK(ring.GetUsed() == 4096);
+	CHECK(!ring.Allocate(1, offset));
+
+	// Still full while the frame is in flight
+	ring.EndFrame();
+	ring.EndFrame();
+	ring.EndFrame();
+	CHECK(!ring.Allocate(1, offset));
+
+	ring.EndFrame();
+	CHECK(ring.Allocate(256, offset));
+	CHECK(offset == 0);
+
+	// Reset frees everything at once, as after the buffer is discarded
+	CHECK(ring.Allocate(2048, offset));
+	ring.Reset();
+	CHECK(ring.GetUsed() == 0);
+	CHECK(ring.GetHead() == 0);
+	CHECK(ring.Allocate(4096, offset));
+	CHECK(offset == 0);
+}
+
+int main()
+{
+	TestAlignment();
+	TestRetirement();
+	TestWrap();
+	TestFull();
+
+	return TestResult("UniformRingAllocator");
+}
@@ -0,0 +1,123 @@
+#include "TextFormatter.h"
+
+TextFormatter::TextFormatter()
+{
+	Clear();
+}
+
+void TextFormatter::Clear()
+{
+	mLength = 0;
+	mBuffer[0] = 0;
+}
+
+TextFormatter& TextFormatter::Append(const char* text)
+{
+	while (*text) {
+		AppendChar(*text++);
+	}
+
+	return *this;
+}
+
+TextFormatter& TextFormatter::Append(int value)
+{
+	if (value < 0) {
+		AppendChar('-');
+		AppendUnsigned(0u - (unsigned int)value);
+	}
+	else {
+		AppendUnsigned((unsigned int)value);
+	}
+
+	return *this;
+}
+
+TextFormatter& TextFormatter::Append(float value, int decimals)
+{
+	unsigned int whole, fraction, scale;
+	int i;
+
+	// NaN fails every comparison
+	if (!(value == value)) {
+		return Append("nan");
+	}
+
+	if (value < 0.f) {
+		AppendChar('-');
+		value = -value;
+	}
+
+	if (value >= 4294967040.f) {
+		return Append("inf");
+	}
+
+	if (decimals < 0) {
+		decimals = 0;
+	}
+	else if (decimals > 6) {
+		decimals = 6;
+	}
+
+	scale = 1;
+	for (i = 0; i < decimals; i++) {
+		scale *= 10;
+	}
+
+	// Round at the last printed digit, carrying into the whole part if needed
+	whole = (unsigned int)value;
+	fraction = (unsigned int)((value - (float)whole) * scale + 0.5f);
+
+	if (fraction >= scale) {
+		whole++;
+		fraction -= scale;
+	}
+
+	AppendUnsigned(whole);
+
+	if (decimals > 0) {
+		AppendChar('.');
+
+		// Leading zeros of the fraction
+		for (scale /= 10; scale > 1 && fraction < scale; scale /= 10) {
+			AppendChar('0');
+		}
+
+		AppendUnsigned(fraction);
+	}
+
+	return *this;
+}
+
+const char* TextFormatter::GetText()
+{
+	return mBuffer;
+}
+
+int TextFormatter::GetLength()
+{
+	return mLength;
+}
+
+void TextFormatter::AppendChar(char c)
+{
+	if (mLength < TEXT_FORMATTER_SIZE - 1) {
+		mBuffer[mLength++] = c;
+		mBuffer[mLength] = 0;
+	}
+}
+
+void TextFormatter::AppendUnsigned(unsigned int value)
+{
+	char digits[10];
+	int count = 0;
+
+	do {
+		digits[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	while (count > 0) {
+		AppendChar(digits[--count]);
+	}
+}
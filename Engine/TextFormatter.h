@@ -0,0 +1,27 @@
+#pragma once
+
+#define TEXT_FORMATTER_SIZE 512
+
+// Builds a line of text in a fixed buffer without touching the heap, for HUD
+// strings that are rebuilt every frame. Anything past the end of the buffer is dropped.
+class TextFormatter
+{
+public:
+	TextFormatter();
+
+	void Clear();
+
+	TextFormatter& Append(const char* text);
+	TextFormatter& Append(int value);
+	TextFormatter& Append(float value, int decimals = 2);
+
+	const char* GetText();
+	int GetLength();
+
+private:
+	void AppendChar(char c);
+	void AppendUnsigned(unsigned int value);
+
+	char mBuffer[TEXT_FORMATTER_SIZE];
+	int mLength;
+};
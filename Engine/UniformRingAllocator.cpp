@@ -0,0 +1,148 @@
+#include "UniformRingAllocator.h"
+
+UniformRingAllocator::UniformRingAllocator()
+{
+	mCapacity = 0;
+	mAlignment = 1;
+	mFramesInFlight = 1;
+
+	Reset();
+}
+
+UniformRingAllocator::~UniformRingAllocator()
+{
+}
+
+bool UniformRingAllocator::Initialize(unsigned int capacity, unsigned int alignment, unsigned int framesInFlight)
+{
+	// Alignment must be a power of two and the capacity a multiple of it
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		return false;
+	}
+
+	if (capacity == 0 || capacity % alignment != 0 || framesInFlight == 0) {
+		return false;
+	}
+
+	mCapacity = capacity;
+	mAlignment = alignment;
+	mFramesInFlight = framesInFlight;
+
+	Reset();
+
+	return true;
+}
+
+void UniformRingAllocator::Shutdown()
+{
+	mCapacity = 0;
+
+	Reset();
+}
+
+bool UniformRingAllocator::Allocate(unsigned int size, unsigned int& offset)
+{
+	if (size == 0 || mCapacity == 0) {
+		return false;
+	}
+
+	// Round the request up so the next allocation stays aligned
+	unsigned int alignedSize = (size + mAlignment - 1) & ~(mAlignment - 1);
+	if (alignedSize > mCapacity) {
+		return false;
+	}
+
+	unsigned int free = mCapacity - mUsed;
+	unsigned int consumed = alignedSize;
+
+	// The used region runs from tail to head, modulo capacity. If the block does not fit
+	// before the end of the ring, skip the remainder and start again at zero.
+	if (mHead >= mTail || mUsed == 0) {
+		unsigned int untilEnd = mCapacity - mHead;
+
+		if (alignedSize > untilEnd) {
+			consumed = untilEnd + alignedSize;
+		}
+	}
+
+	if (consumed > free) {
+		return false;
+	}
+
+	if (consumed != alignedSize) {
+		mHead = 0;
+	}
+
+	offset = mHead;
+
+	mHead += alignedSize;
+	if (mHead == mCapacity) {
+		mHead = 0;
+	}
+
+	mUsed += consumed;
+	mFrameBytes += consumed;
+	mTotalAllocated += consumed;
+
+	return true;
+}
+
+void UniformRingAllocator::EndFrame()
+{
+	mFrameSizes.push_back(mFrameBytes);
+	mFrameBytes = 0;
+
+	// Retire frames the GPU can no longer be reading from
+	while (mFrameSizes.size() > mFramesInFlight) {
+		unsigned int retired = mFrameSizes.front();
+		mFrameSizes.erase(mFrameSizes.begin());
+
+		mTail = (mTail + retired) % mCapacity;
+		mUsed -= retired;
+	}
+
+	if (mUsed == 0) {
+		mTail = mHead;
+	}
+}
+
+void UniformRingAllocator::Reset()
+{
+	mHead = 0;
+	mTail = 0;
+	mUsed = 0;
+	mFrameBytes = 0;
+	mTotalAllocated = 0;
+
+	mFrameSizes.clear();
+}
+
+unsigned int UniformRingAllocator::GetCapacity()
+{
+	return mCapacity;
+}
+
+unsigned int UniformRingAllocator::GetAlignment()
+{
+	return mAlignment;
+}
+
+unsigned int UniformRingAllocator::GetUsed()
+{
+	return mUsed;
+}
+
+unsigned int UniformRingAllocator::GetHead()
+{
+	return mHead;
+}
+
+unsigned int UniformRingAllocator::GetFrameBytes()
+{
+	return mFrameBytes;
+}
+
+unsigned long long UniformRingAllocator::GetTotalAllocated()
+{
+	return mTotalAllocated;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+// Linear allocator over a fixed size ring of bytes, used to hand out aligned
+// regions of a large constant buffer. Memory written in a frame stays reserved
+// until that frame has been retired, which happens once mFramesInFlight newer
+// frames have been ended. All offsets are in bytes from the start of the ring.
+class UniformRingAllocator
+{
+public:
+	UniformRingAllocator();
+	~UniformRingAllocator();
+
+	bool Initialize(unsigned int capacity, unsigned int alignment, unsigned int framesInFlight);
+	void Shutdown();
+
+	// Reserves size bytes, returns false if the ring has no room left this frame
+	bool Allocate(unsigned int size, unsigned int& offset);
+
+	// Closes the current frame and retires the oldest one if enough frames are in flight
+	void EndFrame();
+
+	// Frees everything, used after the backing buffer has been discarded
+	void Reset();
+
+	unsigned int GetCapacity();
+	unsigned int GetAlignment();
+	unsigned int GetUsed();
+	unsigned int GetHead();
+	unsigned int GetFrameBytes();
+	unsigned long long GetTotalAllocated();
+
+private:
+	unsigned int mCapacity;
+	unsigned int mAlignment;
+	unsigned int mFramesInFlight;
+
+	unsigned int mHead;
+	unsigned int mTail;
+	unsigned int mUsed;
+	unsigned int mFrameBytes;
+	unsigned long long mTotalAllocated;
+
+	// Bytes consumed by each frame still in flight, oldest first
+	std::vector<unsigned int> mFrameSizes;
+};
@@ -8,6 +8,12 @@
 #include "Missile.h"
 #include "graphicsclass.h"
 #include "ParticleSystem.h"
+#include "MathUtil.h"
+#include "JobSystem.h"
+#include "HitResult.h"
+#include "CityTraffic.h"
+#include <algorithm>
+#include <cmath>
 /**
 	NIEE2211 - Computer Games Studio 2
 
@@ -84,14 +90,36 @@ World::World()
 	mCameraMovementEnabled = true;
 	ModelCache = std::map<const char*, BumpModelClass*>();
 	pGraphicsClass = NULL;
+	pParticleSystem = NULL;
+	ParticleCapacity = PARTICLE_DEFAULT_CAPACITY;
+
+	// One worker per hardware thread, the calling thread is worker 0 and helps while it waits on jobs.
+	// Created first as the city is generated on it.
+	pJobSystem = new JobSystem();
+	pJobSystem->Initialize();
 
 	CurrentID = 0;
+	pPlayerShip = NULL;
+	mStaticMaxWidth = 0.f;
+
+	// Stands in for the city's static boxes in contacts, it is never added to the world
+	pStaticObject = new BaseObject("Building", NULL, NULL, NULL);
+	pStaticObject->mStatic = true;
 	Objects = new std::vector<BaseObject*>();
+	mTransformOrderDirty = true;
+	mTransformRootCount = 0;
+	mSimulationTime = 0.0;
+	mNarrowphaseTask = -1;
+	mIntegrateTask = -1;
+	mUpdateTask = -1;
+	mStepDelta = 0.f;
+	mTextCount = 0;
 	pLightingOrigin = 0;
 	pLightingAngle = new XMFLOAT3(0.6f,-1.f,0.7f); // RIGHT, UP, FRONT
 
 	pCameraPosition = new XMFLOAT3(0.f, 0.f, -10.f);
 	pCameraAngle = new XMFLOAT3(0.f, 0.f, 0.f);
+	mPreviousCameraPosition = *pCameraPosition;
 	pSkySphereMaterial = L"../Engine/data/skysphere1.dds";
 
 	StellarBody* SkySphere = CreateObject<StellarBody>("Test planet 1", "../Engine/data/sphere_hd.obj", L"../Engine/data/sky/clouds1.dds", L"../Engine/data/sun.dds");
@@ -140,6 +168,7 @@ World::World()
 	pGenerator->CrossRoadsModel = "../Engine/data/city/roads/road_2_lane_x.obj";
 	pGenerator->CrossRoadsMaterial = L"../Engine/data/city/roads/road_2_lane_x.dds";
 
+	pGenerator->Streaming = true;
 	pGenerator->mActive = true;
 	pGenerator->GenerateWorld(this);
 
@@ -152,16 +181,40 @@ World::World()
 
 World::~World()
 {
+	// Before the job system, blocks may still be generating on it
+	delete pCityGenerator;
+	pCityGenerator = NULL;
+
+	if (pJobSystem != NULL) {
+		pJobSystem->Shutdown();
+		delete pJobSystem;
+		pJobSystem = NULL;
+	}
+
+	delete pStaticObject;
+
+	for (int i = 0; i < Objects->size(); i++) {
+		delete (*Objects)[i];
+	}
 	delete Objects;
+
+	for (int i = 0; i < mDestroyedObjects.size(); i++) {
+		delete mDestroyedObjects[i];
+	}
 }
 
 void World::PostInitialized()
 {
+	BuildStepGraph();
+
 	pParticleSystem = new ParticleSystem();
 	pParticleSystem->pD3D = pGraphicsClass->m_D3D;
-	pParticleSystem->Initialize();
+	pParticleSystem->pBackend = pGraphicsClass->m_ShaderManager->GetBackend();
+	pParticleSystem->Initialize(ParticleCapacity);
 
 	CacheModel("../Engine/data/missile/missile.obj", L"../Engine/data/missile/missile.dds", L"../Engine/data/missile/missile.dds");
+
+	pCityGenerator->LoadModels(this);
 }
 
 std::vector<BaseObject*>* World::GetObjects()
@@ -169,7 +222,102 @@ std::vector<BaseObject*>* World::GetObjects()
 	return Objects;
 }
 
-// Remove an object from the world
+void World::AddObject(BaseObject* pObject)
+{
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->AddObject(pObject);
+		return;
+	}
+
+	pObject->ID = CurrentID;
+	CurrentID++;
+
+	// Add to object array & call create functions
+	Objects->push_back(pObject);
+	mTransformOrderDirty = true;
+
+	pObject->OnCreate();
+}
+
+void World::AddScore(int amount)
+{
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->AddScore(amount);
+		return;
+	}
+
+	mScore += amount;
+}
+
+// Health does not go below zero
+void World::Damage(int amount)
+{
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->Damage(amount);
+		return;
+	}
+
+	mHealth -= amount;
+	if (mHealth < 0) {
+		mHealth = 0;
+	}
+}
+
+// Placing the camera takes it away from the free camera controls
+void World::SetCameraPosition(XMFLOAT3 position)
+{
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->SetCameraPosition(position);
+		return;
+	}
+
+	*pCameraPosition = position;
+	mCameraMovementEnabled = false;
+}
+
+void World::RenderText(const char* text)
+{
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->RenderText(text);
+		return;
+	}
+
+	// Text past the sentences the HUD has spare is dropped
+	if (mTextCount < TEXT_SENTENCE_COUNT - 1) {
+		strncpy_s(mText[mTextCount], text, _TRUNCATE);
+		mTextCount++;
+	}
+}
+
+// The emitter's index is written to pEmitter once it exists
+void World::CreateEmitter(const ParticleEmitterDesc& desc, XMFLOAT3 position, int* pEmitter)
+{
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->CreateEmitter(desc, position, pEmitter);
+		return;
+	}
+
+	*pEmitter = pParticleSystem->CreateEmitter(desc, position);
+}
+
+void World::SetEmitterPosition(int emitter, XMFLOAT3 position)
+{
+	WorldCommandBuffer* pCommands = WorldCommandBuffer::GetCurrent();
+	if (pCommands) {
+		pCommands->SetEmitterPosition(emitter, position);
+		return;
+	}
+
+	pParticleSystem->SetEmitterPosition(emitter, position);
+}
+
+// Remove an object from the world. It stays allocated until the world is deleted.
 
 void World::DestroyObject(BaseObject* pObject)
 {
@@ -177,8 +325,11 @@ void World::DestroyObject(BaseObject* pObject)
 	std::vector<BaseObject*>::iterator index = std::find(Objects->begin(), Objects->end(), pObject);
 	if (index != Objects->end()) {
 		Objects->erase(index);
+		mDestroyedObjects.push_back(pObject);
 	}
 
+	mTransformOrderDirty = true;
+
 	pObject->OnDestroy();
 }
 
@@ -223,4 +374,492 @@ void World::Think() {
 	if (pCityGenerator != 0) {
 		pCityGenerator->Think(this);
 	}
+}
+
+// Advances the game by one fixed step. Everything that moves, collides or spawns happens here,
+// rendering only sees the state through the snapshots written after, see WriteSnapshot.
+void World::Step(float deltaTime, InputFrame inputFrame)
+{
+	mPreviousCameraPosition = *pCameraPosition;
+	mTextCount = 0;
+
+	for (int i = 0; i < Objects->size(); i++) {
+		(*Objects)[i]->SavePreviousTransform();
+	}
+
+	mSimulationTime += deltaTime;
+
+	mStepDelta = deltaTime;
+	mStepInput = inputFrame;
+
+	mStepGraph.Execute(pJobSystem);
+}
+
+// The phases are added in the order they ran in when a step was one loop over the objects, so
+// any two that touch the same state still run in that order. Particles share nothing with the
+// collision phases and run alongside them. Object updates run in parallel and record what they
+// change outside themselves, the rest of the game code runs on the main thread.
+void World::BuildStepGraph()
+{
+	mCommandBuffers.resize(pJobSystem ? pJobSystem->GetWorkerCount() + 1 : 1);
+
+	mStepGraph.AddTask("think", TaskMethod<World, &World::StepThink>, this,
+		0, STEP_OBJECTS | STEP_TRANSFORMS | STEP_PARTICLES | STEP_TRAFFIC, TASK_MAIN_THREAD);
+	mStepGraph.AddTask("particles", TaskMethod<World, &World::StepParticles>, this,
+		STEP_PARTICLES, STEP_PARTICLES);
+
+	// Traffic only shares its focus with think and runs alongside everything after it
+	CityTraffic* pTraffic = pCityGenerator->GetTraffic();
+	mStepGraph.AddTask("traffic sort", TaskMethod<CityTraffic, &CityTraffic::Sort>, pTraffic,
+		STEP_TRAFFIC, STEP_TRAFFIC);
+	mStepGraph.AddTask("traffic", TaskMethod<CityTraffic, &CityTraffic::Update>, pTraffic,
+		STEP_TRAFFIC, STEP_TRAFFIC, 0, (unsigned int)pTraffic->GetVehicleCount(), 1024);
+	mStepGraph.AddTask("transform", TaskMethod<World, &World::StepTransforms>, this,
+		STEP_OBJECTS, STEP_TRANSFORMS | STEP_BOUNDS);
+	mStepGraph.AddTask("broadphase", TaskMethod<World, &World::Broadphase>, this,
+		STEP_OBJECTS | STEP_BOUNDS, STEP_PAIRS);
+	mNarrowphaseTask = mStepGraph.AddTask("narrowphase", TaskMethod<World, &World::Narrowphase>, this,
+		STEP_OBJECTS | STEP_BOUNDS | STEP_PAIRS, STEP_CONTACTS, 0, 0, 16);
+	mStepGraph.AddTask("resolve", TaskMethod<World, &World::ResolveContacts>, this,
+		STEP_CONTACTS, STEP_OBJECTS | STEP_PARTICLES, TASK_MAIN_THREAD);
+	mIntegrateTask = mStepGraph.AddTask("integrate", TaskMethod<World, &World::Integrate>, this,
+		0, STEP_OBJECTS, 0, 0, 64);
+	mUpdateTask = mStepGraph.AddTask("update", TaskMethod<World, &World::UpdateObjects>, this,
+		STEP_TRANSFORMS | STEP_PARTICLES, STEP_OBJECTS | STEP_COMMANDS, 0, 0, 32);
+	mStepGraph.AddTask("apply", TaskMethod<World, &World::ApplyCommands>, this,
+		STEP_COMMANDS, STEP_OBJECTS | STEP_TRANSFORMS | STEP_PARTICLES | STEP_COMMANDS, TASK_MAIN_THREAD);
+	mStepGraph.AddTask("destroy", TaskMethod<World, &World::DestroyObjects>, this,
+		0, STEP_OBJECTS | STEP_TRANSFORMS | STEP_PARTICLES, TASK_MAIN_THREAD);
+}
+
+// City generation and model loading, then the objects the rest of the step works on
+void World::StepThink(unsigned int begin, unsigned int end)
+{
+	Think();
+
+	// Objects may be created while stepping, so work from a copy of the list
+	mStepObjects = *Objects;
+
+	for (int i = 0; i < mStepObjects.size(); i++) {
+		if (!mStepObjects[i]->IsInitialized()) {
+			mStepObjects[i]->Initialize(pGraphicsClass->m_D3D);
+		}
+	}
+
+	mStepGraph.SetTaskCount(mIntegrateTask, (unsigned int)mStepObjects.size());
+	mStepGraph.SetTaskCount(mUpdateTask, (unsigned int)mStepObjects.size());
+}
+
+void World::StepParticles(unsigned int begin, unsigned int end)
+{
+	pParticleSystem->Update(mStepDelta);
+}
+
+// Bring the cached transforms and the AABBs of objects that moved last step up to date
+void World::StepTransforms(unsigned int begin, unsigned int end)
+{
+	UpdateTransforms();
+	UpdateBounds();
+}
+
+// Sweep and prune along x. The intervals are at least as wide as the ones HitResult::AABB_AABB
+// tests, so every pair it would find is kept.
+void World::Broadphase(unsigned int begin, unsigned int end)
+{
+	mColliders.clear();
+
+	for (int i = 0; i < mStepObjects.size(); i++) {
+		BaseObject* pObject = mStepObjects[i];
+
+		if (!pObject->GetCollisionsEnabled() || !pObject->pAABB) { continue; }
+
+		float extent = fabs((pObject->pAABB->pMaxs->x - pObject->pAABB->pMins->x) * 0.5f * pObject->pScale->x);
+
+		Collider collider;
+		collider.pObject = pObject;
+		collider.minX = pObject->pPosition->x - extent;
+		collider.maxX = pObject->pPosition->x + extent;
+		collider.resolve = pObject->pModelClass && !pObject->mStatic;
+		mColliders.push_back(collider);
+	}
+
+	mColliderOrder.resize(mColliders.size());
+	for (int i = 0; i < mColliders.size(); i++) {
+		mColliderOrder[i] = i;
+	}
+
+	std::sort(mColliderOrder.begin(), mColliderOrder.end(), [this](int a, int b) {
+		if (mColliders[a].minX != mColliders[b].minX) {
+			return mColliders[a].minX < mColliders[b].minX;
+		}
+		return a < b;
+	});
+
+	if (mCandidates.size() < mColliders.size()) {
+		mCandidates.resize(mColliders.size());
+	}
+	for (int i = 0; i < mColliders.size(); i++) {
+		mCandidates[i].clear();
+	}
+
+	mActiveColliders.clear();
+
+	for (int i = 0; i < mColliderOrder.size(); i++) {
+		int current = mColliderOrder[i];
+
+		// Drop the colliders that end before this one starts, nothing later can reach them either
+		for (int j = (int)mActiveColliders.size() - 1; j >= 0; j--) {
+			if (mColliders[mActiveColliders[j]].maxX < mColliders[current].minX) {
+				mActiveColliders[j] = mActiveColliders.back();
+				mActiveColliders.pop_back();
+			}
+		}
+
+		for (int j = 0; j < mActiveColliders.size(); j++) {
+			int other = mActiveColliders[j];
+
+			if (mColliders[other].resolve) { mCandidates[other].push_back(current); }
+			if (mColliders[current].resolve) { mCandidates[current].push_back(other); }
+		}
+
+		mActiveColliders.push_back(current);
+	}
+
+	// Each collider that resolves looks up the static boxes that can reach it along x
+	for (int i = 0; i < mColliders.size(); i++) {
+		if (!mColliders[i].resolve || mStaticColliders.empty()) { continue; }
+
+		int first = (int)(std::lower_bound(mStaticMinX.begin(), mStaticMinX.end(), mColliders[i].minX - mStaticMaxWidth) - mStaticMinX.begin());
+
+		for (int j = first; j < mStaticMinX.size() && mStaticMinX[j] <= mColliders[i].maxX; j++) {
+			if (mStaticColliders[j].center.x + mStaticColliders[j].extents.x < mColliders[i].minX) { continue; }
+
+			mCandidates[i].push_back(~j);
+		}
+	}
+
+	// Back into object order, a collider resolves against the first object it hits as it always has.
+	// Static boxes sort first, as the city's objects were created before anything else.
+	for (int i = 0; i < mColliders.size(); i++) {
+		std::sort(mCandidates[i].begin(), mCandidates[i].end());
+	}
+
+	mContacts.resize(mColliders.size());
+	mStepGraph.SetTaskCount(mNarrowphaseTask, (unsigned int)mColliders.size());
+}
+
+void World::Narrowphase(unsigned int begin, unsigned int end)
+{
+	for (unsigned int i = begin; i < end; i++) {
+		Contact& contact = mContacts[i];
+		contact.pOther = NULL;
+		contact.pHitResult = NULL;
+
+		if (!mColliders[i].resolve) { continue; }
+
+		std::vector<int>& candidates = mCandidates[i];
+
+		for (int j = 0; j < candidates.size(); j++) {
+			BaseObject* pOther;
+			HitResult* pHitResult;
+
+			if (candidates[j] < 0) {
+				pOther = pStaticObject;
+				pHitResult = HitResult::AABB_Box(mColliders[i].pObject, mStaticColliders[~candidates[j]]);
+			}
+			else {
+				pOther = mColliders[candidates[j]].pObject;
+				pHitResult = HitResult::AABB_AABB(mColliders[i].pObject, pOther);
+			}
+
+			if (pHitResult != NULL) {
+				contact.pOther = pOther;
+				contact.pHitResult = pHitResult;
+				break;
+			}
+		}
+	}
+}
+
+// Impulses and collision callbacks, in object order so the result does not depend on the workers
+void World::ResolveContacts(unsigned int begin, unsigned int end)
+{
+	for (int i = 0; i < mContacts.size(); i++) {
+		Contact& contact = mContacts[i];
+		if (!contact.pHitResult) { continue; }
+
+		BaseObject* pObject = mColliders[i].pObject;
+
+		HitResult::ResolveCollision(contact.pHitResult, pObject, contact.pOther);
+		pObject->OnCollide(contact.pOther, contact.pHitResult);
+
+		delete contact.pHitResult;
+		contact.pHitResult = NULL;
+	}
+}
+
+void World::Integrate(unsigned int begin, unsigned int end)
+{
+	float deltaTime = mStepDelta;
+
+	for (unsigned int i = begin; i < end; i++) {
+		BaseObject* pObject = mStepObjects[i];
+
+		if (!pObject->pModelClass) { continue; }
+
+		pObject->pPosition->x += pObject->pVelocity->x * deltaTime;
+		pObject->pPosition->y += pObject->pVelocity->y * deltaTime;
+		pObject->pPosition->z += pObject->pVelocity->z * deltaTime;
+
+		pObject->pAngle->x += pObject->pAngularVelocity->x * deltaTime;
+		pObject->pAngle->y += pObject->pAngularVelocity->y * deltaTime;
+		pObject->pAngle->z += pObject->pAngularVelocity->z * deltaTime;
+	}
+}
+
+void World::UpdateObjects(unsigned int begin, unsigned int end)
+{
+	unsigned int worker = pJobSystem ? pJobSystem->GetCurrentWorker() : 0;
+	WorldCommandBuffer& commands = mCommandBuffers[worker];
+
+	for (unsigned int i = begin; i < end; i++) {
+		BaseObject* pObject = mStepObjects[i];
+
+		if (!pObject->pModelClass) { continue; }
+
+		commands.Begin(i);
+		pObject->OnRender(mStepDelta);
+		pObject->OnInput(mStepInput, mStepDelta);
+		commands.End();
+	}
+}
+
+void World::ApplyCommands(unsigned int begin, unsigned int end)
+{
+	WorldCommandBuffer::Apply(this, &mCommandBuffers[0], (unsigned int)mCommandBuffers.size());
+}
+
+void World::DestroyObjects(unsigned int begin, unsigned int end)
+{
+	for (int i = mStepObjects.size() - 1; i >= 0; i--) {
+		if (mStepObjects[i]->IsDestroyed()) {
+			DestroyObject(mStepObjects[i]);
+		}
+	}
+}
+
+// Copies out what drawing the world needs. Objects without a parent carry their transforms from
+// the last two steps for the renderer to blend, children carry their current world matrix as their
+// parent's frame would have to be blended as well.
+void World::WriteSnapshot(RenderSnapshot& snapshot)
+{
+	UpdateTransforms();
+
+	snapshot.items.clear();
+
+	for (int i = 0; i < mTransformOrder.size(); i++) {
+		BaseObject* pObject = mTransformOrder[i];
+
+		if (!pObject->IsInitialized() || !pObject->pModelClass) { continue; }
+
+		RenderItem item;
+		item.objectID = pObject->ID;
+		item.pModel = pObject->pModelClass;
+		item.shader = pObject->renderShader;
+
+		item.interpolate = i < mTransformRootCount && !pObject->mUseOrientationMatrix;
+		if (item.interpolate) {
+			pObject->GetPreviousTransform(item.previousPosition, item.previousOrientation, item.previousScale);
+			item.position = *pObject->pPosition;
+			item.orientation = pObject->GetOrientation();
+			item.scale = *pObject->pScale;
+		}
+		else {
+			XMStoreFloat4x4(&item.world, pObject->GetWorldMatrix(XMMatrixIdentity()));
+		}
+
+		item.pickable = pObject->GetCollisionsEnabled();
+		item.hoverable = pObject->GetHoveringEnabled();
+		item.collisionRadius = pObject->mCollisionRadius;
+
+		item.drawOBB = pObject->GetDrawOBB() && pObject->pOBB;
+		if (item.drawOBB) {
+			item.obbMins = *pObject->pOBB->pMins;
+			item.obbMaxs = *pObject->pOBB->pMaxs;
+		}
+
+		item.drawAABB = pObject->GetDrawAABB() && pObject->pAABB;
+		if (item.drawAABB) {
+			item.aabbMins = *pObject->pAABB->pMins;
+			item.aabbMaxs = *pObject->pAABB->pMaxs;
+			XMStoreFloat4x4(&item.aabbWorld, pObject->GetWorldMatrix(XMMatrixIdentity(), false));
+		}
+
+		snapshot.items.push_back(item);
+	}
+
+	snapshot.previousCameraPosition = mPreviousCameraPosition;
+	snapshot.cameraPosition = *pCameraPosition;
+	snapshot.cameraFree = mCameraMovementEnabled;
+
+	snapshot.hasLightingOrigin = pLightingOrigin != 0;
+	if (snapshot.hasLightingOrigin) {
+		snapshot.lightingOrigin = *pLightingOrigin;
+	}
+	snapshot.lightingAngle = *pLightingAngle;
+
+	pParticleSystem->Snapshot(snapshot.particles);
+
+	pCityGenerator->WriteSnapshot(snapshot);
+
+	snapshot.score = mScore;
+	snapshot.health = mHealth;
+
+	for (int i = 0; i < mTextCount; i++) {
+		strncpy_s(snapshot.text[i], mText[i], _TRUNCATE);
+	}
+	snapshot.textCount = mTextCount;
+}
+
+// A click or hover the renderer found on a snapshot item, the object may have gone since
+void World::Pick(int objectID, bool clicked, bool hovered)
+{
+	for (int i = 0; i < Objects->size(); i++) {
+		BaseObject* pObject = (*Objects)[i];
+
+		if (pObject->ID != objectID) { continue; }
+
+		if (clicked) {
+			pObject->DoClick();
+		}
+
+		if (pObject->GetHoveringEnabled()) {
+			pObject->SetHovered(hovered);
+		}
+
+		return;
+	}
+}
+
+// Copied and sorted for the broadphase, call when the city's boxes change
+void World::SetStaticColliders(const std::vector<StaticCollider>& colliders)
+{
+	mStaticColliders = colliders;
+
+	std::sort(mStaticColliders.begin(), mStaticColliders.end(), [](const StaticCollider& a, const StaticCollider& b) {
+		return a.center.x - a.extents.x < b.center.x - b.extents.x;
+	});
+
+	mStaticMinX.resize(mStaticColliders.size());
+	mStaticMaxWidth = 0.f;
+
+	for (int i = 0; i < mStaticColliders.size(); i++) {
+		mStaticMinX[i] = mStaticColliders[i].center.x - mStaticColliders[i].extents.x;
+		mStaticMaxWidth = max(mStaticMaxWidth, mStaticColliders[i].extents.x * 2.f);
+	}
+}
+
+double World::GetSimulationTime()
+{
+	return mSimulationTime;
+}
+
+TaskGraph* World::GetStepGraph()
+{
+	return &mStepGraph;
+}
+
+// Brings every cached world matrix up to date, parents first so each child reads a current parent.
+// Objects without a parent sort to the front and are built together in one SIMD pass.
+void World::UpdateTransforms()
+{
+	if (mTransformOrderDirty) {
+		mTransformOrder = *Objects;
+
+		std::stable_sort(mTransformOrder.begin(), mTransformOrder.end(), [](BaseObject* a, BaseObject* b) {
+			return a->GetHierarchyDepth() < b->GetHierarchyDepth();
+		});
+
+		mTransformRootCount = 0;
+		while (mTransformRootCount < mTransformOrder.size() && mTransformOrder[mTransformRootCount]->GetParent() == 0) {
+			mTransformRootCount++;
+		}
+
+		mTransformOrderDirty = false;
+	}
+
+	mRootObjects.clear();
+	mRootPositions.clear();
+	mRootOrientations.clear();
+	mRootScales.clear();
+
+	for (int i = 0; i < mTransformRootCount; i++) {
+		BaseObject* pObject = mTransformOrder[i];
+
+		if (!pObject->TransformNeedsUpdate()) { continue; }
+
+		mRootObjects.push_back(pObject);
+		mRootPositions.push_back(*pObject->pPosition);
+		mRootOrientations.push_back(pObject->GetOrientation());
+		mRootScales.push_back(*pObject->pScale);
+	}
+
+	if (!mRootObjects.empty()) {
+		mRootWorlds.resize(mRootObjects.size());
+		mRootFrames.resize(mRootObjects.size());
+
+		MathUtil::BuildWorldMatrices(&mRootPositions[0], &mRootOrientations[0], &mRootScales[0], (unsigned int)mRootObjects.size(),
+			&mRootWorlds[0], &mRootFrames[0]);
+
+		for (int i = 0; i < mRootObjects.size(); i++) {
+			mRootObjects[i]->SetRootTransform(mRootWorlds[i], mRootFrames[i]);
+		}
+	}
+
+	for (int i = mTransformRootCount; i < mTransformOrder.size(); i++) {
+		mTransformOrder[i]->UpdateTransform();
+	}
+}
+
+void World::InvalidateTransformOrder()
+{
+	mTransformOrderDirty = true;
+}
+
+// Rebuilds the AABB of every object whose angle changed since its last update in one batch
+void World::UpdateBounds()
+{
+	mBoundsObjects.clear();
+	mBoundsMins.clear();
+	mBoundsMaxs.clear();
+	mBoundsMatrices.clear();
+
+	for (int i = 0; i < Objects->size(); i++) {
+		BaseObject* pObject = (*Objects)[i];
+
+		if (!pObject->BoundsNeedUpdate()) { continue; }
+
+		XMFLOAT4X4 rotation;
+		XMStoreFloat4x4(&rotation, pObject->GetRotationMatrix());
+
+		mBoundsObjects.push_back(pObject);
+		mBoundsMins.push_back(*pObject->pOBB->pMins);
+		mBoundsMaxs.push_back(*pObject->pOBB->pMaxs);
+		mBoundsMatrices.push_back(rotation);
+	}
+
+	if (mBoundsObjects.empty()) {
+		return;
+	}
+
+	// Transform in place, the local bounds are not needed once the new ones are written
+	ObjectBoundingBox::TransformBounds(&mBoundsMins[0], &mBoundsMaxs[0], &mBoundsMatrices[0], (unsigned int)mBoundsObjects.size(),
+		&mBoundsMins[0], &mBoundsMaxs[0]);
+
+	for (int i = 0; i < mBoundsObjects.size(); i++) {
+		BaseObject* pObject = mBoundsObjects[i];
+
+		pObject->pAABB->Set(mBoundsMins[i], mBoundsMaxs[i]);
+		pObject->mBoundsOrientation = pObject->GetOrientation();
+	}
 }
\ No newline at end of file
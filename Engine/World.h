@@ -9,18 +9,36 @@ Date: 13/12/2018
 #include <vector>
 #include <map>
 #include "CityGenerator.h"
+#include "BaseObject.h"
+#include "TaskGraph.h"
+#include "WorldCommandBuffer.h"
+#include "RenderSnapshot.h"
 
 class BaseObject;
 class GraphicsClass;
 class ShipSelect;
 class Ship;
 class ParticleSystem;
+class JobSystem;
+class HitResult;
 
 enum GameState {
 	SHIP_SELECT,
 	PLAY,
 };
 
+// The state the phases of a step declare they read or write, see World::BuildStepGraph
+enum StepResource {
+	STEP_OBJECTS = 1 << 0,
+	STEP_TRANSFORMS = 1 << 1,
+	STEP_BOUNDS = 1 << 2,
+	STEP_PAIRS = 1 << 3,
+	STEP_CONTACTS = 1 << 4,
+	STEP_PARTICLES = 1 << 5,
+	STEP_COMMANDS = 1 << 6,
+	STEP_TRAFFIC = 1 << 7,
+};
+
 class World
 {
 private:
@@ -34,6 +52,86 @@ private:
 
 	std::vector<ShipSelect*> mShipSelects;
 
+	// Scratch arrays for the per frame AABB pass, kept so the pass does not allocate
+	std::vector<BaseObject*> mBoundsObjects;
+	std::vector<XMFLOAT3> mBoundsMins;
+	std::vector<XMFLOAT3> mBoundsMaxs;
+	std::vector<XMFLOAT4X4> mBoundsMatrices;
+
+	// Objects ordered so parents come before their children, rebuilt when the hierarchy changes
+	std::vector<BaseObject*> mTransformOrder;
+	int mTransformRootCount;
+	bool mTransformOrderDirty;
+
+	// Seconds simulated so far, advanced by Step
+	double mSimulationTime;
+	XMFLOAT3 mPreviousCameraPosition;
+
+	// Scratch arrays for the batched matrix build of objects without a parent
+	std::vector<BaseObject*> mRootObjects;
+	std::vector<XMFLOAT3> mRootPositions;
+	std::vector<XMFLOAT4> mRootOrientations;
+	std::vector<XMFLOAT3> mRootScales;
+	std::vector<XMFLOAT4X4> mRootWorlds;
+	std::vector<XMFLOAT4X4> mRootFrames;
+
+	// A step is run as a graph of phases, the phases work on the objects that existed after think
+	TaskGraph mStepGraph;
+	int mNarrowphaseTask;
+	int mIntegrateTask;
+	int mUpdateTask;
+	float mStepDelta;
+	InputFrame mStepInput;
+	std::vector<BaseObject*> mStepObjects;
+
+	// Objects DestroyObject took out of the world. Missiles and children keep pointers to others
+	// and check IsDestroyed, so these are only deleted with the world.
+	std::vector<BaseObject*> mDestroyedObjects;
+
+	// Objects that can collide, in object order. Broadphase gives each one the others its box
+	// overlaps along x, narrowphase keeps the first of those it really hits.
+	struct Collider {
+		BaseObject* pObject;
+		float minX;
+		float maxX;
+		bool resolve;
+	};
+	struct Contact {
+		BaseObject* pOther;
+		HitResult* pHitResult;
+	};
+	std::vector<Collider> mColliders;
+	std::vector<int> mColliderOrder;
+	std::vector<int> mActiveColliders;
+	std::vector<std::vector<int>> mCandidates;
+	std::vector<Contact> mContacts;
+
+	// Boxes of the city that never move, sorted by their min x. A candidate below zero is
+	// ~index into these, contacts with them are made against pStaticObject.
+	std::vector<StaticCollider> mStaticColliders;
+	std::vector<float> mStaticMinX;
+	float mStaticMaxWidth;
+	BaseObject* pStaticObject;
+
+	// One per worker plus one for a thread outside the job system, applied after the update
+	std::vector<WorldCommandBuffer> mCommandBuffers;
+
+	// Text objects asked for during the last step, handed to the renderer with the snapshot
+	char mText[TEXT_SENTENCE_COUNT - 1][TEXT_SENTENCE_LENGTH];
+	int mTextCount;
+
+	void BuildStepGraph();
+	void StepThink(unsigned int begin, unsigned int end);
+	void StepParticles(unsigned int begin, unsigned int end);
+	void StepTransforms(unsigned int begin, unsigned int end);
+	void Broadphase(unsigned int begin, unsigned int end);
+	void Narrowphase(unsigned int begin, unsigned int end);
+	void ResolveContacts(unsigned int begin, unsigned int end);
+	void Integrate(unsigned int begin, unsigned int end);
+	void UpdateObjects(unsigned int begin, unsigned int end);
+	void ApplyCommands(unsigned int begin, unsigned int end);
+	void DestroyObjects(unsigned int begin, unsigned int end);
+
 	Ship* pPlayerShip;
 public:
 	World();
@@ -42,6 +140,15 @@ public:
 	void PostInitialized();
 
 	void Think();
+	void Step(float deltaTime, InputFrame inputFrame);
+	void WriteSnapshot(RenderSnapshot& snapshot);
+	void Pick(int objectID, bool clicked, bool hovered);
+	void SetStaticColliders(const std::vector<StaticCollider>& colliders);
+	double GetSimulationTime();
+	TaskGraph* GetStepGraph();
+	void UpdateBounds();
+	void UpdateTransforms();
+	void InvalidateTransformOrder();
 	int mScore = 0;
 	int mHealth = 10;
 
@@ -53,18 +160,23 @@ public:
 	template<class T>
 	T* CreateObject(const char* Name, const char* ModelPath, WCHAR* MaterialPath, WCHAR* MaterialPath2) {
 		T* pObject = new T(Name, ModelPath, MaterialPath, MaterialPath2);
-		pObject->ID = CurrentID;
 		pObject->pWorld = this;
-		CurrentID++;
 
-		// Add to object array & call create functions
-		Objects->push_back((BaseObject*)pObject);
-
-		pObject->OnCreate();
+		AddObject((BaseObject*)pObject);
 
 		return pObject;
 	}
 
+	// These change state objects share, during a parallel update they are recorded
+	// and made once every object has updated, see WorldCommandBuffer
+	void AddObject(BaseObject* pObject);
+	void AddScore(int amount);
+	void Damage(int amount);
+	void SetCameraPosition(XMFLOAT3 position);
+	void RenderText(const char* text);
+	void CreateEmitter(const ParticleEmitterDesc& desc, XMFLOAT3 position, int* pEmitter);
+	void SetEmitterPosition(int emitter, XMFLOAT3 position);
+
 	bool mCameraMovementEnabled;
 	XMFLOAT3* pCameraPosition;
 	XMFLOAT3* pCameraAngle;
@@ -75,6 +187,10 @@ public:
 	GraphicsClass* pGraphicsClass;
 	CityGenerator* pCityGenerator;
 	ParticleSystem* pParticleSystem;
+	JobSystem* pJobSystem;
+
+	// Settings, ParticleCapacity is read at PostInitialized and sizes the pool and its vertex buffer
+	unsigned int ParticleCapacity;
 
 	void DestroyObject(BaseObject*);
 	void SetGameState(GameState state);
@@ -0,0 +1,167 @@
+#include "WorldCommandBuffer.h"
+#include "World.h"
+#include "BaseObject.h"
+#include <algorithm>
+#include <cstring>
+
+// The buffer the current thread is recording into, set between Begin and End
+static thread_local WorldCommandBuffer* sCurrentBuffer = 0;
+
+WorldCommandBuffer::WorldCommandBuffer()
+{
+	mOrder = 0;
+}
+
+WorldCommandBuffer* WorldCommandBuffer::GetCurrent()
+{
+	return sCurrentBuffer;
+}
+
+void WorldCommandBuffer::Begin(unsigned int order)
+{
+	mOrder = order;
+	sCurrentBuffer = this;
+}
+
+void WorldCommandBuffer::End()
+{
+	sCurrentBuffer = 0;
+}
+
+WorldCommandBuffer::Command& WorldCommandBuffer::Record(CommandType type)
+{
+	Command command;
+	command.type = type;
+	command.order = mOrder;
+	command.pObject = 0;
+	command.value = 0;
+	command.pEmitter = 0;
+	command.position = XMFLOAT3(0.f, 0.f, 0.f);
+
+	mCommands.push_back(command);
+
+	return mCommands.back();
+}
+
+void WorldCommandBuffer::Destroy(BaseObject* pObject)
+{
+	Record(COMMAND_DESTROY).pObject = pObject;
+}
+
+void WorldCommandBuffer::AddObject(BaseObject* pObject)
+{
+	Record(COMMAND_ADD_OBJECT).pObject = pObject;
+}
+
+void WorldCommandBuffer::AddScore(int amount)
+{
+	Record(COMMAND_ADD_SCORE).value = amount;
+}
+
+void WorldCommandBuffer::Damage(int amount)
+{
+	Record(COMMAND_DAMAGE).value = amount;
+}
+
+void WorldCommandBuffer::SetCameraPosition(XMFLOAT3 position)
+{
+	Record(COMMAND_CAMERA_POSITION).position = position;
+}
+
+void WorldCommandBuffer::RenderText(const char* text)
+{
+	Record(COMMAND_TEXT).value = (int)mText.size();
+	mText.insert(mText.end(), text, text + strlen(text) + 1);
+}
+
+void WorldCommandBuffer::CreateEmitter(const ParticleEmitterDesc& desc, XMFLOAT3 position, int* pEmitter)
+{
+	Command& command = Record(COMMAND_CREATE_EMITTER);
+	command.value = (int)mEmitterDescs.size();
+	command.pEmitter = pEmitter;
+	command.position = position;
+
+	mEmitterDescs.push_back(desc);
+}
+
+void WorldCommandBuffer::SetEmitterPosition(int emitter, XMFLOAT3 position)
+{
+	Command& command = Record(COMMAND_EMITTER_POSITION);
+	command.value = emitter;
+	command.position = position;
+}
+
+int WorldCommandBuffer::GetCommandCount()
+{
+	return (int)mCommands.size();
+}
+
+void WorldCommandBuffer::Clear()
+{
+	mCommands.clear();
+	mText.clear();
+	mEmitterDescs.clear();
+}
+
+// An object's commands are all in the buffer of the worker that updated it, in the order it made
+// them, so sorting on the object's order and then the position in the buffer is a total order
+void WorldCommandBuffer::Apply(World* pWorld, WorldCommandBuffer* pBuffers, unsigned int count)
+{
+	struct CommandRef {
+		unsigned int order;
+		unsigned int buffer;
+		unsigned int index;
+	};
+
+	std::vector<CommandRef> commands;
+
+	for (unsigned int i = 0; i < count; i++) {
+		for (unsigned int j = 0; j < pBuffers[i].mCommands.size(); j++) {
+			CommandRef ref = { pBuffers[i].mCommands[j].order, i, j };
+			commands.push_back(ref);
+		}
+	}
+
+	std::sort(commands.begin(), commands.end(), [](const CommandRef& a, const CommandRef& b) {
+		if (a.order != b.order) { return a.order < b.order; }
+		if (a.buffer != b.buffer) { return a.buffer < b.buffer; }
+		return a.index < b.index;
+	});
+
+	// No buffer is current here, so each call changes the world straight away
+	for (unsigned int i = 0; i < commands.size(); i++) {
+		WorldCommandBuffer& buffer = pBuffers[commands[i].buffer];
+		Command& command = buffer.mCommands[commands[i].index];
+
+		switch (command.type) {
+		case COMMAND_DESTROY:
+			command.pObject->Destroy();
+			break;
+		case COMMAND_ADD_OBJECT:
+			pWorld->AddObject(command.pObject);
+			break;
+		case COMMAND_ADD_SCORE:
+			pWorld->AddScore(command.value);
+			break;
+		case COMMAND_DAMAGE:
+			pWorld->Damage(command.value);
+			break;
+		case COMMAND_CAMERA_POSITION:
+			pWorld->SetCameraPosition(command.position);
+			break;
+		case COMMAND_TEXT:
+			pWorld->RenderText(&buffer.mText[command.value]);
+			break;
+		case COMMAND_CREATE_EMITTER:
+			pWorld->CreateEmitter(buffer.mEmitterDescs[command.value], command.position, command.pEmitter);
+			break;
+		case COMMAND_EMITTER_POSITION:
+			pWorld->SetEmitterPosition(command.value, command.position);
+			break;
+		}
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		pBuffers[i].Clear();
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ParticleSystem.h"
+#include <vector>
+
+class BaseObject;
+class World;
+
+// Changes an object makes to the world or to other objects while objects are
+// updated in parallel. Each worker records into its own buffer between Begin and
+// End, and the buffers are applied together once every object has updated, in
+// the order of the objects that recorded them. The result is the same however
+// the objects were split between the workers.
+//
+// While a buffer is current, World and BaseObject record the calls that would
+// touch shared state instead of making them, so game code does not call this
+// directly. An object can change its own state freely during its update, and
+// reads everything else as it was when the update began.
+class WorldCommandBuffer
+{
+public:
+	WorldCommandBuffer();
+
+	// The buffer the calling thread is recording into, null outside an update
+	static WorldCommandBuffer* GetCurrent();
+
+	// Commands recorded until End are applied in order of the order given here
+	void Begin(unsigned int order);
+	void End();
+
+	void Destroy(BaseObject* pObject);
+	void AddObject(BaseObject* pObject);
+	void AddScore(int amount);
+	void Damage(int amount);
+	void SetCameraPosition(XMFLOAT3 position);
+	void RenderText(const char* text);
+	void CreateEmitter(const ParticleEmitterDesc& desc, XMFLOAT3 position, int* pEmitter);
+	void SetEmitterPosition(int emitter, XMFLOAT3 position);
+
+	int GetCommandCount();
+	void Clear();
+
+	// Carries out every recorded command through the world, then empties the buffers
+	static void Apply(World* pWorld, WorldCommandBuffer* pBuffers, unsigned int count);
+
+private:
+	enum CommandType {
+		COMMAND_DESTROY,
+		COMMAND_ADD_OBJECT,
+		COMMAND_ADD_SCORE,
+		COMMAND_DAMAGE,
+		COMMAND_CAMERA_POSITION,
+		COMMAND_TEXT,
+		COMMAND_CREATE_EMITTER,
+		COMMAND_EMITTER_POSITION,
+	};
+
+	struct Command {
+		CommandType type;
+		unsigned int order;
+		BaseObject* pObject;
+		int value;
+		int* pEmitter;
+		XMFLOAT3 position;
+	};
+
+	Command& Record(CommandType type);
+
+	unsigned int mOrder;
+	std::vector<Command> mCommands;
+
+	// Text and emitter descriptions are kept to the side, value indexes into them
+	std::vector<char> mText;
+	std::vector<ParticleEmitterDesc> mEmitterDescs;
+};
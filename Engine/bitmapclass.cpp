@@ -2,6 +2,7 @@
 // Filename: bitmapclass.cpp
 ////////////////////////////////////////////////////////////////////////////////
 #include "bitmapclass.h"
+#include "d3d11renderbackendclass.h"
 
 
 BitmapClass::BitmapClass()
@@ -88,6 +89,25 @@ bool BitmapClass::Render(ID3D11DeviceContext* deviceContext, int positionX, int
 }
 
 
+bool BitmapClass::Render(SpriteBatchClass* spriteBatch, int positionX, int positionY)
+{
+	SpriteQuad quad;
+
+
+	// Queue the bitmap into the sprite batch instead of drawing it with its own buffers.
+	quad.x = (float)((m_screenWidth / 2) * -1) + (float)positionX;
+	quad.y = (float)(m_screenHeight / 2) - (float)positionY;
+	quad.width = (float)m_bitmapWidth;
+	quad.height = (float)m_bitmapHeight;
+	quad.left = 0.0f;
+	quad.top = 0.0f;
+	quad.right = 1.0f;
+	quad.bottom = 1.0f;
+
+	return spriteBatch->Draw(D3D11RenderBackendClass::WrapTexture(m_Texture->GetTexture()), quad);
+}
+
+
 int BitmapClass::GetIndexCount()
 {
 	return m_indexCount;
@@ -16,6 +16,7 @@
 // MY CLASS INCLUDES //
 ///////////////////////
 #include "textureclass.h"
+#include "spritebatchclass.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -38,6 +39,7 @@ public:
 	bool Initialize(ID3D11Device*, int, int, WCHAR*, int, int);
 	void Shutdown();
 	bool Render(ID3D11DeviceContext*, int, int);
+	bool Render(SpriteBatchClass*, int, int);
 
 	int GetIndexCount();
 	ID3D11ShaderResourceView* GetTexture();
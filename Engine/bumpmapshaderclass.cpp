@@ -12,6 +12,7 @@ BumpMapShaderClass::BumpMapShaderClass()
 	m_matrixBuffer = 0;
 	m_sampleState = 0;
 	m_lightBuffer = 0;
+	m_pipeline = 0;
 }
 
 
@@ -414,6 +415,69 @@ bool BumpMapShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext,
 }
 
 
+bool BumpMapShaderClass::CreatePipeline(RenderBackendClass* backend)
+{
+	PipelineDesc desc;
+
+
+	// Hand the compiled shader objects to the backend, the draw queue only refers to the returned handle.
+	desc.vertexShader = m_vertexShader;
+	desc.pixelShader = m_pixelShader;
+	desc.inputLayout = m_layout;
+	desc.sampleState = m_sampleState;
+
+	m_pipeline = backend->CreatePipeline(desc);
+	if(!m_pipeline)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool BumpMapShaderClass::Record(ConstantBufferRingClass* constantRing, DrawPacket& packet, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix,
+	const XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* colorTexture, ID3D11ShaderResourceView* normalMapTexture,
+	XMFLOAT3 lightDirection, XMFLOAT4 diffuseColor)
+{
+	MatrixBufferType* dataPtr;
+	LightBufferType* dataPtr2;
+
+
+	// Allocate this draw's matrix constants from the frame ring.
+	if(!constantRing->Allocate(sizeof(MatrixBufferType), (void**)&dataPtr, packet.vsConstants[0]))
+	{
+		return false;
+	}
+
+	// Copy the transposed matrices into the ring.
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
+	dataPtr->view = XMMatrixTranspose(viewMatrix);
+	dataPtr->projection = XMMatrixTranspose(projectionMatrix);
+
+	// Allocate and fill the light constants for the pixel shader.
+	if(!constantRing->Allocate(sizeof(LightBufferType), (void**)&dataPtr2, packet.psConstants[0]))
+	{
+		return false;
+	}
+
+	dataPtr2->diffuseColor = diffuseColor;
+	dataPtr2->lightDirection = lightDirection;
+	dataPtr2->padding = 0.0f;
+
+	packet.vsConstantCount = 1;
+	packet.psConstantCount = 1;
+
+	// Record the shader objects and textures the draw will bind when the queue is executed.
+	packet.pipeline = m_pipeline;
+	packet.textures[0] = D3D11RenderBackendClass::WrapTexture(colorTexture);
+	packet.textures[1] = D3D11RenderBackendClass::WrapTexture(normalMapTexture);
+	packet.textureCount = 2;
+
+	return true;
+}
+
+
 void BumpMapShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
 {
 	// Set the vertex input layout.
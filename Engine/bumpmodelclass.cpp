@@ -15,6 +15,8 @@ BumpModelClass::BumpModelClass()
 	m_model = 0;
 	m_ColorTexture = 0;
 	m_NormalMapTexture = 0;
+	m_boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f);
 }
 
 
@@ -56,6 +58,9 @@ bool BumpModelClass::Initialize(ID3D11Device* device, char* modelFilename, WCHAR
 	// Calculate the tangent and binormal vectors for the model.
 	CalculateModelVectors();
 
+	// Calculate the local bounds once, every object using the model shares them.
+	CalculateBounds();
+
 	// Initialize the vertex and index buffers.
 	result = InitializeBuffers(device);
 	if(!result)
@@ -87,6 +92,9 @@ bool BumpModelClass::InitializeFromVertexArray(ID3D11Device * device, VertexData
 	// Calculate the tangent and binormal vectors for the model.
 	CalculateModelVectors();
 
+	// Calculate the local bounds once, every object using the model shares them.
+	CalculateBounds();
+
 	// Initialize the vertex and index buffers.
 	result = InitializeBuffers(device);
 	if (!result)
@@ -138,6 +146,44 @@ int BumpModelClass::GetVertexCount() {
 	return m_vertexCount;
 }
 
+void BumpModelClass::GetBounds(XMFLOAT3& mins, XMFLOAT3& maxs)
+{
+	mins = m_boundsMin;
+	maxs = m_boundsMax;
+}
+
+void BumpModelClass::CalculateBounds()
+{
+	int i;
+
+
+	if(m_vertexCount <= 0)
+	{
+		return;
+	}
+
+	m_boundsMin = XMFLOAT3(m_model[0].x, m_model[0].y, m_model[0].z);
+	m_boundsMax = m_boundsMin;
+
+	for(i=1; i<m_vertexCount; i++)
+	{
+		m_boundsMin.x = min(m_boundsMin.x, m_model[i].x);
+		m_boundsMin.y = min(m_boundsMin.y, m_model[i].y);
+		m_boundsMin.z = min(m_boundsMin.z, m_model[i].z);
+
+		m_boundsMax.x = max(m_boundsMax.x, m_model[i].x);
+		m_boundsMax.y = max(m_boundsMax.y, m_model[i].y);
+		m_boundsMax.z = max(m_boundsMax.z, m_model[i].z);
+	}
+
+	return;
+}
+
+unsigned int BumpModelClass::GetVertexStride()
+{
+	return sizeof(VertexType);
+}
+
 void BumpModelClass::SetIndexCount(int count)
 {
 	m_indexCount = count;
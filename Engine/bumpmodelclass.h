@@ -87,6 +87,8 @@ public:
 
 	int GetIndexCount();
 	int GetVertexCount();
+	unsigned int GetVertexStride();
+	void GetBounds(XMFLOAT3&, XMFLOAT3&);
 	void SetIndexCount(int);
 	void SetVertexCount(int);
 	void InitializeModel();
@@ -97,6 +99,7 @@ public:
 	void CalculateModelVectors();
 	bool InitializeBuffers(ID3D11Device*);
 private:
+	void CalculateBounds();
 	void ShutdownBuffers();
 	void RenderBuffers(ID3D11DeviceContext*);
 
@@ -115,6 +118,7 @@ private:
 	int m_vertexCount, m_indexCount;
 	TextureClass* m_ColorTexture;
 	TextureClass* m_NormalMapTexture;
+	XMFLOAT3 m_boundsMin, m_boundsMax;
 };
 
 #endif
\ No newline at end of file
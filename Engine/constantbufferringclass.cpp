@@ -0,0 +1,224 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: constantbufferringclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "constantbufferringclass.h"
+
+#include <cstring>
+
+
+ConstantBufferRingClass::ConstantBufferRingClass()
+{
+	m_backend = 0;
+	m_buffer = 0;
+	m_shadowMemory = 0;
+	m_shadow = 0;
+	m_commitOffset = 0;
+	m_committedBytes = 0;
+	m_noOverwrite = false;
+	m_discardPending = true;
+	m_mapCount = 0;
+	m_lastMapCount = 0;
+}
+
+
+ConstantBufferRingClass::ConstantBufferRingClass(const ConstantBufferRingClass& other)
+{
+}
+
+
+ConstantBufferRingClass::~ConstantBufferRingClass()
+{
+}
+
+
+bool ConstantBufferRingClass::Initialize(RenderBackendClass* backend, unsigned int size, unsigned int framesInFlight)
+{
+	RenderBackendCaps caps;
+	BufferDesc ringBufferDesc;
+	size_t misalignment;
+
+
+	m_backend = backend;
+
+	// Binding a constant buffer by offset needs the 11.1 runtime and driver support.
+	// If either is missing the shader manager falls back to a buffer per shader.
+	caps = m_backend->GetCaps();
+	if(!caps.constantBufferOffsets)
+	{
+		return false;
+	}
+
+	// Without NO_OVERWRITE support every commit has to discard, so the ring restarts after each one.
+	m_noOverwrite = caps.constantBufferNoOverwrite;
+
+	if(!m_allocator.Initialize(size, CONSTANT_RING_ALIGNMENT, framesInFlight))
+	{
+		return false;
+	}
+
+	// Create the CPU copy that draws write their constants into. It is over allocated and
+	// aligned by hand so the matrices written into it are always 16 byte aligned.
+	m_shadowMemory = new unsigned char[size + CONSTANT_RING_ALIGNMENT];
+	if(!m_shadowMemory)
+	{
+		return false;
+	}
+
+	misalignment = (size_t)m_shadowMemory % CONSTANT_RING_ALIGNMENT;
+	m_shadow = m_shadowMemory + (misalignment ? CONSTANT_RING_ALIGNMENT - misalignment : 0);
+
+	// Create the dynamic constant buffer that backs every draw of the frame.
+	ringBufferDesc.type = BUFFER_CONSTANT;
+	ringBufferDesc.byteWidth = size;
+	ringBufferDesc.dynamic = true;
+	ringBufferDesc.initialData = 0;
+
+	m_buffer = m_backend->CreateBuffer(ringBufferDesc);
+	if(!m_buffer)
+	{
+		return false;
+	}
+
+	m_discardPending = true;
+
+	return true;
+}
+
+
+void ConstantBufferRingClass::Shutdown()
+{
+	// Release the ring buffer.
+	if(m_buffer)
+	{
+		m_backend->DestroyBuffer(m_buffer);
+		m_buffer = 0;
+	}
+
+	// Release the CPU copy.
+	if(m_shadowMemory)
+	{
+		delete [] m_shadowMemory;
+		m_shadowMemory = 0;
+		m_shadow = 0;
+	}
+
+	m_allocator.Shutdown();
+	m_backend = 0;
+
+	return;
+}
+
+
+bool ConstantBufferRingClass::Allocate(unsigned int size, void** data, UniformRange& range)
+{
+	unsigned int offset;
+
+
+	if(!m_allocator.Allocate(size, offset))
+	{
+		return false;
+	}
+
+	*data = m_shadow + offset;
+
+	// Constant buffer offsets and sizes are counted in 16 byte constants.
+	range.firstConstant = offset / 16;
+	range.numConstants = ((size + CONSTANT_RING_ALIGNMENT - 1) & ~(CONSTANT_RING_ALIGNMENT - 1)) / 16;
+
+	return true;
+}
+
+
+bool ConstantBufferRingClass::Commit()
+{
+	MapMode mapMode;
+	unsigned int pending, capacity, firstPart;
+	unsigned char* dataPtr;
+
+
+	// Everything written since the last commit is one contiguous run modulo the ring size.
+	pending = (unsigned int)(m_allocator.GetTotalAllocated() - m_committedBytes);
+	if(pending == 0)
+	{
+		return true;
+	}
+
+	mapMode = (m_noOverwrite && !m_discardPending) ? MAP_WRITE_NO_OVERWRITE : MAP_WRITE_DISCARD;
+
+	// Lock the ring buffer once for all the draws queued since the last commit.
+	dataPtr = (unsigned char*)m_backend->Map(m_buffer, mapMode);
+	if(!dataPtr)
+	{
+		return false;
+	}
+
+	capacity = m_allocator.GetCapacity();
+
+	firstPart = capacity - m_commitOffset;
+	if(firstPart > pending)
+	{
+		firstPart = pending;
+	}
+
+	memcpy(dataPtr + m_commitOffset, m_shadow + m_commitOffset, firstPart);
+	if(pending > firstPart)
+	{
+		memcpy(dataPtr, m_shadow, pending - firstPart);
+	}
+
+	m_backend->Unmap(m_buffer, pending);
+	m_mapCount++;
+
+	m_discardPending = false;
+
+	if(m_noOverwrite)
+	{
+		m_committedBytes = m_allocator.GetTotalAllocated();
+		m_commitOffset = m_allocator.GetHead();
+	}
+	else
+	{
+		// The draws already issued keep the old contents alive, so the whole ring is free again.
+		m_allocator.Reset();
+		m_committedBytes = 0;
+		m_commitOffset = 0;
+	}
+
+	return true;
+}
+
+
+void ConstantBufferRingClass::Discard()
+{
+	// Only valid once every queued draw has been committed and issued.
+	m_allocator.Reset();
+	m_committedBytes = 0;
+	m_commitOffset = 0;
+	m_discardPending = true;
+
+	return;
+}
+
+
+void ConstantBufferRingClass::EndFrame()
+{
+	m_allocator.EndFrame();
+
+	m_lastMapCount = m_mapCount;
+	m_mapCount = 0;
+
+	return;
+}
+
+
+BufferHandle ConstantBufferRingClass::GetBuffer()
+{
+	return m_buffer;
+}
+
+
+int ConstantBufferRingClass::GetMapCount()
+{
+	return m_lastMapCount;
+}
+
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: constantbufferringclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CONSTANTBUFFERRINGCLASS_H_
+#define _CONSTANTBUFFERRINGCLASS_H_
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "UniformRingAllocator.h"
+#include "renderbackendclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+// Offsets passed to *SetConstantBuffers1 must be multiples of 16 constants (256 bytes).
+const unsigned int CONSTANT_RING_ALIGNMENT = 256;
+const unsigned int CONSTANT_RING_SIZE = 4 * 1024 * 1024;
+const unsigned int CONSTANT_RING_FRAMES_IN_FLIGHT = 3;
+
+
+struct UniformRange
+{
+	unsigned int firstConstant;
+	unsigned int numConstants;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ConstantBufferRingClass
+////////////////////////////////////////////////////////////////////////////////
+class ConstantBufferRingClass
+{
+public:
+	ConstantBufferRingClass();
+	ConstantBufferRingClass(const ConstantBufferRingClass&);
+	~ConstantBufferRingClass();
+
+	bool Initialize(RenderBackendClass*, unsigned int, unsigned int);
+	void Shutdown();
+
+	bool Allocate(unsigned int, void**, UniformRange&);
+	bool Commit();
+	void Discard();
+	void EndFrame();
+
+	BufferHandle GetBuffer();
+	int GetMapCount();
+
+private:
+	RenderBackendClass* m_backend;
+	BufferHandle m_buffer;
+	unsigned char* m_shadowMemory;
+	unsigned char* m_shadow;
+	UniformRingAllocator m_allocator;
+	unsigned int m_commitOffset;
+	unsigned long long m_committedBytes;
+	bool m_noOverwrite;
+	bool m_discardPending;
+	int m_mapCount, m_lastMapCount;
+};
+
+#endif
@@ -0,0 +1,407 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d11renderbackendclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "d3d11renderbackendclass.h"
+
+
+D3D11RenderBackendClass::D3D11RenderBackendClass()
+{
+	m_D3D = 0;
+	m_device = 0;
+	m_deviceContext = 0;
+	m_deviceContext1 = 0;
+	m_caps.constantBufferOffsets = false;
+	m_caps.constantBufferNoOverwrite = false;
+	m_renderFlags = 0;
+}
+
+
+D3D11RenderBackendClass::D3D11RenderBackendClass(const D3D11RenderBackendClass& other)
+{
+}
+
+
+D3D11RenderBackendClass::~D3D11RenderBackendClass()
+{
+}
+
+
+bool D3D11RenderBackendClass::Initialize(D3DClass* d3d)
+{
+	HRESULT result;
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+
+
+	m_D3D = d3d;
+	m_device = m_D3D->GetDevice();
+	m_deviceContext = m_D3D->GetDeviceContext();
+
+	// The 11.1 interface is only needed to bind constant buffers by offset, so carry on without it.
+	result = m_deviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&m_deviceContext1);
+	if(FAILED(result))
+	{
+		m_deviceContext1 = 0;
+	}
+
+	// Offsetting also needs driver support, and NO_OVERWRITE on a constant buffer is a separate feature.
+	result = m_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+	if(SUCCEEDED(result) && m_deviceContext1)
+	{
+		m_caps.constantBufferOffsets = options.ConstantBufferOffsetting ? true : false;
+		m_caps.constantBufferNoOverwrite = options.MapNoOverwriteOnDynamicConstantBuffer ? true : false;
+	}
+
+	return true;
+}
+
+
+void D3D11RenderBackendClass::Shutdown()
+{
+	unsigned int i;
+
+
+	// Release the pipeline records.
+	for(i=0; i<m_pipelines.size(); i++)
+	{
+		delete m_pipelines[i];
+	}
+	m_pipelines.clear();
+
+	// Release the 11.1 device context interface.
+	if(m_deviceContext1)
+	{
+		m_deviceContext1->Release();
+		m_deviceContext1 = 0;
+	}
+
+	m_deviceContext = 0;
+	m_device = 0;
+	m_D3D = 0;
+
+	return;
+}
+
+
+BufferHandle D3D11RenderBackendClass::WrapBuffer(ID3D11Buffer* buffer)
+{
+	return (BufferHandle)buffer;
+}
+
+
+TextureHandle D3D11RenderBackendClass::WrapTexture(ID3D11ShaderResourceView* texture)
+{
+	return (TextureHandle)texture;
+}
+
+
+RenderBackendCaps D3D11RenderBackendClass::GetCaps()
+{
+	return m_caps;
+}
+
+
+BufferHandle D3D11RenderBackendClass::CreateBuffer(const BufferDesc& desc)
+{
+	HRESULT result;
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SUBRESOURCE_DATA bufferData;
+	ID3D11Buffer* buffer;
+
+
+	// Setup the description of the buffer.
+	bufferDesc.Usage = desc.dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+	bufferDesc.ByteWidth = desc.byteWidth;
+	bufferDesc.CPUAccessFlags = desc.dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	switch(desc.type)
+	{
+	case BUFFER_VERTEX:
+		bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		break;
+	case BUFFER_INDEX:
+		bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		break;
+	default:
+		bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		break;
+	}
+
+	// Give the subresource structure a pointer to the initial data, if there is any.
+	bufferData.pSysMem = desc.initialData;
+	bufferData.SysMemPitch = 0;
+	bufferData.SysMemSlicePitch = 0;
+
+	result = m_device->CreateBuffer(&bufferDesc, desc.initialData ? &bufferData : NULL, &buffer);
+	if(FAILED(result))
+	{
+		return 0;
+	}
+
+	return WrapBuffer(buffer);
+}
+
+
+void D3D11RenderBackendClass::DestroyBuffer(BufferHandle handle)
+{
+	if(handle)
+	{
+		((ID3D11Buffer*)handle)->Release();
+	}
+
+	return;
+}
+
+
+TextureHandle D3D11RenderBackendClass::CreateTexture(const TextureDesc& desc)
+{
+	HRESULT result;
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SUBRESOURCE_DATA textureData;
+	ID3D11Texture2D* texture;
+	ID3D11ShaderResourceView* textureView;
+
+
+	// Setup the description of a single mip RGBA texture.
+	textureDesc.Width = desc.width;
+	textureDesc.Height = desc.height;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+
+	textureData.pSysMem = desc.initialData;
+	textureData.SysMemPitch = desc.width * 4;
+	textureData.SysMemSlicePitch = 0;
+
+	result = m_device->CreateTexture2D(&textureDesc, desc.initialData ? &textureData : NULL, &texture);
+	if(FAILED(result))
+	{
+		return 0;
+	}
+
+	// The view keeps the texture alive, so the handle is just the view.
+	result = m_device->CreateShaderResourceView(texture, NULL, &textureView);
+	texture->Release();
+	if(FAILED(result))
+	{
+		return 0;
+	}
+
+	return WrapTexture(textureView);
+}
+
+
+void D3D11RenderBackendClass::DestroyTexture(TextureHandle handle)
+{
+	if(handle)
+	{
+		((ID3D11ShaderResourceView*)handle)->Release();
+	}
+
+	return;
+}
+
+
+PipelineHandle D3D11RenderBackendClass::CreatePipeline(const PipelineDesc& desc)
+{
+	PipelineType* pipeline;
+
+
+	pipeline = new PipelineType;
+	if(!pipeline)
+	{
+		return 0;
+	}
+
+	pipeline->vertexShader = (ID3D11VertexShader*)desc.vertexShader;
+	pipeline->pixelShader = (ID3D11PixelShader*)desc.pixelShader;
+	pipeline->layout = (ID3D11InputLayout*)desc.inputLayout;
+	pipeline->sampleState = (ID3D11SamplerState*)desc.sampleState;
+
+	m_pipelines.push_back(pipeline);
+
+	return (PipelineHandle)pipeline;
+}
+
+
+void D3D11RenderBackendClass::DestroyPipeline(PipelineHandle handle)
+{
+	unsigned int i;
+
+
+	for(i=0; i<m_pipelines.size(); i++)
+	{
+		if((PipelineHandle)m_pipelines[i] == handle)
+		{
+			delete m_pipelines[i];
+			m_pipelines.erase(m_pipelines.begin() + i);
+			break;
+		}
+	}
+
+	return;
+}
+
+
+void* D3D11RenderBackendClass::Map(BufferHandle handle, MapMode mode)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+
+	result = m_deviceContext->Map((ID3D11Buffer*)handle, 0, mode == MAP_WRITE_NO_OVERWRITE ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD,
+								  0, &mappedResource);
+	if(FAILED(result))
+	{
+		return 0;
+	}
+
+	return mappedResource.pData;
+}
+
+
+void D3D11RenderBackendClass::Unmap(BufferHandle handle, unsigned int bytesWritten)
+{
+	m_deviceContext->Unmap((ID3D11Buffer*)handle, 0);
+}
+
+
+void D3D11RenderBackendClass::SetRenderFlags(unsigned int renderFlags)
+{
+	unsigned int changed;
+
+
+	changed = m_renderFlags ^ renderFlags;
+
+	if(changed & RENDER_FLAG_WIREFRAME)
+	{
+		if(renderFlags & RENDER_FLAG_WIREFRAME)
+		{
+			m_D3D->TurnOnWireframe();
+		}
+		else
+		{
+			m_D3D->TurnOffWireframe();
+		}
+	}
+
+	if(changed & RENDER_FLAG_ALPHA_BLEND)
+	{
+		if(renderFlags & RENDER_FLAG_ALPHA_BLEND)
+		{
+			m_D3D->TurnOnAlphaBlending();
+		}
+		else
+		{
+			m_D3D->TurnOffAlphaBlending();
+		}
+	}
+
+	m_renderFlags = renderFlags;
+
+	return;
+}
+
+
+void D3D11RenderBackendClass::SetPipeline(PipelineHandle handle)
+{
+	PipelineType* pipeline;
+
+
+	pipeline = (PipelineType*)handle;
+
+	// Set the vertex input layout, the shaders and the sampler state in the pixel shader.
+	m_deviceContext->IASetInputLayout(pipeline->layout);
+	m_deviceContext->VSSetShader(pipeline->vertexShader, NULL, 0);
+	m_deviceContext->PSSetShader(pipeline->pixelShader, NULL, 0);
+	m_deviceContext->PSSetSamplers(0, 1, &pipeline->sampleState);
+}
+
+
+void D3D11RenderBackendClass::SetTopology(PrimitiveTopology topology)
+{
+	m_deviceContext->IASetPrimitiveTopology(topology == TOPOLOGY_LINE_LIST ? D3D11_PRIMITIVE_TOPOLOGY_LINELIST : D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+
+void D3D11RenderBackendClass::SetVertexBuffer(BufferHandle handle, unsigned int stride, unsigned int offset)
+{
+	ID3D11Buffer* vertexBuffer;
+
+
+	vertexBuffer = (ID3D11Buffer*)handle;
+	m_deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+}
+
+
+void D3D11RenderBackendClass::SetIndexBuffer(BufferHandle handle)
+{
+	m_deviceContext->IASetIndexBuffer((ID3D11Buffer*)handle, DXGI_FORMAT_R32_UINT, 0);
+}
+
+
+void D3D11RenderBackendClass::SetTexture(unsigned int slot, TextureHandle handle)
+{
+	ID3D11ShaderResourceView* texture;
+
+
+	texture = (ID3D11ShaderResourceView*)handle;
+	m_deviceContext->PSSetShaderResources(slot, 1, &texture);
+}
+
+
+void D3D11RenderBackendClass::SetVSConstantBuffer(unsigned int slot, BufferHandle handle, unsigned int firstConstant, unsigned int numConstants)
+{
+	ID3D11Buffer* buffer;
+
+
+	buffer = (ID3D11Buffer*)handle;
+
+	// A zero sized range binds the whole buffer.
+	if(numConstants > 0 && m_deviceContext1)
+	{
+		m_deviceContext1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	}
+	else
+	{
+		m_deviceContext->VSSetConstantBuffers(slot, 1, &buffer);
+	}
+}
+
+
+void D3D11RenderBackendClass::SetPSConstantBuffer(unsigned int slot, BufferHandle handle, unsigned int firstConstant, unsigned int numConstants)
+{
+	ID3D11Buffer* buffer;
+
+
+	buffer = (ID3D11Buffer*)handle;
+
+	// A zero sized range binds the whole buffer.
+	if(numConstants > 0 && m_deviceContext1)
+	{
+		m_deviceContext1->PSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	}
+	else
+	{
+		m_deviceContext->PSSetConstantBuffers(slot, 1, &buffer);
+	}
+}
+
+
+void D3D11RenderBackendClass::Draw(unsigned int vertexCount, unsigned int startVertex)
+{
+	m_deviceContext->Draw(vertexCount, startVertex);
+}
+
+
+void D3D11RenderBackendClass::DrawIndexed(unsigned int indexCount, unsigned int startIndex)
+{
+	m_deviceContext->DrawIndexed(indexCount, startIndex, 0);
+}
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d11renderbackendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _D3D11RENDERBACKENDCLASS_H_
+#define _D3D11RENDERBACKENDCLASS_H_
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11_1.h>
+#include <vector>
+using namespace std;
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "d3dclass.h"
+#include "renderbackendclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D11RenderBackendClass
+////////////////////////////////////////////////////////////////////////////////
+class D3D11RenderBackendClass : public RenderBackendClass
+{
+private:
+	// The shader objects stay owned by the shader class that compiled them.
+	struct PipelineType
+	{
+		ID3D11VertexShader* vertexShader;
+		ID3D11PixelShader* pixelShader;
+		ID3D11InputLayout* layout;
+		ID3D11SamplerState* sampleState;
+	};
+
+public:
+	D3D11RenderBackendClass();
+	D3D11RenderBackendClass(const D3D11RenderBackendClass&);
+	~D3D11RenderBackendClass();
+
+	bool Initialize(D3DClass*);
+	void Shutdown();
+
+	static BufferHandle WrapBuffer(ID3D11Buffer*);
+	static TextureHandle WrapTexture(ID3D11ShaderResourceView*);
+
+	RenderBackendCaps GetCaps();
+
+	BufferHandle CreateBuffer(const BufferDesc&);
+	void DestroyBuffer(BufferHandle);
+	TextureHandle CreateTexture(const TextureDesc&);
+	void DestroyTexture(TextureHandle);
+	PipelineHandle CreatePipeline(const PipelineDesc&);
+	void DestroyPipeline(PipelineHandle);
+
+	void* Map(BufferHandle, MapMode);
+	void Unmap(BufferHandle, unsigned int);
+
+	void SetRenderFlags(unsigned int);
+	void SetPipeline(PipelineHandle);
+	void SetTopology(PrimitiveTopology);
+	void SetVertexBuffer(BufferHandle, unsigned int, unsigned int);
+	void SetIndexBuffer(BufferHandle);
+	void SetTexture(unsigned int, TextureHandle);
+	void SetVSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int);
+	void SetPSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int);
+
+	void Draw(unsigned int, unsigned int);
+	void DrawIndexed(unsigned int, unsigned int);
+
+private:
+	D3DClass* m_D3D;
+	ID3D11Device* m_device;
+	ID3D11DeviceContext* m_deviceContext;
+	ID3D11DeviceContext1* m_deviceContext1;
+	RenderBackendCaps m_caps;
+	unsigned int m_renderFlags;
+	vector<PipelineType*> m_pipelines;
+};
+
+#endif
@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: debugdrawclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "debugdrawclass.h"
+
+#include <cstring>
+
+
+DebugDrawClass::DebugDrawClass()
+{
+	m_backend = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_Texture = 0;
+	m_maxLines = 0;
+}
+
+
+DebugDrawClass::DebugDrawClass(const DebugDrawClass& other)
+{
+}
+
+
+DebugDrawClass::~DebugDrawClass()
+{
+}
+
+
+bool DebugDrawClass::Initialize(ID3D11Device* device, RenderBackendClass* backend, unsigned int maxLines)
+{
+	BufferDesc desc;
+	unsigned long* indices;
+	unsigned int i;
+	bool result;
+
+
+	m_backend = backend;
+	m_maxLines = maxLines;
+
+	// Create the dynamic vertex buffer the lines are written into each frame.
+	desc.type = BUFFER_VERTEX;
+	desc.byteWidth = m_maxLines * 2 * sizeof(VertexType);
+	desc.dynamic = true;
+	desc.initialData = 0;
+
+	m_vertexBuffer = m_backend->CreateBuffer(desc);
+	if(!m_vertexBuffer)
+	{
+		return false;
+	}
+
+	// The shader manager draws indexed, so the lines use a static index buffer that counts up.
+	indices = new unsigned long[m_maxLines * 2];
+	if(!indices)
+	{
+		return false;
+	}
+
+	for(i=0; i<m_maxLines * 2; i++)
+	{
+		indices[i] = i;
+	}
+
+	desc.type = BUFFER_INDEX;
+	desc.byteWidth = m_maxLines * 2 * sizeof(unsigned long);
+	desc.dynamic = false;
+	desc.initialData = indices;
+
+	m_indexBuffer = m_backend->CreateBuffer(desc);
+
+	// Release the index array as it is no longer needed.
+	delete [] indices;
+	indices = 0;
+
+	if(!m_indexBuffer)
+	{
+		return false;
+	}
+
+	// Load the plain white texture the lines are drawn with, once for every line.
+	m_Texture = new TextureClass;
+	if(!m_Texture)
+	{
+		return false;
+	}
+
+	result = m_Texture->Initialize(device, L"../Engine/data/white.dds");
+	if(!result)
+	{
+		return false;
+	}
+
+	m_vertices.reserve(m_maxLines * 2);
+
+	return true;
+}
+
+
+void DebugDrawClass::Shutdown()
+{
+	// Release the texture object.
+	if(m_Texture)
+	{
+		m_Texture->Shutdown();
+		delete m_Texture;
+		m_Texture = 0;
+	}
+
+	// Release the index and vertex buffers.
+	if(m_indexBuffer)
+	{
+		m_backend->DestroyBuffer(m_indexBuffer);
+		m_indexBuffer = 0;
+	}
+
+	if(m_vertexBuffer)
+	{
+		m_backend->DestroyBuffer(m_vertexBuffer);
+		m_vertexBuffer = 0;
+	}
+
+	m_vertices.clear();
+	m_backend = 0;
+
+	return;
+}
+
+
+bool DebugDrawClass::AddLine(const XMFLOAT3& start, const XMFLOAT3& end)
+{
+	VertexType vertex;
+
+
+	// Drop lines past the end of the buffer rather than growing it.
+	if(m_vertices.size() + 2 > m_maxLines * 2)
+	{
+		return false;
+	}
+
+	vertex.texture = XMFLOAT2(0.0f, 0.0f);
+
+	vertex.position = start;
+	m_vertices.push_back(vertex);
+
+	vertex.position = end;
+	m_vertices.push_back(vertex);
+
+	return true;
+}
+
+
+bool DebugDrawClass::AddBox(const XMFLOAT3& mins, const XMFLOAT3& maxs, const XMMATRIX& transform)
+{
+	XMFLOAT3 corners[8];
+	unsigned int i, axis;
+	bool result;
+
+
+	// Corner i takes the max on x, y and z when bits 0, 1 and 2 of i are set.
+	for(i=0; i<8; i++)
+	{
+		XMFLOAT3 corner((i & 1) ? maxs.x : mins.x, (i & 2) ? maxs.y : mins.y, (i & 4) ? maxs.z : mins.z);
+		XMStoreFloat3(&corners[i], XMVector3Transform(XMLoadFloat3(&corner), transform));
+	}
+
+	// Each edge joins two corners that differ on one axis.
+	result = true;
+	for(i=0; i<8; i++)
+	{
+		for(axis=1; axis<8; axis<<=1)
+		{
+			if(!(i & axis))
+			{
+				result = AddLine(corners[i], corners[i | axis]) && result;
+			}
+		}
+	}
+
+	return result;
+}
+
+
+bool DebugDrawClass::Render(ShaderManagerClass* shaderManager, ID3D11DeviceContext* deviceContext, const XMMATRIX& viewMatrix,
+							const XMMATRIX& projectionMatrix)
+{
+	void* data;
+	unsigned int vertexCount;
+	bool result;
+
+
+	vertexCount = (unsigned int)m_vertices.size();
+	if(vertexCount == 0)
+	{
+		return true;
+	}
+
+	// Upload this frame's lines in one go.
+	data = m_backend->Map(m_vertexBuffer, MAP_WRITE_DISCARD);
+	if(!data)
+	{
+		m_vertices.clear();
+		return false;
+	}
+
+	memcpy(data, &m_vertices[0], vertexCount * sizeof(VertexType));
+
+	m_backend->Unmap(m_vertexBuffer, vertexCount * sizeof(VertexType));
+
+	// The lines are already in world space, so they are drawn with an identity world matrix.
+	shaderManager->SetTopology(TOPOLOGY_LINE_LIST);
+	result = shaderManager->RenderTextureShader(deviceContext, m_vertexBuffer, m_indexBuffer, sizeof(VertexType), vertexCount, XMMatrixIdentity(),
+		viewMatrix, projectionMatrix, m_Texture->GetTexture());
+	shaderManager->SetTopology(TOPOLOGY_TRIANGLE_LIST);
+
+	// Start collecting the next frame's lines.
+	m_vertices.clear();
+
+	return result;
+}
+
+
+int DebugDrawClass::GetLineCount()
+{
+	return (int)m_vertices.size() / 2;
+}
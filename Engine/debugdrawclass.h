@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: debugdrawclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _DEBUGDRAWCLASS_H_
+#define _DEBUGDRAWCLASS_H_
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <vector>
+using namespace DirectX;
+using namespace std;
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "shadermanagerclass.h"
+#include "textureclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: DebugDrawClass
+//
+// Immediate mode debug lines. Lines and boxes are added during the frame in
+// world space and all of them go out in one line list draw from a single
+// dynamic vertex buffer. Nothing is allocated after Initialize.
+////////////////////////////////////////////////////////////////////////////////
+class DebugDrawClass
+{
+private:
+	struct VertexType
+	{
+		XMFLOAT3 position;
+		XMFLOAT2 texture;
+	};
+
+public:
+	DebugDrawClass();
+	DebugDrawClass(const DebugDrawClass&);
+	~DebugDrawClass();
+
+	bool Initialize(ID3D11Device*, RenderBackendClass*, unsigned int);
+	void Shutdown();
+
+	bool AddLine(const XMFLOAT3&, const XMFLOAT3&);
+	bool AddBox(const XMFLOAT3&, const XMFLOAT3&, const XMMATRIX&);
+	bool Render(ShaderManagerClass*, ID3D11DeviceContext*, const XMMATRIX&, const XMMATRIX&);
+
+	int GetLineCount();
+
+private:
+	RenderBackendClass* m_backend;
+	BufferHandle m_vertexBuffer;
+	BufferHandle m_indexBuffer;
+	TextureClass* m_Texture;
+	unsigned int m_maxLines;
+	vector<VertexType> m_vertices;
+};
+
+#endif
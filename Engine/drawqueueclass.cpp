@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: drawqueueclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "drawqueueclass.h"
+
+
+DrawQueueClass::DrawQueueClass()
+{
+}
+
+
+DrawQueueClass::DrawQueueClass(const DrawQueueClass& other)
+{
+}
+
+
+DrawQueueClass::~DrawQueueClass()
+{
+}
+
+
+bool DrawQueueClass::Initialize(unsigned int capacity)
+{
+	// Reserve up front so recording a frame does not reallocate.
+	m_packets.reserve(capacity);
+
+	return true;
+}
+
+
+void DrawQueueClass::Shutdown()
+{
+	m_packets.clear();
+	m_packets.shrink_to_fit();
+
+	return;
+}
+
+
+void DrawQueueClass::Add(const DrawPacket& packet)
+{
+	m_packets.push_back(packet);
+
+	return;
+}
+
+
+void DrawQueueClass::Execute(ConstantBufferRingClass* constantRing, RenderBackendClass* backend)
+{
+	BufferHandle ringBuffer;
+	unsigned int i, j;
+
+
+	ringBuffer = constantRing->GetBuffer();
+
+	// Every packet sets its full state, the backend is expected to drop the binds that do not change.
+	for(i=0; i<m_packets.size(); i++)
+	{
+		const DrawPacket& packet = m_packets[i];
+
+		backend->SetRenderFlags(packet.renderFlags);
+
+		// Set the vertex and index buffers to active in the input assembler.
+		backend->SetVertexBuffer(packet.vertexBuffer, packet.stride, 0);
+		backend->SetIndexBuffer(packet.indexBuffer);
+		backend->SetTopology(packet.topology);
+
+		// Set the shaders, input layout and sampler.
+		backend->SetPipeline(packet.pipeline);
+
+		for(j=0; j<packet.textureCount; j++)
+		{
+			backend->SetTexture(j, packet.textures[j]);
+		}
+
+		// Bind each constant buffer slot to this draw's window of the ring.
+		for(j=0; j<packet.vsConstantCount; j++)
+		{
+			backend->SetVSConstantBuffer(j, ringBuffer, packet.vsConstants[j].firstConstant, packet.vsConstants[j].numConstants);
+		}
+
+		for(j=0; j<packet.psConstantCount; j++)
+		{
+			backend->SetPSConstantBuffer(j, ringBuffer, packet.psConstants[j].firstConstant, packet.psConstants[j].numConstants);
+		}
+
+		backend->DrawIndexed(packet.indexCount, 0);
+	}
+
+	// Leave the device in the default solid, opaque state.
+	backend->SetRenderFlags(0);
+
+	m_packets.clear();
+
+	return;
+}
+
+
+int DrawQueueClass::GetCount()
+{
+	return (int)m_packets.size();
+}
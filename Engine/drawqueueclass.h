@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: drawqueueclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _DRAWQUEUECLASS_H_
+#define _DRAWQUEUECLASS_H_
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+using namespace std;
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "renderbackendclass.h"
+#include "constantbufferringclass.h"
+
+
+// Everything needed to issue one draw after the frame's constants have been committed.
+struct DrawPacket
+{
+	PipelineHandle pipeline;
+
+	BufferHandle vertexBuffer;
+	BufferHandle indexBuffer;
+	unsigned int stride;
+	unsigned int indexCount;
+	PrimitiveTopology topology;
+
+	TextureHandle textures[2];
+	unsigned int textureCount;
+
+	UniformRange vsConstants[2];
+	unsigned int vsConstantCount;
+	UniformRange psConstants[1];
+	unsigned int psConstantCount;
+
+	unsigned int renderFlags;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: DrawQueueClass
+////////////////////////////////////////////////////////////////////////////////
+class DrawQueueClass
+{
+public:
+	DrawQueueClass();
+	DrawQueueClass(const DrawQueueClass&);
+	~DrawQueueClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	void Add(const DrawPacket&);
+	void Execute(ConstantBufferRingClass*, RenderBackendClass*);
+	int GetCount();
+
+private:
+	vector<DrawPacket> m_packets;
+};
+
+#endif
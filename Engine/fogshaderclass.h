@@ -17,6 +17,13 @@ using namespace DirectX;
 using namespace std;
 
 
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "drawqueueclass.h"
+#include "d3d11renderbackendclass.h"
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: FogShaderClass
 ////////////////////////////////////////////////////////////////////////////////
@@ -54,6 +61,9 @@ public:
 	void Shutdown();
 	bool Render(ID3D11DeviceContext*, int, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*, XMFLOAT3, XMFLOAT4, XMFLOAT4,
 		XMFLOAT3, XMFLOAT4, float);
+	bool CreatePipeline(RenderBackendClass*);
+	bool Record(ConstantBufferRingClass*, DrawPacket&, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*, XMFLOAT3, XMFLOAT4, XMFLOAT4,
+		XMFLOAT3, XMFLOAT4, float);
 
 private:
 	bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
@@ -69,6 +79,7 @@ private:
 	ID3D11PixelShader* m_pixelShader;
 	ID3D11InputLayout* m_layout;
 	ID3D11SamplerState* m_sampleState;
+	PipelineHandle m_pipeline;
 	ID3D11Buffer* m_matrixBuffer;
 	ID3D11Buffer* m_cameraBuffer;
 	ID3D11Buffer* m_lightBuffer;
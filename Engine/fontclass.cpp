@@ -159,63 +159,58 @@ ID3D11ShaderResourceView* FontClass::GetTexture()
 }
 
 
-void FontClass::BuildVertexArray(void* vertices, char* sentence, float drawX, float drawY)
+int FontClass::BuildQuadArray(SpriteQuad* quads, const char* sentence, float drawX, float drawY)
 {
-	VertexType* vertexPtr;
-	int numLetters, index, i, letter;
+	float startX;
+	int count, letter;
+	const char* character;
 
 
-	// Coerce the input vertices into a VertexType structure.
-	vertexPtr = (VertexType*)vertices;
+	// Remember where lines start so a newline can return to it.
+	startX = drawX;
 
-	// Get the number of letters in the sentence.
-	numLetters = (int)strlen(sentence);
+	// Initialize the number of quads written.
+	count = 0;
 
-	// Initialize the index to the vertex array.
-	index = 0;
-
-	// Draw each letter onto a quad.
-	for(i=0; i<numLetters; i++)
+	// Put each letter onto a quad.
+	for(character=sentence; *character; character++)
 	{
-		letter = ((int)sentence[i]) - 32;
+		// Start a new line below the current one.
+		if(*character == '\n')
+		{
+			drawX = startX;
+			drawY = drawY - 18.0f;
+			continue;
+		}
+
+		letter = ((int)(unsigned char)*character) - 32;
+
+		// Skip control characters and anything past the end of the font.
+		if(letter < 0 || letter >= 95)
+		{
+			continue;
+		}
 
 		// If the letter is a space then just move over three pixels.
 		if(letter == 0)
 		{
 			drawX = drawX + 3.0f;
+			continue;
 		}
-		else
-		{
-			// First triangle in quad.
-			vertexPtr[index].position = XMFLOAT3(drawX, drawY, 0.0f);  // Top left.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].left, 0.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3((drawX + m_Font[letter].size), (drawY - 16), 0.0f);  // Bottom right.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].right, 1.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3(drawX, (drawY - 16), 0.0f);  // Bottom left.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].left, 1.0f);
-			index++;
-
-			// Second triangle in quad.
-			vertexPtr[index].position = XMFLOAT3(drawX, drawY, 0.0f);  // Top left.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].left, 0.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3(drawX + m_Font[letter].size, drawY, 0.0f);  // Top right.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].right, 0.0f);
-			index++;
-
-			vertexPtr[index].position = XMFLOAT3((drawX + m_Font[letter].size), (drawY - 16), 0.0f);  // Bottom right.
-			vertexPtr[index].texture = XMFLOAT2(m_Font[letter].right, 1.0f);
-			index++;
-
-			// Update the x location for drawing by the size of the letter and one pixel.
-			drawX = drawX + m_Font[letter].size + 1.0f;
-		}
+
+		quads[count].x = drawX;
+		quads[count].y = drawY;
+		quads[count].width = (float)m_Font[letter].size;
+		quads[count].height = 16.0f;
+		quads[count].left = m_Font[letter].left;
+		quads[count].top = 0.0f;
+		quads[count].right = m_Font[letter].right;
+		quads[count].bottom = 1.0f;
+		count++;
+
+		// Update the x location for drawing by the size of the letter and one pixel.
+		drawX = drawX + m_Font[letter].size + 1.0f;
 	}
 
-	return;
-}
\ No newline at end of file
+	return count;
+}
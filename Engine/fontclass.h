@@ -18,6 +18,7 @@ using namespace std;
 // MY CLASS INCLUDES //
 ///////////////////////
 #include "textureclass.h"
+#include "spritebatchclass.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,12 +33,6 @@ private:
 		int size;
 	};
 
-	struct VertexType
-	{
-		XMFLOAT3 position;
-	    XMFLOAT2 texture;
-	};
-
 public:
 	FontClass();
 	FontClass(const FontClass&);
@@ -48,7 +43,7 @@ public:
 
 	ID3D11ShaderResourceView* GetTexture();
 
-	void BuildVertexArray(void*, char*, float, float);
+	int BuildQuadArray(SpriteQuad*, const char*, float, float);
 
 private:
 	bool LoadFontData(char*);
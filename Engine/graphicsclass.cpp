@@ -3,16 +3,19 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "graphicsclass.h"
 #include "ParticleSystem.h"
+#include "TextFormatter.h"
+#include "MathUtil.h"
 #include <ctime>
 #include <chrono>
 #include <cstdint>
 #include <conio.h>
 #include <sstream>
 
-GraphicsClass::GraphicsClass()
+GraphicsClass::GraphicsClass() : m_Simulation(SIMULATION_STEP, SIMULATION_MAX_STEPS)
 {
 	m_D3D = 0;
 	m_ShaderManager = 0;
+	m_DebugDraw = 0;
 	m_Light = 0;
 	m_Camera = 0;
 	m_Model1 = 0;
@@ -23,11 +26,25 @@ GraphicsClass::GraphicsClass()
 	m_SkyPlane = 0;
 	m_SkyPlaneShader = 0;
 
+	m_Snapshot = 0;
+	m_CameraAngle = XMFLOAT3(0.f, 0.f, 0.f);
+	m_CameraPosition = XMFLOAT3(0.f, 0.f, 0.f);
+	m_FreeCamera = false;
+
+	m_CullTask = -1;
+	m_FrameResult = true;
+	m_FrameAlpha = 0.f;
+	m_MouseX = 0;
+	m_MouseY = 0;
+	m_ScreenWidth = 0.f;
+	m_ScreenHeight = 0.f;
+	m_MouseClicked = false;
+
 	GetCursorPos(&lastCursorPos);
 }
 
 
-GraphicsClass::GraphicsClass(const GraphicsClass& other)
+GraphicsClass::GraphicsClass(const GraphicsClass& other) : m_Simulation(SIMULATION_STEP, SIMULATION_MAX_STEPS)
 {
 }
 
@@ -67,13 +84,28 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd, Wor
 	}
 
 	// Initialize the shader manager object.
-	result = m_ShaderManager->Initialize(m_D3D->GetDevice(), hwnd);
+	result = m_ShaderManager->Initialize(m_D3D, hwnd);
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the shader manager object.", L"Error", MB_OK);
 		return false;
 	}
 
+	// Create the debug draw object.
+	m_DebugDraw = new DebugDrawClass;
+	if (!m_DebugDraw)
+	{
+		return false;
+	}
+
+	// Initialize the debug draw object, every box is twelve lines.
+	result = m_DebugDraw->Initialize(m_D3D->GetDevice(), m_ShaderManager->GetBackend(), 12 * 1024);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the debug draw object.", L"Error", MB_OK);
+		return false;
+	}
+
 	// Create the camera object.
 	m_Camera = new CameraClass;
 	if (!m_Camera)
@@ -204,22 +236,42 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd, Wor
 	}
 
 	// Initialize the text object.
-	result = m_Text->Initialize(m_D3D->GetDevice(), m_D3D->GetDeviceContext(), hwnd, screenWidth, screenHeight, baseViewMatrix);
+	result = m_Text->Initialize(m_D3D->GetDevice(), m_D3D->GetDeviceContext(), hwnd, screenWidth, screenHeight, baseViewMatrix,
+		m_ShaderManager->GetBackend());
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the text object.", L"Error", MB_OK);
 		return false;
 	}
 
-	LastTime = timeGetTime();
+	BuildFrameGraph();
+
+	m_Picker.pGraphicsClass = this;
+
 	pWorld->PostInitialized();
 
+	// From here the world belongs to the simulation thread
+	SimulationInput input;
+	input.inputFrame.horizontal = 0.f;
+	input.inputFrame.vertical = 0.f;
+	input.cameraAngle = *pWorld->pCameraAngle;
+	input.freeCamera = false;
+	input.cameraPosition = *pWorld->pCameraPosition;
+
+	m_CameraAngle = input.cameraAngle;
+
+	m_Simulation.Start(pWorld, input);
+	m_Timer.Reset();
+
 	return true;
 }
 
 
 void GraphicsClass::Shutdown()
 {
+	// Stop stepping the world before anything it draws with goes away
+	m_Simulation.Stop();
+
 	// Release the sky plane shader object.
 	if (m_SkyPlaneShader)
 	{
@@ -280,6 +332,14 @@ void GraphicsClass::Shutdown()
 		m_Camera = 0;
 	}
 
+	// Release the debug draw object.
+	if (m_DebugDraw)
+	{
+		m_DebugDraw->Shutdown();
+		delete m_DebugDraw;
+		m_DebugDraw = 0;
+	}
+
 	// Release the shader manager object.
 	if (m_ShaderManager)
 	{
@@ -327,42 +387,315 @@ bool GraphicsClass::Frame()
 }
 
 
-void GraphicsClass::RenderText(std::string text)
+// The phases are added in the order they ran in as one loop. Culling is split over the workers,
+// anything that records draws stays on this thread. Picking only reads the snapshot and sends
+// what it finds to the simulation, so it runs alongside the rest.
+void GraphicsClass::BuildFrameGraph()
 {
-	m_Camera->Render();
+	m_FrameGraph.AddTask("transform", TaskMethod<GraphicsClass, &GraphicsClass::FrameTransform>, this,
+		FRAME_SNAPSHOT, FRAME_MATRICES);
+	m_CullTask = m_FrameGraph.AddTask("cull", TaskMethod<GraphicsClass, &GraphicsClass::FrameCull>, this,
+		FRAME_SNAPSHOT | FRAME_MATRICES, FRAME_VISIBILITY, 0, 0, 64);
+	m_FrameGraph.AddTask("queue", TaskMethod<GraphicsClass, &GraphicsClass::FrameQueue>, this,
+		FRAME_SNAPSHOT | FRAME_MATRICES | FRAME_VISIBILITY, FRAME_QUEUE, TASK_MAIN_THREAD);
+	m_FrameGraph.AddTask("submit", TaskMethod<GraphicsClass, &GraphicsClass::FrameSubmit>, this,
+		FRAME_SNAPSHOT, FRAME_QUEUE, TASK_MAIN_THREAD);
+	m_FrameGraph.AddTask("pick", TaskMethod<GraphicsClass, &GraphicsClass::FramePick>, this,
+		FRAME_SNAPSHOT | FRAME_MATRICES, 0);
+}
 
-	XMMATRIX projectionMatrix, worldMatrix, orthoMatrix;
 
-	// Get the view, projection, and world matrices from the camera and D3D objects.
-	// m_Camera->GetViewMatrix(viewMatrix);
-	m_D3D->GetProjectionMatrix(projectionMatrix);
+// Items without a parent are blended m_FrameAlpha of the way from the previous step to the last
+// one and built in one batch, the rest were given their world matrix by the simulation. The city's
+// instances follow the items and are built in a batch of their own.
+void GraphicsClass::FrameTransform(unsigned int begin, unsigned int end)
+{
+	const std::vector<RenderItem>& items = m_Snapshot->items;
+	const std::vector<CityInstance>& instances = m_Snapshot->instances;
+	const std::vector<CityModel>& models = m_Snapshot->instanceModels;
+	unsigned int count = (unsigned int)(items.size() + instances.size());
+	unsigned int i;
+
+
+	m_FrameMatrices.resize(count);
+	m_FrameModels.resize(count);
+	m_FrameShaders.resize(count);
+
+	m_BlendItems.clear();
+	m_BlendPositions.clear();
+	m_BlendOrientations.clear();
+	m_BlendScales.clear();
+
+	for (i = 0; i < items.size(); i++)
+	{
+		const RenderItem& item = items[i];
+
+		m_FrameModels[i] = item.pModel;
+		m_FrameShaders[i] = item.shader;
+
+		if (!item.interpolate)
+		{
+			m_FrameMatrices[i] = item.world;
+			continue;
+		}
+
+		m_BlendItems.push_back(i);
+		m_BlendPositions.push_back(MathUtil::AddFloat3(item.previousPosition,
+			MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(item.position, item.previousPosition), m_FrameAlpha)));
+		m_BlendOrientations.push_back(MathUtil::OrientationNlerp(item.previousOrientation, item.orientation, m_FrameAlpha));
+		m_BlendScales.push_back(MathUtil::AddFloat3(item.previousScale,
+			MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(item.scale, item.previousScale), m_FrameAlpha)));
+	}
+
+	if (!m_BlendItems.empty())
+	{
+		m_BlendWorlds.resize(m_BlendItems.size());
+
+		MathUtil::BuildWorldMatrices(&m_BlendPositions[0], &m_BlendOrientations[0], &m_BlendScales[0], (unsigned int)m_BlendItems.size(),
+			&m_BlendWorlds[0], 0);
+
+		for (i = 0; i < m_BlendItems.size(); i++)
+		{
+			m_FrameMatrices[m_BlendItems[i]] = m_BlendWorlds[i];
+		}
+	}
+
+	if (!instances.empty())
+	{
+		XMFLOAT4 turns[4];
+		for (i = 0; i < 4; i++)
+		{
+			turns[i] = MathUtil::AngleOrientation(XMFLOAT3(0.f, i * XM_PIDIV2, 0.f));
+		}
+
+		m_InstancePositions.resize(instances.size());
+		m_InstanceOrientations.resize(instances.size());
+		m_InstanceScales.resize(instances.size());
+
+		for (i = 0; i < instances.size(); i++)
+		{
+			const CityModel& model = models[instances[i].Model];
+
+			m_InstancePositions[i] = MathUtil::FromFloat3(instances[i].Position);
+			m_InstanceOrientations[i] = turns[instances[i].Turns & 3];
+			m_InstanceScales[i] = XMFLOAT3(model.Scale, model.Scale, model.Scale);
+
+			m_FrameModels[items.size() + i] = model.pModel;
+			m_FrameShaders[items.size() + i] = model.Shader;
+		}
+
+		MathUtil::BuildWorldMatrices(&m_InstancePositions[0], &m_InstanceOrientations[0], &m_InstanceScales[0], (unsigned int)instances.size(),
+			&m_FrameMatrices[items.size()], 0);
+	}
+
+	m_CullMins.resize(count);
+	m_CullMaxs.resize(count);
+	m_CullMatrices.resize(count);
+	m_Visible.resize(count);
+
+	m_FrameGraph.SetTaskCount(m_CullTask, count);
+}
+
+
+// Each job puts its objects' model bounds into world space in one batch, then tests them against the frustum
+void GraphicsClass::FrameCull(unsigned int begin, unsigned int end)
+{
+	unsigned int i;
+	int j;
+
+
+	for (i = begin; i < end; i++)
+	{
+		m_FrameModels[i]->GetBounds(m_CullMins[i], m_CullMaxs[i]);
+		m_CullMatrices[i] = m_FrameMatrices[i];
+	}
+
+	ObjectBoundingBox::TransformBounds(&m_CullMins[begin], &m_CullMaxs[begin], &m_CullMatrices[begin], end - begin,
+		&m_CullMins[begin], &m_CullMaxs[begin]);
+
+	for (i = begin; i < end; i++)
+	{
+		m_Visible[i] = 1;
+
+		// The box is outside when its corner furthest along a plane's normal is behind that plane
+		for (j = 0; j < 6 && m_Visible[i]; j++)
+		{
+			const XMFLOAT4& plane = m_FrustumPlanes[j];
+
+			float x = plane.x >= 0.f ? m_CullMaxs[i].x : m_CullMins[i].x;
+			float y = plane.y >= 0.f ? m_CullMaxs[i].y : m_CullMins[i].y;
+			float z = plane.z >= 0.f ? m_CullMaxs[i].z : m_CullMins[i].z;
+
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.f)
+			{
+				m_Visible[i] = 0;
+			}
+		}
+	}
+}
+
+
+void GraphicsClass::FrameQueue(unsigned int begin, unsigned int end)
+{
+	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
+	bool result;
+
+
+	viewMatrix = XMLoadFloat4x4(&m_FrameView);
+	projectionMatrix = XMLoadFloat4x4(&m_FrameProjection);
+
+	for (int i = 0; i < m_Visible.size(); i++) {
+		if (!m_Visible[i]) { continue; }
+
+		BumpModelClass* pModelClass = m_FrameModels[i];
+
+		worldMatrix = XMLoadFloat4x4(&m_FrameMatrices[i]);
+
+		// Store the global xyz coordinates of the object in an XMFLOAT3
+		XMVECTOR worldPos = worldMatrix.r[3];
+		XMFLOAT3 objectPos;
+		XMStoreFloat3(&objectPos, worldPos);
+
+		// Calculate the relative position between the lighting origin and the object
+		// This is sometimes used for dynamic lighting origin for planets (not used in the city scene)
+		XMFLOAT3 relativePosition;
+
+		if (m_Snapshot->hasLightingOrigin) {
+			XMFLOAT3 lightOrigin = m_Snapshot->lightingOrigin;
+			relativePosition.x = objectPos.x - lightOrigin.x;
+			relativePosition.y = objectPos.y - lightOrigin.y;
+			relativePosition.z = objectPos.z - lightOrigin.z;
+
+
+			// Calculate length of relative lighting vector
+			float rLen = sqrt((relativePosition.x * relativePosition.x) + (relativePosition.y * relativePosition.y) + (relativePosition.z * relativePosition.z));
+
+			// Normalize relative lighting direction (this is now the light origin normal vector)
+			relativePosition.x = relativePosition.x / rLen;
+			relativePosition.y = relativePosition.y / rLen;
+			relativePosition.z = relativePosition.z / rLen;
+		}
+		else {
+			// If the lighting origin does not exist, default to a fixed vector
+			relativePosition = m_Snapshot->lightingAngle;
+		}
+
+		// Render the object to scene
+
+		XMFLOAT4 ambientColor = XMFLOAT4(0.22f, 0.21f, 0.2f, 1.f);
+		XMFLOAT4 specularColor = XMFLOAT4(0.2f, 0.2f, 0.2f, 0.f);
+		float specularPower = 15;
+
+		// This switch statement allows each object to control which shader is used when rendering it
+		switch (m_FrameShaders[i]) {
+		case RenderShader::SHADED_NO_BUMP:
+			result = m_ShaderManager->RenderLightShader(m_D3D->GetDeviceContext(), pModelClass, worldMatrix, viewMatrix, projectionMatrix,
+				pModelClass->GetColorTexture(), relativePosition, m_Light->GetDiffuseColor(), ambientColor, m_Camera->GetPosition(), specularColor, specularPower);
+			break;
+		case RenderShader::SHADED_FOG:
+			result = m_ShaderManager->RenderFogShader(m_D3D->GetDeviceContext(), pModelClass, worldMatrix, viewMatrix, projectionMatrix,
+				pModelClass->GetColorTexture(), relativePosition, m_Light->GetDiffuseColor(), ambientColor, m_Camera->GetPosition(), specularColor, specularPower);
+			break;
+		case RenderShader::SHADED:
+			result = m_ShaderManager->RenderBumpMapShader(m_D3D->GetDeviceContext(), pModelClass, worldMatrix, viewMatrix, projectionMatrix,
+				pModelClass->GetColorTexture(), pModelClass->GetNormalMapTexture(), relativePosition,
+				m_Light->GetDiffuseColor());
+			break;
+		case RenderShader::UNLIT:
+			result = m_ShaderManager->RenderTextureShader(m_D3D->GetDeviceContext(), pModelClass, worldMatrix, viewMatrix, projectionMatrix,
+				pModelClass->GetColorTexture());
+			break;
+		}
+
+		// Bounds are added as lines and drawn together once every object has been visited. An
+		// instance's AABB is the box it was culled with.
+		if (i >= m_Snapshot->items.size()) {
+			const CityInstance& instance = m_Snapshot->instances[i - m_Snapshot->items.size()];
+
+			if (instance.Flags & CITY_DRAW_OBB) {
+				XMFLOAT3 mins, maxs;
+				pModelClass->GetBounds(mins, maxs);
+				m_DebugDraw->AddBox(mins, maxs, worldMatrix);
+			}
+
+			if (instance.Flags & CITY_DRAW_AABB) {
+				m_DebugDraw->AddBox(m_CullMins[i], m_CullMaxs[i], XMMatrixIdentity());
+			}
+			continue;
+		}
+
+		const RenderItem& item = m_Snapshot->items[i];
+
+		if (item.drawOBB) {
+			m_DebugDraw->AddBox(item.obbMins, item.obbMaxs, worldMatrix);
+		}
+
+		// The AABB is drawn with the object's non rotated matrix from the last step
+		if (item.drawAABB) {
+			m_DebugDraw->AddBox(item.aabbMins, item.aabbMaxs, XMLoadFloat4x4(&item.aabbWorld));
+		}
+	}
+}
+
+
+void GraphicsClass::FrameSubmit(unsigned int begin, unsigned int end)
+{
+	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
+
+
+	viewMatrix = XMLoadFloat4x4(&m_FrameView);
+	projectionMatrix = XMLoadFloat4x4(&m_FrameProjection);
+
+	m_DebugDraw->Render(m_ShaderManager, m_D3D->GetDeviceContext(), viewMatrix, projectionMatrix);
+
 	m_D3D->GetWorldMatrix(worldMatrix);
-	m_D3D->GetOrthoMatrix(orthoMatrix);
+	pWorld->pParticleSystem->RenderParticles(this, worldMatrix, viewMatrix, projectionMatrix, m_Snapshot->particles);
 
-	// Turn off the Z buffer to begin all 2D rendering.
-	m_D3D->TurnZBufferOff();
+	// Upload the frame's constants and issue every queued draw before switching to 2D.
+	m_FrameResult = m_ShaderManager->EndFrame();
+}
 
-	// Turn on alpha blending.
-	m_D3D->TurnOnAlphaBlending();
 
-	int strLen = text.length();
-	char char_array[1024];
+// Clicks and hovering are tested against every item that can collide, drawn this frame or not. The
+// simulation clicks and hovers the objects when it next steps.
+void GraphicsClass::FramePick(unsigned int begin, unsigned int end)
+{
+	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
 
-	// copying the contents of the 
-	// string to char array 
-	strcpy(char_array, text.c_str());
 
-	m_Text->SetText(char_array, m_D3D->GetDeviceContext());
-	m_Text->Render(m_D3D->GetDeviceContext(), worldMatrix, orthoMatrix);
+	viewMatrix = XMLoadFloat4x4(&m_FrameView);
+	projectionMatrix = XMLoadFloat4x4(&m_FrameProjection);
 
-	m_D3D->TurnZBufferOn();
-	m_D3D->TurnOffAlphaBlending();
+	m_Picker.m_screenWidth = m_ScreenWidth;
+	m_Picker.m_screenHeight = m_ScreenHeight;
+
+	for (int i = 0; i < m_Snapshot->items.size(); i++) {
+		const RenderItem& item = m_Snapshot->items[i];
+
+		if (!item.pickable) { continue; }
+		if (!m_MouseClicked && !item.hoverable) { continue; }
+
+		worldMatrix = XMLoadFloat4x4(&m_FrameMatrices[i]);
+
+		bool hit = m_Picker.TestIntersection(Collision::CollisionDetectionType::SPHERE, worldMatrix, viewMatrix, projectionMatrix, m_MouseX, m_MouseY, item.collisionRadius);
+
+		// Hovering is sent every frame, a click only when it hit
+		if (item.hoverable || (m_MouseClicked && hit)) {
+			PickEvent pick;
+			pick.objectID = item.objectID;
+			pick.clicked = m_MouseClicked && hit;
+			pick.hovered = hit;
+
+			m_Simulation.Pick(pick);
+		}
+	}
 }
 
+
 bool GraphicsClass::Render(float rotation)
 {
-	pWorld->Think();
-	pWorld->pGraphicsClass = this;
+	// The newest state the simulation has published, or the one drawn last frame if it has not stepped since
+	m_Snapshot = m_Simulation.AcquireSnapshot();
 
 	RECT wRect;
 	GetWindowRect(mHWnd, &wRect);
@@ -376,9 +709,8 @@ bool GraphicsClass::Render(float rotation)
 	// Here i calculate the mouse movement since the last frame to rotate the camera
 	// This allows for a mouse controlled FPS style camera
 
-	double CurTime = timeGetTime();
-	float DeltaTime = (CurTime - LastTime) / 1000.f;
-	LastTime = timeGetTime();
+	double frameTime = m_Timer.Tick();
+	float DeltaTime = (float)frameTime;
 
 	POINT cursorPos;
 	GetCursorPos(&cursorPos);
@@ -396,12 +728,12 @@ bool GraphicsClass::Render(float rotation)
 	lastCursorPos.y = fixedCursorY;
 
 	if (diffX != 0) {
-		pWorld->pCameraAngle->y += diffX * 0.07f;
+		m_CameraAngle.y += diffX * 0.07f;
 	}
 	if (diffY != 0) {
-		pWorld->pCameraAngle->x += diffY * 0.07f;
+		m_CameraAngle.x += diffY * 0.07f;
 	}
-	m_Camera->SetRotation(pWorld->pCameraAngle->x, pWorld->pCameraAngle->y, pWorld->pCameraAngle->z);
+	m_Camera->SetRotation(m_CameraAngle.x, m_CameraAngle.y, m_CameraAngle.z);
 
 	float cameraVelocityDampen = 0.3f;
 
@@ -450,9 +782,9 @@ bool GraphicsClass::Render(float rotation)
 	XMVECTOR up = XMLoadFloat3(new XMFLOAT3(0.f, 1.f, 0.f));
 	// Find the camera forward heading
 	XMFLOAT3* pCameraHeading = new XMFLOAT3(
-		sin(pWorld->pCameraAngle->y * degToRad),
-		-sin(pWorld->pCameraAngle->x * degToRad),
-		cos(pWorld->pCameraAngle->y * degToRad)
+		sin(m_CameraAngle.y * degToRad),
+		-sin(m_CameraAngle.x * degToRad),
+		cos(m_CameraAngle.y * degToRad)
 	);
 	// Normalize the camera forward heading
 	float cameraHeadingLen = sqrt((pCameraHeading->x * pCameraHeading->x) + (pCameraHeading->y * pCameraHeading->y) + (pCameraHeading->z * pCameraHeading->z));
@@ -473,26 +805,62 @@ bool GraphicsClass::Render(float rotation)
 
 	float camSpeed = 100.f;
 
-	if (pWorld->mCameraMovementEnabled) {
+	// The free camera starts where the simulation last had it and is moved here every frame
+	if (m_Snapshot && m_Snapshot->cameraFree) {
+		if (!m_FreeCamera) {
+			m_CameraPosition = m_Snapshot->cameraPosition;
+			m_FreeCamera = true;
+		}
+
 		// Modify the camera's position
-		pWorld->pCameraPosition->x += cameraRightFloat.x * vel * DeltaTime * camSpeed;
-		pWorld->pCameraPosition->y += cameraRightFloat.y * vel * DeltaTime * camSpeed;
-		pWorld->pCameraPosition->z += cameraRightFloat.z * vel * DeltaTime * camSpeed;
+		m_CameraPosition.x += cameraRightFloat.x * vel * DeltaTime * camSpeed;
+		m_CameraPosition.y += cameraRightFloat.y * vel * DeltaTime * camSpeed;
+		m_CameraPosition.z += cameraRightFloat.z * vel * DeltaTime * camSpeed;
 
 		vel = pCameraVelocity->y;
 
-		pWorld->pCameraPosition->x += cameraForwardFloat.x * vel * DeltaTime * camSpeed;
-		pWorld->pCameraPosition->y += cameraForwardFloat.y * vel * DeltaTime * camSpeed;
-		pWorld->pCameraPosition->z += cameraForwardFloat.z * vel * DeltaTime * camSpeed;
+		m_CameraPosition.x += cameraForwardFloat.x * vel * DeltaTime * camSpeed;
+		m_CameraPosition.y += cameraForwardFloat.y * vel * DeltaTime * camSpeed;
+		m_CameraPosition.z += cameraForwardFloat.z * vel * DeltaTime * camSpeed;
+	}
+	else {
+		m_FreeCamera = false;
 	}
 
-	m_Camera->SetPosition(pWorld->pCameraPosition->x, pWorld->pCameraPosition->y, pWorld->pCameraPosition->z);
+	// The simulation takes this on its next step
+	SimulationInput input;
+	input.inputFrame = inputFrame;
+	input.cameraAngle = m_CameraAngle;
+	input.freeCamera = m_FreeCamera;
+	input.cameraPosition = m_CameraPosition;
 
-	XMMATRIX worldMatrix, worldMatrix2, viewMatrix, projectionMatrix, translateMatrix;
-	bool result;
+	m_Simulation.SetInput(input);
+
+	// Nothing to draw until the first step is done
+	if (!m_Snapshot)
+	{
+		m_D3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
+		m_D3D->EndScene();
+		return true;
+	}
 
+	// The snapshot was published at the end of a step, so the objects are drawn going from the
+	// previous step to that one over the length of a step from then. Motion stays smooth at any
+	// frame rate a step behind the simulation.
+	double sincePublish = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Snapshot->publishTime).count();
+	m_FrameAlpha = (float)(sincePublish / m_Snapshot->step);
+	if (m_FrameAlpha > 1.f) { m_FrameAlpha = 1.f; }
+	if (m_FrameAlpha < 0.f) { m_FrameAlpha = 0.f; }
 
-	
+	XMFLOAT3 cameraPosition = m_CameraPosition;
+	if (!m_FreeCamera) {
+		cameraPosition = MathUtil::AddFloat3(m_Snapshot->previousCameraPosition,
+			MathUtil::MultiplyFloat3(MathUtil::SubtractFloat3(m_Snapshot->cameraPosition, m_Snapshot->previousCameraPosition), m_FrameAlpha));
+	}
+	m_Camera->SetPosition(cameraPosition.x, cameraPosition.y, cameraPosition.z);
+
+	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
+	bool result;
 
 	// Clear the buffers to begin the scene.
 	m_D3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
@@ -500,164 +868,45 @@ bool GraphicsClass::Render(float rotation)
 	// Generate the view matrix based on the camera's position.
 	m_Camera->Render();
 
-	m_D3D->GetWorldMatrix(worldMatrix);
 	m_Camera->GetViewMatrix(viewMatrix);
 	m_D3D->GetProjectionMatrix(projectionMatrix);
 
-	// World operations such as rendering and object think invoking
-	if (pWorld) {
-		std::vector<BaseObject*> objects = *pWorld->GetObjects();
-
-		// Loop through each object
-		for (int i = 0; i < objects.size(); i++) {
-			BaseObject* pObject = objects[i];
-
-			if (!pObject->IsInitialized()) {
-				pObject->Initialize(m_D3D);
-			}
-
-			BumpModelClass* pModelClass = pObject->pModelClass;
-			if (!pModelClass) { continue; }
-
-			// Resolve collisions linearly for objects with enabled collisions
-			// This is the naive approach, given more time I could implement a better collision resolution method
-			if (pObject->GetCollisionsEnabled() && !pObject->mStatic) {
-				pObject->ResolveCollisions();
-			}
-
-			objects[i]->pPosition->x += objects[i]->pVelocity->x * DeltaTime;
-			objects[i]->pPosition->y += objects[i]->pVelocity->y * DeltaTime;
-			objects[i]->pPosition->z += objects[i]->pVelocity->z * DeltaTime;
-
-			objects[i]->pAngle->x += objects[i]->pAngularVelocity->x * DeltaTime;
-			objects[i]->pAngle->y += objects[i]->pAngularVelocity->y * DeltaTime;
-			objects[i]->pAngle->z += objects[i]->pAngularVelocity->z * DeltaTime;
-
-			objects[i]->OnRender(DeltaTime);
-			objects[i]->OnInput(inputFrame, DeltaTime);
-
-			// Reset worldMatrix to origin
-			m_D3D->GetWorldMatrix(worldMatrix);
-			m_Camera->GetViewMatrix(viewMatrix);
-			m_D3D->GetProjectionMatrix(projectionMatrix);
-
-			worldMatrix = pObject->GetWorldMatrix(worldMatrix);
-
-			// Store the global xyz coordinates of the object in an XMFLOAT3
-			XMVECTOR worldPos = worldMatrix.r[3];
-			XMFLOAT3 objectPos;
-			XMStoreFloat3(&objectPos, worldPos);
-
-			// Calculate the relative position between the lighting origin and the object
-			// This is sometimes used for dynamic lighting origin for planets (not used in the city scene)
-			XMFLOAT3 relativePosition;
+	XMStoreFloat4x4(&m_FrameView, viewMatrix);
+	XMStoreFloat4x4(&m_FrameProjection, projectionMatrix);
 
-			if (pWorld->pLightingOrigin != 0) {
-				XMFLOAT3 lightOrigin = *pWorld->pLightingOrigin;
-				relativePosition.x = objectPos.x - lightOrigin.x;
-				relativePosition.y = objectPos.y - lightOrigin.y;
-				relativePosition.z = objectPos.z - lightOrigin.z;
+	// Frustum planes from the combined matrix, a point is inside when it is on the positive side of all six
+	XMFLOAT4X4 viewProjection;
+	XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(viewMatrix, projectionMatrix));
 
+	for (int i = 0; i < 3; i++) {
+		float sign = i == 2 ? 0.f : 1.f;
 
-				// Calculate length of relative lighting vector
-				float rLen = sqrt((relativePosition.x * relativePosition.x) + (relativePosition.y * relativePosition.y) + (relativePosition.z * relativePosition.z));
-
-				// Normalize relative lighting direction (this is now the light origin normal vector)
-				relativePosition.x = relativePosition.x / rLen;
-				relativePosition.y = relativePosition.y / rLen;
-				relativePosition.z = relativePosition.z / rLen;
-			}
-			else {
-				// If the lighting origin does not exist, default to a fixed vector
-				relativePosition = *pWorld->pLightingAngle;
-			}
-
-			// Render the object to scene
-
-			XMFLOAT4 ambientColor = XMFLOAT4(0.22f, 0.21f, 0.2f, 1.f);
-			XMFLOAT4 specularColor = XMFLOAT4(0.2f, 0.2f, 0.2f, 0.f);
-			float specularPower = 15;
-
-			// This switch statement allows each object to control which shader is used when rendering it
-			switch (pObject->renderShader) {
-			case RenderShader::SHADED_NO_BUMP:
-				pModelClass->Render(m_D3D->GetDeviceContext());
-				result = m_ShaderManager->RenderLightShader(m_D3D->GetDeviceContext(), pModelClass->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-					pModelClass->GetColorTexture(), relativePosition, m_Light->GetDiffuseColor(), ambientColor, m_Camera->GetPosition(), specularColor, specularPower);
-				break;
-			case RenderShader::SHADED_FOG:
-				pModelClass->Render(m_D3D->GetDeviceContext());
-				result = m_ShaderManager->RenderFogShader(m_D3D->GetDeviceContext(), pModelClass->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-					pModelClass->GetColorTexture(), relativePosition, m_Light->GetDiffuseColor(), ambientColor, m_Camera->GetPosition(), specularColor, specularPower);
-				break;
-			case RenderShader::SHADED:
-				pModelClass->Render(m_D3D->GetDeviceContext());
-				result = m_ShaderManager->RenderBumpMapShader(m_D3D->GetDeviceContext(), pModelClass->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-					pModelClass->GetColorTexture(), pModelClass->GetNormalMapTexture(), relativePosition,
-					m_Light->GetDiffuseColor());
-				break;
-			case RenderShader::UNLIT:
-				pModelClass->Render(m_D3D->GetDeviceContext());
-				result = m_ShaderManager->RenderTextureShader(m_D3D->GetDeviceContext(), pModelClass->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-					pModelClass->GetColorTexture());
-				break;
-			}
-
-			if (pObject->GetDrawOBB()) {
-				m_D3D->TurnOnWireframe();
-				pObject->pOBBModel->Render(m_D3D->GetDeviceContext());
-				bool success = m_ShaderManager->RenderTextureShader(m_D3D->GetDeviceContext(), pObject->pOBBModel->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-					pObject->pOBBModel->GetColorTexture());
-				m_D3D->TurnOffWireframe();
-			}
-
-			if (pObject->GetDrawAABB()) {
-				// Get non rotated object matrix for AABB
-				XMMATRIX tempWorldMatrix = XMMatrixScaling(1.f, 1.f, 1.f);
-				XMMATRIX AABBMatrix = pObject->GetWorldMatrix(tempWorldMatrix, false);
-
-				m_D3D->TurnOnWireframe();
-				pObject->pAABBModel->Render(m_D3D->GetDeviceContext());
-				bool success = m_ShaderManager->RenderTextureShader(m_D3D->GetDeviceContext(), pObject->pAABBModel->GetIndexCount(), AABBMatrix, viewMatrix, projectionMatrix,
-					pObject->pAABBModel->GetColorTexture());
-				m_D3D->TurnOffWireframe();
-			}
-
-			// If mouse clicked and object collisions enabled, check if object was clicked
-			if (mouseClicked && pObject->GetCollisionsEnabled()) {
-				pObject->pCollisionUtil->pGraphicsClass = this;
-				pObject->pCollisionUtil->m_screenWidth = scrW;
-				pObject->pCollisionUtil->m_screenHeight = scrH;
-
-				if (pObject->pCollisionUtil->TestIntersection(Collision::CollisionDetectionType::SPHERE, worldMatrix, viewMatrix, projectionMatrix, mouseX, mouseY, pObject->mCollisionRadius)) {
-					pObject->DoClick();
-					//pObject->SetScale(0.005f);
-				}
-				else {
-					//pObject->SetScale(0.001f);
-				}
-			}
-			
-			// If object hovering is enabled, check if object is hovered by mouse each frame
-			if (pObject->GetCollisionsEnabled() && pObject->GetHoveringEnabled()) {
-				pObject->pCollisionUtil->pGraphicsClass = this;
-				pObject->pCollisionUtil->m_screenWidth = scrW;
-				pObject->pCollisionUtil->m_screenHeight = scrH;
-
-				pObject->SetHovered(pObject->pCollisionUtil->TestIntersection(Collision::CollisionDetectionType::SPHERE, worldMatrix, viewMatrix, projectionMatrix, mouseX, mouseY, pObject->mCollisionRadius));
-			}
-		}
+		// Left and right, bottom and top, near and far (near is z >= 0 in Direct3D)
+		m_FrustumPlanes[i * 2] = XMFLOAT4(
+			sign * viewProjection.m[0][3] + viewProjection.m[0][i],
+			sign * viewProjection.m[1][3] + viewProjection.m[1][i],
+			sign * viewProjection.m[2][3] + viewProjection.m[2][i],
+			sign * viewProjection.m[3][3] + viewProjection.m[3][i]);
+		m_FrustumPlanes[i * 2 + 1] = XMFLOAT4(
+			viewProjection.m[0][3] - viewProjection.m[0][i],
+			viewProjection.m[1][3] - viewProjection.m[1][i],
+			viewProjection.m[2][3] - viewProjection.m[2][i],
+			viewProjection.m[3][3] - viewProjection.m[3][i]);
+	}
 
-		for (int i = objects.size() - 1; i >= 0; i--) {
-			BaseObject* pObject = objects[i];
+	m_MouseX = mouseX;
+	m_MouseY = mouseY;
+	m_ScreenWidth = scrW;
+	m_ScreenHeight = scrH;
+	m_MouseClicked = mouseClicked;
 
-			if (pObject->IsDestroyed()) {
-				pWorld->DestroyObject(pObject);
-			}
-		}
+	// Transform, cull, queue and submit the world as a graph, see BuildFrameGraph
+	m_FrameResult = true;
+	m_FrameGraph.Execute(pWorld->pJobSystem);
 
-		m_D3D->GetWorldMatrix(worldMatrix);
-		pWorld->pParticleSystem->RenderParticles(DeltaTime, this, worldMatrix, viewMatrix, projectionMatrix);
+	if (!m_FrameResult)
+	{
+		return false;
 	}
 
 	/////////////// Render the text strings. ///////////////
@@ -677,16 +926,21 @@ bool GraphicsClass::Render(float rotation)
 	// Turn on alpha blending.
 	m_D3D->TurnOnAlphaBlending();
 
-	std::string message = "Score: " + std::to_string(pWorld->mScore) + "\nHealth: " + std::to_string(pWorld->mHealth);
-	int strLen = message.length();
-	char char_array[512];
+	// The score line only changes when the score or health does, the text object skips the rebuild otherwise.
+	TextFormatter message;
+	message.Append("Score: ").Append(m_Snapshot->score).Append("\nHealth: ").Append(m_Snapshot->health);
 
-	// copying the contents of the 
-	// string to char array 
-	strcpy(char_array, message.c_str());
+	m_Text->SetText(0, message.GetText(), m_D3D->GetDeviceContext());
+	m_Text->Render(0);
+
+	// Queue any text objects asked for during the step the snapshot was taken after.
+	for (int i = 0; i < m_Snapshot->textCount; i++) {
+		m_Text->SetText(i + 1, m_Snapshot->text[i], m_D3D->GetDeviceContext());
+		m_Text->Render(i + 1);
+	}
 
-	m_Text->SetText(char_array, m_D3D->GetDeviceContext());
-	result = m_Text->Render(m_D3D->GetDeviceContext(), worldMatrix, orthoMatrix);         
+	// All of the HUD text goes out in a single batched draw.
+	result = m_Text->Flush(m_D3D->GetDeviceContext(), worldMatrix, orthoMatrix);
 	if (!result)
 	{
 		return false;
@@ -22,6 +22,12 @@
 
 #include "skyplaneclass.h"
 #include "skyplaneshaderclass.h"
+#include "textclass.h"
+#include "debugdrawclass.h"
+#include "GameTimer.h"
+#include "TaskGraph.h"
+#include "SimulationThread.h"
+#include "CollisionUtils.h"
 
 #endif // !GCLASS
 
@@ -34,6 +40,17 @@ const bool FULL_SCREEN = false;
 const bool VSYNC_ENABLED = true;
 const float SCREEN_DEPTH = 20000.0f;
 const float SCREEN_NEAR = 0.1f;
+const double SIMULATION_STEP = 1.0 / 60.0;
+const int SIMULATION_MAX_STEPS = 5;
+
+// The state the phases of a frame declare they read or write, see GraphicsClass::BuildFrameGraph
+enum FrameResource
+{
+	FRAME_SNAPSHOT = 1 << 0,
+	FRAME_MATRICES = 1 << 1,
+	FRAME_VISIBILITY = 1 << 2,
+	FRAME_QUEUE = 1 << 3,
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,10 +72,16 @@ public:
 	TextClass* m_Text;
 
 	ShaderManagerClass* m_ShaderManager;
+	DebugDrawClass* m_DebugDraw;
 	LightClass* m_Light;
-	void RenderText(std::string text);
 private:
 	bool Render(float);
+	void BuildFrameGraph();
+	void FrameTransform(unsigned int, unsigned int);
+	void FrameCull(unsigned int, unsigned int);
+	void FrameQueue(unsigned int, unsigned int);
+	void FrameSubmit(unsigned int, unsigned int);
+	void FramePick(unsigned int, unsigned int);
 	HWND mHWnd;
 private:
 	
@@ -72,5 +95,43 @@ private:
 	SkyPlaneClass *m_SkyPlane;
 	SkyPlaneShaderClass* m_SkyPlaneShader;
 
-	double LastTime;
+	GameTimer m_Timer;
+
+	// The world is stepped on its own thread, frames are drawn from the snapshots it publishes
+	SimulationThread m_Simulation;
+	RenderSnapshot* m_Snapshot;
+
+	// The camera is turned here every frame, and moved here too while the snapshot says it is free
+	XMFLOAT3 m_CameraAngle;
+	XMFLOAT3 m_CameraPosition;
+	bool m_FreeCamera;
+
+	// What the frame graph's phases share. Matrices are stored unaligned as the class is not
+	// allocated on a 16 byte boundary.
+	TaskGraph m_FrameGraph;
+	int m_CullTask;
+	bool m_FrameResult;
+	float m_FrameAlpha;
+	XMFLOAT4X4 m_FrameView;
+	XMFLOAT4X4 m_FrameProjection;
+	XMFLOAT4 m_FrustumPlanes[6];
+	int m_MouseX, m_MouseY;
+	float m_ScreenWidth, m_ScreenHeight;
+	bool m_MouseClicked;
+	CollisionUtils m_Picker;
+	std::vector<XMFLOAT4X4> m_FrameMatrices;
+	std::vector<int> m_BlendItems;
+	std::vector<XMFLOAT3> m_BlendPositions;
+	std::vector<XMFLOAT4> m_BlendOrientations;
+	std::vector<XMFLOAT3> m_BlendScales;
+	std::vector<XMFLOAT4X4> m_BlendWorlds;
+	std::vector<XMFLOAT3> m_InstancePositions;
+	std::vector<XMFLOAT4> m_InstanceOrientations;
+	std::vector<XMFLOAT3> m_InstanceScales;
+	std::vector<BumpModelClass*> m_FrameModels;
+	std::vector<RenderShader> m_FrameShaders;
+	std::vector<XMFLOAT3> m_CullMins;
+	std::vector<XMFLOAT3> m_CullMaxs;
+	std::vector<XMFLOAT4X4> m_CullMatrices;
+	std::vector<unsigned char> m_Visible;
 };
\ No newline at end of file
@@ -13,6 +13,7 @@ LightShaderClass::LightShaderClass()
 	m_matrixBuffer = 0;
 	m_cameraBuffer = 0;
 	m_lightBuffer = 0;
+	m_pipeline = 0;
 }
 
 
@@ -446,6 +447,80 @@ bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, c
 }
 
 
+bool LightShaderClass::CreatePipeline(RenderBackendClass* backend)
+{
+	PipelineDesc desc;
+
+
+	// Hand the compiled shader objects to the backend, the draw queue only refers to the returned handle.
+	desc.vertexShader = m_vertexShader;
+	desc.pixelShader = m_pixelShader;
+	desc.inputLayout = m_layout;
+	desc.sampleState = m_sampleState;
+
+	m_pipeline = backend->CreatePipeline(desc);
+	if(!m_pipeline)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool LightShaderClass::Record(ConstantBufferRingClass* constantRing, DrawPacket& packet, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix,
+	const XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 ambientColor,
+	XMFLOAT4 diffuseColor, XMFLOAT3 cameraPosition, XMFLOAT4 specularColor, float specularPower)
+{
+	MatrixBufferType* dataPtr;
+	LightBufferType* dataPtr2;
+	CameraBufferType* dataPtr3;
+
+
+	// Allocate this draw's matrix constants from the frame ring.
+	if(!constantRing->Allocate(sizeof(MatrixBufferType), (void**)&dataPtr, packet.vsConstants[0]))
+	{
+		return false;
+	}
+
+	// Copy the transposed matrices into the ring.
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
+	dataPtr->view = XMMatrixTranspose(viewMatrix);
+	dataPtr->projection = XMMatrixTranspose(projectionMatrix);
+
+	// Allocate and fill the camera constants, bound to the second vertex shader slot.
+	if(!constantRing->Allocate(sizeof(CameraBufferType), (void**)&dataPtr3, packet.vsConstants[1]))
+	{
+		return false;
+	}
+
+	dataPtr3->cameraPosition = cameraPosition;
+	dataPtr3->padding = 0.0f;
+
+	// Allocate and fill the light constants for the pixel shader.
+	if(!constantRing->Allocate(sizeof(LightBufferType), (void**)&dataPtr2, packet.psConstants[0]))
+	{
+		return false;
+	}
+
+	dataPtr2->ambientColor = ambientColor;
+	dataPtr2->diffuseColor = diffuseColor;
+	dataPtr2->lightDirection = lightDirection;
+	dataPtr2->specularColor = specularColor;
+	dataPtr2->specularPower = specularPower;
+
+	packet.vsConstantCount = 2;
+	packet.psConstantCount = 1;
+
+	// Record the shader objects and textures the draw will bind when the queue is executed.
+	packet.pipeline = m_pipeline;
+	packet.textures[0] = D3D11RenderBackendClass::WrapTexture(texture);
+	packet.textureCount = 1;
+
+	return true;
+}
+
+
 void LightShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
 {
 	// Set the vertex input layout.
@@ -0,0 +1,503 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullrenderbackendclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "nullrenderbackendclass.h"
+
+
+NullRenderBackendClass::NullRenderBackendClass()
+{
+	// Report everything as supported so the queued path is the one exercised.
+	m_caps.constantBufferOffsets = true;
+	m_caps.constantBufferNoOverwrite = true;
+	m_recording = false;
+
+	Reset();
+}
+
+
+NullRenderBackendClass::NullRenderBackendClass(const NullRenderBackendClass& other)
+{
+}
+
+
+NullRenderBackendClass::~NullRenderBackendClass()
+{
+	Shutdown();
+}
+
+
+void NullRenderBackendClass::Shutdown()
+{
+	unsigned int i;
+
+
+	// Release the memory behind every buffer that was not destroyed.
+	for(i=0; i<m_buffers.size(); i++)
+	{
+		delete [] m_buffers[i]->data;
+		delete m_buffers[i];
+	}
+	m_buffers.clear();
+
+	for(i=0; i<m_textures.size(); i++)
+	{
+		delete [] m_textures[i]->data;
+		delete m_textures[i];
+	}
+	m_textures.clear();
+
+	for(i=0; i<m_pipelines.size(); i++)
+	{
+		delete m_pipelines[i];
+	}
+	m_pipelines.clear();
+
+	m_commands.clear();
+
+	return;
+}
+
+
+void NullRenderBackendClass::SetCaps(const RenderBackendCaps& caps)
+{
+	m_caps = caps;
+}
+
+
+void NullRenderBackendClass::SetRecording(bool recording)
+{
+	m_recording = recording;
+}
+
+
+RenderBackendCaps NullRenderBackendClass::GetCaps()
+{
+	return m_caps;
+}
+
+
+BufferHandle NullRenderBackendClass::CreateBuffer(const BufferDesc& desc)
+{
+	BufferMemoryType* buffer;
+	unsigned int i;
+
+
+	buffer = new BufferMemoryType;
+	buffer->type = desc.type;
+	buffer->dynamic = desc.dynamic;
+	buffer->byteWidth = desc.byteWidth;
+	buffer->data = new unsigned char[desc.byteWidth];
+
+	for(i=0; i<desc.byteWidth; i++)
+	{
+		buffer->data[i] = desc.initialData ? ((const unsigned char*)desc.initialData)[i] : 0;
+	}
+
+	if(desc.initialData)
+	{
+		m_bytesUploaded += desc.byteWidth;
+	}
+
+	m_buffers.push_back(buffer);
+
+	Record(COMMAND_CREATE_BUFFER, buffer, desc.type, desc.byteWidth, desc.dynamic ? 1 : 0);
+
+	return (BufferHandle)buffer;
+}
+
+
+void NullRenderBackendClass::DestroyBuffer(BufferHandle handle)
+{
+	unsigned int i;
+
+
+	Record(COMMAND_DESTROY_BUFFER, handle, 0, 0, 0);
+
+	for(i=0; i<m_buffers.size(); i++)
+	{
+		if((BufferHandle)m_buffers[i] == handle)
+		{
+			delete [] m_buffers[i]->data;
+			delete m_buffers[i];
+			m_buffers.erase(m_buffers.begin() + i);
+			break;
+		}
+	}
+
+	return;
+}
+
+
+TextureHandle NullRenderBackendClass::CreateTexture(const TextureDesc& desc)
+{
+	TextureMemoryType* texture;
+	unsigned int i, byteWidth;
+
+
+	texture = new TextureMemoryType;
+	texture->width = desc.width;
+	texture->height = desc.height;
+	texture->data = 0;
+
+	if(desc.initialData)
+	{
+		byteWidth = desc.width * desc.height * 4;
+		texture->data = new unsigned char[byteWidth];
+
+		for(i=0; i<byteWidth; i++)
+		{
+			texture->data[i] = ((const unsigned char*)desc.initialData)[i];
+		}
+
+		m_bytesUploaded += byteWidth;
+	}
+
+	m_textures.push_back(texture);
+
+	Record(COMMAND_CREATE_TEXTURE, texture, desc.width, desc.height, 0);
+
+	return (TextureHandle)texture;
+}
+
+
+void NullRenderBackendClass::DestroyTexture(TextureHandle handle)
+{
+	unsigned int i;
+
+
+	Record(COMMAND_DESTROY_TEXTURE, handle, 0, 0, 0);
+
+	for(i=0; i<m_textures.size(); i++)
+	{
+		if((TextureHandle)m_textures[i] == handle)
+		{
+			delete [] m_textures[i]->data;
+			delete m_textures[i];
+			m_textures.erase(m_textures.begin() + i);
+			break;
+		}
+	}
+
+	return;
+}
+
+
+PipelineHandle NullRenderBackendClass::CreatePipeline(const PipelineDesc& desc)
+{
+	PipelineDesc* pipeline;
+
+
+	// The shader objects are never used here, they are only kept for a replay.
+	pipeline = new PipelineDesc;
+	*pipeline = desc;
+
+	m_pipelines.push_back(pipeline);
+
+	Record(COMMAND_CREATE_PIPELINE, pipeline, 0, 0, 0);
+
+	return (PipelineHandle)pipeline;
+}
+
+
+void NullRenderBackendClass::DestroyPipeline(PipelineHandle handle)
+{
+	unsigned int i;
+
+
+	Record(COMMAND_DESTROY_PIPELINE, handle, 0, 0, 0);
+
+	for(i=0; i<m_pipelines.size(); i++)
+	{
+		if((PipelineHandle)m_pipelines[i] == handle)
+		{
+			delete m_pipelines[i];
+			m_pipelines.erase(m_pipelines.begin() + i);
+			break;
+		}
+	}
+
+	return;
+}
+
+
+void* NullRenderBackendClass::Map(BufferHandle handle, MapMode mode)
+{
+	Record(COMMAND_MAP, handle, mode, 0, 0);
+
+	return ((BufferMemoryType*)handle)->data;
+}
+
+
+void NullRenderBackendClass::Unmap(BufferHandle handle, unsigned int bytesWritten)
+{
+	m_bytesUploaded += bytesWritten;
+
+	Record(COMMAND_UNMAP, handle, bytesWritten, 0, 0);
+}
+
+
+void NullRenderBackendClass::SetRenderFlags(unsigned int renderFlags)
+{
+	Record(COMMAND_RENDER_FLAGS, 0, renderFlags, 0, 0);
+}
+
+
+void NullRenderBackendClass::SetPipeline(PipelineHandle handle)
+{
+	Record(COMMAND_PIPELINE, handle, 0, 0, 0);
+}
+
+
+void NullRenderBackendClass::SetTopology(PrimitiveTopology topology)
+{
+	Record(COMMAND_TOPOLOGY, 0, topology, 0, 0);
+}
+
+
+void NullRenderBackendClass::SetVertexBuffer(BufferHandle handle, unsigned int stride, unsigned int offset)
+{
+	Record(COMMAND_VERTEX_BUFFER, handle, stride, offset, 0);
+}
+
+
+void NullRenderBackendClass::SetIndexBuffer(BufferHandle handle)
+{
+	Record(COMMAND_INDEX_BUFFER, handle, 0, 0, 0);
+}
+
+
+void NullRenderBackendClass::SetTexture(unsigned int slot, TextureHandle handle)
+{
+	Record(COMMAND_TEXTURE, handle, slot, 0, 0);
+}
+
+
+void NullRenderBackendClass::SetVSConstantBuffer(unsigned int slot, BufferHandle handle, unsigned int firstConstant, unsigned int numConstants)
+{
+	Record(COMMAND_VS_CONSTANT_BUFFER, handle, slot, firstConstant, numConstants);
+}
+
+
+void NullRenderBackendClass::SetPSConstantBuffer(unsigned int slot, BufferHandle handle, unsigned int firstConstant, unsigned int numConstants)
+{
+	Record(COMMAND_PS_CONSTANT_BUFFER, handle, slot, firstConstant, numConstants);
+}
+
+
+void NullRenderBackendClass::Draw(unsigned int vertexCount, unsigned int startVertex)
+{
+	m_vertexCount += vertexCount;
+
+	Record(COMMAND_DRAW, 0, vertexCount, startVertex, 0);
+}
+
+
+void NullRenderBackendClass::DrawIndexed(unsigned int indexCount, unsigned int startIndex)
+{
+	m_indexCount += indexCount;
+
+	Record(COMMAND_DRAW_INDEXED, 0, indexCount, startIndex, 0);
+}
+
+
+void NullRenderBackendClass::Reset()
+{
+	int i;
+
+
+	for(i=0; i<COMMAND_TYPE_COUNT; i++)
+	{
+		m_callCounts[i] = 0;
+	}
+
+	m_indexCount = 0;
+	m_vertexCount = 0;
+	m_bytesUploaded = 0;
+
+	m_commands.clear();
+
+	return;
+}
+
+
+// The handles recorded here mean nothing to another backend, so every resource this one
+// still holds is created again on the target first and each recorded handle is swapped for
+// the target's. Buffers are copied as they are now, so the constants of the last frame
+// written are the ones the replay sees. Handles to resources that have since been destroyed
+// are replayed as null. The copies are destroyed once the commands have been issued.
+void NullRenderBackendClass::Replay(RenderBackendClass* backend)
+{
+	map<void*, void*> handles;
+	BufferDesc bufferDesc;
+	TextureDesc textureDesc;
+	unsigned int i;
+
+
+	for(i=0; i<m_buffers.size(); i++)
+	{
+		bufferDesc.type = m_buffers[i]->type;
+		bufferDesc.byteWidth = m_buffers[i]->byteWidth;
+		bufferDesc.dynamic = m_buffers[i]->dynamic;
+		bufferDesc.initialData = m_buffers[i]->data;
+
+		handles[m_buffers[i]] = backend->CreateBuffer(bufferDesc);
+	}
+
+	for(i=0; i<m_textures.size(); i++)
+	{
+		textureDesc.width = m_textures[i]->width;
+		textureDesc.height = m_textures[i]->height;
+		textureDesc.initialData = m_textures[i]->data;
+
+		handles[m_textures[i]] = backend->CreateTexture(textureDesc);
+	}
+
+	for(i=0; i<m_pipelines.size(); i++)
+	{
+		handles[m_pipelines[i]] = backend->CreatePipeline(*m_pipelines[i]);
+	}
+
+	// Only state and draw commands are replayed, the resources were made above.
+	for(i=0; i<m_commands.size(); i++)
+	{
+		const RenderCommand& command = m_commands[i];
+		void* handle = Translate(handles, command.handle);
+
+		switch(command.type)
+		{
+		case COMMAND_RENDER_FLAGS:
+			backend->SetRenderFlags(command.args[0]);
+			break;
+		case COMMAND_PIPELINE:
+			backend->SetPipeline((PipelineHandle)handle);
+			break;
+		case COMMAND_TOPOLOGY:
+			backend->SetTopology((PrimitiveTopology)command.args[0]);
+			break;
+		case COMMAND_VERTEX_BUFFER:
+			backend->SetVertexBuffer((BufferHandle)handle, command.args[0], command.args[1]);
+			break;
+		case COMMAND_INDEX_BUFFER:
+			backend->SetIndexBuffer((BufferHandle)handle);
+			break;
+		case COMMAND_TEXTURE:
+			backend->SetTexture(command.args[0], (TextureHandle)handle);
+			break;
+		case COMMAND_VS_CONSTANT_BUFFER:
+			backend->SetVSConstantBuffer(command.args[0], (BufferHandle)handle, command.args[1], command.args[2]);
+			break;
+		case COMMAND_PS_CONSTANT_BUFFER:
+			backend->SetPSConstantBuffer(command.args[0], (BufferHandle)handle, command.args[1], command.args[2]);
+			break;
+		case COMMAND_DRAW:
+			backend->Draw(command.args[0], command.args[1]);
+			break;
+		case COMMAND_DRAW_INDEXED:
+			backend->DrawIndexed(command.args[0], command.args[1]);
+			break;
+		default:
+			break;
+		}
+	}
+
+	for(i=0; i<m_buffers.size(); i++)
+	{
+		backend->DestroyBuffer((BufferHandle)handles[m_buffers[i]]);
+	}
+
+	for(i=0; i<m_textures.size(); i++)
+	{
+		backend->DestroyTexture((TextureHandle)handles[m_textures[i]]);
+	}
+
+	for(i=0; i<m_pipelines.size(); i++)
+	{
+		backend->DestroyPipeline((PipelineHandle)handles[m_pipelines[i]]);
+	}
+
+	return;
+}
+
+
+int NullRenderBackendClass::GetCallCount(CommandType commandType)
+{
+	return m_callCounts[commandType];
+}
+
+
+int NullRenderBackendClass::GetTotalCallCount()
+{
+	int i, total;
+
+
+	total = 0;
+	for(i=0; i<COMMAND_TYPE_COUNT; i++)
+	{
+		total += m_callCounts[i];
+	}
+
+	return total;
+}
+
+
+unsigned int NullRenderBackendClass::GetIndexCount()
+{
+	return m_indexCount;
+}
+
+
+unsigned int NullRenderBackendClass::GetVertexCount()
+{
+	return m_vertexCount;
+}
+
+
+unsigned long long NullRenderBackendClass::GetBytesUploaded()
+{
+	return m_bytesUploaded;
+}
+
+
+const vector<NullRenderBackendClass::RenderCommand>& NullRenderBackendClass::GetCommands()
+{
+	return m_commands;
+}
+
+
+void NullRenderBackendClass::Record(CommandType type, void* handle, unsigned int arg0, unsigned int arg1, unsigned int arg2)
+{
+	RenderCommand command;
+
+
+	m_callCounts[type]++;
+
+	if(!m_recording)
+	{
+		return;
+	}
+
+	command.type = type;
+	command.handle = handle;
+	command.args[0] = arg0;
+	command.args[1] = arg1;
+	command.args[2] = arg2;
+
+	m_commands.push_back(command);
+
+	return;
+}
+
+
+void* NullRenderBackendClass::Translate(const map<void*, void*>& handles, void* handle)
+{
+	map<void*, void*>::const_iterator it;
+
+
+	it = handles.find(handle);
+	if(it == handles.end())
+	{
+		return 0;
+	}
+
+	return it->second;
+}
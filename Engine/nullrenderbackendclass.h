@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullrenderbackendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _NULLRENDERBACKENDCLASS_H_
+#define _NULLRENDERBACKENDCLASS_H_
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <map>
+#include <vector>
+using namespace std;
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "renderbackendclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullRenderBackendClass
+//
+// Backend that never touches a device. Buffers are plain memory so the ring
+// can still be written through Map, and every call is counted and optionally
+// logged so a frame can be measured without a window or a GPU. A logged frame
+// can be replayed into another backend, which gets its own copy of every
+// resource this one holds.
+////////////////////////////////////////////////////////////////////////////////
+class NullRenderBackendClass : public RenderBackendClass
+{
+public:
+	enum CommandType
+	{
+		COMMAND_CREATE_BUFFER,
+		COMMAND_DESTROY_BUFFER,
+		COMMAND_CREATE_TEXTURE,
+		COMMAND_DESTROY_TEXTURE,
+		COMMAND_CREATE_PIPELINE,
+		COMMAND_DESTROY_PIPELINE,
+		COMMAND_MAP,
+		COMMAND_UNMAP,
+		COMMAND_RENDER_FLAGS,
+		COMMAND_PIPELINE,
+		COMMAND_TOPOLOGY,
+		COMMAND_VERTEX_BUFFER,
+		COMMAND_INDEX_BUFFER,
+		COMMAND_TEXTURE,
+		COMMAND_VS_CONSTANT_BUFFER,
+		COMMAND_PS_CONSTANT_BUFFER,
+		COMMAND_DRAW,
+		COMMAND_DRAW_INDEXED,
+		COMMAND_TYPE_COUNT
+	};
+
+	struct RenderCommand
+	{
+		CommandType type;
+		void* handle;
+		unsigned int args[3];
+	};
+
+private:
+	struct BufferMemoryType
+	{
+		BufferType type;
+		bool dynamic;
+		unsigned int byteWidth;
+		unsigned char* data;
+	};
+
+	// The pixels are only kept so a replay can create the texture again.
+	struct TextureMemoryType
+	{
+		unsigned int width;
+		unsigned int height;
+		unsigned char* data;
+	};
+
+public:
+	NullRenderBackendClass();
+	NullRenderBackendClass(const NullRenderBackendClass&);
+	~NullRenderBackendClass();
+
+	void Shutdown();
+
+	void SetCaps(const RenderBackendCaps&);
+	void SetRecording(bool);
+
+	RenderBackendCaps GetCaps();
+
+	BufferHandle CreateBuffer(const BufferDesc&);
+	void DestroyBuffer(BufferHandle);
+	TextureHandle CreateTexture(const TextureDesc&);
+	void DestroyTexture(TextureHandle);
+	PipelineHandle CreatePipeline(const PipelineDesc&);
+	void DestroyPipeline(PipelineHandle);
+
+	void* Map(BufferHandle, MapMode);
+	void Unmap(BufferHandle, unsigned int);
+
+	void SetRenderFlags(unsigned int);
+	void SetPipeline(PipelineHandle);
+	void SetTopology(PrimitiveTopology);
+	void SetVertexBuffer(BufferHandle, unsigned int, unsigned int);
+	void SetIndexBuffer(BufferHandle);
+	void SetTexture(unsigned int, TextureHandle);
+	void SetVSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int);
+	void SetPSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int);
+
+	void Draw(unsigned int, unsigned int);
+	void DrawIndexed(unsigned int, unsigned int);
+
+	void Reset();
+	void Replay(RenderBackendClass*);
+
+	int GetCallCount(CommandType);
+	int GetTotalCallCount();
+	unsigned int GetIndexCount();
+	unsigned int GetVertexCount();
+	unsigned long long GetBytesUploaded();
+	const vector<RenderCommand>& GetCommands();
+
+private:
+	void Record(CommandType, void*, unsigned int, unsigned int, unsigned int);
+	void* Translate(const map<void*, void*>&, void*);
+
+private:
+	RenderBackendCaps m_caps;
+	bool m_recording;
+
+	vector<RenderCommand> m_commands;
+	int m_callCounts[COMMAND_TYPE_COUNT];
+	unsigned int m_indexCount;
+	unsigned int m_vertexCount;
+	unsigned long long m_bytesUploaded;
+
+	vector<BufferMemoryType*> m_buffers;
+	vector<TextureMemoryType*> m_textures;
+	vector<PipelineDesc*> m_pipelines;
+};
+
+#endif
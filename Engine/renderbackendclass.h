@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderbackendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _RENDERBACKENDCLASS_H_
+#define _RENDERBACKENDCLASS_H_
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int RENDER_FLAG_WIREFRAME = 1;
+const unsigned int RENDER_FLAG_ALPHA_BLEND = 2;
+
+
+// Opaque handles. Each backend decides what they point at, the D3D11 backend
+// uses the native interface pointers so wrapping an existing object is free.
+struct RenderBuffer;
+struct RenderTexture;
+struct RenderPipeline;
+
+typedef RenderBuffer* BufferHandle;
+typedef RenderTexture* TextureHandle;
+typedef RenderPipeline* PipelineHandle;
+
+
+enum BufferType
+{
+	BUFFER_VERTEX,
+	BUFFER_INDEX,
+	BUFFER_CONSTANT
+};
+
+enum MapMode
+{
+	MAP_WRITE_DISCARD,
+	MAP_WRITE_NO_OVERWRITE
+};
+
+enum PrimitiveTopology
+{
+	TOPOLOGY_TRIANGLE_LIST,
+	TOPOLOGY_LINE_LIST
+};
+
+struct BufferDesc
+{
+	BufferType type;
+	unsigned int byteWidth;
+	bool dynamic;
+	const void* initialData;
+};
+
+// Textures are always 32 bit RGBA.
+struct TextureDesc
+{
+	unsigned int width;
+	unsigned int height;
+	const void* initialData;
+};
+
+// The compiled shader objects a pipeline is built from. These are owned by the
+// shader classes and passed through untouched, a backend that does not execute
+// anything can ignore them.
+struct PipelineDesc
+{
+	void* vertexShader;
+	void* pixelShader;
+	void* inputLayout;
+	void* sampleState;
+};
+
+struct RenderBackendCaps
+{
+	bool constantBufferOffsets;
+	bool constantBufferNoOverwrite;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderBackendClass
+//
+// Everything the queued draw path needs from a graphics API: resources,
+// map/unmap, one call per pipeline bind and the draws. It deliberately has no
+// API headers so the draw path can be built and run without a device.
+////////////////////////////////////////////////////////////////////////////////
+class RenderBackendClass
+{
+public:
+	virtual ~RenderBackendClass() {}
+
+	virtual RenderBackendCaps GetCaps() = 0;
+
+	virtual BufferHandle CreateBuffer(const BufferDesc&) = 0;
+	virtual void DestroyBuffer(BufferHandle) = 0;
+	virtual TextureHandle CreateTexture(const TextureDesc&) = 0;
+	virtual void DestroyTexture(TextureHandle) = 0;
+	virtual PipelineHandle CreatePipeline(const PipelineDesc&) = 0;
+	virtual void DestroyPipeline(PipelineHandle) = 0;
+
+	// Unmap is told how many bytes were written so uploads can be measured.
+	virtual void* Map(BufferHandle, MapMode) = 0;
+	virtual void Unmap(BufferHandle, unsigned int) = 0;
+
+	virtual void SetRenderFlags(unsigned int) = 0;
+	virtual void SetPipeline(PipelineHandle) = 0;
+	virtual void SetTopology(PrimitiveTopology) = 0;
+	virtual void SetVertexBuffer(BufferHandle, unsigned int, unsigned int) = 0;
+	virtual void SetIndexBuffer(BufferHandle) = 0;
+	virtual void SetTexture(unsigned int, TextureHandle) = 0;
+	virtual void SetVSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int) = 0;
+	virtual void SetPSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int) = 0;
+
+	virtual void Draw(unsigned int, unsigned int) = 0;
+	virtual void DrawIndexed(unsigned int, unsigned int) = 0;
+};
+
+#endif
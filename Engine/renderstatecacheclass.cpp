@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderstatecacheclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "renderstatecacheclass.h"
+
+
+RenderStateCacheClass::RenderStateCacheClass()
+{
+	m_backend = 0;
+
+	m_stats.issued = 0;
+	m_stats.filtered = 0;
+	m_frameStats = m_stats;
+
+	Invalidate();
+}
+
+
+RenderStateCacheClass::RenderStateCacheClass(const RenderStateCacheClass& other)
+{
+}
+
+
+RenderStateCacheClass::~RenderStateCacheClass()
+{
+}
+
+
+bool RenderStateCacheClass::Initialize(RenderBackendClass* backend)
+{
+	if(!backend)
+	{
+		return false;
+	}
+
+	m_backend = backend;
+
+	Invalidate();
+
+	return true;
+}
+
+
+void RenderStateCacheClass::Shutdown()
+{
+	m_backend = 0;
+
+	return;
+}
+
+
+RenderBackendCaps RenderStateCacheClass::GetCaps()
+{
+	return m_backend->GetCaps();
+}
+
+
+BufferHandle RenderStateCacheClass::CreateBuffer(const BufferDesc& desc)
+{
+	return m_backend->CreateBuffer(desc);
+}
+
+
+void RenderStateCacheClass::DestroyBuffer(BufferHandle handle)
+{
+	// A new buffer could come back with the same handle, so forget anything bound to it.
+	Invalidate();
+	m_backend->DestroyBuffer(handle);
+}
+
+
+TextureHandle RenderStateCacheClass::CreateTexture(const TextureDesc& desc)
+{
+	return m_backend->CreateTexture(desc);
+}
+
+
+void RenderStateCacheClass::DestroyTexture(TextureHandle handle)
+{
+	Invalidate();
+	m_backend->DestroyTexture(handle);
+}
+
+
+PipelineHandle RenderStateCacheClass::CreatePipeline(const PipelineDesc& desc)
+{
+	return m_backend->CreatePipeline(desc);
+}
+
+
+void RenderStateCacheClass::DestroyPipeline(PipelineHandle handle)
+{
+	Invalidate();
+	m_backend->DestroyPipeline(handle);
+}
+
+
+void* RenderStateCacheClass::Map(BufferHandle handle, MapMode mode)
+{
+	return m_backend->Map(handle, mode);
+}
+
+
+void RenderStateCacheClass::Unmap(BufferHandle handle, unsigned int bytesWritten)
+{
+	m_backend->Unmap(handle, bytesWritten);
+}
+
+
+void RenderStateCacheClass::SetRenderFlags(unsigned int renderFlags)
+{
+	if(Filter(STATE_RENDER_FLAGS, m_renderFlags == renderFlags))
+	{
+		return;
+	}
+
+	m_renderFlags = renderFlags;
+	m_backend->SetRenderFlags(renderFlags);
+}
+
+
+void RenderStateCacheClass::SetPipeline(PipelineHandle pipeline)
+{
+	if(Filter(STATE_PIPELINE, m_pipeline == pipeline))
+	{
+		return;
+	}
+
+	m_pipeline = pipeline;
+	m_backend->SetPipeline(pipeline);
+}
+
+
+void RenderStateCacheClass::SetTopology(PrimitiveTopology topology)
+{
+	if(Filter(STATE_TOPOLOGY, m_topology == topology))
+	{
+		return;
+	}
+
+	m_topology = topology;
+	m_backend->SetTopology(topology);
+}
+
+
+void RenderStateCacheClass::SetVertexBuffer(BufferHandle vertexBuffer, unsigned int stride, unsigned int offset)
+{
+	if(Filter(STATE_VERTEX_BUFFER, m_vertexBuffer == vertexBuffer && m_stride == stride && m_offset == offset))
+	{
+		return;
+	}
+
+	m_vertexBuffer = vertexBuffer;
+	m_stride = stride;
+	m_offset = offset;
+	m_backend->SetVertexBuffer(vertexBuffer, stride, offset);
+}
+
+
+void RenderStateCacheClass::SetIndexBuffer(BufferHandle indexBuffer)
+{
+	if(Filter(STATE_INDEX_BUFFER, m_indexBuffer == indexBuffer))
+	{
+		return;
+	}
+
+	m_indexBuffer = indexBuffer;
+	m_backend->SetIndexBuffer(indexBuffer);
+}
+
+
+void RenderStateCacheClass::SetTexture(unsigned int slot, TextureHandle texture)
+{
+	if(slot < STATE_CACHE_SLOTS)
+	{
+		if(Filter(STATE_TEXTURE << slot, m_textures[slot] == texture))
+		{
+			return;
+		}
+
+		m_textures[slot] = texture;
+	}
+
+	m_backend->SetTexture(slot, texture);
+}
+
+
+void RenderStateCacheClass::SetVSConstantBuffer(unsigned int slot, BufferHandle buffer, unsigned int firstConstant, unsigned int numConstants)
+{
+	if(slot < STATE_CACHE_SLOTS)
+	{
+		ConstantBufferBinding& binding = m_vsConstants[slot];
+
+		if(Filter(STATE_VS_CONSTANTS << slot, binding.buffer == buffer && binding.firstConstant == firstConstant && binding.numConstants == numConstants))
+		{
+			return;
+		}
+
+		binding.buffer = buffer;
+		binding.firstConstant = firstConstant;
+		binding.numConstants = numConstants;
+	}
+
+	m_backend->SetVSConstantBuffer(slot, buffer, firstConstant, numConstants);
+}
+
+
+void RenderStateCacheClass::SetPSConstantBuffer(unsigned int slot, BufferHandle buffer, unsigned int firstConstant, unsigned int numConstants)
+{
+	if(slot < STATE_CACHE_SLOTS)
+	{
+		ConstantBufferBinding& binding = m_psConstants[slot];
+
+		if(Filter(STATE_PS_CONSTANTS << slot, binding.buffer == buffer && binding.firstConstant == firstConstant && binding.numConstants == numConstants))
+		{
+			return;
+		}
+
+		binding.buffer = buffer;
+		binding.firstConstant = firstConstant;
+		binding.numConstants = numConstants;
+	}
+
+	m_backend->SetPSConstantBuffer(slot, buffer, firstConstant, numConstants);
+}
+
+
+void RenderStateCacheClass::Draw(unsigned int vertexCount, unsigned int startVertex)
+{
+	m_backend->Draw(vertexCount, startVertex);
+}
+
+
+void RenderStateCacheClass::DrawIndexed(unsigned int indexCount, unsigned int startIndex)
+{
+	m_backend->DrawIndexed(indexCount, startIndex);
+}
+
+
+void RenderStateCacheClass::Invalidate()
+{
+	int i;
+
+
+	// Clear the valid bits so the next bind of each state is issued even when it
+	// matches the cleared value, such as a null texture.
+	m_validStates = 0;
+
+	m_renderFlags = 0;
+	m_pipeline = 0;
+	m_topology = TOPOLOGY_TRIANGLE_LIST;
+	m_vertexBuffer = 0;
+	m_stride = 0;
+	m_offset = 0;
+	m_indexBuffer = 0;
+
+	for(i=0; i<STATE_CACHE_SLOTS; i++)
+	{
+		m_textures[i] = 0;
+
+		m_vsConstants[i].buffer = 0;
+		m_vsConstants[i].firstConstant = 0;
+		m_vsConstants[i].numConstants = 0;
+
+		m_psConstants[i] = m_vsConstants[i];
+	}
+
+	return;
+}
+
+
+void RenderStateCacheClass::EndFrame()
+{
+	m_frameStats = m_stats;
+
+	m_stats.issued = 0;
+	m_stats.filtered = 0;
+
+	// Text and anything else drawn after the flush binds its own state.
+	Invalidate();
+
+	return;
+}
+
+
+RenderStateStats RenderStateCacheClass::GetFrameStats()
+{
+	return m_frameStats;
+}
+
+
+bool RenderStateCacheClass::Filter(unsigned int state, bool unchanged)
+{
+	if(unchanged && (m_validStates & state))
+	{
+		m_stats.filtered++;
+		return true;
+	}
+
+	m_validStates |= state;
+	m_stats.issued++;
+	return false;
+}
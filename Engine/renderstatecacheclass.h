@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderstatecacheclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _RENDERSTATECACHECLASS_H_
+#define _RENDERSTATECACHECLASS_H_
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "renderbackendclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const int STATE_CACHE_SLOTS = 4;
+
+
+struct RenderStateStats
+{
+	int issued;
+	int filtered;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderStateCacheClass
+//
+// Sits in front of another backend and drops any bind that would set the
+// same value the device already has. Resource calls are passed straight
+// through. Anything that changes device state without going through here
+// (the font wrapper, the immediate shader path) must call Invalidate after.
+////////////////////////////////////////////////////////////////////////////////
+class RenderStateCacheClass : public RenderBackendClass
+{
+private:
+	// One valid bit per tracked state, slotted states take STATE_CACHE_SLOTS bits each.
+	enum StateBits
+	{
+		STATE_RENDER_FLAGS = 1 << 0,
+		STATE_PIPELINE = 1 << 1,
+		STATE_TOPOLOGY = 1 << 2,
+		STATE_VERTEX_BUFFER = 1 << 3,
+		STATE_INDEX_BUFFER = 1 << 4,
+		STATE_TEXTURE = 1 << 5,
+		STATE_VS_CONSTANTS = STATE_TEXTURE << STATE_CACHE_SLOTS,
+		STATE_PS_CONSTANTS = STATE_VS_CONSTANTS << STATE_CACHE_SLOTS
+	};
+
+	struct ConstantBufferBinding
+	{
+		BufferHandle buffer;
+		unsigned int firstConstant;
+		unsigned int numConstants;
+	};
+
+public:
+	RenderStateCacheClass();
+	RenderStateCacheClass(const RenderStateCacheClass&);
+	~RenderStateCacheClass();
+
+	bool Initialize(RenderBackendClass*);
+	void Shutdown();
+
+	RenderBackendCaps GetCaps();
+
+	BufferHandle CreateBuffer(const BufferDesc&);
+	void DestroyBuffer(BufferHandle);
+	TextureHandle CreateTexture(const TextureDesc&);
+	void DestroyTexture(TextureHandle);
+	PipelineHandle CreatePipeline(const PipelineDesc&);
+	void DestroyPipeline(PipelineHandle);
+
+	void* Map(BufferHandle, MapMode);
+	void Unmap(BufferHandle, unsigned int);
+
+	void SetRenderFlags(unsigned int);
+	void SetPipeline(PipelineHandle);
+	void SetTopology(PrimitiveTopology);
+	void SetVertexBuffer(BufferHandle, unsigned int, unsigned int);
+	void SetIndexBuffer(BufferHandle);
+	void SetTexture(unsigned int, TextureHandle);
+	void SetVSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int);
+	void SetPSConstantBuffer(unsigned int, BufferHandle, unsigned int, unsigned int);
+
+	void Draw(unsigned int, unsigned int);
+	void DrawIndexed(unsigned int, unsigned int);
+
+	void Invalidate();
+	void EndFrame();
+	RenderStateStats GetFrameStats();
+
+private:
+	bool Filter(unsigned int, bool);
+
+private:
+	RenderBackendClass* m_backend;
+	unsigned int m_validStates;
+
+	unsigned int m_renderFlags;
+	PipelineHandle m_pipeline;
+	PrimitiveTopology m_topology;
+	BufferHandle m_vertexBuffer;
+	unsigned int m_stride, m_offset;
+	BufferHandle m_indexBuffer;
+	TextureHandle m_textures[STATE_CACHE_SLOTS];
+	ConstantBufferBinding m_vsConstants[STATE_CACHE_SLOTS];
+	ConstantBufferBinding m_psConstants[STATE_CACHE_SLOTS];
+
+	RenderStateStats m_stats, m_frameStats;
+};
+
+#endif
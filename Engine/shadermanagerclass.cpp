@@ -8,7 +8,15 @@ ShaderManagerClass::ShaderManagerClass()
 {
 	m_TextureShader = 0;
 	m_LightShader = 0;
+	m_FogShader = 0;
 	m_BumpMapShader = 0;
+	m_D3D = 0;
+	m_ConstantRing = 0;
+	m_DrawQueue = 0;
+	m_Backend = 0;
+	m_StateCache = 0;
+	m_renderFlags = 0;
+	m_topology = TOPOLOGY_TRIANGLE_LIST;
 }
 
 
@@ -22,11 +30,15 @@ ShaderManagerClass::~ShaderManagerClass()
 }
 
 
-bool ShaderManagerClass::Initialize(ID3D11Device* device, HWND hwnd)
+bool ShaderManagerClass::Initialize(D3DClass* d3d, HWND hwnd)
 {
+	ID3D11Device* device;
 	bool result;
 
 
+	m_D3D = d3d;
+	device = m_D3D->GetDevice();
+
 	// Create the texture shader object.
 	m_TextureShader = new TextureShaderClass;
 	if(!m_TextureShader)
@@ -59,7 +71,7 @@ bool ShaderManagerClass::Initialize(ID3D11Device* device, HWND hwnd)
 
 	// Create the fog shader object.
 	m_FogShader = new FogShaderClass;
-	if (!m_LightShader)
+	if (!m_FogShader)
 	{
 		return false;
 	}
@@ -87,12 +99,115 @@ bool ShaderManagerClass::Initialize(ID3D11Device* device, HWND hwnd)
 		return false;
 	}
 
+	// Create the draw queue object.
+	m_DrawQueue = new DrawQueueClass;
+	if(!m_DrawQueue)
+	{
+		return false;
+	}
+
+	// Initialize the draw queue object.
+	result = m_DrawQueue->Initialize(4096);
+	if(!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the draw queue object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the D3D11 backend object.
+	m_Backend = new D3D11RenderBackendClass;
+	if(!m_Backend)
+	{
+		return false;
+	}
+
+	// Initialize the D3D11 backend object.
+	result = m_Backend->Initialize(m_D3D);
+	if(!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the render backend object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Register each shader's pipeline with the backend so queued draws can refer to it by handle.
+	result = m_TextureShader->CreatePipeline(m_Backend) && m_LightShader->CreatePipeline(m_Backend) &&
+		m_FogShader->CreatePipeline(m_Backend) && m_BumpMapShader->CreatePipeline(m_Backend);
+	if(!result)
+	{
+		MessageBox(hwnd, L"Could not create the shader pipelines.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the render state cache object.
+	m_StateCache = new RenderStateCacheClass;
+	if(!m_StateCache)
+	{
+		return false;
+	}
+
+	// Initialize the render state cache object in front of the backend.
+	result = m_StateCache->Initialize(m_Backend);
+	if(!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the render state cache object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Create the constant buffer ring object.
+	m_ConstantRing = new ConstantBufferRingClass;
+	if(!m_ConstantRing)
+	{
+		return false;
+	}
+
+	// Initialize the constant buffer ring object. This needs constant buffer offsetting from the
+	// 11.1 runtime, so when it is not available draws go through each shader's own buffers instead.
+	result = m_ConstantRing->Initialize(m_StateCache, CONSTANT_RING_SIZE, CONSTANT_RING_FRAMES_IN_FLIGHT);
+	if(!result)
+	{
+		m_ConstantRing->Shutdown();
+		delete m_ConstantRing;
+		m_ConstantRing = 0;
+	}
+
 	return true;
 }
 
 
 void ShaderManagerClass::Shutdown()
 {
+	// Release the constant buffer ring object.
+	if(m_ConstantRing)
+	{
+		m_ConstantRing->Shutdown();
+		delete m_ConstantRing;
+		m_ConstantRing = 0;
+	}
+
+	// Release the render state cache object.
+	if(m_StateCache)
+	{
+		m_StateCache->Shutdown();
+		delete m_StateCache;
+		m_StateCache = 0;
+	}
+
+	// Release the D3D11 backend object.
+	if(m_Backend)
+	{
+		m_Backend->Shutdown();
+		delete m_Backend;
+		m_Backend = 0;
+	}
+
+	// Release the draw queue object.
+	if(m_DrawQueue)
+	{
+		m_DrawQueue->Shutdown();
+		delete m_DrawQueue;
+		m_DrawQueue = 0;
+	}
+
 	// Release the bump map shader object.
 	if(m_BumpMapShader)
 	{
@@ -101,6 +216,14 @@ void ShaderManagerClass::Shutdown()
 		m_BumpMapShader = 0;
 	}
 
+	// Release the fog shader object.
+	if(m_FogShader)
+	{
+		m_FogShader->Shutdown();
+		delete m_FogShader;
+		m_FogShader = 0;
+	}
+
 	// Release the light shader object.
 	if(m_LightShader)
 	{
@@ -121,73 +244,298 @@ void ShaderManagerClass::Shutdown()
 }
 
 
-bool ShaderManagerClass::RenderTextureShader(ID3D11DeviceContext* device, int indexCount, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix, const XMMATRIX &projectionMatrix,
-											 ID3D11ShaderResourceView* texture)
+void ShaderManagerClass::SetRenderFlags(unsigned int renderFlags)
+{
+	// Queued draws carry their flags with them, only the immediate path changes state here.
+	if(!m_ConstantRing)
+	{
+		m_Backend->SetRenderFlags(renderFlags);
+	}
+
+	m_renderFlags = renderFlags;
+
+	return;
+}
+
+
+void ShaderManagerClass::SetTopology(PrimitiveTopology topology)
+{
+	// Only draws from raw buffers use this, models always draw triangle lists.
+	m_topology = topology;
+
+	return;
+}
+
+
+bool ShaderManagerClass::Flush()
 {
 	bool result;
 
 
-	// Render the model using the texture shader.
-	result = m_TextureShader->Render(device, indexCount, worldMatrix, viewMatrix, projectionMatrix, texture);
+	if(!m_ConstantRing || m_DrawQueue->GetCount() == 0)
+	{
+		return true;
+	}
+
+	// Upload the constants of every queued draw with a single map, then issue the draws.
+	result = m_ConstantRing->Commit();
 	if(!result)
 	{
 		return false;
 	}
 
+	m_DrawQueue->Execute(m_ConstantRing, m_StateCache);
+
 	return true;
 }
 
 
-bool ShaderManagerClass::RenderLightShader(ID3D11DeviceContext* deviceContext, int indexCount, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix, const XMMATRIX &projectionMatrix,
-	ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 ambient, XMFLOAT4 diffuse,
-	XMFLOAT3 cameraPosition, XMFLOAT4 specular, float specularPower)
+bool ShaderManagerClass::EndFrame()
 {
 	bool result;
 
 
-	// Render the model using the light shader.
-	result = m_LightShader->Render(deviceContext, indexCount, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse, cameraPosition, 
-								   specular, specularPower);
+	result = Flush();
 	if(!result)
 	{
 		return false;
 	}
 
+	if(m_ConstantRing)
+	{
+		m_ConstantRing->EndFrame();
+	}
+
+	// Roll the bind counts over and forget the cached state, the HUD is drawn outside the cache.
+	m_StateCache->EndFrame();
+
+	return true;
+}
+
+
+RenderStateStats ShaderManagerClass::GetStateStats()
+{
+	return m_StateCache->GetFrameStats();
+}
+
+
+RenderBackendClass* ShaderManagerClass::GetBackend()
+{
+	return m_Backend;
+}
+
+
+bool ShaderManagerClass::RenderTextureShader(ID3D11DeviceContext* deviceContext, BumpModelClass* model, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix,
+											 const XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
+{
+	DrawPacket packet;
+	bool result;
+
+
+	// Without the constant ring render the model straight away using the texture shader.
+	if(!m_ConstantRing)
+	{
+		model->Render(deviceContext);
+		return m_TextureShader->Render(deviceContext, model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, texture);
+	}
+
+	// Queue the model using the texture shader.
+	BeginPacket(model, packet);
+	result = m_TextureShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture);
+	if(!result)
+	{
+		result = RestartRing() && m_TextureShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture);
+		if(!result)
+		{
+			return false;
+		}
+	}
+
+	m_DrawQueue->Add(packet);
+
+	return true;
+}
+
+
+bool ShaderManagerClass::RenderTextureShader(ID3D11DeviceContext* deviceContext, BufferHandle vertexBuffer, BufferHandle indexBuffer, unsigned int stride,
+											 unsigned int indexCount, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix, const XMMATRIX &projectionMatrix,
+											 ID3D11ShaderResourceView* texture)
+{
+	DrawPacket packet;
+	bool result;
+
+
+	// Without the constant ring bind the buffers and render straight away using the texture shader.
+	if(!m_ConstantRing)
+	{
+		m_Backend->SetVertexBuffer(vertexBuffer, stride, 0);
+		m_Backend->SetIndexBuffer(indexBuffer);
+		m_Backend->SetTopology(m_topology);
+		return m_TextureShader->Render(deviceContext, indexCount, worldMatrix, viewMatrix, projectionMatrix, texture);
+	}
+
+	// Queue the buffers using the texture shader.
+	BeginPacket(vertexBuffer, indexBuffer, stride, indexCount, packet);
+	result = m_TextureShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture);
+	if(!result)
+	{
+		result = RestartRing() && m_TextureShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture);
+		if(!result)
+		{
+			return false;
+		}
+	}
+
+	m_DrawQueue->Add(packet);
+
 	return true;
 }
 
-bool ShaderManagerClass::RenderFogShader(ID3D11DeviceContext* deviceContext, int indexCount, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix, const XMMATRIX &projectionMatrix,
-	ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 ambient, XMFLOAT4 diffuse,
+
+bool ShaderManagerClass::RenderLightShader(ID3D11DeviceContext* deviceContext, BumpModelClass* model, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix,
+	const XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 ambient, XMFLOAT4 diffuse,
 	XMFLOAT3 cameraPosition, XMFLOAT4 specular, float specularPower)
 {
+	DrawPacket packet;
 	bool result;
 
 
-	// Render the model using the light shader.
-	result = m_FogShader->Render(deviceContext, indexCount, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse, cameraPosition,
-		specular, specularPower);
+	// Without the constant ring render the model straight away using the light shader.
+	if(!m_ConstantRing)
+	{
+		model->Render(deviceContext);
+		return m_LightShader->Render(deviceContext, model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse,
+									 cameraPosition, specular, specularPower);
+	}
+
+	// Queue the model using the light shader.
+	BeginPacket(model, packet);
+	result = m_LightShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse,
+								   cameraPosition, specular, specularPower);
+	if(!result)
+	{
+		result = RestartRing() && m_LightShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse,
+														cameraPosition, specular, specularPower);
+		if(!result)
+		{
+			return false;
+		}
+	}
+
+	m_DrawQueue->Add(packet);
+
+	return true;
+}
+
+bool ShaderManagerClass::RenderFogShader(ID3D11DeviceContext* deviceContext, BumpModelClass* model, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix,
+	const XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT3 lightDirection, XMFLOAT4 ambient, XMFLOAT4 diffuse,
+	XMFLOAT3 cameraPosition, XMFLOAT4 specular, float specularPower)
+{
+	DrawPacket packet;
+	bool result;
+
+
+	// Without the constant ring render the model straight away using the fog shader.
+	if (!m_ConstantRing)
+	{
+		model->Render(deviceContext);
+		return m_FogShader->Render(deviceContext, model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse,
+								   cameraPosition, specular, specularPower);
+	}
+
+	// Queue the model using the fog shader.
+	BeginPacket(model, packet);
+	result = m_FogShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse,
+								 cameraPosition, specular, specularPower);
 	if (!result)
 	{
-		return false;
+		result = RestartRing() && m_FogShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambient, diffuse,
+													  cameraPosition, specular, specularPower);
+		if (!result)
+		{
+			return false;
+		}
 	}
 
+	m_DrawQueue->Add(packet);
+
 	return true;
 }
 
 
-bool ShaderManagerClass::RenderBumpMapShader(ID3D11DeviceContext* deviceContext, int indexCount, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix, const XMMATRIX &projectionMatrix,
-	ID3D11ShaderResourceView* colorTexture, ID3D11ShaderResourceView* normalTexture, XMFLOAT3 lightDirection,
+bool ShaderManagerClass::RenderBumpMapShader(ID3D11DeviceContext* deviceContext, BumpModelClass* model, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix,
+	const XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* colorTexture, ID3D11ShaderResourceView* normalTexture, XMFLOAT3 lightDirection,
 											 XMFLOAT4 diffuse)
 {
+	DrawPacket packet;
 	bool result;
 
 
-	// Render the model using the bump map shader.
-	result = m_BumpMapShader->Render(deviceContext, indexCount, worldMatrix, viewMatrix, projectionMatrix, colorTexture, normalTexture, lightDirection, diffuse);
+	// Without the constant ring render the model straight away using the bump map shader.
+	if(!m_ConstantRing)
+	{
+		model->Render(deviceContext);
+		return m_BumpMapShader->Render(deviceContext, model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, colorTexture, normalTexture,
+									   lightDirection, diffuse);
+	}
+
+	// Queue the model using the bump map shader.
+	BeginPacket(model, packet);
+	result = m_BumpMapShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, colorTexture, normalTexture, lightDirection, diffuse);
+	if(!result)
+	{
+		result = RestartRing() && m_BumpMapShader->Record(m_ConstantRing, packet, worldMatrix, viewMatrix, projectionMatrix, colorTexture, normalTexture,
+														  lightDirection, diffuse);
+		if(!result)
+		{
+			return false;
+		}
+	}
+
+	m_DrawQueue->Add(packet);
+
+	return true;
+}
+
+
+void ShaderManagerClass::BeginPacket(BumpModelClass* model, DrawPacket& packet)
+{
+	BeginPacket(D3D11RenderBackendClass::WrapBuffer(model->m_vertexBuffer), D3D11RenderBackendClass::WrapBuffer(model->m_indexBuffer),
+		model->GetVertexStride(), model->GetIndexCount(), packet);
+	packet.topology = TOPOLOGY_TRIANGLE_LIST;
+
+	return;
+}
+
+
+void ShaderManagerClass::BeginPacket(BufferHandle vertexBuffer, BufferHandle indexBuffer, unsigned int stride, unsigned int indexCount, DrawPacket& packet)
+{
+	// Capture the buffers now, the input assembler is only set when the queue is executed.
+	packet.vertexBuffer = vertexBuffer;
+	packet.indexBuffer = indexBuffer;
+	packet.stride = stride;
+	packet.indexCount = indexCount;
+	packet.topology = m_topology;
+	packet.renderFlags = m_renderFlags;
+
+	return;
+}
+
+
+bool ShaderManagerClass::RestartRing()
+{
+	bool result;
+
+
+	// The ring has run out of room for this frame. Issue everything queued so far and
+	// discard the buffer so the allocator can start again from the beginning.
+	result = Flush();
 	if(!result)
 	{
 		return false;
 	}
 
+	m_ConstantRing->Discard();
+
 	return true;
-}
\ No newline at end of file
+}
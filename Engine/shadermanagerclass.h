@@ -13,6 +13,11 @@
 #include "lightshaderclass.h"
 #include "bumpmapshaderclass.h"
 #include "fogshaderclass.h"
+#include "bumpmodelclass.h"
+#include "constantbufferringclass.h"
+#include "drawqueueclass.h"
+#include "d3d11renderbackendclass.h"
+#include "renderstatecacheclass.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -25,25 +30,47 @@ public:
 	ShaderManagerClass(const ShaderManagerClass&);
 	~ShaderManagerClass();
 
-	bool Initialize(ID3D11Device*, HWND);
+	bool Initialize(D3DClass*, HWND);
 	void Shutdown();
 
-	bool RenderTextureShader(ID3D11DeviceContext*, int, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*);
+	void SetRenderFlags(unsigned int);
+	void SetTopology(PrimitiveTopology);
+	bool Flush();
+	bool EndFrame();
+	RenderStateStats GetStateStats();
+	RenderBackendClass* GetBackend();
 
-	bool RenderLightShader(ID3D11DeviceContext*, int, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*,
+	bool RenderTextureShader(ID3D11DeviceContext*, BumpModelClass*, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*);
+	bool RenderTextureShader(ID3D11DeviceContext*, BufferHandle, BufferHandle, unsigned int, unsigned int, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&,
+		ID3D11ShaderResourceView*);
+
+	bool RenderLightShader(ID3D11DeviceContext*, BumpModelClass*, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*,
 		XMFLOAT3, XMFLOAT4, XMFLOAT4, XMFLOAT3, XMFLOAT4, float);
 
-	bool RenderFogShader(ID3D11DeviceContext*, int, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*,
+	bool RenderFogShader(ID3D11DeviceContext*, BumpModelClass*, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*,
 		XMFLOAT3, XMFLOAT4, XMFLOAT4, XMFLOAT3, XMFLOAT4, float);
 
-	bool RenderBumpMapShader(ID3D11DeviceContext*, int, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*,
+	bool RenderBumpMapShader(ID3D11DeviceContext*, BumpModelClass*, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*,
 		ID3D11ShaderResourceView*, XMFLOAT3, XMFLOAT4);
 
+private:
+	void BeginPacket(BumpModelClass*, DrawPacket&);
+	void BeginPacket(BufferHandle, BufferHandle, unsigned int, unsigned int, DrawPacket&);
+	bool RestartRing();
+
 private:
 	TextureShaderClass* m_TextureShader;
 	LightShaderClass* m_LightShader;
 	FogShaderClass* m_FogShader;
 	BumpMapShaderClass* m_BumpMapShader;
+
+	D3DClass* m_D3D;
+	ConstantBufferRingClass* m_ConstantRing;
+	DrawQueueClass* m_DrawQueue;
+	D3D11RenderBackendClass* m_Backend;
+	RenderStateCacheClass* m_StateCache;
+	unsigned int m_renderFlags;
+	PrimitiveTopology m_topology;
 };
 
 #endif
\ No newline at end of file
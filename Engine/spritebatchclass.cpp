@@ -0,0 +1,323 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: spritebatchclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "spritebatchclass.h"
+
+#include <xmmintrin.h>
+
+
+SpriteBatchClass::SpriteBatchClass()
+{
+	m_backend = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_maxQuads = 0;
+	m_ringQuads = 0;
+	m_ringHead = 0;
+}
+
+
+SpriteBatchClass::SpriteBatchClass(const SpriteBatchClass& other)
+{
+}
+
+
+SpriteBatchClass::~SpriteBatchClass()
+{
+}
+
+
+bool SpriteBatchClass::Initialize(RenderBackendClass* backend, unsigned int maxQuads)
+{
+	BufferDesc desc;
+	unsigned long* indices;
+	unsigned int i;
+
+
+	m_backend = backend;
+	m_maxQuads = maxQuads;
+
+	// The vertex buffer holds a few frames of quads and is written as a ring, so a frame only
+	// discards it when the write would run past the end.
+	m_ringQuads = maxQuads * SPRITE_RING_FRAMES;
+	m_ringHead = 0;
+
+	desc.type = BUFFER_VERTEX;
+	desc.byteWidth = m_ringQuads * 4 * sizeof(SpriteVertex);
+	desc.dynamic = true;
+	desc.initialData = 0;
+
+	m_vertexBuffer = m_backend->CreateBuffer(desc);
+	if(!m_vertexBuffer)
+	{
+		return false;
+	}
+
+	// Every quad uses the same two triangles, so one static index buffer covers the whole ring.
+	indices = new unsigned long[m_ringQuads * 6];
+	if(!indices)
+	{
+		return false;
+	}
+
+	for(i=0; i<m_ringQuads; i++)
+	{
+		indices[i * 6 + 0] = i * 4 + 0;  // Top left.
+		indices[i * 6 + 1] = i * 4 + 3;  // Bottom right.
+		indices[i * 6 + 2] = i * 4 + 2;  // Bottom left.
+		indices[i * 6 + 3] = i * 4 + 0;  // Top left.
+		indices[i * 6 + 4] = i * 4 + 1;  // Top right.
+		indices[i * 6 + 5] = i * 4 + 3;  // Bottom right.
+	}
+
+	desc.type = BUFFER_INDEX;
+	desc.byteWidth = m_ringQuads * 6 * sizeof(unsigned long);
+	desc.dynamic = false;
+	desc.initialData = indices;
+
+	m_indexBuffer = m_backend->CreateBuffer(desc);
+
+	// Release the index array as it is no longer needed.
+	delete [] indices;
+	indices = 0;
+
+	if(!m_indexBuffer)
+	{
+		return false;
+	}
+
+	// Reserve the per frame lists so queueing quads does not allocate.
+	m_quads.reserve(m_maxQuads);
+	m_quadTextures.reserve(m_maxQuads);
+	m_sortedQuads.resize(m_maxQuads);
+
+	return true;
+}
+
+
+void SpriteBatchClass::Shutdown()
+{
+	// Release the index and vertex buffers.
+	if(m_indexBuffer)
+	{
+		m_backend->DestroyBuffer(m_indexBuffer);
+		m_indexBuffer = 0;
+	}
+
+	if(m_vertexBuffer)
+	{
+		m_backend->DestroyBuffer(m_vertexBuffer);
+		m_vertexBuffer = 0;
+	}
+
+	m_quads.clear();
+	m_quadTextures.clear();
+	m_sortedQuads.clear();
+	m_batches.clear();
+	m_backend = 0;
+
+	return;
+}
+
+
+void SpriteBatchClass::Begin()
+{
+	m_quads.clear();
+	m_quadTextures.clear();
+	m_batches.clear();
+
+	return;
+}
+
+
+bool SpriteBatchClass::Draw(TextureHandle texture, const SpriteQuad& quad)
+{
+	return Draw(texture, &quad, 1);
+}
+
+
+bool SpriteBatchClass::Draw(TextureHandle texture, const SpriteQuad* quads, unsigned int count)
+{
+	// Drop quads that do not fit in a frame rather than growing the buffers.
+	if(m_quads.size() + count > m_maxQuads)
+	{
+		return false;
+	}
+
+	m_quads.insert(m_quads.end(), quads, quads + count);
+	m_quadTextures.insert(m_quadTextures.end(), count, texture);
+
+	return true;
+}
+
+
+bool SpriteBatchClass::End()
+{
+	SpriteVertex* vertices;
+	unsigned int count, i;
+	MapMode mode;
+
+
+	count = (unsigned int)m_quads.size();
+	if(count == 0)
+	{
+		return true;
+	}
+
+	// Group the quads by texture so each texture is drawn once.
+	SortByTexture();
+
+	// Append to the ring, starting it over with a discard when the frame does not fit.
+	mode = MAP_WRITE_NO_OVERWRITE;
+	if(m_ringHead == 0 || m_ringHead + count > m_ringQuads)
+	{
+		mode = MAP_WRITE_DISCARD;
+		m_ringHead = 0;
+	}
+
+	vertices = (SpriteVertex*)m_backend->Map(m_vertexBuffer, mode);
+	if(!vertices)
+	{
+		m_batches.clear();
+		return false;
+	}
+
+	BuildVertices(&m_sortedQuads[0], count, vertices + m_ringHead * 4);
+
+	m_backend->Unmap(m_vertexBuffer, count * 4 * sizeof(SpriteVertex));
+
+	// Move the batches to where their quads landed in the ring.
+	for(i=0; i<m_batches.size(); i++)
+	{
+		m_batches[i].startIndex += m_ringHead * 6;
+	}
+
+	m_ringHead += count;
+
+	return true;
+}
+
+
+void SpriteBatchClass::Render()
+{
+	unsigned int i;
+
+
+	if(m_batches.empty())
+	{
+		return;
+	}
+
+	// The caller has bound the sprite shader, so only the buffers and each batch's texture are set here.
+	m_backend->SetVertexBuffer(m_vertexBuffer, sizeof(SpriteVertex), 0);
+	m_backend->SetIndexBuffer(m_indexBuffer);
+	m_backend->SetTopology(TOPOLOGY_TRIANGLE_LIST);
+
+	for(i=0; i<m_batches.size(); i++)
+	{
+		m_backend->SetTexture(0, m_batches[i].texture);
+		m_backend->DrawIndexed(m_batches[i].indexCount, m_batches[i].startIndex);
+	}
+
+	return;
+}
+
+
+int SpriteBatchClass::GetQuadCount()
+{
+	return (int)m_quads.size();
+}
+
+
+int SpriteBatchClass::GetBatchCount()
+{
+	return (int)m_batches.size();
+}
+
+
+void SpriteBatchClass::BuildVertices(const SpriteQuad* quads, unsigned int count, SpriteVertex* vertices)
+{
+	__m128 rect, texture, size, corners;
+	__m128 extent = _mm_setr_ps(1.0f, -1.0f, 0.0f, 0.0f);
+	unsigned int i;
+
+
+	for(i=0; i<count; i++)
+	{
+		// rect = [x y w h], texture = [left top right bottom]
+		rect = _mm_loadu_ps(&quads[i].x);
+		texture = _mm_loadu_ps(&quads[i].left);
+
+		// corners = [x y x+w y-h]
+		size = _mm_mul_ps(_mm_shuffle_ps(rect, rect, _MM_SHUFFLE(3, 2, 3, 2)), extent);
+		corners = _mm_movelh_ps(rect, _mm_add_ps(rect, size));
+
+		// Each vertex is one register, [x y u v], in the order top left, top right, bottom left, bottom right.
+		_mm_storeu_ps(&vertices[0].x, _mm_movelh_ps(corners, texture));
+		_mm_storeu_ps(&vertices[1].x, _mm_shuffle_ps(corners, texture, _MM_SHUFFLE(1, 2, 1, 2)));
+		_mm_storeu_ps(&vertices[2].x, _mm_shuffle_ps(corners, texture, _MM_SHUFFLE(3, 0, 3, 0)));
+		_mm_storeu_ps(&vertices[3].x, _mm_movehl_ps(texture, corners));
+
+		vertices += 4;
+	}
+
+	return;
+}
+
+
+void SpriteBatchClass::SortByTexture()
+{
+	BatchType batch;
+	unsigned int count, offset, i, j;
+
+
+	count = (unsigned int)m_quads.size();
+
+	// Count the quads per texture, in the order each texture first appears. A HUD only uses a
+	// handful of textures, so a linear search is cheaper than anything fancier.
+	m_textureCounts.clear();
+	m_batches.clear();
+
+	for(i=0; i<count; i++)
+	{
+		for(j=0; j<m_batches.size(); j++)
+		{
+			if(m_batches[j].texture == m_quadTextures[i])
+			{
+				break;
+			}
+		}
+
+		if(j == m_batches.size())
+		{
+			batch.texture = m_quadTextures[i];
+			batch.startIndex = 0;
+			batch.indexCount = 0;
+			m_batches.push_back(batch);
+			m_textureCounts.push_back(0);
+		}
+
+		m_batches[j].indexCount += 6;
+	}
+
+	// Give every texture a contiguous run of quads.
+	offset = 0;
+	for(j=0; j<m_batches.size(); j++)
+	{
+		m_batches[j].startIndex = offset * 6;
+		m_textureCounts[j] = offset;
+		offset += m_batches[j].indexCount / 6;
+	}
+
+	// Scatter the quads into their runs, keeping the order they were drawn in within each texture.
+	for(i=0; i<count; i++)
+	{
+		for(j=0; m_batches[j].texture != m_quadTextures[i]; j++)
+		{
+		}
+
+		m_sortedQuads[m_textureCounts[j]++] = m_quads[i];
+	}
+
+	return;
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: spritebatchclass.h
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _SPRITEBATCHCLASS_H_
+#define _SPRITEBATCHCLASS_H_
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+using namespace std;
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "renderbackendclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int SPRITE_RING_FRAMES = 3;
+
+
+// A screen space rectangle and the part of its texture to show. The position is the top left
+// corner in the same pixel space as the ortho matrix, so the quad extends right and down.
+struct SpriteQuad
+{
+	float x, y, width, height;
+	float left, top, right, bottom;
+};
+
+// Sprite vertices carry a two component position, so each one fits in a single SSE register.
+struct SpriteVertex
+{
+	float x, y;
+	float u, v;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SpriteBatchClass
+////////////////////////////////////////////////////////////////////////////////
+class SpriteBatchClass
+{
+private:
+	struct BatchType
+	{
+		TextureHandle texture;
+		unsigned int startIndex;
+		unsigned int indexCount;
+	};
+
+public:
+	SpriteBatchClass();
+	SpriteBatchClass(const SpriteBatchClass&);
+	~SpriteBatchClass();
+
+	bool Initialize(RenderBackendClass*, unsigned int);
+	void Shutdown();
+
+	void Begin();
+	bool Draw(TextureHandle, const SpriteQuad&);
+	bool Draw(TextureHandle, const SpriteQuad*, unsigned int);
+	bool End();
+	void Render();
+
+	int GetQuadCount();
+	int GetBatchCount();
+
+	static void BuildVertices(const SpriteQuad*, unsigned int, SpriteVertex*);
+
+private:
+	void SortByTexture();
+
+private:
+	RenderBackendClass* m_backend;
+	BufferHandle m_vertexBuffer;
+	BufferHandle m_indexBuffer;
+	unsigned int m_maxQuads;
+	unsigned int m_ringQuads;
+	unsigned int m_ringHead;
+
+	vector<SpriteQuad> m_quads;
+	vector<TextureHandle> m_quadTextures;
+	vector<SpriteQuad> m_sortedQuads;
+	vector<BatchType> m_batches;
+	vector<unsigned int> m_textureCounts;
+};
+
+#endif
@@ -3,20 +3,21 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include "textclass.h"
 
-#include "FW1Library/Source/CFW1Factory.h"
-#include "FW1Library/Source/CFW1FontWrapper.h"
-#include "FW1Library/Source/FW1FontWrapper.h"
-
-#pragma comment(lib, "FW1FontWrapper.lib")
 
 TextClass::TextClass()
 {
+	int i;
+
+
 	m_Font = 0;
 	m_FontShader = 0;
-	m_sentence1 = 0;
+	m_SpriteBatch = 0;
+	m_fontTexture = 0;
 
-	m_pFW1Factory = 0;
-	m_pFontWrapper = 0;
+	for(i=0; i<TEXT_SENTENCE_COUNT; i++)
+	{
+		m_sentences[i] = 0;
+	}
 }
 
 
@@ -30,10 +31,11 @@ TextClass::~TextClass()
 }
 
 
-bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd, int screenWidth, int screenHeight, 
-						   const XMMATRIX &baseViewMatrix)
+bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd, int screenWidth, int screenHeight,
+						   const XMMATRIX &baseViewMatrix, RenderBackendClass* backend)
 {
 	bool result;
+	int i;
 
 
 	// Store the screen width and height.
@@ -58,6 +60,8 @@ bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceCont
 		return false;
 	}
 
+	m_fontTexture = D3D11RenderBackendClass::WrapTexture(m_Font->GetTexture());
+
 	// Create the font shader object.
 	m_FontShader = new FontShaderClass;
 	if(!m_FontShader)
@@ -73,33 +77,38 @@ bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceCont
 		return false;
 	}
 
-	// Initialize the first sentence.
-	result = InitializeSentence(&m_sentence1, 512, device);
-	if(!result)
+	// Create the sprite batch object.
+	m_SpriteBatch = new SpriteBatchClass;
+	if(!m_SpriteBatch)
 	{
 		return false;
 	}
 
-	// Now update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence1, "Intersection: Nsd", 20, 20, 1.0f, 0.0f, 0.0f, deviceContext);
+	// Initialize the sprite batch with room for every sentence at full length.
+	result = m_SpriteBatch->Initialize(backend, TEXT_MAX_QUADS);
 	if(!result)
 	{
+		MessageBox(hwnd, L"Could not initialize the sprite batch object.", L"Error", MB_OK);
 		return false;
 	}
 
-	//Initialise the FW1Factory.
-	result = FW1CreateFactory(FW1_VERSION, &m_pFW1Factory);
-	if (FAILED(result))
+	m_SpriteBatch->Begin();
+
+	// Initialize the sentences. Each one keeps its laid out glyphs so a line that does not
+	// change between frames is never laid out again.
+	for(i=0; i<TEXT_SENTENCE_COUNT; i++)
 	{
-		MessageBox(hwnd, L"Could not Create FW1 Factory.", L"Error", MB_OK);
-		return false;
+		result = InitializeSentence(&m_sentences[i], TEXT_SENTENCE_LENGTH);
+		if(!result)
+		{
+			return false;
+		}
 	}
 
-	//Create a font wrapper for the ARIAL font.
-	result = m_pFW1Factory->CreateFontWrapper(device, (LPCWSTR)("ARIAL"), &m_pFontWrapper);
-	if (FAILED(result))
+	// Now lay out the first sentence with the new string information.
+	result = UpdateSentence(m_sentences[0], "Intersection: Nsd", 20, 20, 1.0f, 0.0f, 0.0f);
+	if(!result)
 	{
-		MessageBox(hwnd, L"Could not initialize font wrapper", L"Error", MB_OK);
 		return false;
 	}
 
@@ -109,8 +118,22 @@ bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceCont
 
 void TextClass::Shutdown()
 {
-	// Release the first sentence.
-	ReleaseSentence(&m_sentence1);
+	int i;
+
+
+	// Release the sentences.
+	for(i=0; i<TEXT_SENTENCE_COUNT; i++)
+	{
+		ReleaseSentence(&m_sentences[i]);
+	}
+
+	// Release the sprite batch object.
+	if(m_SpriteBatch)
+	{
+		m_SpriteBatch->Shutdown();
+		delete m_SpriteBatch;
+		m_SpriteBatch = 0;
+	}
 
 	// Release the font shader object.
 	if(m_FontShader)
@@ -128,215 +151,146 @@ void TextClass::Shutdown()
 		m_Font = 0;
 	}
 
-	if (m_pFontWrapper)
-	{
-		delete m_pFontWrapper;
-		m_pFontWrapper = 0;
-	}
-
-	if (m_pFW1Factory)
-	{
-		delete m_pFW1Factory;
-		m_pFW1Factory = 0;
-	}
-
-	
+	m_fontTexture = 0;
 
 	return;
 }
 
 
-bool TextClass::Render(ID3D11DeviceContext* deviceContext, const XMMATRIX &worldMatrix, const XMMATRIX &orthoMatrix)
+bool TextClass::Render(int index)
 {
-	bool result;
+	SentenceType* sentence;
 
 
-	// Draw the first sentence.
-	result = RenderSentence(deviceContext, m_sentence1, worldMatrix, orthoMatrix);
-	if(!result)
+	if(index < 0 || index >= TEXT_SENTENCE_COUNT)
 	{
 		return false;
 	}
 
-	return true;
-}
-
-
-bool TextClass::InitializeSentence(SentenceType** sentence, int maxLength, ID3D11Device* device)
-{
-	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-    D3D11_SUBRESOURCE_DATA vertexData, indexData;
-	HRESULT result;
-	int i;
-
+	sentence = m_sentences[index];
 
-	// Create a new sentence object.
-	*sentence = new SentenceType;
-	if(!*sentence)
+	// The whole batch is drawn in one color, the color of the first sentence queued.
+	if(m_SpriteBatch->GetQuadCount() == 0)
 	{
-		return false;
+		m_color = XMFLOAT4(sentence->red, sentence->green, sentence->blue, 1.0f);
 	}
 
-	// Initialize the sentence buffers to null.
-	(*sentence)->vertexBuffer = 0;
-	(*sentence)->indexBuffer = 0;
+	// Queue the sentence's glyphs, they are drawn when the text is flushed.
+	return m_SpriteBatch->Draw(m_fontTexture, sentence->quads, sentence->quadCount);
+}
 
-	// Set the maximum length of the sentence.
-	(*sentence)->maxLength = maxLength;
 
-	// Set the number of vertices in the vertex array.
-	(*sentence)->vertexCount = 6 * maxLength;
+bool TextClass::Flush(ID3D11DeviceContext* deviceContext, const XMMATRIX &worldMatrix, const XMMATRIX &orthoMatrix)
+{
+	bool result;
 
-	// Set the number of indexes in the index array.
-	(*sentence)->indexCount = (*sentence)->vertexCount;
 
-	// Create the vertex array.
-	vertices = new VertexType[(*sentence)->vertexCount];
-	if(!vertices)
+	if(m_SpriteBatch->GetQuadCount() == 0)
 	{
-		return false;
+		return true;
 	}
 
-	// Create the index array.
-	indices = new unsigned long[(*sentence)->indexCount];
-	if(!indices)
+	// Write every queued glyph into the sprite ring in one go.
+	result = m_SpriteBatch->End();
+	if(result)
 	{
-		return false;
+		// Bind the font shader and let the batch draw once per texture.
+		result = m_FontShader->Bind(deviceContext, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture(), m_color);
+		if(result)
+		{
+			m_SpriteBatch->Render();
+		}
 	}
 
-	// Initialize vertex array to zeros at first.
-	memset(vertices, 0, (sizeof(VertexType) * (*sentence)->vertexCount));
+	// Start collecting the next frame's text.
+	m_SpriteBatch->Begin();
+
+	return result;
+}
 
-	// Initialize the index array.
-	for(i=0; i<(*sentence)->indexCount; i++)
-	{
-		indices[i] = i;
-	}
 
-	// Set up the description of the dynamic vertex buffer.
-    vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    vertexBufferDesc.ByteWidth = sizeof(VertexType) * (*sentence)->vertexCount;
-    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the vertex data.
-    vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Create the vertex buffer.
-    result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &(*sentence)->vertexBuffer);
-	if(FAILED(result))
+bool TextClass::InitializeSentence(SentenceType** sentence, int maxLength)
+{
+	// Create a new sentence object.
+	*sentence = new SentenceType;
+	if(!*sentence)
 	{
 		return false;
 	}
 
-	// Set up the description of the static index buffer.
-    indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    indexBufferDesc.ByteWidth = sizeof(unsigned long) * (*sentence)->indexCount;
-    indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    indexBufferDesc.CPUAccessFlags = 0;
-    indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the index data.
-    indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
-
-	// Create the index buffer.
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &(*sentence)->indexBuffer);
-	if(FAILED(result))
+	// Mark the sentence as never set so the first update always goes through.
+	(*sentence)->quadCount = 0;
+	(*sentence)->hash = 0;
+	(*sentence)->length = -1;
+	(*sentence)->lineCount = 0;
+	(*sentence)->positionY = -1;
+
+	// Set the maximum length of the sentence.
+	(*sentence)->maxLength = maxLength;
+
+	// Create the quad array, one quad per letter at most.
+	(*sentence)->quads = new SpriteQuad[maxLength];
+	if(!(*sentence)->quads)
 	{
 		return false;
 	}
 
-	// Release the vertex array as it is no longer needed.
-	delete [] vertices;
-	vertices = 0;
-
-	// Release the index array as it is no longer needed.
-	delete [] indices;
-	indices = 0;
-
 	return true;
 }
 
 
-bool TextClass::UpdateSentence(SentenceType* sentence, char* text, int positionX, int positionY, float red, float green, float blue,
-							   ID3D11DeviceContext* deviceContext)
+bool TextClass::UpdateSentence(SentenceType* sentence, const char* text, int positionX, int positionY, float red, float green, float blue)
 {
-	int numLetters;
-	VertexType* vertices;
+	int numLetters, numLines;
+	unsigned int hash;
 	float drawX, drawY;
-	HRESULT result;
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
+	const char* letter;
 
 
-	// Store the color of the sentence.
-	sentence->red = red;
-	sentence->green = green;
-	sentence->blue = blue;
+	// Hash the text to see whether it differs from what is already laid out, and count its lines.
+	hash = 2166136261u;
+	numLines = 1;
+	for(letter=text; *letter; letter++)
+	{
+		hash = (hash ^ (unsigned char)*letter) * 16777619u;
+		if(*letter == '\n')
+		{
+			numLines++;
+		}
+	}
 
 	// Get the number of letters in the sentence.
-	numLetters = (int)strlen(text);
+	numLetters = (int)(letter - text);
 
-	// Check for possible buffer overflow.
-	if(numLetters > sentence->maxLength)
+	// Nothing to do if the text, color and position are the same as last time.
+	if(numLetters == sentence->length && hash == sentence->hash && positionY == sentence->positionY &&
+		red == sentence->red && green == sentence->green && blue == sentence->blue)
 	{
-		return false;
+		return true;
 	}
 
-	// Create the vertex array.
-	vertices = new VertexType[sentence->vertexCount];
-	if(!vertices)
+	// Check for possible buffer overflow.
+	if(numLetters > sentence->maxLength)
 	{
 		return false;
 	}
 
-	// Initialize vertex array to zeros at first.
-	memset(vertices, 0, (sizeof(VertexType) * sentence->vertexCount));
+	// Store the color of the sentence.
+	sentence->red = red;
+	sentence->green = green;
+	sentence->blue = blue;
 
 	// Calculate the X and Y pixel position on the screen to start drawing to.
 	drawX = (float)(((m_screenWidth / 2) * -1) + positionX);
 	drawY = (float)((m_screenHeight / 2) - positionY);
 
-	// Use the font class to build the vertex array from the sentence text and sentence draw location.
-	m_Font->BuildVertexArray((void*)vertices, text, drawX, drawY);
+	// Use the font class to build the quad array from the sentence text and sentence draw location.
+	sentence->quadCount = m_Font->BuildQuadArray(sentence->quads, text, drawX, drawY);
 
-	// Lock the vertex buffer so it can be written to.
-	result = deviceContext->Map(sentence->vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	// Get a pointer to the data in the vertex buffer.
-	verticesPtr = (VertexType*)mappedResource.pData;
-
-	// Copy the data into the vertex buffer.
-	memcpy(verticesPtr, (void*)vertices, (sizeof(VertexType) * sentence->vertexCount));
-
-	// Unlock the vertex buffer.
-	deviceContext->Unmap(sentence->vertexBuffer, 0);
-
-	// Release the vertex array as it is no longer needed.
-	delete [] vertices;
-	vertices = 0;
-
-	//Conver the given Char* to a WCHAR for display.
-	size_t newsize = strlen(text) + 1;
-	wchar_t * wcstring = new wchar_t[newsize];
-	size_t convertedChars = 0;
-	mbstowcs_s(&convertedChars, wcstring, newsize, text, _TRUNCATE);
-
-	//Set the sentence object in our sentence struct.
-	sentence->sentence = wcstring;
+	sentence->hash = hash;
+	sentence->length = numLetters;
+	sentence->lineCount = numLines;
+	sentence->positionY = positionY;
 
 	return true;
 }
@@ -346,18 +300,11 @@ void TextClass::ReleaseSentence(SentenceType** sentence)
 {
 	if(*sentence)
 	{
-		// Release the sentence vertex buffer.
-		if((*sentence)->vertexBuffer)
-		{
-			(*sentence)->vertexBuffer->Release();
-			(*sentence)->vertexBuffer = 0;
-		}
-
-		// Release the sentence index buffer.
-		if((*sentence)->indexBuffer)
+		// Release the quad array.
+		if((*sentence)->quads)
 		{
-			(*sentence)->indexBuffer->Release();
-			(*sentence)->indexBuffer = 0;
+			delete [] (*sentence)->quads;
+			(*sentence)->quads = 0;
 		}
 
 		// Release the sentence.
@@ -369,53 +316,23 @@ void TextClass::ReleaseSentence(SentenceType** sentence)
 }
 
 
-bool TextClass::RenderSentence(ID3D11DeviceContext* deviceContext, SentenceType* sentence, const XMMATRIX &worldMatrix,
-	const XMMATRIX &orthoMatrix)
-{
-	unsigned int stride, offset;
-	XMFLOAT4 pixelColor;
-	bool result = true;
-
-
-	// Set vertex buffer stride and offset.
-    stride = sizeof(VertexType); 
-	offset = 0;
+bool TextClass::SetText(int index, const char* message, ID3D11DeviceContext* deviceContext) {
+	int positionY;
 
-	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetVertexBuffers(0, 1, &sentence->vertexBuffer, &stride, &offset);
 
-    // Set the index buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetIndexBuffer(sentence->indexBuffer, DXGI_FORMAT_R32_UINT, 0);
-
-    // Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-	// Create a pixel color vector with the input sentence color.
-	pixelColor = XMFLOAT4(sentence->red, sentence->green, sentence->blue, 1.0f);
-
-	// Render the text using the font shader.
-	//result = m_FontShader->Render(deviceContext, sentence->indexCount, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture(), 
-	//							  pixelColor);
-	//if(!result)
-	//{
-	//	false;
-	//}
-
-	//Color = 0xAABBGGRR
-	UINT32 color = 0xFF0000FF;
-
-	//RESTORESTATE flag = draw what was on the screen before the text was rendered as well
-	m_pFontWrapper->DrawString(deviceContext, sentence->sentence, 10.0f, 10.0f, 10.0f, color,
-		FW1_TOP | FW1_LEFT | FW1_RESTORESTATE);
-
-	return true;
-}
+	if (index < 0 || index >= TEXT_SENTENCE_COUNT) {
+		return false;
+	}
 
-bool TextClass::SetText(const char* message, ID3D11DeviceContext* deviceContext) {
-	char intersectionString[512];
+	// Stack the sentences down the screen below however many lines those above were laid out
+	// with, leaving a blank line between each. The sentences are set in order every frame, so
+	// the ones above are already up to date.
+	positionY = 20;
+	for (int i = 0; i < index; i++) {
+		positionY += (m_sentences[i]->lineCount + 1) * TEXT_LINE_HEIGHT;
+	}
 
-	strcpy_s(intersectionString, message);
-	return UpdateSentence(m_sentence1, intersectionString, 20, 20, 0.0f, 1.0f, 0.0f, deviceContext);
+	return UpdateSentence(m_sentences[index], message, 20, positionY, 0.0f, 1.0f, 0.0f);
 }
 
 bool TextClass::SetIntersection(bool intersection, ID3D11DeviceContext* deviceContext)
@@ -427,13 +344,13 @@ bool TextClass::SetIntersection(bool intersection, ID3D11DeviceContext* deviceCo
 	if(intersection)
 	{
 		strcpy_s(intersectionString, "Intersection: Y");
-		result = UpdateSentence(m_sentence1, intersectionString, 20, 20, 0.0f, 1.0f, 0.0f, deviceContext);
+		result = UpdateSentence(m_sentences[0], intersectionString, 20, 20, 0.0f, 1.0f, 0.0f);
 	}
 	else
 	{
 		strcpy_s(intersectionString, "Intersection: N");
-		result = UpdateSentence(m_sentence1, intersectionString, 20, 20, 1.0f, 0.0f, 0.0f, deviceContext);
+		result = UpdateSentence(m_sentences[0], intersectionString, 20, 20, 1.0f, 0.0f, 0.0f);
 	}
 
 	return result;
-}
\ No newline at end of file
+}
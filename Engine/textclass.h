@@ -9,9 +9,18 @@
 ///////////////////////
 #include "fontclass.h"
 #include "fontshaderclass.h"
-#include "FW1Library/Source/FW1Precompiled.h"
+#include "spritebatchclass.h"
+#include "d3d11renderbackendclass.h"
 
 
+/////////////
+// GLOBALS //
+/////////////
+const int TEXT_SENTENCE_COUNT = 4;
+const int TEXT_SENTENCE_LENGTH = 512;
+const int TEXT_MAX_QUADS = TEXT_SENTENCE_COUNT * TEXT_SENTENCE_LENGTH;
+const int TEXT_LINE_HEIGHT = 18;  // How far FontClass::BuildQuadArray moves down for each new line
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: TextClass
@@ -21,16 +30,12 @@ class TextClass
 private:
 	struct SentenceType
 	{
-		ID3D11Buffer *vertexBuffer, *indexBuffer;
-		int vertexCount, indexCount, maxLength;
+		SpriteQuad* quads;
+		int quadCount, maxLength;
 		float red, green, blue;
-		WCHAR* sentence;
-	};
-
-	struct VertexType
-	{
-		XMFLOAT3 position;
-		XMFLOAT2 texture;
+		unsigned int hash;
+		int length;
+		int lineCount, positionY;
 	};
 
 public:
@@ -38,29 +43,27 @@ public:
 	TextClass(const TextClass&);
 	~TextClass();
 
-	bool Initialize(ID3D11Device*, ID3D11DeviceContext*, HWND, int, int, const XMMATRIX&);
+	bool Initialize(ID3D11Device*, ID3D11DeviceContext*, HWND, int, int, const XMMATRIX&, RenderBackendClass*);
 	void Shutdown();
-	bool Render(ID3D11DeviceContext*, const XMMATRIX&, const XMMATRIX&);
+	bool Render(int);
+	bool Flush(ID3D11DeviceContext*, const XMMATRIX&, const XMMATRIX&);
 
 	bool SetIntersection(bool, ID3D11DeviceContext*);
-	bool SetText(const char* message, ID3D11DeviceContext* deviceContext);
+	bool SetText(int, const char* message, ID3D11DeviceContext* deviceContext);
 private:
-	bool InitializeSentence(SentenceType**, int, ID3D11Device*);
-	bool UpdateSentence(SentenceType*, char*, int, int, float, float, float, ID3D11DeviceContext*);
+	bool InitializeSentence(SentenceType**, int);
+	bool UpdateSentence(SentenceType*, const char*, int, int, float, float, float);
 	void ReleaseSentence(SentenceType**);
-	bool RenderSentence(ID3D11DeviceContext*, SentenceType*, const XMMATRIX&, const XMMATRIX&);
 
 private:
 	FontClass* m_Font;
 	FontShaderClass* m_FontShader;
+	SpriteBatchClass* m_SpriteBatch;
+	TextureHandle m_fontTexture;
+	XMFLOAT4 m_color;
 	int m_screenWidth, m_screenHeight;
 	XMMATRIX m_baseViewMatrix;
-	SentenceType* m_sentence1;
-
-	
-
-	IFW1Factory* m_pFW1Factory;
-	IFW1FontWrapper* m_pFontWrapper;
+	SentenceType* m_sentences[TEXT_SENTENCE_COUNT];
 };
 
 #endif
\ No newline at end of file
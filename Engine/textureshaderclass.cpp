@@ -11,6 +11,7 @@ TextureShaderClass::TextureShaderClass()
 	m_layout = 0;
 	m_matrixBuffer = 0;
 	m_sampleState = 0;
+	m_pipeline = 0;
 }
 
 
@@ -334,6 +335,56 @@ bool TextureShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext,
 }
 
 
+bool TextureShaderClass::CreatePipeline(RenderBackendClass* backend)
+{
+	PipelineDesc desc;
+
+
+	// Hand the compiled shader objects to the backend, the draw queue only refers to the returned handle.
+	desc.vertexShader = m_vertexShader;
+	desc.pixelShader = m_pixelShader;
+	desc.inputLayout = m_layout;
+	desc.sampleState = m_sampleState;
+
+	m_pipeline = backend->CreatePipeline(desc);
+	if(!m_pipeline)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool TextureShaderClass::Record(ConstantBufferRingClass* constantRing, DrawPacket& packet, const XMMATRIX &worldMatrix, const XMMATRIX &viewMatrix,
+	const XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
+{
+	MatrixBufferType* dataPtr;
+
+
+	// Allocate this draw's matrix constants from the frame ring.
+	if(!constantRing->Allocate(sizeof(MatrixBufferType), (void**)&dataPtr, packet.vsConstants[0]))
+	{
+		return false;
+	}
+
+	// Copy the transposed matrices into the ring.
+	dataPtr->world = XMMatrixTranspose(worldMatrix);
+	dataPtr->view = XMMatrixTranspose(viewMatrix);
+	dataPtr->projection = XMMatrixTranspose(projectionMatrix);
+
+	packet.vsConstantCount = 1;
+	packet.psConstantCount = 0;
+
+	// Record the shader objects and textures the draw will bind when the queue is executed.
+	packet.pipeline = m_pipeline;
+	packet.textures[0] = D3D11RenderBackendClass::WrapTexture(texture);
+	packet.textureCount = 1;
+
+	return true;
+}
+
+
 void TextureShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
 {
 	// Set the vertex input layout.
@@ -17,6 +17,13 @@ using namespace DirectX;
 using namespace std;
 
 
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "drawqueueclass.h"
+#include "d3d11renderbackendclass.h"
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: TextureShaderClass
 ////////////////////////////////////////////////////////////////////////////////
@@ -38,6 +45,8 @@ public:
 	bool Initialize(ID3D11Device*, HWND);
 	void Shutdown();
 	bool Render(ID3D11DeviceContext*, int, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*);
+	bool CreatePipeline(RenderBackendClass*);
+	bool Record(ConstantBufferRingClass*, DrawPacket&, const XMMATRIX&, const XMMATRIX&, const XMMATRIX&, ID3D11ShaderResourceView*);
 
 private:
 	bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
@@ -53,6 +62,7 @@ private:
 	ID3D11InputLayout* m_layout;
 	ID3D11Buffer* m_matrixBuffer;
 	ID3D11SamplerState* m_sampleState;
+	PipelineHandle m_pipeline;
 };
 
 #endif
\ No newline at end of file